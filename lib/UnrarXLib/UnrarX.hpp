@@ -43,8 +43,10 @@ int urarlib_get(char *rarfile, char *targetPath, char *fileToExtract, char *libp
   list      - Output. A list of file data of the files in the archive.
                 The list should be freed with urarlib_freelist().
   libpassword - Password (for encrypted archives)
+  complete    - Output, optional. false if the listing stopped early, e.g.
+                because the next volume is missing.
 \*-------------------------------------------------------------------------*/
-int urarlib_list(char *rarfile, ArchiveList_struct **ppList, char *libpassword = NULL, bool stopattwo=false);
+int urarlib_list(char *rarfile, ArchiveList_struct **ppList, char *libpassword = NULL, bool stopattwo=false, bool *complete = NULL);
 
 /*-------------------------------------------------------------------------*\
   Free the file list returned by urarlib_list()
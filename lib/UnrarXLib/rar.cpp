@@ -273,9 +273,13 @@ int urarlib_get(char *rarfile, char *targetPath, char *fileToExtract, char *libp
   list      - Output. A list of file data of the files in the archive.
                 The list should be freed with urarlib_freelist().
   libpassword - Password (for encrypted archives)
+  complete    - Output, optional. false if the listing stopped early, e.g.
+                because the next volume is missing.
 \*-------------------------------------------------------------------------*/
-int urarlib_list(char *rarfile, ArchiveList_struct **ppList, char *libpassword, bool stopattwo)
+int urarlib_list(char *rarfile, ArchiveList_struct **ppList, char *libpassword, bool stopattwo, bool *complete)
 {
+  if (complete)
+    *complete = false;
   if (!ppList)
     return 0;
   uint FileCount = 0;
@@ -308,6 +312,7 @@ int urarlib_list(char *rarfile, ArchiveList_struct **ppList, char *libpassword,
       *ppList = NULL;
       ArchiveList_struct *pPrev = NULL;
       int iArchive=0;
+      bool bStopped=false;
       while (1)
       {
         if (pArc->IsOpened() && pArc->IsArchive(true))
@@ -328,7 +333,10 @@ int urarlib_list(char *rarfile, ArchiveList_struct **ppList, char *libpassword,
               IntToExt(pArc->NewLhd.FileName,pArc->NewLhd.FileName);
               ArchiveList_struct *pCurr = (ArchiveList_struct *)malloc(sizeof(ArchiveList_struct));
               if (!pCurr)
+              {
+                bStopped = true;
                 break;
+              }
               if (pPrev)
                 pPrev->next = pCurr;
               if (!*ppList)
@@ -358,7 +366,10 @@ int urarlib_list(char *rarfile, ArchiveList_struct **ppList, char *libpassword,
               pPrev = pCurr;
               FileCount++;
               if (stopattwo && FileCount > 1)
+              {
+                bStopped = true;
                 break;
+              }
             }
             iOffset = pArc->NextBlockPos;
             if (iOffset > pArc->FileLength())
@@ -389,6 +400,9 @@ int urarlib_list(char *rarfile, ArchiveList_struct **ppList, char *libpassword,
                   if (arc.GetHeaderType() == FILE_HEAD)
                     if (stricmp(arc.NewLhd.FileName,pPrev->item.Name)==0)
                     {
+                      // only the whole set if the file doesn't continue in a missing volume
+                      if (complete && !(arc.NewLhd.Flags & LHD_SPLIT_AFTER))
+                        *complete = true;
                       bBreak=true;
                       break;  
                     }
@@ -407,10 +421,15 @@ int urarlib_list(char *rarfile, ArchiveList_struct **ppList, char *libpassword,
               pArc->Seek(0,SEEK_SET); 
             }
             else
-              break;
+              break; // the next volume is missing
           }
           else
+          {
+            // the last volume was listed
+            if (complete && !bStopped)
+              *complete = true;
             break;
+          }
         }
         else
           break;
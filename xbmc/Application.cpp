@@ -72,6 +72,7 @@
 #endif
 #include "utils/SystemInfo.h"
 #include "utils/TimeUtils.h"
+#include "utils/FrameProfiler.h"
 #include "GUILargeTextureManager.h"
 #include "TextureCache.h"
 #include "playlists/SmartPlayList.h"
@@ -1953,6 +1954,7 @@ void CApplication::Render()
     return;
 
   CDirtyRegionList dirtyRegions = g_windowManager.GetDirty();
+  int64_t renderStart = CurrentHostCounter();
   if(g_graphicsContext.GetStereoMode())
   {
     g_graphicsContext.SetStereoView(RENDER_STEREO_VIEW_LEFT);
@@ -1974,6 +1976,7 @@ void CApplication::Render()
   }
 
   g_Windowing.EndRender();
+  CFrameProfiler::Get().AddTime(FRAME_STAGE_RENDER, CurrentHostCounter() - renderStart);
 
   // execute post rendering actions (finalize window closing)
   g_windowManager.AfterRender();
@@ -2008,7 +2011,10 @@ void CApplication::Render()
   }
 
   if (flip)
+  {
+    CFrameProfileScope profile(FRAME_STAGE_PRESENT);
     g_graphicsContext.Flip(dirtyRegions);
+  }
 
   if (!extPlayerActive && g_graphicsContext.IsFullScreenVideo() && !m_pPlayer->IsPausedPlayback())
   {
@@ -2017,6 +2023,7 @@ void CApplication::Render()
 
   m_lastFrameTime = XbmcThreads::SystemClockMillis();
   CTimeUtils::UpdateFrameTime(flip, vsync);
+  CFrameProfiler::Get().EndFrame();
 
   g_renderManager.UpdateResolution();
   g_renderManager.ManageCaptures();
@@ -2471,7 +2478,10 @@ void CApplication::FrameMove(bool processEvents, bool processGUI)
   if (processGUI && m_renderGUI)
   {
     if (!m_bStop)
+    {
+      CFrameProfileScope profile(FRAME_STAGE_PROCESS);
       g_windowManager.Process(CTimeUtils::GetFrameTime());
+    }
     g_windowManager.FrameMove();
   }
 }
@@ -24,6 +24,10 @@
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 
+#include <algorithm>
+
+#define LOADER_PAGE_SIZE 20 // items loaded before checking which ones are in view
+
 using namespace std;
 
 CBackgroundInfoLoader::CBackgroundInfoLoader() : m_thread (NULL)
@@ -49,44 +53,10 @@ void CBackgroundInfoLoader::Run()
       OnLoaderStart();
 
       // Stage 1: All "fast" stuff we have already cached
-      for (vector<CFileItemPtr>::const_iterator iter = m_vecItems.begin(); iter != m_vecItems.end(); ++iter)
-      {
-        CFileItemPtr pItem = *iter;
-
-        // Ask the callback if we should abort
-        if ((m_pProgressCallback && m_pProgressCallback->Abort()) || m_bStop)
-          break;
-
-        try
-        {
-          if (LoadItemCached(pItem.get()) && m_pObserver)
-            m_pObserver->OnItemLoaded(pItem.get());
-        }
-        catch (...)
-        {
-          CLog::Log(LOGERROR, "CBackgroundInfoLoader::LoadItemCached - Unhandled exception for item %s", pItem->GetPath().c_str());
-        }
-      }
+      LoadItems(false);
 
       // Stage 2: All "slow" stuff that we need to lookup
-      for (vector<CFileItemPtr>::const_iterator iter = m_vecItems.begin(); iter != m_vecItems.end(); ++iter)
-      {
-        CFileItemPtr pItem = *iter;
-
-        // Ask the callback if we should abort
-        if ((m_pProgressCallback && m_pProgressCallback->Abort()) || m_bStop)
-          break;
-
-        try
-        {
-          if (LoadItemLookup(pItem.get()) && m_pObserver)
-            m_pObserver->OnItemLoaded(pItem.get());
-        }
-        catch (...)
-        {
-          CLog::Log(LOGERROR, "CBackgroundInfoLoader::LoadItemLookup - Unhandled exception for item %s", pItem->GetPath().c_str());
-        }
-      }
+      LoadItems(true);
     }
 
     OnLoaderFinish();
@@ -99,6 +69,60 @@ void CBackgroundInfoLoader::Run()
   }
 }
 
+void CBackgroundInfoLoader::LoadItems(bool lookup)
+{
+  vector<bool> loaded(m_vecItems.size());
+  size_t remaining = m_vecItems.size();
+  size_t next = 0;
+  CFileItemPtr focusItem;
+  while (remaining > 0)
+  {
+    // continue with the item in view if it changed
+    {
+      CSingleLock lock(m_lock);
+      if (m_focusItem && m_focusItem != focusItem)
+      {
+        focusItem = m_focusItem;
+        vector<CFileItemPtr>::const_iterator it = find(m_vecItems.begin(), m_vecItems.end(), focusItem);
+        if (it != m_vecItems.end())
+          next = max(it - m_vecItems.begin() - LOADER_PAGE_SIZE / 2, (ptrdiff_t)0);
+      }
+    }
+
+    for (int page = 0; page < LOADER_PAGE_SIZE && remaining > 0; next = (next + 1) % m_vecItems.size())
+    {
+      if (loaded[next])
+        continue;
+
+      // Ask the callback if we should abort
+      if ((m_pProgressCallback && m_pProgressCallback->Abort()) || m_bStop)
+        return;
+
+      CFileItemPtr pItem = m_vecItems[next];
+      loaded[next] = true;
+      remaining--;
+      page++;
+
+      try
+      {
+        if ((lookup ? LoadItemLookup(pItem.get()) : LoadItemCached(pItem.get())) && m_pObserver)
+          m_pObserver->OnItemLoaded(pItem.get());
+      }
+      catch (...)
+      {
+        CLog::Log(LOGERROR, "CBackgroundInfoLoader::%s - Unhandled exception for item %s",
+                  lookup ? "LoadItemLookup" : "LoadItemCached", pItem->GetPath().c_str());
+      }
+    }
+  }
+}
+
+void CBackgroundInfoLoader::SetFocusItem(const CFileItemPtr &item)
+{
+  CSingleLock lock(m_lock);
+  m_focusItem = item;
+}
+
 void CBackgroundInfoLoader::Load(CFileItemList& items)
 {
   StopThread();
@@ -139,6 +163,9 @@ void CBackgroundInfoLoader::StopThread()
   m_vecItems.clear();
   m_pVecItems = NULL;
   m_bIsLoading = false;
+
+  CSingleLock lock(m_lock);
+  m_focusItem.reset();
 }
 
 bool CBackgroundInfoLoader::IsLoading()
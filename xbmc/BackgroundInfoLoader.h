@@ -48,6 +48,14 @@ public:
   virtual void Run();
   void SetObserver(IBackgroundLoaderObserver* pObserver);
   void SetProgressCallback(IProgressCallback* pCallback);
+
+  /*! \brief Load the given item and the ones following it next
+   Items are loaded a page at a time. Windows call this as their view
+   scrolls, so that the items on screen are loaded first and the next
+   page is prefetched, whatever the size of the list.
+   \param item the item in view, e.g. the selected one.
+   */
+  void SetFocusItem(const CFileItemPtr &item);
   virtual bool LoadItem(CFileItem* pItem) { return false; };
   virtual bool LoadItemCached(CFileItem* pItem) { return false; };
   virtual bool LoadItemLookup(CFileItem* pItem) { return false; };
@@ -59,6 +67,11 @@ protected:
   virtual void OnLoaderStart() {};
   virtual void OnLoaderFinish() {};
 
+  /*! \brief Run one stage of loading over all items, a page at a time
+   \param lookup false for LoadItemCached(), true for LoadItemLookup()
+   */
+  void LoadItems(bool lookup);
+
   CFileItemList *m_pVecItems;
   std::vector<CFileItemPtr> m_vecItems; // FileItemList would delete the items and we only want to keep a reference.
   CCriticalSection m_lock;
@@ -69,5 +82,7 @@ protected:
 
   IBackgroundLoaderObserver* m_pObserver;
   IProgressCallback* m_pProgressCallback;
+
+  CFileItemPtr m_focusItem; ///< item to continue loading at, protected by m_lock
 };
 
@@ -585,14 +585,7 @@ void CFileItem::Serialize(CVariant& value) const
 {
   //CGUIListItem::Serialize(value["CGUIListItem"]);
 
-  value["strPath"] = m_strPath;
-  value["dateTime"] = (m_dateTime.IsValid()) ? m_dateTime.GetAsRFC1123DateTime() : "";
-  value["lastmodified"] = m_dateTime.IsValid() ? m_dateTime.GetAsDBDateTime() : "";
-  value["size"] = m_dwSize;
-  value["DVDLabel"] = m_strDVDLabel;
-  value["title"] = m_strTitle;
-  value["mimetype"] = m_mimetype;
-  value["extrainfo"] = m_extrainfo;
+  SerializeFields(value);
 
   if (m_musicInfoTag)
     (*m_musicInfoTag).Serialize(value["musicInfoTag"]);
@@ -607,6 +600,18 @@ void CFileItem::Serialize(CVariant& value) const
     (*m_gameInfoTag).Serialize(value["gameInfoTag"]);
 }
 
+void CFileItem::SerializeFields(CVariant& value) const
+{
+  value["strPath"] = m_strPath;
+  value["dateTime"] = (m_dateTime.IsValid()) ? m_dateTime.GetAsRFC1123DateTime() : "";
+  value["lastmodified"] = m_dateTime.IsValid() ? m_dateTime.GetAsDBDateTime() : "";
+  value["size"] = m_dwSize;
+  value["DVDLabel"] = m_strDVDLabel;
+  value["title"] = m_strTitle;
+  value["mimetype"] = m_mimetype;
+  value["extrainfo"] = m_extrainfo;
+}
+
 void CFileItem::ToSortable(SortItem &sortable, Field field) const
 {
   switch (field)
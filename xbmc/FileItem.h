@@ -135,6 +135,10 @@ public:
   const CFileItem& operator=(const CFileItem& item);
   virtual void Archive(CArchive& ar);
   virtual void Serialize(CVariant& value) const;
+  /*! \brief Serialize the properties of the item itself, without its info tags
+   \sa Serialize
+   */
+  void SerializeFields(CVariant& value) const;
   virtual void ToSortable(SortItem &sortable, Field field) const;
   void ToSortable(SortItem &sortable, const Fields &fields) const;
   virtual bool IsFileItem() const { return true; };
@@ -71,6 +71,7 @@
 #include "music/dialogs/GUIDialogMusicInfo.h"
 #include "storage/MediaManager.h"
 #include "utils/TimeUtils.h"
+#include "threads/Atomics.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 
@@ -126,6 +127,10 @@ CGUIInfoManager::CGUIInfoManager(void) :
   m_playerShowCodec = false;
   m_playerShowInfo = false;
   m_fps = 0.0f;
+  for (int i = 0; i < INFOSOURCE_COUNT; i++)
+    m_infoVersions[i] = 1;
+  m_wasPlaying = false;
+  m_clockTime = 0;
   ResetLibraryBools();
 }
 
@@ -5474,6 +5479,91 @@ void CGUIInfoManager::ResetCache()
   CSingleLock lock(m_critInfo);
   for (vector<InfoPtr>::iterator i = m_bools.begin(); i != m_bools.end(); ++i)
     (*i)->SetDirty();
+
+  // the player labels change every frame while playing, and once more after it stopped
+  bool playing = g_application.m_pPlayer->IsPlaying();
+  if (playing || m_wasPlaying)
+    InvalidateInfoSource(INFOSOURCE_PLAYER);
+  m_wasPlaying = playing;
+
+  time_t now = time(NULL);
+  if (now != m_clockTime)
+  {
+    m_clockTime = now;
+    InvalidateInfoSource(INFOSOURCE_CLOCK);
+  }
+}
+
+void CGUIInfoManager::InvalidateInfoSource(InfoSource source)
+{
+  AtomicIncrement(&m_infoVersions[source]);
+}
+
+unsigned int CGUIInfoManager::GetInfoVersion(int info) const
+{
+  int sources = GetInfoSources(info);
+  if (!sources)
+    return 0;
+
+  // versions only ever grow, so their sum changes when any of them does
+  unsigned int version = 0;
+  for (int source = 0; source < INFOSOURCE_COUNT; source++)
+  {
+    if (sources & (1 << source))
+      version += (unsigned int)m_infoVersions[source];
+  }
+  return version;
+}
+
+int CGUIInfoManager::GetInfoSources(int info) const
+{
+  if (info >= MULTI_INFO_START && info <= MULTI_INFO_END)
+  {
+    if (info - MULTI_INFO_START >= (int)m_multiInfo.size())
+      return 0;
+
+    switch (m_multiInfo[info - MULTI_INFO_START].m_info)
+    {
+    case SKIN_STRING:
+    case SKIN_BOOL:
+      return 1 << INFOSOURCE_SKIN;
+    case SYSTEM_TIME:
+    case SYSTEM_DATE:
+      return 1 << INFOSOURCE_CLOCK;
+    case PLAYER_TIME:
+    case PLAYER_TIME_REMAINING:
+    case PLAYER_TIME_SPEED:
+    case PLAYER_DURATION:
+    case PLAYER_SEEKTIME:
+      return 1 << INFOSOURCE_PLAYER;
+    case PLAYER_FINISH_TIME:
+    case PLAYER_START_TIME:
+      return (1 << INFOSOURCE_PLAYER) | (1 << INFOSOURCE_CLOCK);
+    default:
+      return 0;
+    }
+  }
+
+  // the labels of the playing item are empty unless something is playing
+  if ((info >= MUSICPLAYER_TITLE && info <= MUSICPLAYER_CONTENT) ||
+      (info >= VIDEOPLAYER_TITLE && info <= VIDEOPLAYER_IMDBNUMBER))
+    return 1 << INFOSOURCE_PLAYER;
+
+  switch (info)
+  {
+  case PLAYER_TIME:
+  case PLAYER_DURATION:
+  case PLAYER_CHAPTER:
+  case PLAYER_CHAPTERCOUNT:
+  case PLAYER_CHAPTERNAME:
+  case PLAYER_CACHELEVEL:
+    return 1 << INFOSOURCE_PLAYER;
+  case SYSTEM_TIME:
+  case SYSTEM_DATE:
+    return 1 << INFOSOURCE_CLOCK;
+  default:
+    return 0;
+  }
 }
 
 std::string CGUIInfoManager::GetPictureLabel(int info)
@@ -38,6 +38,7 @@
 
 #include <list>
 #include <map>
+#include <time.h>
 
 namespace MUSIC_INFO
 {
@@ -829,6 +830,33 @@ public:
   void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; };
 
   void ResetCache();
+
+  /*! \brief Sources that tell when the info labels depending on them may have changed
+   The current list item (ListItem.*, Container.*) and system stats (memory, cpu usage,
+   temperatures, network and the like) have no source, their labels are resolved every frame.
+   \sa GetInfoVersion
+   */
+  enum InfoSource
+  {
+    INFOSOURCE_PLAYER = 0, ///< playback, changes every frame while playing
+    INFOSOURCE_CLOCK,      ///< the current date and time, changes every second
+    INFOSOURCE_SKIN,       ///< skin strings and bools
+    INFOSOURCE_COUNT
+  };
+
+  /*! \brief Mark the info labels depending on a source as changed
+   \param source the source that changed
+   */
+  void InvalidateInfoSource(InfoSource source);
+
+  /*! \brief Get the version of everything an info label depends on
+   The version changes whenever the label may have changed, so a label resolved at
+   the same version doesn't need to be resolved again.
+   \param info the info label, as returned by TranslateString()
+   \return the version, 0 if the label has to be resolved every time
+   */
+  unsigned int GetInfoVersion(int info) const;
+
   bool GetItemInt(int &value, const CGUIListItem *item, int info) const;
   std::string GetItemLabel(const CFileItem *item, int info, std::string *fallback = NULL);
   std::string GetItemImage(const CFileItem *item, int info, std::string *fallback = NULL);
@@ -943,6 +971,13 @@ protected:
   bool m_playerShowCodec;
   bool m_playerShowInfo;
 
+  int GetInfoSources(int info) const;
+
+  // versions of the info sources
+  volatile long m_infoVersions[INFOSOURCE_COUNT];
+  bool m_wasPlaying;
+  time_t m_clockTime;
+
   // FPS counters
   float m_fps;
   unsigned int m_frameCounter;
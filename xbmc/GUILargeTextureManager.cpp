@@ -30,6 +30,9 @@
 #include "TextureCache.h"
 
 #include <cassert>
+#include <string.h>
+
+#define MAX_LOADING_JOBS 4 // images loaded at the same time
 
 using namespace std;
 
@@ -131,7 +134,11 @@ void CGUILargeTextureManager::CLargeTexture::SetTexture(CBaseTexture* texture)
 }
 
 CGUILargeTextureManager::CGUILargeTextureManager()
+  : m_running(0),
+    m_sequence(0),
+    m_requestDistance(0)
 {
+  memset(&m_stats, 0, sizeof(m_stats));
 }
 
 CGUILargeTextureManager::~CGUILargeTextureManager()
@@ -142,12 +149,12 @@ void CGUILargeTextureManager::CleanupUnusedImages(bool immediately)
 {
   CSingleLock lock(m_listSection);
   // check for items to remove from allocated list, and remove
-  listIterator it = m_allocated.begin();
+  AllocatedMap::iterator it = m_allocated.begin();
   while (it != m_allocated.end())
   {
-    CLargeTexture *image = *it;
+    CLargeTexture *image = it->second;
     if (image->DeleteIfRequired(immediately))
-      it = m_allocated.erase(it);
+      m_allocated.erase(it++);
     else
       ++it;
   }
@@ -158,19 +165,20 @@ void CGUILargeTextureManager::CleanupUnusedImages(bool immediately)
 bool CGUILargeTextureManager::GetImage(const std::string &path, CTextureArray &texture, bool firstRequest, const bool useCache)
 {
   CSingleLock lock(m_listSection);
-  for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+  AllocatedMap::iterator it = m_allocated.find(path);
+  if (it != m_allocated.end())
   {
-    CLargeTexture *image = *it;
-    if (image->GetPath() == path)
-    {
-      if (firstRequest)
-        image->AddRef();
-      texture = image->GetTexture();
-      return texture.size() > 0;
-    }
+    CLargeTexture *image = it->second;
+    if (firstRequest)
+      image->AddRef();
+    texture = image->GetTexture();
+    return texture.size() > 0;
   }
 
-  if (firstRequest)
+  QueuedMap::iterator queued = m_queued.find(path);
+  if (queued != m_queued.end())
+    RequestQueued(queued, firstRequest);
+  else if (firstRequest)
     QueueImage(path, useCache);
 
   return true;
@@ -179,68 +187,134 @@ bool CGUILargeTextureManager::GetImage(const std::string &path, CTextureArray &t
 void CGUILargeTextureManager::ReleaseImage(const std::string &path, bool immediately)
 {
   CSingleLock lock(m_listSection);
-  for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+  AllocatedMap::iterator it = m_allocated.find(path);
+  if (it != m_allocated.end())
   {
-    CLargeTexture *image = *it;
-    if (image->GetPath() == path)
-    {
-      if (image->DecrRef(immediately) && immediately)
-        m_allocated.erase(it);
-      return;
-    }
+    CLargeTexture *image = it->second;
+    if (image->DecrRef(immediately) && immediately)
+      m_allocated.erase(it);
+    return;
   }
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+
+  QueuedMap::iterator queued = m_queued.find(path);
+  if (queued != m_queued.end() && queued->second.m_image->DecrRef(true))
   {
-    unsigned int id = it->first;
-    CLargeTexture *image = it->second;
-    if (image->GetPath() == path && image->DecrRef(true))
-    {
-      // cancel this job
-      CJobManager::GetInstance().CancelJob(id);
-      m_queued.erase(it);
-      return;
-    }
+    // nobody wants this image anymore. A loader job may already be running and
+    // wouldn't report back once cancelled, so it keeps its loader until it completes.
+    if (queued->second.m_jobID)
+      m_abandoned.insert(queued->second.m_jobID);
+    else
+      m_waiting.erase(queued->second.m_key);
+    m_queued.erase(queued);
+    m_stats.cancelled++;
+    StartJobs();
   }
 }
 
+unsigned int CGUILargeTextureManager::SetRequestDistance(unsigned int distance)
+{
+  CSingleLock lock(m_listSection);
+  unsigned int previous = m_requestDistance;
+  m_requestDistance = distance;
+  return previous;
+}
+
+CGUILargeTextureManager::Stats CGUILargeTextureManager::GetStats() const
+{
+  CSingleLock lock(m_listSection);
+  Stats stats = m_stats;
+  stats.queued = m_queued.size();
+  return stats;
+}
+
 // queue the image, and start the background loader if necessary
 void CGUILargeTextureManager::QueueImage(const std::string &path, bool useCache)
 {
   CSingleLock lock(m_listSection);
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+  QueuedMap::iterator it = m_queued.insert(make_pair(path, CQueuedImage(new CLargeTexture(path), useCache))).first;
+  CQueuedImage &queued = it->second;
+  queued.m_key = ((uint64_t)m_requestDistance << 32) | m_sequence++;
+  queued.m_waited = m_requestDistance == 0;
+  m_waiting.insert(make_pair(queued.m_key, it));
+
+  if (queued.m_waited)
+    m_stats.waited++;
+  else
+    m_stats.prefetched++;
+  StartJobs();
+}
+
+// a queued image is requested again, possibly from an item nearer to or in view
+void CGUILargeTextureManager::RequestQueued(QueuedMap::iterator it, bool firstRequest)
+{
+  CQueuedImage &queued = it->second;
+  if (firstRequest)
+    queued.m_image->AddRef();
+
+  if (m_requestDistance == 0 && !queued.m_waited)
   {
-    CLargeTexture *image = it->second;
-    if (image->GetPath() == path)
-    {
-      image->AddRef();
-      return; // already queued
-    }
+    queued.m_waited = true;
+    m_stats.waited++;
   }
 
-  // queue the item
-  CLargeTexture *image = new CLargeTexture(path);
-  unsigned int jobID = CJobManager::GetInstance().AddJob(new CImageLoader(path, useCache), this, CJob::PRIORITY_NORMAL);
-  m_queued.push_back(make_pair(jobID, image));
+  // move it forward in the queue, keeping its order of arrival
+  uint64_t key = ((uint64_t)m_requestDistance << 32) | (queued.m_key & 0xffffffff);
+  if (!queued.m_jobID && key < queued.m_key)
+  {
+    m_waiting.erase(queued.m_key);
+    queued.m_key = key;
+    m_waiting.insert(make_pair(key, it));
+    StartJobs();
+  }
 }
 
-void CGUILargeTextureManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+// hand the most urgent images to the job manager. Prefetches are never allowed to take
+// the last loader, so that an image coming into view doesn't wait behind them.
+void CGUILargeTextureManager::StartJobs()
 {
-  // see if we still have this job id
-  CSingleLock lock(m_listSection);
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+  while (!m_waiting.empty() && m_running < MAX_LOADING_JOBS)
   {
-    if (it->first == jobID)
-    { // found our job
-      CImageLoader *loader = (CImageLoader *)job;
-      CLargeTexture *image = it->second;
-      image->SetTexture(loader->m_texture);
-      loader->m_texture = NULL; // we want to keep the texture, and jobs are auto-deleted.
-      m_queued.erase(it);
-      m_allocated.push_back(image);
-      return;
+    WaitingQueue::iterator next = m_waiting.begin();
+    bool prefetch = (next->first >> 32) > 0;
+    if (prefetch && m_running >= MAX_LOADING_JOBS - 1)
+      break;
+
+    QueuedMap::iterator it = next->second;
+    CImageLoader *loader = new CImageLoader(it->first, it->second.m_useCache);
+    unsigned int jobID = CJobManager::GetInstance().AddJob(loader, this, prefetch ? CJob::PRIORITY_LOW : CJob::PRIORITY_NORMAL);
+    if (!jobID)
+    { // the job manager is shutting down
+      delete loader;
+      break;
     }
+    it->second.m_jobID = jobID;
+    m_waiting.erase(next);
+    m_running++;
   }
 }
 
+void CGUILargeTextureManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  // see if we still have this job id
+  CSingleLock lock(m_listSection);
+  if (m_abandoned.erase(jobID))
+  { // the image was released while loading, the loader deletes the texture
+    m_running--;
+    StartJobs();
+    return;
+  }
 
+  CImageLoader *loader = (CImageLoader *)job;
+  QueuedMap::iterator it = m_queued.find(loader->m_path);
+  if (it == m_queued.end() || it->second.m_jobID != jobID)
+    return;
 
+  CLargeTexture *image = it->second.m_image;
+  image->SetTexture(loader->m_texture);
+  loader->m_texture = NULL; // we want to keep the texture, and jobs are auto-deleted.
+  m_queued.erase(it);
+  m_allocated.insert(make_pair(image->GetPath(), image));
+  m_running--;
+  m_stats.loaded++;
+  StartJobs();
+}
@@ -24,6 +24,10 @@
 #include "utils/Job.h"
 #include "guilib/TextureManager.h"
 
+#include <map>
+#include <set>
+#include <stdint.h>
+
 /*!
  \ingroup textures,jobs
  \brief Image loader job class
@@ -55,6 +59,11 @@ public:
  Used to load textures for the user interface asynchronously, allowing fluid framerates
  while background loading textures.
 
+ Requests are kept in a queue ordered by the distance of the requesting item from the
+ visible area (see SetRequestDistance()), and only a few of them are handed to the job
+ manager at a time. Textures in view are therefore loaded before those that are
+ prefetched, and requests that are released before they are started cost nothing.
+
  \sa IJobCallback, CGUITexture
  */
 class CGUILargeTextureManager : public IJobCallback
@@ -112,6 +121,33 @@ public:
    */
   void CleanupUnusedImages(bool immediately = false);
 
+  /*!
+   \brief Set how far the item the following requests are for is from the visible area.
+
+   Containers set this while processing the items they preload outside their visible area,
+   so that the images of those items are loaded after the visible ones, nearest first.
+   A request for an image that is still queued moves it forward if it comes from a nearer item.
+   Must be called from the thread that processes the GUI.
+
+   \param distance distance in rows, 0 for items in view.
+   \return the previous distance, to be restored once the item is processed.
+   \sa CGUIBaseContainer
+   */
+  unsigned int SetRequestDistance(unsigned int distance);
+
+  /*!
+   \brief Counters of the background loader.
+   */
+  struct Stats
+  {
+    unsigned int loaded;     ///< loads completed
+    unsigned int waited;     ///< loads that a texture in view had to wait for
+    unsigned int prefetched; ///< loads queued for items outside the visible area
+    unsigned int cancelled;  ///< loads dropped because the texture was released first
+    unsigned int queued;     ///< loads waiting or in progress right now
+  };
+  Stats GetStats() const;
+
 private:
   class CLargeTexture
   {
@@ -136,12 +172,34 @@ private:
     unsigned int m_timeToDelete;
   };
 
-  void QueueImage(const std::string &path, bool useCache = true);
+  class CQueuedImage
+  {
+  public:
+    CQueuedImage(CLargeTexture *image, bool useCache) : m_image(image), m_useCache(useCache), m_jobID(0), m_key(0), m_waited(false) {};
 
-  std::vector< std::pair<unsigned int, CLargeTexture *> > m_queued;
-  std::vector<CLargeTexture *> m_allocated;
-  typedef std::vector<CLargeTexture *>::iterator listIterator;
-  typedef std::vector< std::pair<unsigned int, CLargeTexture *> >::iterator queueIterator;
+    CLargeTexture *m_image;
+    bool m_useCache;
+    unsigned int m_jobID; ///< id of the loader job, 0 while waiting for a free loader
+    uint64_t m_key;       ///< position in the waiting queue, distance and order of arrival
+    bool m_waited;        ///< a texture in view is waiting for this image
+  };
+
+  typedef std::map<std::string, CLargeTexture *> AllocatedMap;
+  typedef std::map<std::string, CQueuedImage> QueuedMap;
+  typedef std::map<uint64_t, QueuedMap::iterator> WaitingQueue;
+
+  void QueueImage(const std::string &path, bool useCache = true);
+  void RequestQueued(QueuedMap::iterator it, bool firstRequest);
+  void StartJobs();
+
+  AllocatedMap m_allocated;
+  QueuedMap m_queued;      ///< images waiting or being loaded
+  WaitingQueue m_waiting;  ///< images waiting for a loader, most urgent first
+  unsigned int m_running;  ///< number of loader jobs, including abandoned ones
+  std::set<unsigned int> m_abandoned; ///< loader jobs of images that were released while loading
+  unsigned int m_sequence; ///< order of arrival of requests
+  unsigned int m_requestDistance;
+  Stats m_stats;
 
   CCriticalSection m_listSection;
 };
@@ -23,13 +23,16 @@
 #include "filesystem/File.h"
 #include "profiles/ProfilesManager.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/Crc32.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "utils/StringUtils.h"
+#include "windowing/WindowingFactory.h"
 #include "URL.h"
-#include "utils/StringUtils.h"
+
+#include <algorithm>
 
 using namespace XFILE;
 
@@ -39,7 +42,7 @@ CTextureCache &CTextureCache::Get()
   return s_cache;
 }
 
-CTextureCache::CTextureCache() : CJobQueue(false, 1, CJob::PRIORITY_LOW_PAUSABLE)
+CTextureCache::CTextureCache() : CJobQueue(false, 1, CJob::PRIORITY_LOW_PAUSABLE), m_pipeline(this)
 {
 }
 
@@ -52,10 +55,12 @@ void CTextureCache::Initialize()
   CSingleLock lock(m_databaseSection);
   if (!m_database.IsOpen())
     m_database.Open();
+  m_pipeline.Start();
 }
 
 void CTextureCache::Deinitialize()
 {
+  m_pipeline.Stop();
   CancelJobs();
   CSingleLock lock(m_databaseSection);
   m_database.Close();
@@ -102,6 +107,11 @@ bool CTextureCache::CanCacheImageURL(const CURL &url)
   return (url.GetUserName().empty() || url.GetUserName() == "music");
 }
 
+bool CTextureCache::UseCompressedTextures()
+{
+  return g_advancedSettings.m_textureCacheCompress && g_Windowing.SupportsDXT();
+}
+
 std::string CTextureCache::CheckCachedImage(const std::string &url, bool returnDDS, bool &needsRecaching)
 {
   CTextureDetails details;
@@ -114,7 +124,7 @@ std::string CTextureCache::CheckCachedImage(const std::string &url, bool returnD
       std::string ddsPath = URIUtils::ReplaceExtension(path, ".dds");
       if (CFile::Exists(ddsPath))
         return ddsPath;
-      if (g_advancedSettings.m_useDDSFanart)
+      if (g_advancedSettings.m_useDDSFanart || UseCompressedTextures())
         AddJob(new CTextureDDSJob(path));
     }
     return path;
@@ -130,7 +140,58 @@ void CTextureCache::BackgroundCacheImage(const std::string &url)
     return; // image is already cached and doesn't need to be checked further
 
   // needs (re)caching
-  AddJob(new CTextureCacheJob(CTextureUtils::UnwrapImageURL(url), details.hash));
+  m_pipeline.AddJob(new CTextureCacheJob(CTextureUtils::UnwrapImageURL(url), details.hash));
+}
+
+unsigned int CTextureCache::CacheImages(const std::vector<std::string> &images, CJob *job)
+{
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  uint64_t completed = m_pipeline.GetCompletedCount();
+  unsigned int queued = 0;
+  unsigned int compressed = 0;
+  bool cancelled = false;
+  bool compress = UseCompressedTextures();
+
+  for (unsigned int i = 0; i < images.size(); i++)
+  {
+    if (job && job->ShouldCancel(i, images.size()))
+    {
+      cancelled = true;
+      break;
+    }
+
+    CTextureDetails details;
+    std::string path(GetCachedImage(images[i], details));
+    if (!path.empty() && details.hash.empty())
+    { // cached already, but may have been cached before compressing was enabled
+      if (compress && !URIUtils::HasExtension(path, ".dds") && !CFile::Exists(URIUtils::ReplaceExtension(path, ".dds")))
+      {
+        AddJob(new CTextureDDSJob(path));
+        compressed++;
+      }
+      continue;
+    }
+
+    // waits while the pipeline is busy, so the list isn't queued all at once
+    if (!m_pipeline.AddJob(new CTextureCacheJob(CTextureUtils::UnwrapImageURL(images[i]), details.hash), true))
+      break;
+    queued++;
+  }
+
+  while (!m_pipeline.WaitIdle(1000))
+  {
+    if (job && !cancelled && job->ShouldCancel(images.size(), images.size()))
+      break;
+  }
+
+  // background requests finishing meanwhile are counted too, close enough for a throughput figure
+  unsigned int cached = (unsigned int)std::min<uint64_t>(m_pipeline.GetCompletedCount() - completed, queued);
+  float elapsed = (XbmcThreads::SystemClockMillis() - start) / 1000.0f;
+  CLog::Log(LOGNOTICE, "%s - cached %u of %u images in %.1f s (%.1f images/s), %u were cached already",
+            __FUNCTION__, cached, queued, elapsed, elapsed > 0.0f ? cached / elapsed : 0.0f, (unsigned int)images.size() - queued);
+  if (compressed)
+    CLog::Log(LOGNOTICE, "%s - compressing %u previously cached images in the background", __FUNCTION__, compressed);
+  return cached;
 }
 
 bool CTextureCache::CacheImage(const std::string &image, CTextureDetails &details)
@@ -263,6 +324,28 @@ std::string CTextureCache::GetCachedPath(const std::string &file)
   return URIUtils::AddFileToFolder(CProfilesManager::Get().GetThumbnailsFolder(), file);
 }
 
+bool CTextureCache::OnCachingStart(CTextureCacheJob *job)
+{
+  {
+    CSingleLock lock(m_processingSection);
+    if (!m_processinglist.insert(job->m_url).second)
+      return false; // being cached by someone else
+  }
+
+  // an earlier request for the same image may have cached it while this one was queued
+  CTextureDetails details;
+  std::string path(GetCachedImage(job->m_url, details));
+  if (path.empty() || !details.hash.empty())
+    return true;
+
+  {
+    CSingleLock lock(m_processingSection);
+    m_processinglist.erase(job->m_url);
+  }
+  m_completeEvent.Set();
+  return false;
+}
+
 void CTextureCache::OnCachingComplete(bool success, CTextureCacheJob *job)
 {
   if (success)
@@ -283,37 +366,11 @@ void CTextureCache::OnCachingComplete(bool success, CTextureCacheJob *job)
   m_completeEvent.Set();
 
   // TODO: call back to the UI indicating that it can update it's image...
-  if (success && g_advancedSettings.m_useDDSFanart && !job->m_details.file.empty())
+  // with compressed textures the job has written the .dds version already
+  if (success && g_advancedSettings.m_useDDSFanart && !UseCompressedTextures() && !job->m_details.file.empty())
     AddJob(new CTextureDDSJob(GetCachedPath(job->m_details.file)));
 }
 
-void CTextureCache::OnJobComplete(unsigned int jobID, bool success, CJob *job)
-{
-  if (strcmp(job->GetType(), kJobTypeCacheImage) == 0)
-    OnCachingComplete(success, (CTextureCacheJob *)job);
-  return CJobQueue::OnJobComplete(jobID, success, job);
-}
-
-void CTextureCache::OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob *job)
-{
-  if (strcmp(job->GetType(), kJobTypeCacheImage) == 0 && !progress)
-  { // check our processing list
-    {
-      CSingleLock lock(m_processingSection);
-      const CTextureCacheJob *cacheJob = (CTextureCacheJob *)job;
-      std::set<std::string>::iterator i = m_processinglist.find(cacheJob->m_url);
-      if (i == m_processinglist.end())
-      {
-        m_processinglist.insert(cacheJob->m_url);
-        return;
-      }
-    }
-    CancelJob(job);
-  }
-  else
-    CJobQueue::OnJobProgress(jobID, progress, total, job);
-}
-
 bool CTextureCache::Export(const std::string &image, const std::string &destination, bool overwrite)
 {
   CTextureDetails details;
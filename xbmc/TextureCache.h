@@ -24,6 +24,7 @@
 #include <string>
 #include <vector>
 #include "utils/JobManager.h"
+#include "TextureCachePipeline.h"
 #include "TextureDatabase.h"
 #include "threads/Event.h"
 
@@ -39,8 +40,11 @@ class CBaseTexture;
  may be periodically checked for updates and may be purged from the cache if
  unused for a set period of time.
 
+ Background caching runs on a CTextureCachePipeline, other jobs such as
+ creating .dds versions run on the job queue.
+
  */
-class CTextureCache : public CJobQueue
+class CTextureCache : public CJobQueue, public ITextureCacheCallback
 {
 public:
   /*!
@@ -82,6 +86,17 @@ public:
    */
   void BackgroundCacheImage(const std::string &image);
 
+  /*! \brief Cache a list of images in the background and wait for them
+   Images that are cached already and don't need checking are skipped. The images are
+   fed to the caching pipeline as fast as it takes them, and the throughput is logged
+   once all are done.
+   \param images urls of the images to cache
+   \param job [optional] job to report progress to, caching stops when it is cancelled
+   \return the number of images that had to be cached
+   \sa UseCompressedTextures, cached images without a .dds version get one in the background
+   */
+  unsigned int CacheImages(const std::vector<std::string> &images, CJob *job = NULL);
+
   /*! \brief Cache an image to image cache, optionally return the texture
 
    Caches the given image, returning the texture if the caller wants it.
@@ -141,6 +156,12 @@ public:
    */
   static bool CanCacheImageURL(const CURL &url);
 
+  /*! \brief whether cached images get a block compressed (.dds) version for the GUI
+   Enabled by the compress option of the texturecache advanced settings, if the GPU can use DXT textures.
+   The .dds versions are loaded straight into the GPU, without decoding the image.
+   */
+  static bool UseCompressedTextures();
+
   /*! \brief Add this image to the database
    Thread-safe wrapper of CTextureDatabase::AddCachedTexture
    \param image url of the original image
@@ -210,8 +231,13 @@ private:
    */
   bool SetCachedTextureValid(const std::string &url, bool updateable);
 
-  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
-  virtual void OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob *job);
+  /*! \brief Called when the pipeline is about to start a caching job.
+   Adds the job to our processing list unless the image is being cached
+   already or doesn't need caching any more.
+   \param job the caching job.
+   \return true if the job should be run, false otherwise.
+   */
+  virtual bool OnCachingStart(CTextureCacheJob *job);
 
   /*! \brief Called when a caching job has completed.
    Removes the job from our processing list, updates the database
@@ -219,8 +245,9 @@ private:
    \param success whether the job was successful.
    \param job the caching job.
    */
-  void OnCachingComplete(bool success, CTextureCacheJob *job);
+  virtual void OnCachingComplete(bool success, CTextureCacheJob *job);
 
+  CTextureCachePipeline m_pipeline;
   CCriticalSection m_databaseSection;
   CTextureDatabase m_database;
   std::set<std::string> m_processinglist; ///< currently processing list to avoid 2 jobs being processed at once
@@ -31,21 +31,34 @@
 #include "utils/StringUtils.h"
 #include "URL.h"
 #include "FileItem.h"
+#include "video/VideoDatabase.h"
+#include "music/MusicDatabase.h"
 #include "music/MusicThumbLoader.h"
 #include "music/tags/MusicInfoTag.h"
 #if defined(HAS_OMXPLAYER)
 #include "cores/omxplayer/OMXImage.h"
 #endif
 
+#include <string.h>
+
 CTextureCacheJob::CTextureCacheJob(const std::string &url, const std::string &oldHash):
   m_url(url),
   m_oldHash(oldHash),
-  m_cachePath(CTextureCache::GetCacheFile(m_url))
+  m_cachePath(CTextureCache::GetCacheFile(m_url)),
+  m_width(0),
+  m_height(0),
+  m_embedded(false),
+  m_keepTexture(false),
+  m_done(false),
+  m_texture(NULL),
+  m_scaled(NULL)
 {
 }
 
 CTextureCacheJob::~CTextureCacheJob()
 {
+  delete m_texture;
+  delete[] m_scaled;
 }
 
 bool CTextureCacheJob::operator==(const CJob* job) const
@@ -75,56 +88,172 @@ bool CTextureCacheJob::DoWork()
 }
 
 bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
+{
+  m_keepTexture = out_texture != NULL;
+  if (!Fetch())
+    return false;
+  if (!m_done && !(Decode() && Scale() && Encode()))
+    return false;
+
+  if (out_texture) // caller wants the texture
+  {
+    *out_texture = m_texture;
+    m_texture = NULL;
+#if defined(HAS_OMXPLAYER)
+    if (!*out_texture && !m_details.file.empty()) // cached by Fetch()
+      *out_texture = LoadImage(CTextureCache::GetCachedPath(m_details.file), m_details.width, m_details.height, "" /* already flipped */);
+#endif
+  }
+  return true;
+}
+
+bool CTextureCacheJob::Fetch()
 {
   // unwrap the URL as required
-  std::string additional_info;
-  unsigned int width, height;
-  std::string image = DecodeImageURL(m_url, width, height, additional_info);
+  m_image = DecodeImageURL(m_url, m_width, m_height, m_additionalInfo);
 
-  m_details.updateable = additional_info != "music" && UpdateableURL(image);
+  m_details.updateable = m_additionalInfo != "music" && UpdateableURL(m_image);
 
   // generate the hash
-  m_details.hash = GetImageHash(image);
+  m_details.hash = GetImageHash(m_image);
   if (m_details.hash.empty())
     return false;
   else if (m_details.hash == m_oldHash)
+  {
+    m_done = true;
     return true;
+  }
 
 #if defined(HAS_OMXPLAYER)
-  if (COMXImage::CreateThumb(image, width, height, additional_info, CTextureCache::GetCachedPath(m_cachePath + ".jpg")))
+  if (COMXImage::CreateThumb(m_image, m_width, m_height, m_additionalInfo, CTextureCache::GetCachedPath(m_cachePath + ".jpg")))
   {
-    m_details.width = width;
-    m_details.height = height;
+    m_details.width = m_width;
+    m_details.height = m_height;
     m_details.file = m_cachePath + ".jpg";
-    if (out_texture)
-      *out_texture = LoadImage(CTextureCache::GetCachedPath(m_details.file), width, height, "" /* already flipped */);
-    CLog::Log(LOGDEBUG, "Fast %s image '%s' to '%s': %p", m_oldHash.empty() ? "Caching" : "Recaching", image.c_str(), m_details.file.c_str(), out_texture);
+    CLog::Log(LOGDEBUG, "Fast %s image '%s' to '%s'", m_oldHash.empty() ? "Caching" : "Recaching", m_image.c_str(), m_details.file.c_str());
+    m_done = true;
     return true;
   }
 #endif
-  CBaseTexture *texture = LoadImage(image, width, height, additional_info, true);
-  if (texture)
-  {
-    if (texture->HasAlpha())
-      m_details.file = m_cachePath + ".png";
-    else
-      m_details.file = m_cachePath + ".jpg";
-
-    CLog::Log(LOGDEBUG, "%s image '%s' to '%s':", m_oldHash.empty() ? "Caching" : "Recaching", image.c_str(), m_details.file.c_str());
 
-    if (CPicture::CacheTexture(texture, width, height, CTextureCache::GetCachedPath(m_details.file)))
+  if (m_additionalInfo == "music")
+  { // special case for embedded music images
+    MUSIC_INFO::EmbeddedArt art;
+    if (CMusicThumbLoader::GetEmbeddedThumb(m_image, art))
     {
-      m_details.width = width;
-      m_details.height = height;
-      if (out_texture) // caller wants the texture
-        *out_texture = texture;
-      else
-        delete texture;
+      m_buffer.allocate(art.size);
+      memcpy(m_buffer.get(), &art.data[0], art.size);
+      m_mimeType = art.mime;
+      m_embedded = true;
       return true;
     }
   }
-  delete texture;
-  return false;
+
+  CFileItem file(m_image, false);
+  if (!IsImage(file))
+    return false;
+  m_mimeType = file.GetMimeType();
+
+  // .dds files are read by the texture itself in Decode()
+  if (URIUtils::HasExtension(m_image, ".dds"))
+    return true;
+
+  XFILE::CFile imageFile;
+  return imageFile.LoadFile(m_image, m_buffer) > 0;
+}
+
+bool CTextureCacheJob::Decode()
+{
+  if (m_embedded)
+    m_texture = CBaseTexture::LoadFromFileInMemory((unsigned char *)m_buffer.get(), m_buffer.size(), m_mimeType, m_width, m_height);
+  else if (m_buffer.size())
+    m_texture = CBaseTexture::LoadFromFileBuffer(m_image, (unsigned char *)m_buffer.get(), m_buffer.size(), m_width, m_height,
+                                                 CSettings::Get().GetBool("pictures.useexifrotation"), m_mimeType);
+  else
+    m_texture = CBaseTexture::LoadFromFile(m_image, m_width, m_height, CSettings::Get().GetBool("pictures.useexifrotation"), true, m_mimeType);
+  m_buffer.clear();
+  if (!m_texture)
+    return false;
+
+  // EXIF bits are interpreted as: <flipXY><flipY*flipX><flipX>
+  // where to undo the operation we apply them in reverse order <flipX>*<flipY*flipX>*<flipXY>
+  // When flipped we have an additional <flipX> on the left, which is equivalent to toggling the last bit
+  if (m_additionalInfo == "flipped")
+    m_texture->SetOrientation(m_texture->GetOrientation() ^ 1);
+
+  if (m_texture->HasAlpha())
+    m_details.file = m_cachePath + ".png";
+  else
+    m_details.file = m_cachePath + ".jpg";
+
+  CLog::Log(LOGDEBUG, "%s image '%s' to '%s':", m_oldHash.empty() ? "Caching" : "Recaching", m_image.c_str(), m_details.file.c_str());
+  return true;
+}
+
+bool CTextureCacheJob::Scale()
+{
+  if (!m_texture)
+    return false;
+
+  if (!CPicture::ScaleForCache(m_texture->GetPixels(), m_texture->GetWidth(), m_texture->GetHeight(), m_texture->GetPitch(),
+                               m_texture->GetOrientation(), m_width, m_height, m_scaled))
+    return false;
+
+  // the scaled image is all we need from here on
+  if (m_scaled && !m_keepTexture)
+  {
+    delete m_texture;
+    m_texture = NULL;
+  }
+  return true;
+}
+
+bool CTextureCacheJob::Encode()
+{
+  unsigned char *pixels;
+  unsigned int pitch;
+  if (m_scaled)
+  {
+    pixels = (unsigned char *)m_scaled;
+    pitch = m_width * 4;
+  }
+  else if (m_texture)
+  {
+    pixels = m_texture->GetPixels();
+    pitch = m_texture->GetPitch();
+  }
+  else
+    return false;
+
+  std::string path(CTextureCache::GetCachedPath(m_details.file));
+  bool success = CPicture::CreateThumbnailFromSurface(pixels, m_width, m_height, pitch, path);
+
+  // compress straight from the decoded image, rather than decoding the cached
+  // file again in a CTextureDDSJob. A .dds of an earlier version must go.
+  std::string ddsPath(URIUtils::ReplaceExtension(path, ".dds"));
+  if (success && CTextureCache::UseCompressedTextures())
+  {
+    CDDSImage dds;
+    if (!dds.Create(ddsPath, m_width, m_height, pitch, pixels, 0, true))
+      CLog::Log(LOGERROR, "%s - unable to write %s", __FUNCTION__, ddsPath.c_str());
+  }
+  else if (!m_oldHash.empty() && XFILE::CFile::Exists(ddsPath))
+    XFILE::CFile::Delete(ddsPath);
+
+  delete[] m_scaled;
+  m_scaled = NULL;
+  if (!m_keepTexture)
+  {
+    delete m_texture;
+    m_texture = NULL;
+  }
+
+  if (!success)
+    return false;
+
+  m_details.width = m_width;
+  m_details.height = m_height;
+  return true;
 }
 
 bool CTextureCacheJob::ResizeTexture(const std::string &url, uint8_t* &result, size_t &result_size)
@@ -197,9 +326,7 @@ CBaseTexture *CTextureCacheJob::LoadImage(const std::string &image, unsigned int
 
   // Validate file URL to see if it is an image
   CFileItem file(image, false);
-  file.FillInMimeType();
-  if (!(file.IsPicture() && !(file.IsZIP() || file.IsRAR() || file.IsCBR() || file.IsCBZ() ))
-      && !StringUtils::StartsWithNoCase(file.GetMimeType(), "image/") && !StringUtils::EqualsNoCase(file.GetMimeType(), "application/octet-stream")) // ignore non-pictures
+  if (!IsImage(file))
     return NULL;
 
   CBaseTexture *texture = CBaseTexture::LoadFromFile(image, width, height, CSettings::Get().GetBool("pictures.useexifrotation"), requirePixels, file.GetMimeType());
@@ -215,6 +342,15 @@ CBaseTexture *CTextureCacheJob::LoadImage(const std::string &image, unsigned int
   return texture;
 }
 
+bool CTextureCacheJob::IsImage(CFileItem &file)
+{
+  file.FillInMimeType();
+  if (!(file.IsPicture() && !(file.IsZIP() || file.IsRAR() || file.IsCBR() || file.IsCBZ() ))
+      && !StringUtils::StartsWithNoCase(file.GetMimeType(), "image/") && !StringUtils::EqualsNoCase(file.GetMimeType(), "application/octet-stream")) // ignore non-pictures
+    return false;
+  return true;
+}
+
 bool CTextureCacheJob::UpdateableURL(const std::string &url) const
 {
   // we don't constantly check online images
@@ -268,7 +404,9 @@ bool CTextureDDSJob::DoWork()
   { // convert to DDS
     CDDSImage dds;
     CLog::Log(LOGDEBUG, "Creating DDS version of: %s", m_original.c_str());
-    bool ret = dds.Create(URIUtils::ReplaceExtension(m_original, ".dds"), texture->GetWidth(), texture->GetHeight(), texture->GetPitch(), texture->GetPixels(), 40);
+    // compressed textures for the GUI trade some quality for speed
+    bool fast = CTextureCache::UseCompressedTextures();
+    bool ret = dds.Create(URIUtils::ReplaceExtension(m_original, ".dds"), texture->GetWidth(), texture->GetHeight(), texture->GetPitch(), texture->GetPixels(), fast ? 0 : 40, fast);
     delete texture;
     return ret;
   }
@@ -302,3 +440,29 @@ bool CTextureUseCountJob::DoWork()
   }
   return true;
 }
+
+bool CTexturePrecacheJob::operator==(const CJob* job) const
+{
+  return strcmp(job->GetType(), GetType()) == 0;
+}
+
+bool CTexturePrecacheJob::DoWork()
+{
+  std::vector<std::string> urls;
+  CVideoDatabase videodb;
+  if (videodb.Open())
+  {
+    videodb.GetArtURLs(urls);
+    videodb.Close();
+  }
+  CMusicDatabase musicdb;
+  if (musicdb.Open())
+  {
+    musicdb.GetArtURLs(urls);
+    musicdb.Close();
+  }
+
+  CLog::Log(LOGNOTICE, "%s - caching %u library images", __FUNCTION__, (unsigned int)urls.size());
+  CTextureCache::Get().CacheImages(urls, this);
+  return true;
+}
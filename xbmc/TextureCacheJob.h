@@ -24,8 +24,10 @@
 #include <string>
 #include <vector>
 #include "utils/Job.h"
+#include "utils/auto_buffer.h"
 
 class CBaseTexture;
+class CFileItem;
 
 /*!
  \ingroup textures
@@ -59,6 +61,11 @@ public:
  \brief Job class for caching textures
  
  Handles loading and caching of textures.
+
+ Caching is done in four stages: Fetch(), Decode(), Scale() and Encode().
+ CacheTexture() runs them all in a row, CTextureCachePipeline runs each of
+ them on its own set of threads so that fetching one image overlaps with
+ decoding and encoding others.
  */
 class CTextureCacheJob : public CJob
 {
@@ -77,6 +84,32 @@ public:
    */
   bool CacheTexture(CBaseTexture **texture = NULL);
 
+  /*! \brief Check the image for changes and read it into memory
+   \return false if the image can't be cached
+   \sa IsDone
+   */
+  bool Fetch();
+
+  /*! \brief Decode the image read by Fetch() into a texture
+   \return false if the image can't be decoded
+   */
+  bool Decode();
+
+  /*! \brief Resize, rotate and flip the decoded texture as needed
+   \return false if the texture can't be scaled
+   */
+  bool Scale();
+
+  /*! \brief Save the scaled image to the cache as JPG or PNG
+   \return false if the image can't be saved
+   */
+  bool Encode();
+
+  /*! \brief Whether the remaining stages can be skipped
+   True if the image is unchanged or was cached by Fetch() already.
+   */
+  bool IsDone() const { return m_done; };
+
   static bool ResizeTexture(const std::string &url, uint8_t* &result, size_t &result_size);
 
   std::string m_url;
@@ -121,7 +154,25 @@ private:
    */
   static CBaseTexture *LoadImage(const std::string &image, unsigned int width, unsigned int height, const std::string &additional_info, bool requirePixels = false);
 
+  /*! \brief Check whether the given file can be loaded as an image
+   \param file the file to check, the mime type is filled in as needed
+   */
+  static bool IsImage(CFileItem &file);
+
   std::string    m_cachePath;
+
+  // state passed between the caching stages
+  std::string    m_image;          ///< underlying image file
+  std::string    m_additionalInfo;
+  std::string    m_mimeType;
+  unsigned int   m_width;          ///< requested, then cached width
+  unsigned int   m_height;         ///< requested, then cached height
+  bool           m_embedded;       ///< m_buffer holds embedded music art
+  bool           m_keepTexture;    ///< the caller of CacheTexture() wants the texture
+  bool           m_done;
+  XUTILS::auto_buffer m_buffer;    ///< the image file, until decoded
+  CBaseTexture  *m_texture;        ///< the decoded image
+  uint32_t      *m_scaled;         ///< the scaled image, NULL if the texture is cached as is
 };
 
 /* \brief Job class for creating .dds versions of textures
@@ -152,3 +203,13 @@ public:
 private:
   std::vector<CTextureDetails> m_textures;
 };
+
+/* \brief Job class for caching all artwork of the video and music libraries
+ */
+class CTexturePrecacheJob : public CJob
+{
+public:
+  virtual const char* GetType() const { return "precacheart"; };
+  virtual bool operator==(const CJob *job) const;
+  virtual bool DoWork();
+};
@@ -0,0 +1,252 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TextureCachePipeline.h"
+#include "TextureCacheJob.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/JobManager.h"
+
+#include <vector>
+
+#define WORKER_IDLE_TIMEOUT 5000 // ms a worker waits for work before exiting
+#define WORKER_POLL_TIME     500 // ms between checks while jobs are paused
+
+CTextureCachePipeline::CWorker::CWorker(CTextureCachePipeline *pipeline, Stage stage)
+  : CThread("TextureCacheWorker"),
+    m_pipeline(pipeline),
+    m_stage(stage)
+{
+  Create(true); // start work immediately, and kill ourselves when we're done
+}
+
+void CTextureCachePipeline::CWorker::Process()
+{
+  SetPriority(GetMinPriority());
+  while (CTextureCacheJob *job = m_pipeline->GetNextJob(m_stage))
+    m_pipeline->RunStage(m_stage, job);
+}
+
+CTextureCachePipeline::CTextureCachePipeline(ITextureCacheCallback *callback)
+  : m_callback(callback),
+    m_pending(0),
+    m_completed(0),
+    m_stopping(false)
+{
+  Configure();
+}
+
+CTextureCachePipeline::~CTextureCachePipeline()
+{
+  Stop();
+}
+
+void CTextureCachePipeline::Configure()
+{
+  m_stages[STAGE_FETCH].maxWorkers  = g_advancedSettings.m_textureCacheFetchThreads;
+  m_stages[STAGE_DECODE].maxWorkers = g_advancedSettings.m_textureCacheDecodeThreads;
+  m_stages[STAGE_SCALE].maxWorkers  = g_advancedSettings.m_textureCacheScaleThreads;
+  m_stages[STAGE_ENCODE].maxWorkers = g_advancedSettings.m_textureCacheEncodeThreads;
+
+  // two jobs per worker keep a stage busy without piling up decoded images
+  for (unsigned int i = 0; i < STAGE_COUNT; i++)
+    m_stages[i].capacity = 2 * m_stages[i].maxWorkers;
+}
+
+void CTextureCachePipeline::Start()
+{
+  CSingleLock lock(m_section);
+  Configure();
+  m_stopping = false;
+}
+
+void CTextureCachePipeline::Stop()
+{
+  std::deque<CTextureCacheJob*> unstarted;
+  std::vector<CTextureCacheJob*> started;
+  {
+    CSingleLock lock(m_section);
+    m_stopping = true;
+    unstarted.swap(m_stages[STAGE_FETCH].jobs);
+    for (unsigned int i = STAGE_FETCH + 1; i < STAGE_COUNT; i++)
+    {
+      started.insert(started.end(), m_stages[i].jobs.begin(), m_stages[i].jobs.end());
+      m_stages[i].jobs.clear();
+    }
+    m_changed.notifyAll();
+  }
+
+  for (std::deque<CTextureCacheJob*>::iterator i = unstarted.begin(); i != unstarted.end(); ++i)
+    Drop(*i);
+  for (std::vector<CTextureCacheJob*>::iterator i = started.begin(); i != started.end(); ++i)
+    Finish(*i, false);
+
+  // wait for the workers, jobs they are running are dropped once the current stage is done
+  CSingleLock lock(m_section);
+  for (unsigned int i = 0; i < STAGE_COUNT; i++)
+  {
+    while (m_stages[i].workers)
+      m_changed.wait(lock);
+  }
+}
+
+bool CTextureCachePipeline::AddJob(CTextureCacheJob *job, bool wait)
+{
+  CSingleLock lock(m_section);
+  m_pending++;
+  while (wait && IsFull(STAGE_FETCH) && !m_stopping)
+    m_changed.wait(lock);
+
+  if (m_stopping)
+  {
+    lock.Leave();
+    Drop(job);
+    return false;
+  }
+
+  Push(STAGE_FETCH, job);
+  return true;
+}
+
+bool CTextureCachePipeline::WaitIdle(unsigned int milliseconds)
+{
+  XbmcThreads::EndTime timeout(milliseconds);
+  CSingleLock lock(m_section);
+  while (m_pending && !timeout.IsTimePast())
+    m_changed.wait(lock, timeout.MillisLeft());
+  return m_pending == 0;
+}
+
+uint64_t CTextureCachePipeline::GetCompletedCount() const
+{
+  CSingleLock lock(m_section);
+  return m_completed;
+}
+
+bool CTextureCachePipeline::IsFull(Stage stage) const
+{
+  const CStageQueue &queue = m_stages[stage];
+  return queue.capacity && queue.jobs.size() >= queue.capacity;
+}
+
+void CTextureCachePipeline::Push(Stage stage, CTextureCacheJob *job)
+{
+  CStageQueue &queue = m_stages[stage];
+  queue.jobs.push_back(job);
+
+  // start another worker if the idle ones can't take all queued jobs
+  if (queue.jobs.size() > queue.idleWorkers && queue.workers < queue.maxWorkers)
+  {
+    queue.workers++;
+    new CWorker(this, stage);
+  }
+  m_changed.notifyAll();
+}
+
+CTextureCacheJob *CTextureCachePipeline::GetNextJob(Stage stage)
+{
+  CSingleLock lock(m_section);
+  CStageQueue &queue = m_stages[stage];
+  XbmcThreads::EndTime idle(WORKER_IDLE_TIMEOUT);
+  while (!m_stopping)
+  {
+    if (!queue.jobs.empty())
+    {
+      if (!CJobManager::GetInstance().IsPaused())
+      {
+        CTextureCacheJob *job = queue.jobs.front();
+        queue.jobs.pop_front();
+        m_changed.notifyAll(); // there's room in this stage now
+        return job;
+      }
+      idle.Set(WORKER_IDLE_TIMEOUT); // paused, not idle
+    }
+    else if (idle.IsTimePast())
+      break;
+
+    queue.idleWorkers++;
+    m_changed.wait(lock, WORKER_POLL_TIME);
+    queue.idleWorkers--;
+  }
+
+  queue.workers--;
+  m_changed.notifyAll();
+  return NULL;
+}
+
+void CTextureCachePipeline::RunStage(Stage stage, CTextureCacheJob *job)
+{
+  if (stage == STAGE_FETCH && !m_callback->OnCachingStart(job))
+  {
+    Drop(job);
+    return;
+  }
+
+  bool success = false;
+  switch (stage)
+  {
+    case STAGE_FETCH:  success = job->Fetch();  break;
+    case STAGE_DECODE: success = job->Decode(); break;
+    case STAGE_SCALE:  success = job->Scale();  break;
+    case STAGE_ENCODE: success = job->Encode(); break;
+    default: break;
+  }
+
+  if (!success || job->IsDone() || stage == STAGE_ENCODE)
+  {
+    Finish(job, success);
+    return;
+  }
+
+  Stage next = (Stage)(stage + 1);
+  CSingleLock lock(m_section);
+  while (IsFull(next) && !m_stopping)
+    m_changed.wait(lock);
+
+  if (m_stopping)
+  {
+    lock.Leave();
+    Finish(job, false);
+    return;
+  }
+  Push(next, job);
+}
+
+void CTextureCachePipeline::Finish(CTextureCacheJob *job, bool success)
+{
+  m_callback->OnCachingComplete(success, job);
+  delete job;
+
+  CSingleLock lock(m_section);
+  m_pending--;
+  if (success)
+    m_completed++;
+  m_changed.notifyAll();
+}
+
+void CTextureCachePipeline::Drop(CTextureCacheJob *job)
+{
+  delete job;
+
+  CSingleLock lock(m_section);
+  m_pending--;
+  m_changed.notifyAll();
+}
@@ -0,0 +1,148 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <deque>
+#include <stdint.h>
+
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+
+class CTextureCacheJob;
+
+/*!
+ \ingroup textures
+ \brief Callback of the texture cache pipeline
+ */
+class ITextureCacheCallback
+{
+public:
+  virtual ~ITextureCacheCallback() {}
+
+  /*! \brief Called before a job is fetched
+   \return false to drop the job, e.g. because the image is cached already
+   */
+  virtual bool OnCachingStart(CTextureCacheJob *job) = 0;
+
+  /*! \brief Called once a started job has finished or was dropped
+   */
+  virtual void OnCachingComplete(bool success, CTextureCacheJob *job) = 0;
+};
+
+/*!
+ \ingroup textures
+ \brief Runs the stages of texture caching on separate sets of threads
+
+ Each stage of a CTextureCacheJob (fetch, decode, scale and encode) has its
+ own queue and its own number of worker threads, so slow network reads don't
+ keep the CPU bound stages idle and vice versa. The queues in front of the
+ decode, scale and encode stages are bounded; a stage that gets ahead of the
+ next one waits, which keeps the number of decoded images in memory low.
+
+ Workers are started as jobs arrive and exit once their stage has been idle
+ for a while. Like low priority jobs, the pipeline holds off while the job
+ manager is paused, e.g. during video playback.
+
+ Jobs the callback agreed to start end up in its OnCachingComplete(),
+ including those dropped by Stop(). All jobs are deleted by the pipeline.
+ */
+class CTextureCachePipeline
+{
+public:
+  enum Stage
+  {
+    STAGE_FETCH = 0,
+    STAGE_DECODE,
+    STAGE_SCALE,
+    STAGE_ENCODE,
+    STAGE_COUNT
+  };
+
+  CTextureCachePipeline(ITextureCacheCallback *callback);
+  ~CTextureCachePipeline();
+
+  /*! \brief Queue a job at the fetch stage
+   \param job the job to run, the pipeline takes ownership.
+   \param wait whether to wait for room in the fetch queue, for bulk producers.
+   \return false if the pipeline is stopped and the job was dropped.
+   */
+  bool AddJob(CTextureCacheJob *job, bool wait = false);
+
+  /*! \brief Wait for all queued jobs to finish
+   \param milliseconds the maximum time to wait
+   \return true if the pipeline is idle
+   */
+  bool WaitIdle(unsigned int milliseconds);
+
+  /*! \brief Drop all queued jobs and wait for the workers to exit
+   Dropped jobs that were started are passed to the callback as failed.
+   */
+  void Stop();
+
+  /*! \brief Allow jobs to be added again after Stop()
+   */
+  void Start();
+
+  /*! \brief Number of jobs that finished successfully since construction
+   */
+  uint64_t GetCompletedCount() const;
+
+private:
+  class CWorker : public CThread
+  {
+  public:
+    CWorker(CTextureCachePipeline *pipeline, Stage stage);
+  protected:
+    virtual void Process();
+  private:
+    CTextureCachePipeline *m_pipeline;
+    Stage m_stage;
+  };
+
+  struct CStageQueue
+  {
+    CStageQueue() : maxWorkers(1), capacity(0), workers(0), idleWorkers(0) {}
+    std::deque<CTextureCacheJob*> jobs;
+    unsigned int maxWorkers;
+    unsigned int capacity; ///< maximum number of queued jobs, 0 for no limit
+    unsigned int workers;
+    unsigned int idleWorkers;
+  };
+
+  CTextureCachePipeline(const CTextureCachePipeline&);
+  CTextureCachePipeline& operator=(const CTextureCachePipeline&);
+
+  void Configure();
+  bool IsFull(Stage stage) const;
+  void Push(Stage stage, CTextureCacheJob *job);
+  CTextureCacheJob *GetNextJob(Stage stage);
+  void RunStage(Stage stage, CTextureCacheJob *job);
+  void Finish(CTextureCacheJob *job, bool success);
+  void Drop(CTextureCacheJob *job);
+
+  ITextureCacheCallback *m_callback;
+  CStageQueue m_stages[STAGE_COUNT];
+  unsigned int m_pending; ///< jobs queued or running at any stage
+  uint64_t m_completed;
+  bool m_stopping;
+  mutable CCriticalSection m_section;
+  XbmcThreads::ConditionVariable m_changed;
+};
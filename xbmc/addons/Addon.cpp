@@ -222,12 +222,9 @@ void AddonProps::Serialize(CVariant &variant) const
   variant["author"] = author;
   variant["source"] = source;
 
-  if (CURL::IsFullPath(icon))
-    variant["icon"] = icon;
-  else
-    variant["icon"] = URIUtils::AddFileToFolder(path, icon);
-
-  variant["thumbnail"] = variant["icon"];
+  std::string iconPath = CURL::IsFullPath(icon) ? icon : URIUtils::AddFileToFolder(path, icon);
+  variant["icon"] = iconPath;
+  variant["thumbnail"] = iconPath;
   variant["disclaimer"] = disclaimer;
   variant["changelog"] = changelog;
 
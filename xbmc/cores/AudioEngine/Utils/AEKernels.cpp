@@ -0,0 +1,281 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEKernels.h"
+
+#include <algorithm>
+#include <math.h>
+
+#ifdef TARGET_WINDOWS
+#if (_M_IX86_FP>0 || defined(_M_X64)) && !defined(__SSE__)
+#define __SSE__
+#endif
+#endif
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+/* the avx2 kernels are compiled for that target only, the
+ * rest of the build doesn't need to be built for avx2 */
+#if defined(__SSE__) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define HAS_AE_AVX2
+#define AE_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(__SSE__) && defined(_MSC_VER) && _MSC_VER >= 1800
+#define HAS_AE_AVX2
+#define AE_TARGET_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define HAS_AE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+
+/*
+   This is a rational function to approximate a tanh-like soft clipper.
+   It is based on the pade-approximation of the tanh function with tweaked coefficients.
+   See: http://www.musicdsp.org/showone.php?id=238
+   At +-3 it reaches +-1, so the vector versions clamp the input to that range.
+*/
+inline float SoftClamp(const float x)
+{
+  if (x < -3.0f)
+    return -1.0f;
+  else if (x >  3.0f)
+    return 1.0f;
+  float y = x * x;
+  return x * (27.0f + y) / (27.0f + 9.0f * y);
+}
+
+/* plain C kernels, also used for the tails of the vector ones */
+
+void MulArrayC(float *data, const float mul, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    data[i] *= mul;
+}
+
+float MulAddPeakC(float *data, const float *add, const float mul, uint32_t count)
+{
+  float peak = 0.0f;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    data[i] += add[i] * mul;
+    peak = std::max(peak, fabsf(data[i]));
+  }
+  return peak;
+}
+
+bool MulAddArrayC(float *data, const float *add, const float mul, uint32_t count)
+{
+  return MulAddPeakC(data, add, mul, count) > 1.0f;
+}
+
+void ClampArrayC(float *data, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    data[i] = SoftClamp(data[i]);
+}
+
+const AEKernels kernelsC =
+{
+  MulArrayC,
+  MulAddArrayC,
+  ClampArrayC
+};
+
+#ifdef __SSE__
+
+void MulArraySSE(float *data, const float mul, uint32_t count)
+{
+  const __m128 m = _mm_set1_ps(mul);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), m));
+  MulArrayC(data + i, mul, count - i);
+}
+
+bool MulAddArraySSE(float *data, const float *add, const float mul, uint32_t count)
+{
+  const __m128 m    = _mm_set1_ps(mul);
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  __m128       peak = _mm_setzero_ps();
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 out = _mm_add_ps(_mm_loadu_ps(data + i), _mm_mul_ps(_mm_loadu_ps(add + i), m));
+    _mm_storeu_ps(data + i, out);
+    peak = _mm_max_ps(peak, _mm_andnot_ps(sign, out));
+  }
+
+  float peaks[4];
+  _mm_storeu_ps(peaks, peak);
+  float highest = std::max(std::max(peaks[0], peaks[1]), std::max(peaks[2], peaks[3]));
+  return std::max(highest, MulAddPeakC(data + i, add + i, mul, count - i)) > 1.0f;
+}
+
+void ClampArraySSE(float *data, uint32_t count)
+{
+  const __m128 c1  = _mm_set1_ps(27.0f);
+  const __m128 c9  = _mm_set1_ps(9.0f);
+  const __m128 max = _mm_set1_ps(3.0f);
+  const __m128 min = _mm_set1_ps(-3.0f);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(data + i), min), max);
+    __m128 y = _mm_mul_ps(x, x);
+    _mm_storeu_ps(data + i, _mm_div_ps(_mm_mul_ps(x, _mm_add_ps(c1, y)),
+                                       _mm_add_ps(c1, _mm_mul_ps(c9, y))));
+  }
+  ClampArrayC(data + i, count - i);
+}
+
+const AEKernels kernelsSSE =
+{
+  MulArraySSE,
+  MulAddArraySSE,
+  ClampArraySSE
+};
+
+#endif // __SSE__
+
+#ifdef HAS_AE_AVX2
+
+AE_TARGET_AVX2 void MulArrayAVX2(float *data, const float mul, uint32_t count)
+{
+  const __m256 m = _mm256_set1_ps(mul);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), m));
+  MulArrayC(data + i, mul, count - i);
+}
+
+AE_TARGET_AVX2 bool MulAddArrayAVX2(float *data, const float *add, const float mul, uint32_t count)
+{
+  const __m256 m    = _mm256_set1_ps(mul);
+  const __m256 abs  = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  __m256       peak = _mm256_setzero_ps();
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    // no fma, so that the result matches the other kernels
+    __m256 out = _mm256_add_ps(_mm256_loadu_ps(data + i), _mm256_mul_ps(_mm256_loadu_ps(add + i), m));
+    _mm256_storeu_ps(data + i, out);
+    peak = _mm256_max_ps(peak, _mm256_and_ps(out, abs));
+  }
+
+  float peaks[4];
+  _mm_storeu_ps(peaks, _mm_max_ps(_mm256_castps256_ps128(peak), _mm256_extractf128_ps(peak, 1)));
+  float highest = std::max(std::max(peaks[0], peaks[1]), std::max(peaks[2], peaks[3]));
+  return std::max(highest, MulAddPeakC(data + i, add + i, mul, count - i)) > 1.0f;
+}
+
+AE_TARGET_AVX2 void ClampArrayAVX2(float *data, uint32_t count)
+{
+  const __m256 c1  = _mm256_set1_ps(27.0f);
+  const __m256 c9  = _mm256_set1_ps(9.0f);
+  const __m256 max = _mm256_set1_ps(3.0f);
+  const __m256 min = _mm256_set1_ps(-3.0f);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 x = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(data + i), min), max);
+    __m256 y = _mm256_mul_ps(x, x);
+    _mm256_storeu_ps(data + i, _mm256_div_ps(_mm256_mul_ps(x, _mm256_add_ps(c1, y)),
+                                             _mm256_add_ps(c1, _mm256_mul_ps(c9, y))));
+  }
+  ClampArrayC(data + i, count - i);
+}
+
+const AEKernels kernelsAVX2 =
+{
+  MulArrayAVX2,
+  MulAddArrayAVX2,
+  ClampArrayAVX2
+};
+
+#endif // HAS_AE_AVX2
+
+#ifdef HAS_AE_NEON
+
+void MulArrayNEON(float *data, const float mul, uint32_t count)
+{
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    vst1q_f32(data + i, vmulq_n_f32(vld1q_f32(data + i), mul));
+  MulArrayC(data + i, mul, count - i);
+}
+
+bool MulAddArrayNEON(float *data, const float *add, const float mul, uint32_t count)
+{
+  float32x4_t peak = vdupq_n_f32(0.0f);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    float32x4_t out = vmlaq_n_f32(vld1q_f32(data + i), vld1q_f32(add + i), mul);
+    vst1q_f32(data + i, out);
+    peak = vmaxq_f32(peak, vabsq_f32(out));
+  }
+
+  float32x2_t peak2 = vpmax_f32(vget_low_f32(peak), vget_high_f32(peak));
+  float highest = std::max(vget_lane_f32(peak2, 0), vget_lane_f32(peak2, 1));
+  return std::max(highest, MulAddPeakC(data + i, add + i, mul, count - i)) > 1.0f;
+}
+
+// there is no vector division on armv7, the clamp stays scalar
+const AEKernels kernelsNEON =
+{
+  MulArrayNEON,
+  MulAddArrayNEON,
+  ClampArrayC
+};
+
+#endif // HAS_AE_NEON
+
+} // anonymous namespace
+
+const AEKernels* AEGetKernels(AEKernelSet set)
+{
+  switch (set)
+  {
+    case AE_KERNELS_C:
+      return &kernelsC;
+#ifdef __SSE__
+    case AE_KERNELS_SSE:
+      return &kernelsSSE;
+#endif
+#ifdef HAS_AE_AVX2
+    case AE_KERNELS_AVX2:
+      return &kernelsAVX2;
+#endif
+#ifdef HAS_AE_NEON
+    case AE_KERNELS_NEON:
+      return &kernelsNEON;
+#endif
+    default:
+      return NULL;
+  }
+}
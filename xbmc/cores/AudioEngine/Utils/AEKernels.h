@@ -0,0 +1,53 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+
+/*!
+ \brief instruction sets the sample processing kernels are available for
+ \sa CAEUtil::SetKernels
+ */
+enum AEKernelSet
+{
+  AE_KERNELS_C = 0,
+  AE_KERNELS_SSE,
+  AE_KERNELS_AVX2,
+  AE_KERNELS_NEON
+};
+
+/*!
+ \brief one implementation of the sample processing functions of CAEUtil
+
+ All functions work on unaligned buffers of any length.
+ */
+struct AEKernels
+{
+  void (*MulArray)   (float *data, const float mul, uint32_t count);
+  bool (*MulAddArray)(float *data, const float *add, const float mul, uint32_t count);
+  void (*ClampArray) (float *data, uint32_t count);
+};
+
+/*!
+ \brief get the kernels for an instruction set
+ \return the kernels, or NULL if they are not part of this build. Whether
+         the cpu supports them has to be checked by the caller.
+ */
+const AEKernels* AEGetKernels(AEKernelSet set);
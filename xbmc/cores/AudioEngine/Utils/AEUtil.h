@@ -20,6 +20,7 @@
  */
 
 #include "AEAudioFormat.h"
+#include "AEKernels.h"
 #include "PlatformDefs.h"
 #include <math.h>
 
@@ -141,7 +142,9 @@ private:
     static __m128i m_sseSeed;
   #endif
 
-  static float SoftClamp(const float x);
+  static const AEKernels *m_kernels;
+  static AEKernelSet      m_kernelSet;
+  static const AEKernels& Kernels();
 
 public:
   static CAEChannelInfo          GuessChLayout     (const unsigned int channels);
@@ -209,11 +212,35 @@ public:
     return 20*log10(scale);
   }
 
-  #ifdef __SSE__
-  static void SSEMulArray     (float *data, const float mul, uint32_t count);
-  static void SSEMulAddArray  (float *data, float *add, const float mul, uint32_t count);
-  #endif
-  static void ClampArray(float *data, uint32_t count);
+  /*! \brief select the implementation of the sample processing functions below
+   The best set supported by the cpu is selected on first use, so this is
+   only needed to compare them.
+   \param set the instruction set to use
+   \return false if the set isn't supported by this build or cpu
+   \sa GetKernels
+   */
+  static bool SetKernels(AEKernelSet set);
+  static AEKernelSet GetKernels();
+
+  /*! \brief multiply samples by a gain */
+  static void MulArray(float *data, const float mul, uint32_t count)
+  {
+    Kernels().MulArray(data, mul, count);
+  }
+
+  /*! \brief add samples multiplied by a gain
+   \return true if any of the resulting samples exceeds [-1, 1] and needs ClampArray
+   */
+  static bool MulAddArray(float *data, const float *add, const float mul, uint32_t count)
+  {
+    return Kernels().MulAddArray(data, add, mul, count);
+  }
+
+  /*! \brief soft clip samples to [-1, 1] */
+  static void ClampArray(float *data, uint32_t count)
+  {
+    Kernels().ClampArray(data, count);
+  }
 
   /*
     Rand implementations based on:
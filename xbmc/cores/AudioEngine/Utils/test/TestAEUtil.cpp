@@ -0,0 +1,125 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEUtil.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+namespace
+{
+const AEKernelSet kernelSets[]  = { AE_KERNELS_C, AE_KERNELS_SSE, AE_KERNELS_AVX2, AE_KERNELS_NEON };
+const char*       kernelNames[] = { "C", "SSE", "AVX2", "NEON" };
+const unsigned    kernelCount   = sizeof(kernelSets) / sizeof(kernelSets[0]);
+
+class CKernelsRestore
+{
+public:
+  CKernelsRestore() : m_set(CAEUtil::GetKernels()) {}
+  ~CKernelsRestore() { CAEUtil::SetKernels(m_set); }
+private:
+  AEKernelSet m_set;
+};
+
+std::vector<float> Noise(size_t count, float amplitude, unsigned int seed)
+{
+  std::vector<float> samples(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    samples[i] = amplitude * ((float)(seed >> 8) / (float)(1 << 24) * 2.0f - 1.0f);
+  }
+  return samples;
+}
+}
+
+TEST(TestAEUtil, MulAddMatchesC)
+{
+  CKernelsRestore restore;
+
+  // odd size and offset so that every kernel has to handle unaligned heads and tails
+  const size_t count = 1003;
+  std::vector<float> add = Noise(count + 1, 0.5f, 1);
+  std::vector<float> ref = Noise(count + 1, 0.5f, 2);
+  ASSERT_TRUE(CAEUtil::SetKernels(AE_KERNELS_C));
+  CAEUtil::MulAddArray(&ref[1], &add[1], 0.7f, count);
+  CAEUtil::MulArray(&ref[1], 0.9f, count);
+
+  for (unsigned k = 0; k < kernelCount; k++)
+  {
+    if (!CAEUtil::SetKernels(kernelSets[k]))
+      continue;
+    SCOPED_TRACE(kernelNames[k]);
+
+    std::vector<float> data = Noise(count + 1, 0.5f, 2);
+    EXPECT_FALSE(CAEUtil::MulAddArray(&data[1], &add[1], 0.7f, count));
+    CAEUtil::MulArray(&data[1], 0.9f, count);
+    for (size_t i = 1; i <= count; i++)
+      ASSERT_NEAR(ref[i], data[i], 1e-6f);
+  }
+}
+
+TEST(TestAEUtil, MulAddReportsClipping)
+{
+  CKernelsRestore restore;
+
+  for (unsigned k = 0; k < kernelCount; k++)
+  {
+    if (!CAEUtil::SetKernels(kernelSets[k]))
+      continue;
+    SCOPED_TRACE(kernelNames[k]);
+
+    // a single loud sample in the vector part and in the tail
+    for (size_t pos = 0; pos < 19; pos += 18)
+    {
+      std::vector<float> data(19, 0.5f);
+      std::vector<float> add(19, 0.25f);
+      EXPECT_FALSE(CAEUtil::MulAddArray(&data[0], &add[0], 1.0f, 19));
+      add[pos] = -4.0f;
+      EXPECT_TRUE(CAEUtil::MulAddArray(&data[0], &add[0], 1.0f, 19));
+    }
+  }
+}
+
+TEST(TestAEUtil, ClampMatchesC)
+{
+  CKernelsRestore restore;
+
+  const size_t count = 1001;
+  std::vector<float> ref = Noise(count, 5.0f, 3);
+  ASSERT_TRUE(CAEUtil::SetKernels(AE_KERNELS_C));
+  CAEUtil::ClampArray(&ref[0], count);
+
+  for (unsigned k = 0; k < kernelCount; k++)
+  {
+    if (!CAEUtil::SetKernels(kernelSets[k]))
+      continue;
+    SCOPED_TRACE(kernelNames[k]);
+
+    std::vector<float> data = Noise(count, 5.0f, 3);
+    CAEUtil::ClampArray(&data[0], count);
+    for (size_t i = 0; i < count; i++)
+    {
+      ASSERT_NEAR(ref[i], data[i], 1e-6f);
+      ASSERT_LE(fabsf(data[i]), 1.0f);
+    }
+  }
+}
@@ -25,6 +25,7 @@
 #include "RenderManager.h"
 #include "threads/CriticalSection.h"
 #include "video/VideoReferenceClock.h"
+#include "utils/FrameProfiler.h"
 #include "utils/MathUtils.h"
 #include "threads/Atomics.h"
 #include "threads/SingleLock.h"
@@ -789,6 +790,7 @@ void CXBMCRenderManager::RegisterRenderFeaturesCallBack(const void *ctx, RenderF
 
 void CXBMCRenderManager::Render(bool clear, DWORD flags, DWORD alpha, bool gui)
 {
+  CFrameProfileScope profile(FRAME_STAGE_VIDEO);
   CSharedLock lock(m_sharedSection);
 
   if (!gui && m_pRenderer->IsGuiLayer())
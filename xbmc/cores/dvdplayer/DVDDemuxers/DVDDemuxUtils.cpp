@@ -23,19 +23,190 @@
 #endif
 #include "DVDDemuxUtils.h"
 #include "DVDClock.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
 #include "utils/log.h"
 
+#include <vector>
+
 extern "C" {
 #include "libavcodec/avcodec.h"
 }
 
+namespace
+{
+/*!
+ \brief DemuxPacket as handed out by CDVDDemuxUtils, along with what's needed to recycle it.
+ The public DemuxPacket has to come first, as it's also part of the PVR add-on interface.
+ */
+struct DemuxPacketEx
+{
+  DemuxPacket  packet;
+  uint8_t     *buffer;      ///< pooled payload buffer, or NULL
+  int          sizeClass;   ///< size class of buffer, -1 if it is not pooled
+  AVBufferRef *reference;   ///< referenced ffmpeg payload, or NULL
+};
+
+/*!
+ \brief Recycles packets and their payload buffers.
+ Payload buffers are kept in power of two size classes, so that the steady stream
+ of similar sized packets from a demuxer is served without touching the heap.
+ */
+class CDemuxPacketPool
+{
+public:
+  static const int MIN_CLASS_SHIFT = 8;          ///< 256 bytes
+  static const int MAX_CLASS_SHIFT = 22;         ///< 4 MB, larger payloads aren't pooled
+  static const int NUM_CLASSES = MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1;
+  static const size_t MAX_POOLED_BYTES = 32 * 1024 * 1024;
+  static const size_t MAX_POOLED_PACKETS = 1024;
+
+  CDemuxPacketPool() : m_pooledBytes(0)
+  {
+    memset(&m_stats, 0, sizeof(m_stats));
+  }
+
+  ~CDemuxPacketPool()
+  {
+    for (int i = 0; i < NUM_CLASSES; i++)
+    {
+      for (std::vector<uint8_t*>::iterator it = m_buffers[i].begin(); it != m_buffers[i].end(); ++it)
+        _aligned_free(*it);
+    }
+    for (std::vector<DemuxPacketEx*>::iterator it = m_packets.begin(); it != m_packets.end(); ++it)
+      delete *it;
+  }
+
+  DemuxPacketEx *GetPacket()
+  {
+    DemuxPacketEx *packet = NULL;
+    {
+      CSingleLock lock(m_section);
+      m_stats.packets++;
+      if (!m_packets.empty())
+      {
+        packet = m_packets.back();
+        m_packets.pop_back();
+      }
+      else
+        m_stats.packetAllocs++;
+    }
+    if (!packet)
+      packet = new DemuxPacketEx;
+
+    memset(packet, 0, sizeof(DemuxPacketEx));
+    packet->sizeClass = -1;
+    return packet;
+  }
+
+  void ReleasePacket(DemuxPacketEx *packet)
+  {
+    if (packet->reference)
+      av_buffer_unref(&packet->reference);
+    if (packet->buffer)
+      ReleaseBuffer(packet->buffer, packet->sizeClass);
+
+    CSingleLock lock(m_section);
+    if (m_packets.size() < MAX_POOLED_PACKETS)
+    {
+      m_packets.push_back(packet);
+      return;
+    }
+    lock.Leave();
+    delete packet;
+  }
+
+  /*!
+   \brief Get a payload buffer of at least size bytes, plus the padding ffmpeg requires
+   \param sizeClass [out] the size class of the buffer, -1 if it is not pooled
+   */
+  uint8_t *GetBuffer(int size, int &sizeClass)
+  {
+    sizeClass = GetSizeClass(size);
+    if (sizeClass >= 0)
+    {
+      CSingleLock lock(m_section);
+      if (!m_buffers[sizeClass].empty())
+      {
+        uint8_t *buffer = m_buffers[sizeClass].back();
+        m_buffers[sizeClass].pop_back();
+        m_pooledBytes -= GetClassSize(sizeClass);
+        return buffer;
+      }
+      m_stats.bufferAllocs++;
+      lock.Leave();
+      return (uint8_t*)_aligned_malloc(GetClassSize(sizeClass) + FF_INPUT_BUFFER_PADDING_SIZE, 16);
+    }
+
+    {
+      CSingleLock lock(m_section);
+      m_stats.bufferAllocs++;
+    }
+    return (uint8_t*)_aligned_malloc(size + FF_INPUT_BUFFER_PADDING_SIZE, 16);
+  }
+
+  void ReleaseBuffer(uint8_t *buffer, int sizeClass)
+  {
+    if (sizeClass >= 0)
+    {
+      CSingleLock lock(m_section);
+      if (m_pooledBytes + GetClassSize(sizeClass) <= MAX_POOLED_BYTES)
+      {
+        m_buffers[sizeClass].push_back(buffer);
+        m_pooledBytes += GetClassSize(sizeClass);
+        return;
+      }
+    }
+    _aligned_free(buffer);
+  }
+
+  void CountReference()
+  {
+    CSingleLock lock(m_section);
+    m_stats.referenced++;
+  }
+
+  void GetStats(DemuxPacketPoolStats &stats)
+  {
+    CSingleLock lock(m_section);
+    stats = m_stats;
+    stats.pooledBytes = m_pooledBytes;
+  }
+
+private:
+  static int GetSizeClass(int size)
+  {
+    int sizeClass = 0;
+    while (sizeClass < NUM_CLASSES && GetClassSize(sizeClass) < (size_t)size)
+      sizeClass++;
+    return sizeClass < NUM_CLASSES ? sizeClass : -1;
+  }
+
+  static size_t GetClassSize(int sizeClass)
+  {
+    return (size_t)1 << (sizeClass + MIN_CLASS_SHIFT);
+  }
+
+  CCriticalSection m_section;
+  std::vector<uint8_t*> m_buffers[NUM_CLASSES];
+  std::vector<DemuxPacketEx*> m_packets;
+  size_t m_pooledBytes;
+  DemuxPacketPoolStats m_stats;
+};
+
+CDemuxPacketPool &GetPool()
+{
+  static CDemuxPacketPool pool;
+  return pool;
+}
+}
+
 void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 {
   if (pPacket)
   {
     try {
-      if (pPacket->pData) _aligned_free(pPacket->pData);
-      delete pPacket;
+      GetPool().ReleasePacket((DemuxPacketEx*)pPacket);
     }
     catch(...) {
       CLog::Log(LOGERROR, "%s - Exception thrown while freeing packet", __FUNCTION__);
@@ -45,13 +216,12 @@ void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 
 DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
 {
-  DemuxPacket* pPacket = new DemuxPacket;
-  if (!pPacket) return NULL;
+  DemuxPacketEx* pPacketEx = GetPool().GetPacket();
+  if (!pPacketEx) return NULL;
 
+  DemuxPacket* pPacket = &pPacketEx->packet;
   try
   {
-    memset(pPacket, 0, sizeof(DemuxPacket));
-
     if (iDataSize > 0)
     {
       // need to allocate a few bytes more.
@@ -63,12 +233,13 @@ DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
         * Note, if the first 23 bits of the additional bytes are not 0 then damaged
         * MPEG bitstreams could cause overread and segfault
         */
-      pPacket->pData =(uint8_t*)_aligned_malloc(iDataSize + FF_INPUT_BUFFER_PADDING_SIZE, 16);
-      if (!pPacket->pData)
+      pPacketEx->buffer = GetPool().GetBuffer(iDataSize, pPacketEx->sizeClass);
+      if (!pPacketEx->buffer)
       {
         FreeDemuxPacket(pPacket);
         return NULL;
       }
+      pPacket->pData = pPacketEx->buffer;
 
       // reset the last 8 bytes to 0;
       memset(pPacket->pData + iDataSize, 0, FF_INPUT_BUFFER_PADDING_SIZE);
@@ -87,3 +258,60 @@ DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
   }
   return pPacket;
 }
+
+namespace
+{
+// ffmpeg zeroes the padding at the end of a packet buffer, but a packet may be a
+// part of its buffer (parser output, split packets) followed by more payload
+bool HasZeroPadding(const AVPacket *pkt)
+{
+  const uint8_t *end = pkt->data + pkt->size;
+  if (end < pkt->buf->data || end + FF_INPUT_BUFFER_PADDING_SIZE > pkt->buf->data + pkt->buf->size)
+    return false;
+
+  for (int i = 0; i < FF_INPUT_BUFFER_PADDING_SIZE; i++)
+  {
+    if (end[i])
+      return false;
+  }
+  return true;
+}
+}
+
+DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(AVPacket *pkt)
+{
+  // packets followed by zeroed padding in their buffer can be handed on as they are
+  if (pkt->buf && pkt->data && pkt->size > 0 && HasZeroPadding(pkt))
+  {
+    AVBufferRef *reference = av_buffer_ref(pkt->buf);
+    if (reference)
+    {
+      DemuxPacket* pPacket = AllocateDemuxPacket(0);
+      if (!pPacket)
+      {
+        av_buffer_unref(&reference);
+        return NULL;
+      }
+      ((DemuxPacketEx*)pPacket)->reference = reference;
+      pPacket->pData = pkt->data;
+      pPacket->iSize = pkt->size;
+      GetPool().CountReference();
+      return pPacket;
+    }
+  }
+
+  // not reference counted or not padded, so we need our own copy
+  DemuxPacket* pPacket = AllocateDemuxPacket(pkt->size);
+  if (pPacket && pkt->size > 0)
+  {
+    pPacket->iSize = pkt->size;
+    if (pkt->data)
+      memcpy(pPacket->pData, pkt->data, pkt->size);
+  }
+  return pPacket;
+}
+
+void CDVDDemuxUtils::GetPoolStats(DemuxPacketPoolStats &stats)
+{
+  GetPool().GetStats(stats);
+}
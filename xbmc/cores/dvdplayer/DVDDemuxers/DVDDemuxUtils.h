@@ -22,10 +22,36 @@
 
 #include "DVDDemuxPacket.h"
 
+struct AVPacket;
+
+/*!
+ \brief Counters of the demux packet pool, see CDVDDemuxUtils::GetPoolStats()
+ */
+struct DemuxPacketPoolStats
+{
+  unsigned int packets;         ///< packets handed out since startup
+  unsigned int packetAllocs;    ///< packets that needed a heap allocation
+  unsigned int bufferAllocs;    ///< payload buffers that needed a heap allocation
+  unsigned int referenced;      ///< packets that reference an ffmpeg buffer instead of a copy
+  unsigned int pooledBytes;     ///< size of the idle buffers currently kept in the pool
+};
+
 class CDVDDemuxUtils
 {
 public:
   static void FreeDemuxPacket(DemuxPacket* pPacket);
   static DemuxPacket* AllocateDemuxPacket(int iDataSize = 0);
+
+  /*!
+   \brief Allocate a packet holding the payload of an ffmpeg packet.
+   Reference counted payloads are shared with ffmpeg rather than copied, so the
+   payload of the returned packet must be treated as read only. The caller still
+   owns (and has to free) the AVPacket.
+   \param pkt the packet read from ffmpeg
+   \return the packet, with pData and iSize set, or NULL on failure
+   */
+  static DemuxPacket* AllocateDemuxPacket(AVPacket *pkt);
+
+  static void GetPoolStats(DemuxPacketPoolStats &stats);
 };
 
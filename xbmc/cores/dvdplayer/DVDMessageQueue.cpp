@@ -27,7 +27,7 @@
 
 using namespace std;
 
-CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true), m_owner(owner)
+CDVDMessageQueue::CDVDMessageQueue(const string &owner, bool ringBuffer) : m_hEvent(true), m_owner(owner), m_ringBuffer(ringBuffer)
 {
   m_iDataSize     = 0;
   m_bAbortRequest = false;
@@ -39,6 +39,14 @@ CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true), m_owne
   m_TimeFront     = DVD_NOPTS_VALUE;
   m_TimeSize      = 1.0 / 4.0; /* 4 seconds */
   m_iMaxDataSize  = 0;
+
+  m_listCount     = 0;
+  m_ringHead      = 0;
+  m_ringTail      = 0;
+  m_overflowCount = 0;
+  m_waiting       = false;
+  if (m_ringBuffer)
+    m_ring.resize(RING_SIZE, NULL);
 }
 
 CDVDMessageQueue::~CDVDMessageQueue()
@@ -59,6 +67,9 @@ void CDVDMessageQueue::Init()
 
 void CDVDMessageQueue::Flush(CDVDMsg::Message type)
 {
+  // we own both ends of the ring while holding both locks
+  CSingleLock producerLock(m_producerSection);
+  CSingleLock consumerLock(m_consumerSection);
   CSingleLock lock(m_section);
 
   for(SList::iterator it = m_list.begin(); it != m_list.end();)
@@ -68,6 +79,34 @@ void CDVDMessageQueue::Flush(CDVDMsg::Message type)
     else
       ++it;
   }
+  m_listCount = m_list.size();
+
+  if (m_ringBuffer)
+  {
+    std::vector<CDVDMsg*> keep;
+    CDVDMsg* msg;
+    while (GetRing(&msg))
+    {
+      if (msg->IsType(type) || type == CDVDMsg::NONE)
+        msg->Release();
+      else
+        keep.push_back(msg);
+    }
+    for (std::deque<CDVDMsg*>::iterator it = m_overflow.begin(); it != m_overflow.end(); ++it)
+    {
+      if ((*it)->IsType(type) || type == CDVDMsg::NONE)
+        (*it)->Release();
+      else
+        keep.push_back(*it);
+    }
+    m_overflow.clear();
+    for (std::vector<CDVDMsg*>::iterator it = keep.begin(); it != keep.end(); ++it)
+    {
+      if (!PutRing(*it))
+        m_overflow.push_back(*it);
+    }
+    m_overflowCount = m_overflow.size();
+  }
 
   if (type == CDVDMsg::DEMUXER_PACKET ||  type == CDVDMsg::NONE)
   {
@@ -89,20 +128,84 @@ void CDVDMessageQueue::Abort()
 
 void CDVDMessageQueue::End()
 {
-  CSingleLock lock(m_section);
-
   Flush(CDVDMsg::NONE);
 
+  CSingleLock lock(m_section);
+
   m_bInitialized  = false;
   m_iDataSize     = 0;
   m_bAbortRequest = false;
 }
 
+bool CDVDMessageQueue::PutRing(CDVDMsg* pMsg)
+{
+  unsigned int tail = m_ringTail;
+  if (tail - m_ringHead >= RING_SIZE)
+    return false;
 
-MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
+  m_ring[tail & (RING_SIZE - 1)] = pMsg;
+  m_ringTail = tail + 1;
+  return true;
+}
+
+bool CDVDMessageQueue::GetRing(CDVDMsg** pMsg)
 {
-  CSingleLock lock(m_section);
+  unsigned int head = m_ringHead;
+  if (head == m_ringTail)
+    return false;
+
+  *pMsg = m_ring[head & (RING_SIZE - 1)];
+  m_ringHead = head + 1;
+  return true;
+}
 
+bool CDVDMessageQueue::MoveOverflowToRing()
+{
+  while (!m_overflow.empty() && PutRing(m_overflow.front()))
+    m_overflow.pop_front();
+  m_overflowCount = m_overflow.size();
+  return m_overflow.empty();
+}
+
+void CDVDMessageQueue::AddPacket(CDVDMsg* pMsg)
+{
+  if (!pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return;
+
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  if(packet)
+  {
+    m_iDataSize += packet->iSize;
+    if     (packet->dts != DVD_NOPTS_VALUE)
+      m_TimeFront = packet->dts;
+    else if(packet->pts != DVD_NOPTS_VALUE)
+      m_TimeFront = packet->pts;
+    if(m_TimeBack == DVD_NOPTS_VALUE)
+      m_TimeBack = m_TimeFront.load();
+  }
+}
+
+void CDVDMessageQueue::RemovePacket(CDVDMsg* pMsg)
+{
+  if (!pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return;
+
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  if(packet)
+  {
+    m_iDataSize -= packet->iSize;
+    if     (packet->dts != DVD_NOPTS_VALUE)
+      m_TimeBack = packet->dts;
+    else if(packet->pts != DVD_NOPTS_VALUE)
+      m_TimeBack = packet->pts;
+  }
+
+  if(m_bEmptied && m_iDataSize > 0)
+    m_bEmptied = false;
+}
+
+MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
+{
   if (!m_bInitialized)
   {
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Put MSGQ_NOT_INITIALIZED", m_owner.c_str());
@@ -115,6 +218,29 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
     return MSGQ_INVALID_MSG;
   }
 
+  if (m_ringBuffer && priority == 0)
+  {
+    CSingleLock lock(m_producerSection);
+
+    // account before publishing, the consumer may take it straight away
+    AddPacket(pMsg);
+
+    // messages waiting for space in the ring have to go first
+    if (!MoveOverflowToRing() || !PutRing(pMsg))
+    {
+      m_overflow.push_back(pMsg);
+      m_overflowCount = m_overflow.size();
+    }
+    lock.Leave();
+
+    if (m_waiting)
+      m_hEvent.Set(); // inform waiter for new packet
+
+    return MSGQ_OK;
+  }
+
+  CSingleLock lock(m_section);
+
   SList::iterator it = m_list.begin();
   while(it != m_list.end())
   {
@@ -123,21 +249,10 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
     ++it;
   }
   m_list.insert(it, DVDMessageListItem(pMsg, priority));
+  m_listCount = m_list.size();
 
-  if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
-  {
-    DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
-    if(packet)
-    {
-      m_iDataSize += packet->iSize;
-      if     (packet->dts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->dts;
-      else if(packet->pts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->pts;
-      if(m_TimeBack == DVD_NOPTS_VALUE)
-        m_TimeBack = m_TimeFront;
-    }
-  }
+  if (priority == 0)
+    AddPacket(pMsg);
 
   pMsg->Release();
 
@@ -146,21 +261,30 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
   return MSGQ_OK;
 }
 
-MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutInMilliSeconds, int &priority)
+bool CDVDMessageQueue::HasMessage(int priority)
 {
+  if (m_bAbortRequest)
+    return true;
+
+  if (m_ringBuffer && priority == 0 && !m_bCaching &&
+     (m_ringHead != m_ringTail || m_overflowCount > 0))
+    return true;
+
   CSingleLock lock(m_section);
+  return !m_list.empty() && m_list.back().priority >= priority && !m_bCaching;
+}
 
+MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutInMilliSeconds, int &priority)
+{
   *pMsg = NULL;
 
-  int ret = 0;
-
   if (!m_bInitialized)
   {
     CLog::Log(LOGFATAL, "CDVDMessageQueue(%s)::Get MSGQ_NOT_INITIALIZED", m_owner.c_str());
     return MSGQ_NOT_INITIALIZED;
   }
 
-  if(m_list.empty() && m_bEmptied == false && priority == 0 && m_owner != "teletext")
+  if(m_bEmptied == false && priority == 0 && m_owner != "teletext" && !HasMessage(0))
   {
 #if !defined(TARGET_RASPBERRY_PI)
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Get - asked for new data packet, with nothing available", m_owner.c_str());
@@ -170,59 +294,70 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
 
   while (!m_bAbortRequest)
   {
-    if(!m_list.empty() && m_list.back().priority >= priority && !m_bCaching)
+    // higher priority messages are kept in the list, and always go first
+    if (!m_ringBuffer || m_listCount > 0)
     {
-      DVDMessageListItem& item(m_list.back());
-      priority = item.priority;
-
-      if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
+      CSingleLock lock(m_section);
+      if(!m_list.empty() && m_list.back().priority >= priority && !m_bCaching)
       {
-        DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)item.message)->GetPacket();
-        if(packet)
-        {
-          m_iDataSize -= packet->iSize;
-          if     (packet->dts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->dts;
-          else if(packet->pts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->pts;
-        }
-
-        if(m_bEmptied && m_iDataSize > 0)
-          m_bEmptied = false;
-      }
+        DVDMessageListItem& item(m_list.back());
+        priority = item.priority;
 
-      *pMsg = item.message->Acquire();
-      m_list.pop_back();
+        if (item.priority == 0)
+          RemovePacket(item.message);
 
-      ret = MSGQ_OK;
-      break;
+        *pMsg = item.message->Acquire();
+        m_list.pop_back();
+        m_listCount = m_list.size();
+        return MSGQ_OK;
+      }
     }
-    else if (!iTimeoutInMilliSeconds)
+
+    if (m_ringBuffer && priority == 0 && !m_bCaching)
     {
-      ret = MSGQ_TIMEOUT;
-      break;
+      // the ring may be empty while the producer has messages waiting for space
+      if (m_ringHead == m_ringTail && m_overflowCount > 0)
+      {
+        CSingleLock producerLock(m_producerSection);
+        MoveOverflowToRing();
+      }
+
+      CSingleLock lock(m_consumerSection);
+      if (GetRing(pMsg))
+      {
+        RemovePacket(*pMsg);
+        return MSGQ_OK;
+      }
     }
-    else
-    {
-      m_hEvent.Reset();
-      lock.Leave();
 
-      // wait for a new message
-      if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
-        return MSGQ_TIMEOUT;
+    if (!iTimeoutInMilliSeconds)
+      return MSGQ_TIMEOUT;
 
-      lock.Enter();
+    // announce that we are waiting before checking again, so that a message
+    // put in the meantime either is found or signals the event
+    m_hEvent.Reset();
+    m_waiting = true;
+    if (HasMessage(priority))
+    {
+      m_waiting = false;
+      continue;
     }
-  }
 
-  if (m_bAbortRequest) return MSGQ_ABORT;
+    // wait for a new message
+    bool signaled = m_hEvent.WaitMSec(iTimeoutInMilliSeconds);
+    m_waiting = false;
+    if (!signaled)
+      return MSGQ_TIMEOUT;
+  }
 
-  return (MsgQueueReturnCode)ret;
+  return MSGQ_ABORT;
 }
 
 
 unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
 {
+  CSingleLock producerLock(m_producerSection);
+  CSingleLock consumerLock(m_consumerSection);
   CSingleLock lock(m_section);
 
   if (!m_bInitialized)
@@ -235,6 +370,20 @@ unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
       count++;
   }
 
+  if (m_ringBuffer)
+  {
+    for (unsigned int i = m_ringHead; i != m_ringTail; i++)
+    {
+      if (m_ring[i & (RING_SIZE - 1)]->IsType(type))
+        count++;
+    }
+    for (std::deque<CDVDMsg*>::iterator it = m_overflow.begin(); it != m_overflow.end(); ++it)
+    {
+      if ((*it)->IsType(type))
+        count++;
+    }
+  }
+
   return count;
 }
 
@@ -21,8 +21,11 @@
  */
 
 #include "DVDMessage.h"
+#include <atomic>
 #include <string>
 #include <list>
+#include <deque>
+#include <vector>
 #include <algorithm>
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
@@ -81,10 +84,20 @@ enum MsgQueueReturnCode
 
 #define MSGQ_IS_ERROR(c)    (c < 0)
 
+/**
+ * Queue of messages between the player thread and the audio/video threads.
+ *
+ * Messages are returned highest priority first, and in the order they were
+ * put within a priority. In ring buffer mode, priority 0 messages (the data
+ * packets) are kept in a bounded single producer / single consumer ring, so
+ * that the player thread and the consumer don't share a lock or allocate a
+ * list node per packet. Producers other than the player thread serialize on
+ * a producer lock, and Flush() takes both sides of the ring.
+ */
 class CDVDMessageQueue
 {
 public:
-  CDVDMessageQueue(const std::string &owner);
+  CDVDMessageQueue(const std::string &owner, bool ringBuffer = false);
   virtual ~CDVDMessageQueue();
 
   void  Init();
@@ -124,6 +137,14 @@ public:
   bool IsDataBased() const;
 
 private:
+  static const unsigned int RING_SIZE = 16384; // must be a power of two
+
+  bool PutRing(CDVDMsg* pMsg);
+  bool GetRing(CDVDMsg** pMsg);
+  bool MoveOverflowToRing();
+  bool HasMessage(int priority);
+  void AddPacket(CDVDMsg* pMsg);
+  void RemovePacket(CDVDMsg* pMsg);
 
   CEvent m_hEvent;
   mutable CCriticalSection m_section;
@@ -132,9 +153,9 @@ private:
   bool m_bInitialized;
   bool m_bCaching;
 
-  int m_iDataSize;
-  double m_TimeFront;
-  double m_TimeBack;
+  std::atomic<int> m_iDataSize;
+  std::atomic<double> m_TimeFront;
+  std::atomic<double> m_TimeBack;
   double m_TimeSize;
 
   int m_iMaxDataSize;
@@ -143,5 +164,17 @@ private:
 
   typedef std::list<DVDMessageListItem> SList;
   SList m_list;
+  std::atomic<unsigned int> m_listCount;
+
+  // ring buffer mode
+  bool m_ringBuffer;
+  std::vector<CDVDMsg*> m_ring;
+  std::atomic<unsigned int> m_ringHead; // next slot to read, owned by the consumer
+  std::atomic<unsigned int> m_ringTail; // next slot to write, owned by the producer
+  std::deque<CDVDMsg*> m_overflow;      // messages put while the ring was full
+  std::atomic<unsigned int> m_overflowCount;
+  std::atomic<bool> m_waiting;
+  CCriticalSection m_producerSection;
+  CCriticalSection m_consumerSection;
 };
 
@@ -101,7 +101,7 @@ public:
 
 CDVDPlayerAudio::CDVDPlayerAudio(CDVDClock* pClock, CDVDMessageQueue& parent)
 : CThread("DVDPlayerAudio")
-, m_messageQueue("audio")
+, m_messageQueue("audio", true)
 , m_messageParent(parent)
 , m_dvdAudio((bool&)m_bStop)
 {
@@ -124,7 +124,7 @@ CDVDPlayerVideo::CDVDPlayerVideo( CDVDClock* pClock
                                 , CDVDOverlayContainer* pOverlayContainer
                                 , CDVDMessageQueue& parent)
 : CThread("DVDPlayerVideo")
-, m_messageQueue("video")
+, m_messageQueue("video", true)
 , m_messageParent(parent)
 {
   m_pClock = pClock;
@@ -0,0 +1,134 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+TEST(TestDVDDemuxUtils, AllocateDemuxPacket)
+{
+  DemuxPacket *packet = CDVDDemuxUtils::AllocateDemuxPacket(1000);
+  ASSERT_TRUE(packet != NULL);
+  ASSERT_TRUE(packet->pData != NULL);
+  EXPECT_EQ(-1, packet->iStreamId);
+
+  // padding has to be cleared for the ffmpeg bitstream readers
+  for (int i = 0; i < FF_INPUT_BUFFER_PADDING_SIZE; i++)
+    EXPECT_EQ(0, packet->pData[1000 + i]);
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+
+  packet = CDVDDemuxUtils::AllocateDemuxPacket(0);
+  ASSERT_TRUE(packet != NULL);
+  EXPECT_TRUE(packet->pData == NULL);
+  EXPECT_EQ(0, packet->iSize);
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+}
+
+TEST(TestDVDDemuxUtils, ReferenceAVPacket)
+{
+  AVPacket pkt;
+  av_init_packet(&pkt);
+  ASSERT_EQ(0, av_new_packet(&pkt, 4096));
+  memset(pkt.data, 0x55, pkt.size);
+
+  DemuxPacketPoolStats before, after;
+  CDVDDemuxUtils::GetPoolStats(before);
+
+  DemuxPacket *packet = CDVDDemuxUtils::AllocateDemuxPacket(&pkt);
+  ASSERT_TRUE(packet != NULL);
+  EXPECT_EQ(pkt.data, packet->pData);
+  EXPECT_EQ(4096, packet->iSize);
+
+  // the payload stays valid after ffmpeg lets go of it
+  av_free_packet(&pkt);
+  EXPECT_EQ(0x55, packet->pData[0]);
+  EXPECT_EQ(0x55, packet->pData[4095]);
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+
+  CDVDDemuxUtils::GetPoolStats(after);
+  EXPECT_EQ(before.referenced + 1, after.referenced);
+  EXPECT_EQ(before.bufferAllocs, after.bufferAllocs);
+}
+
+TEST(TestDVDDemuxUtils, CopyPartOfAVPacket)
+{
+  AVPacket pkt;
+  av_init_packet(&pkt);
+  ASSERT_EQ(0, av_new_packet(&pkt, 4096));
+  memset(pkt.data, 0x55, pkt.size);
+
+  // the first half of the buffer, followed by payload instead of padding
+  AVPacket part = pkt;
+  part.size = 2048;
+
+  DemuxPacketPoolStats before, after;
+  CDVDDemuxUtils::GetPoolStats(before);
+
+  DemuxPacket *packet = CDVDDemuxUtils::AllocateDemuxPacket(&part);
+  ASSERT_TRUE(packet != NULL);
+  EXPECT_NE(part.data, packet->pData);
+  EXPECT_EQ(2048, packet->iSize);
+  EXPECT_EQ(0x55, packet->pData[2047]);
+  for (int i = 0; i < FF_INPUT_BUFFER_PADDING_SIZE; i++)
+    EXPECT_EQ(0, packet->pData[2048 + i]);
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+
+  CDVDDemuxUtils::GetPoolStats(after);
+  EXPECT_EQ(before.referenced, after.referenced);
+  av_free_packet(&pkt);
+}
+
+TEST(TestDVDDemuxUtils, SteadyStreamFromPool)
+{
+  static const int packets = 100000;
+  static const int inflight = 64;
+  std::vector<DemuxPacket*> queue(inflight, (DemuxPacket*)NULL);
+
+  // warm up the pool with the sizes used below
+  for (int i = 0; i < inflight; i++)
+    queue[i] = CDVDDemuxUtils::AllocateDemuxPacket(1000 + (i * 7919) % 60000);
+
+  DemuxPacketPoolStats before, after;
+  CDVDDemuxUtils::GetPoolStats(before);
+
+  for (int i = 0; i < packets; i++)
+  {
+    // the demuxer runs ahead of the codecs by a number of packets
+    CDVDDemuxUtils::FreeDemuxPacket(queue[i % inflight]);
+    queue[i % inflight] = CDVDDemuxUtils::AllocateDemuxPacket(1000 + (i * 7919) % 60000);
+    ASSERT_TRUE(queue[i % inflight] != NULL);
+  }
+
+  CDVDDemuxUtils::GetPoolStats(after);
+  for (int i = 0; i < inflight; i++)
+    CDVDDemuxUtils::FreeDemuxPacket(queue[i]);
+
+  unsigned int allocs = (after.packetAllocs - before.packetAllocs) + (after.bufferAllocs - before.bufferAllocs);
+
+  // once warmed up, a steady stream of packets is served from the pool
+  EXPECT_EQ((unsigned int)packets, after.packets - before.packets);
+  EXPECT_GT((unsigned int)packets / 100, allocs);
+}
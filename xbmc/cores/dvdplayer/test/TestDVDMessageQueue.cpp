@@ -0,0 +1,201 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDMessageQueue.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "threads/Thread.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+CDVDMsg* CreatePacket(int size, double dts)
+{
+  DemuxPacket *packet = CDVDDemuxUtils::AllocateDemuxPacket(size);
+  packet->iSize = size;
+  packet->dts   = dts;
+  return new CDVDMsgDemuxerPacket(packet);
+}
+
+double GetDts(CDVDMsg *msg)
+{
+  return ((CDVDMsgDemuxerPacket*)msg)->GetPacket()->dts;
+}
+
+class CQueueProducer : public CThread
+{
+public:
+  CQueueProducer(CDVDMessageQueue &queue, int count)
+    : CThread("TestDVDMessageQueue")
+    , m_queue(queue)
+    , m_count(count)
+  {
+  }
+
+protected:
+  virtual void Process()
+  {
+    for (int i = 0; i < m_count; i++)
+    {
+      // keep the queue at a realistic depth, the consumer keeps catching up
+      while (m_queue.GetDataSize() > 256 * 188 && !m_bStop)
+        XbmcThreads::ThreadSleep(0);
+      m_queue.Put(CreatePacket(188, (double)i));
+    }
+  }
+
+private:
+  CDVDMessageQueue &m_queue;
+  int m_count;
+};
+
+void PriorityOrder(bool ringBuffer)
+{
+  CDVDMessageQueue queue("test", ringBuffer);
+  queue.Init();
+
+  queue.Put(CreatePacket(100, 1.0));
+  queue.Put(CreatePacket(100, 2.0));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC), 1);
+  EXPECT_EQ(200, queue.GetDataSize());
+  EXPECT_EQ(2U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  CDVDMsg *msg;
+  int priority = 0;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+  EXPECT_EQ(1, priority);
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_RESYNC));
+  msg->Release();
+
+  // a higher minimum priority must not return data packets
+  priority = 1;
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0, priority));
+
+  for (double dts = 1.0; dts <= 2.0; dts += 1.0)
+  {
+    priority = 0;
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+    EXPECT_EQ(0, priority);
+    EXPECT_EQ(dts, GetDts(msg));
+    msg->Release();
+  }
+  EXPECT_EQ(0, queue.GetDataSize());
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0));
+  queue.End();
+}
+
+void Flush(bool ringBuffer)
+{
+  CDVDMessageQueue queue("test", ringBuffer);
+  queue.Init();
+
+  queue.Put(CreatePacket(100, 1.0));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_EOF));
+  queue.Put(CreatePacket(100, 2.0));
+  queue.Flush(CDVDMsg::DEMUXER_PACKET);
+
+  EXPECT_EQ(0, queue.GetDataSize());
+  EXPECT_EQ(0U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  CDVDMsg *msg;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_EOF));
+  msg->Release();
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0));
+  queue.End();
+}
+
+void ProducerConsumer(bool ringBuffer, int count)
+{
+  CDVDMessageQueue queue("test", ringBuffer);
+  queue.Init();
+
+  // packets put by another thread arrive complete and in order
+  CQueueProducer producer(queue, count);
+  producer.Create();
+
+  int received = 0;
+  CDVDMsg *msg;
+  while (received < count && queue.Get(&msg, 1000) == MSGQ_OK)
+  {
+    EXPECT_EQ((double)received, GetDts(msg));
+    msg->Release();
+    received++;
+  }
+  producer.StopThread();
+
+  EXPECT_EQ(count, received);
+  EXPECT_EQ(0, queue.GetDataSize());
+  queue.End();
+}
+}
+
+TEST(TestDVDMessageQueue, PriorityOrder)
+{
+  PriorityOrder(false);
+}
+
+TEST(TestDVDMessageQueue, PriorityOrderRing)
+{
+  PriorityOrder(true);
+}
+
+TEST(TestDVDMessageQueue, Flush)
+{
+  Flush(false);
+}
+
+TEST(TestDVDMessageQueue, FlushRing)
+{
+  Flush(true);
+}
+
+TEST(TestDVDMessageQueue, RingOverflowKeepsOrder)
+{
+  CDVDMessageQueue queue("test", true);
+  queue.Init();
+
+  // more than fit into the ring
+  const int count = 20000;
+  for (int i = 0; i < count; i++)
+    queue.Put(CreatePacket(10, (double)i));
+  EXPECT_EQ(count * 10, queue.GetDataSize());
+  EXPECT_EQ((unsigned)count, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  CDVDMsg *msg;
+  for (int i = 0; i < count; i++)
+  {
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+    EXPECT_EQ((double)i, GetDts(msg));
+    msg->Release();
+  }
+  EXPECT_EQ(0, queue.GetDataSize());
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, ProducerConsumer)
+{
+  ProducerConsumer(false, 20000);
+}
+
+TEST(TestDVDMessageQueue, ProducerConsumerRing)
+{
+  ProducerConsumer(true, 20000);
+}
@@ -179,6 +179,26 @@ std::string CDatabase::GetSingleValue(const std::string &query)
   return GetSingleValue(query, m_pDS);
 }
 
+std::string CDatabase::GetSingleValue(const std::string &query, const BindParams &params)
+{
+  std::string ret;
+  try
+  {
+    if (!m_pDB.get() || !m_pDS.get())
+      return ret;
+
+    if (m_pDS->query(query, params) && m_pDS->num_rows() > 0)
+      ret = m_pDS->fv(0).get_asString();
+
+    m_pDS->close();
+  }
+  catch(...)
+  {
+    CLog::Log(LOGERROR, "%s - failed on query '%s'", __FUNCTION__, query.c_str());
+  }
+  return ret;
+}
+
 bool CDatabase::DeleteValues(const std::string &strTable, const Filter &filter /* = Filter() */)
 {
   std::string strQuery;
@@ -234,6 +254,33 @@ bool CDatabase::ExecuteQuery(const std::string &strQuery)
   return bReturn;
 }
 
+bool CDatabase::ExecuteQuery(const std::string &strQuery, const BindParams &params)
+{
+  bool bReturn = false;
+
+  try
+  {
+    if (NULL == m_pDB.get()) return bReturn;
+    if (NULL == m_pDS.get()) return bReturn;
+
+    if (m_multipleExecute)
+    {
+      m_multipleQueries.push_back(m_pDB->bind(strQuery, params));
+      return true;
+    }
+
+    m_pDS->exec(strQuery, params);
+    bReturn = true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to execute query '%s'",
+        __FUNCTION__, strQuery.c_str());
+  }
+
+  return bReturn;
+}
+
 bool CDatabase::ResultQuery(const std::string &strQuery)
 {
   bool bReturn = false;
@@ -256,6 +303,38 @@ bool CDatabase::ResultQuery(const std::string &strQuery)
   return bReturn;
 }
 
+bool CDatabase::ResultQuery(const std::string &strQuery, const BindParams &params)
+{
+  bool bReturn = false;
+
+  try
+  {
+    if (NULL == m_pDB.get()) return bReturn;
+    if (NULL == m_pDS.get()) return bReturn;
+
+    bReturn = m_pDS->query(strQuery, params);
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to execute query '%s'",
+        __FUNCTION__, strQuery.c_str());
+  }
+
+  return bReturn;
+}
+
+bool CDatabase::QueueInsertQuery(const std::string &strQuery, const BindParams &params)
+{
+  if (strQuery.empty())
+    return false;
+
+  if (NULL == m_pDB.get()) return false;
+  if (NULL == m_pDS2.get()) return false;
+
+  m_insertQueries.push_back(std::make_pair(strQuery, params));
+  return true;
+}
+
 bool CDatabase::QueueInsertQuery(const std::string &strQuery)
 {
   if (strQuery.empty())
@@ -295,6 +374,37 @@ bool CDatabase::CommitInsertQueries()
     }
   }
 
+  if (!m_insertQueries.empty())
+  {
+    // rows of the same query reuse the prepared statement, so the batch is
+    // only bound by how fast the database can write them
+    bool transaction = !InTransaction();
+    if (transaction)
+      BeginTransaction();
+
+    std::vector<std::pair<std::string, BindParams> >::const_iterator it = m_insertQueries.begin();
+    try
+    {
+      for (; it != m_insertQueries.end(); ++it)
+        m_pDS2->exec(it->first, it->second);
+    }
+    catch(...)
+    {
+      bReturn = false;
+      CLog::Log(LOGERROR, "%s - failed to execute query '%s'",
+          __FUNCTION__, it->first.c_str());
+    }
+
+    if (transaction)
+    {
+      if (bReturn)
+        CommitTransaction();
+      else
+        RollbackTransaction();
+    }
+    m_insertQueries.clear();
+  }
+
   return bReturn;
 }
 
@@ -581,6 +691,7 @@ void CDatabase::Close()
 
   m_openCount = 0;
   m_multipleExecute = false;
+  m_insertQueries.clear();
 
   if (NULL == m_pDB.get() ) return ;
   if (NULL != m_pDS.get()) m_pDS->close();
@@ -674,7 +785,7 @@ void CDatabase::RollbackTransaction()
 
 bool CDatabase::InTransaction()
 {
-  if (NULL != m_pDB.get()) return false;
+  if (NULL == m_pDB.get()) return false;
   return m_pDB->in_transaction();
 }
 
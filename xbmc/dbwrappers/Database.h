@@ -25,8 +25,11 @@ namespace dbiplus {
   class Dataset;
 }
 
+#include "qry_dat.h"
+
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 class DatabaseSettings; // forward
@@ -92,6 +95,14 @@ public:
    */
   std::string GetSingleValue(const std::string &query, std::unique_ptr<dbiplus::Dataset> &ds);
 
+  /*! \brief Get a single value from a query with bound values.
+   \param query the query in question, with ? placeholders for the values.
+   \param params the values for the placeholders.
+   \return the value from the query, empty on failure.
+   \sa ExecuteQuery
+   */
+  std::string GetSingleValue(const std::string &query, const dbiplus::BindParams &params);
+
   /*!
    * @brief Delete values from a table.
    * @param strTable The table to delete the values from.
@@ -110,6 +121,18 @@ public:
    */
   bool ExecuteQuery(const std::string &strQuery);
 
+  /*!
+   * @brief Execute a query that does not return any result, binding values
+   *        to its ? placeholders.
+   *        The statement is prepared once and cached by the database, so
+   *        strQuery should only contain the values that never change (like
+   *        table names) and leave everything else to params.
+   * @param strQuery The query to execute.
+   * @param params The values for the placeholders, in order.
+   * @return True if the query was executed successfully, false otherwise.
+   */
+  bool ExecuteQuery(const std::string &strQuery, const dbiplus::BindParams &params);
+
   /*!
    * @brief Execute a query that returns a result.
    * @remarks Call m_pDS->close(); to clean up the dataset when done.
@@ -118,6 +141,16 @@ public:
    */
   bool ResultQuery(const std::string &strQuery);
 
+  /*!
+   * @brief Execute a query that returns a result, binding values to its ? placeholders.
+   * @remarks Call m_pDS->close(); to clean up the dataset when done.
+   * @param strQuery The query to execute.
+   * @param params The values for the placeholders, in order.
+   * @return True if the query was executed successfully, false otherwise.
+   * @sa ExecuteQuery
+   */
+  bool ResultQuery(const std::string &strQuery, const dbiplus::BindParams &params);
+
   /*!
    * @brief Start a multiple execution queue. Any ExecuteQuery() function
    *        following this call will be queued rather than executed until
@@ -151,6 +184,16 @@ public:
    */
   bool QueueInsertQuery(const std::string &strQuery);
 
+  /*!
+   * @brief Put an INSERT or REPLACE query with bound values in the queue.
+   *        Rows queued with the same query share a single prepared statement
+   *        and are written in one transaction by CommitInsertQueries().
+   * @param strQuery The query to queue, with ? placeholders for the values.
+   * @param params The values of this row.
+   * @return True if the query was added successfully, false otherwise.
+   */
+  bool QueueInsertQuery(const std::string &strQuery, const dbiplus::BindParams &params);
+
   /*!
    * @brief Commit all queries in the queue.
    * @return True if all queries were executed successfully, false otherwise.
@@ -220,4 +263,6 @@ private:
 
   bool m_multipleExecute;
   std::vector<std::string> m_multipleQueries;
+
+  std::vector<std::pair<std::string, dbiplus::BindParams> > m_insertQueries; /*!< queued rows with bound values */
 };
@@ -82,6 +82,60 @@ string Database::prepare(const char *format, ...)
   return result;
 }
 
+string Database::bind(const string &sql, const BindParams &params)
+{
+  string result;
+  result.reserve(sql.size() + params.size() * 16);
+
+  BindParams::const_iterator param = params.begin();
+  bool quoted = false;
+  for (string::const_iterator c = sql.begin(); c != sql.end(); ++c)
+  {
+    if (*c == '\'')
+      quoted = !quoted;
+    if (*c != '?' || quoted)
+    {
+      result += *c;
+      continue;
+    }
+
+    if (param == params.end())
+      throw DbErrors("Not enough values bound to: %s", sql.c_str());
+
+    if (param->get_isNull())
+      result += "NULL";
+    else
+    {
+      switch (param->get_fType())
+      {
+      case ft_String:
+      case ft_Char:
+      case ft_WChar:
+      case ft_WideString:
+        result += prepare("'%s'", param->get_asString().c_str());
+        break;
+      case ft_Boolean:
+        result += param->get_asBool() ? "1" : "0";
+        break;
+      case ft_Float:
+      case ft_Double:
+      case ft_LongDouble:
+        result += prepare("%.15g", param->get_asDouble());
+        break;
+      default:
+        result += param->get_asString();
+        break;
+      }
+    }
+    ++param;
+  }
+
+  if (param != params.end())
+    throw DbErrors("Too many values bound to: %s", sql.c_str());
+
+  return result;
+}
+
 //************* Dataset implementation ***************
 
 Dataset::Dataset():
@@ -216,6 +270,16 @@ bool Dataset::seek(int pos) {
 }
 
 
+int Dataset::exec(const string &sql, const BindParams &params) {
+  return exec(db->bind(sql, params));
+}
+
+
+bool Dataset::query(const string &sql, const BindParams &params) {
+  return query(db->bind(sql, params));
+}
+
+
 void Dataset::refresh() {
   int row = frecno;
   if ((row != 0) && active) {
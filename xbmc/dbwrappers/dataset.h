@@ -167,6 +167,14 @@ public:
    */
   virtual std::string vprepare(const char *format, va_list args) = 0;
 
+  /*! \brief Substitute the ? placeholders of a statement with the escaped values.
+   Used by backends that can't bind the values on the server.
+   \param sql - statement with ? placeholders (placeholders inside quotes are left alone)
+   \param params - values for the placeholders, in order
+   \return the statement with the values in place of the placeholders.
+   */
+  virtual std::string bind(const std::string &sql, const BindParams &params);
+
   virtual bool in_transaction() {return false;};
 
 };
@@ -312,6 +320,10 @@ public:
   virtual const void* getExecRes()=0;
 /* as open, but with our query exept Sql */
   virtual bool query(const std::string &sql) = 0;
+/* as exec and query, with the ? placeholders of sql bound to params. Backends
+   cache the prepared statements, so sql should not contain any formatted values */
+  virtual int  exec (const std::string &sql, const BindParams &params);
+  virtual bool query(const std::string &sql, const BindParams &params);
 /* Close SQL Query*/
   virtual void close();
 /* This function looks for field Field_name with value equal Field_value
@@ -22,6 +22,7 @@
 #include <string>
 #include <set>
 #include <algorithm>
+#include <cstring>
 
 #include "utils/log.h"
 #include "system.h" // for GetLastError()
@@ -39,6 +40,9 @@
 #define MYSQL_OK          0
 #define ER_BAD_DB_ERROR   1049
 
+// see SqliteDatabase
+#define MAX_CACHED_STATEMENTS 128
+
 using namespace std;
 
 namespace dbiplus {
@@ -205,6 +209,8 @@ int MysqlDatabase::connect(bool create_new) {
 void MysqlDatabase::disconnect(void) {
   if (conn != NULL)
   {
+    // statements belong to the connection
+    clear_statements();
     mysql_close(conn);
     conn = NULL;
   }
@@ -406,6 +412,52 @@ int MysqlDatabase::query_with_reconnect(const char* query) {
   return result;
 }
 
+MYSQL_STMT *MysqlDatabase::get_statement(const std::string &sql) {
+  map<string, MYSQL_STMT*>::const_iterator it = statements.find(sql);
+  if (it != statements.end())
+    return it->second;
+
+  if (!conn)
+    return NULL;
+
+  if (statements.size() >= MAX_CACHED_STATEMENTS)
+    clear_statements();
+
+  int attempts = 5;
+  MYSQL_STMT *stmt;
+  while (true)
+  {
+    if (!(stmt = mysql_stmt_init(conn)))
+    {
+      setErr(CR_OUT_OF_MEMORY, sql.c_str());
+      return NULL;
+    }
+    if (mysql_stmt_prepare(stmt, sql.c_str(), sql.size()) == MYSQL_OK)
+      break;
+
+    last_err = setErr(mysql_stmt_errno(stmt), sql.c_str());
+    mysql_stmt_close(stmt);
+
+    // try to reconnect if server is gone, like query_with_reconnect()
+    if ((last_err != CR_SERVER_GONE_ERROR && last_err != CR_SERVER_LOST) || attempts-- <= 0)
+      return NULL;
+    CLog::Log(LOGINFO,"MYSQL server has gone. Will try %d more attempt(s) to reconnect.", attempts);
+    active = false;
+    connect(true);
+    if (!conn)
+      return NULL;
+  }
+
+  statements.insert(make_pair(sql, stmt));
+  return stmt;
+}
+
+void MysqlDatabase::clear_statements() {
+  for (map<string, MYSQL_STMT*>::iterator it = statements.begin(); it != statements.end(); ++it)
+    mysql_stmt_close(it->second);
+  statements.clear();
+}
+
 long MysqlDatabase::nextid(const char* sname) {
   CLog::Log(LOGDEBUG,"MysqlDatabase::nextid for %s",sname);
   if (!active) return DB_UNEXPECTED_RESULT;
@@ -1472,6 +1524,75 @@ int MysqlDataset::exec(const string &sql) {
   }
 }
 
+int MysqlDataset::exec(const string &sql, const BindParams &params) {
+  if (!handle()) throw DbErrors("No Database Connection");
+  exec_res.clear();
+
+  CLog::Log(LOGDEBUG,"Mysql execute prepared: %s", sql.c_str());
+
+  MysqlDatabase *mysqlDb = static_cast<MysqlDatabase*>(db);
+  MYSQL_STMT *stmt = mysqlDb->get_statement(sql);
+  if (!stmt)
+    throw DbErrors(db->getErrorMsg());
+
+  if (mysql_stmt_param_count(stmt) != params.size())
+    throw DbErrors("Wrong number of values bound to: %s", sql.c_str());
+
+  // the values have to stay put until the statement is executed
+  vector<MYSQL_BIND> binds(params.size());
+  vector<string> strings(params.size());
+  vector<long long> ints(params.size());
+  vector<double> doubles(params.size());
+  for (unsigned int i = 0; i < params.size(); i++)
+  {
+    const field_value &v = params[i];
+    MYSQL_BIND &b = binds[i];
+    memset(&b, 0, sizeof(b));
+    if (v.get_isNull())
+    {
+      b.buffer_type = MYSQL_TYPE_NULL;
+      continue;
+    }
+    switch (v.get_fType())
+    {
+    case ft_Boolean:
+    case ft_Short:
+    case ft_UShort:
+    case ft_Int:
+    case ft_UInt:
+    case ft_Int64:
+      ints[i] = v.get_asInt64();
+      b.buffer_type = MYSQL_TYPE_LONGLONG;
+      b.buffer = &ints[i];
+      break;
+    case ft_Float:
+    case ft_Double:
+      doubles[i] = v.get_asDouble();
+      b.buffer_type = MYSQL_TYPE_DOUBLE;
+      b.buffer = &doubles[i];
+      break;
+    default:
+      strings[i] = v.get_asString();
+      b.buffer_type = MYSQL_TYPE_STRING;
+      b.buffer = (void*)strings[i].c_str();
+      b.buffer_length = strings[i].size();
+      break;
+    }
+  }
+
+  if ((!binds.empty() && mysql_stmt_bind_param(stmt, &binds[0]) != MYSQL_OK) ||
+      mysql_stmt_execute(stmt) != MYSQL_OK)
+  {
+    unsigned int err = mysql_stmt_errno(stmt);
+    // the statement died with the connection, exec() reconnects
+    if (err == CR_SERVER_GONE_ERROR || err == CR_SERVER_LOST)
+      return exec(db->bind(sql, params));
+    db->setErr(err, sql.c_str());
+    throw DbErrors(db->getErrorMsg());
+  }
+  return MYSQL_OK;
+}
+
 int MysqlDataset::exec() {
    return exec(sql);
 }
@@ -1578,6 +1699,12 @@ bool MysqlDataset::query(const std::string &query) {
   return true;
 }
 
+bool MysqlDataset::query(const std::string &query, const BindParams &params) {
+  // results are always fetched as text, so there is little to gain from a
+  // server side statement here
+  return this->query(db->bind(query, params));
+}
+
 void MysqlDataset::open(const string &sql) {
    set_select_sql(sql);
    open();
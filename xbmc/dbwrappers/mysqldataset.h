@@ -22,6 +22,7 @@
 #define _MYSQLDATASET_H
 
 #include <stdio.h>
+#include <map>
 #include "dataset.h"
 #include "mysql/mysql.h"
 
@@ -37,6 +38,8 @@ protected:
   MYSQL* conn;
   bool _in_transaction;
   int last_err;
+/* prepared statements by their sql */
+  std::map<std::string, MYSQL_STMT*> statements;
 
 
 public:
@@ -86,6 +89,12 @@ public:
   bool in_transaction() {return _in_transaction;};
   int query_with_reconnect(const char* query);
 
+/* func. returns the cached prepared statement for sql, preparing it if needed.
+   Returns NULL on error */
+  MYSQL_STMT *get_statement(const std::string &sql);
+/* func. closes all cached statements */
+  void clear_statements();
+
 private:
 
   typedef struct StrAccum StrAccum;
@@ -146,9 +155,11 @@ or insert() operations default = false) */
 /* func. executes a query without results to return */
   virtual int  exec ();
   virtual int  exec (const std::string &sql);
+  virtual int  exec (const std::string &sql, const BindParams &params);
   virtual const void* getExecRes();
 /* as open, but with our query exept Sql */
   virtual bool query(const std::string &query);
+  virtual bool query(const std::string &query, const BindParams &params);
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
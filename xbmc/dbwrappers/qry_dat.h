@@ -78,6 +78,7 @@ private:
 public:
   field_value();
   field_value(const char *s);
+  field_value(const std::string &s);
   field_value(const bool b);
   field_value(const char c);
   field_value(const short s);
@@ -210,6 +211,7 @@ struct field {
 
 typedef std::vector<field> Fields;
 typedef std::vector<field_value> sql_record;
+typedef std::vector<field_value> BindParams; // values for the ? placeholders of a statement
 typedef std::vector<field_prop> record_prop;
 typedef std::vector<sql_record*> query_data;
 typedef field_value variant;
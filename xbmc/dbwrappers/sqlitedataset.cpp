@@ -40,6 +40,10 @@
 
 using namespace std;
 
+// statements are cached by their sql. Callers are expected to bind their values
+// so the set is small, but never let formatted statements grow it unbounded
+#define MAX_CACHED_STATEMENTS 128
+
 namespace dbiplus {
 //************* Callback function ***************************
 
@@ -192,6 +196,8 @@ int SqliteDatabase::setErr(int err_code, const char * qry){
     break;
   case SQLITE_MISMATCH:  error = "Data type mismatch";
     break;
+  case SQLITE_RANGE: error = "Wrong number of values bound to the statement";
+    break;
   default : error = "Undefined SQLite error";
   }
   error += "\nQuery: ";
@@ -258,6 +264,8 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  // sqlite3_close() fails while there are unfinalized statements
+  clear_statements();
   sqlite3_close(conn);
   active = false;
 }
@@ -389,6 +397,28 @@ long SqliteDatabase::nextid(const char* sname) {
 }
 
 
+sqlite3_stmt *SqliteDatabase::get_statement(const string &sql) {
+  map<string, sqlite3_stmt*>::const_iterator it = statements.find(sql);
+  if (it != statements.end())
+    return it->second;
+
+  if (statements.size() >= MAX_CACHED_STATEMENTS)
+    clear_statements();
+
+  sqlite3_stmt *stmt = NULL;
+  if ((last_err = setErr(sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, NULL), sql.c_str())) != SQLITE_OK)
+    return NULL;
+
+  statements.insert(make_pair(sql, stmt));
+  return stmt;
+}
+
+void SqliteDatabase::clear_statements() {
+  for (map<string, sqlite3_stmt*>::iterator it = statements.begin(); it != statements.end(); ++it)
+    sqlite3_finalize(it->second);
+  statements.clear();
+}
+
 // methods for transactions
 // ---------------------------------------------
 void SqliteDatabase::start_transaction() {
@@ -628,6 +658,28 @@ int SqliteDataset::exec(const string &sql) {
     }
 }
 
+int SqliteDataset::exec(const string &sql, const BindParams &params) {
+  if (!handle()) throw DbErrors("No Database Connection");
+  exec_res.clear();
+
+  sqlite3_stmt *stmt = static_cast<SqliteDatabase*>(db)->get_statement(sql);
+  if (!stmt)
+    throw DbErrors(db->getErrorMsg());
+
+  int res = bind_params(stmt, params);
+  if (res == SQLITE_OK)
+  {
+    while ((res = sqlite3_step(stmt)) == SQLITE_ROW) {}
+    if (res == SQLITE_DONE)
+      res = SQLITE_OK;
+  }
+  sqlite3_reset(stmt);
+
+  if (db->setErr(res, sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+  return res;
+}
+
 int SqliteDataset::exec() {
   return exec(sql);
 }
@@ -651,6 +703,55 @@ bool SqliteDataset::query(const std::string &query) {
   if (db->setErr(sqlite3_prepare_v2(handle(),query.c_str(),-1,&stmt, NULL),query.c_str()) != SQLITE_OK)
     throw DbErrors(db->getErrorMsg());
 
+  fetch_rows(stmt);
+
+  if (db->setErr(sqlite3_finalize(stmt),query.c_str()) == SQLITE_OK)
+  {
+    active = true;
+    ds_state = dsSelect;
+    this->first();
+    return true;
+  }
+  else
+  {
+    throw DbErrors(db->getErrorMsg());
+  }  
+}
+
+bool SqliteDataset::query(const std::string &query, const BindParams &params) {
+  if(!handle()) throw DbErrors("No Database Connection");
+  if (query.find("select") == string::npos && query.find("SELECT") == string::npos)
+    throw DbErrors("MUST be select SQL!");
+
+  close();
+
+  sqlite3_stmt *stmt = static_cast<SqliteDatabase*>(db)->get_statement(query);
+  if (!stmt)
+    throw DbErrors(db->getErrorMsg());
+
+  int res = bind_params(stmt, params);
+  if (res == SQLITE_OK)
+  {
+    res = fetch_rows(stmt);
+    if (res == SQLITE_DONE)
+      res = SQLITE_OK;
+  }
+  // a statement that isn't reset keeps the database locked for reading
+  sqlite3_reset(stmt);
+
+  if (db->setErr(res, query.c_str()) != SQLITE_OK)
+  {
+    result.clear();
+    throw DbErrors(db->getErrorMsg());
+  }
+
+  active = true;
+  ds_state = dsSelect;
+  this->first();
+  return true;
+}
+
+int SqliteDataset::fetch_rows(sqlite3_stmt *stmt) {
   // column headers
   const unsigned int numColumns = sqlite3_column_count(stmt);
   result.record_header.resize(numColumns);
@@ -658,13 +759,14 @@ bool SqliteDataset::query(const std::string &query) {
     result.record_header[i].name = sqlite3_column_name(stmt, i);
 
   // returned rows
-  while (sqlite3_step(stmt) == SQLITE_ROW)
+  int res;
+  while ((res = sqlite3_step(stmt)) == SQLITE_ROW)
   { // have a row of data
-    sql_record *res = new sql_record;
-    res->resize(numColumns);
+    sql_record *row = new sql_record;
+    row->resize(numColumns);
     for (unsigned int i = 0; i < numColumns; i++)
     {
-      field_value &v = res->at(i);
+      field_value &v = row->at(i);
       switch (sqlite3_column_type(stmt, i))
       {
       case SQLITE_INTEGER:
@@ -686,19 +788,47 @@ bool SqliteDataset::query(const std::string &query) {
         break;
       }
     }
-    result.records.push_back(res);
+    result.records.push_back(row);
   }
-  if (db->setErr(sqlite3_finalize(stmt),query.c_str()) == SQLITE_OK)
+  return res;
+}
+
+int SqliteDataset::bind_params(sqlite3_stmt *stmt, const BindParams &params) {
+  if (sqlite3_bind_parameter_count(stmt) != (int)params.size())
+    return SQLITE_RANGE;
+
+  int res = SQLITE_OK;
+  for (unsigned int i = 0; i < params.size() && res == SQLITE_OK; i++)
   {
-    active = true;
-    ds_state = dsSelect;
-    this->first();
-    return true;
+    const field_value &v = params[i];
+    if (v.get_isNull())
+    {
+      res = sqlite3_bind_null(stmt, i + 1);
+      continue;
+    }
+    switch (v.get_fType())
+    {
+    case ft_Boolean:
+    case ft_Short:
+    case ft_UShort:
+    case ft_Int:
+    case ft_UInt:
+    case ft_Int64:
+      res = sqlite3_bind_int64(stmt, i + 1, v.get_asInt64());
+      break;
+    case ft_Float:
+    case ft_Double:
+      res = sqlite3_bind_double(stmt, i + 1, v.get_asDouble());
+      break;
+    default:
+    {
+      const string str = v.get_asString();
+      res = sqlite3_bind_text(stmt, i + 1, str.c_str(), str.size(), SQLITE_TRANSIENT);
+      break;
+    }
+    }
   }
-  else
-  {
-    throw DbErrors(db->getErrorMsg());
-  }  
+  return res;
 }
 
 void SqliteDataset::open(const string &sql) {
@@ -30,6 +30,7 @@
 #define _SQLITEDATASET_H
 
 #include <stdio.h>
+#include <map>
 #include "dataset.h"
 #include <sqlite3.h>
 
@@ -45,6 +46,8 @@ protected:
   sqlite3 *conn;
   bool _in_transaction;
   int last_err;
+/* prepared statements by their sql */
+  std::map<std::string, sqlite3_stmt*> statements;
 
 public:
 /* default constructor */
@@ -97,6 +100,11 @@ public:
 
   bool in_transaction() {return _in_transaction;}; 	
 
+/* func. returns the cached prepared statement for sql, preparing it if needed.
+   Returns NULL on error. Statements must be reset after use */
+  sqlite3_stmt *get_statement(const std::string &sql);
+/* func. finalizes all cached statements */
+  void clear_statements();
 };
 
 
@@ -127,6 +135,10 @@ protected:
   virtual void fill_fields();
 /* Changing field values during dataset navigation */
   virtual void free_row();  // free the memory allocated for the current row
+/* Reads the rows of a statement into the result, returns the last sqlite3_step() result */
+  int fetch_rows(sqlite3_stmt *stmt);
+/* Binds params to the placeholders of a statement */
+  int bind_params(sqlite3_stmt *stmt, const BindParams &params);
 
 public:
 /* constructor */
@@ -146,9 +158,11 @@ or insert() operations default = false) */
 /* func. executes a query without results to return */
   virtual int  exec ();
   virtual int  exec (const std::string &sql);
+  virtual int  exec (const std::string &sql, const BindParams &params);
   virtual const void* getExecRes();
 /* as open, but with our query exept Sql */
   virtual bool query(const std::string &query);
+  virtual bool query(const std::string &query, const BindParams &params);
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
@@ -0,0 +1,142 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dbwrappers/sqlitedataset.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+
+using namespace dbiplus;
+
+class TestDataset : public testing::Test
+{
+protected:
+  TestDataset()
+  {
+    m_folder = CSpecialProtocol::TranslatePath("special://temp/");
+    XFILE::CFile::Delete(URIUtils::AddFileToFolder(m_folder, "TestDataset.db"));
+    m_db.setHostName(m_folder.c_str());
+    m_db.setDatabase("TestDataset.db");
+  }
+
+  ~TestDataset()
+  {
+    m_db.disconnect();
+    XFILE::CFile::Delete(URIUtils::AddFileToFolder(m_folder, "TestDataset.db"));
+  }
+
+  std::string m_folder;
+  SqliteDatabase m_db;
+};
+
+TEST_F(TestDataset, Bind)
+{
+  BindParams params;
+  params.push_back(42);
+  params.push_back("it's");
+  field_value null;
+  null.set_isNull();
+  params.push_back(null);
+  params.push_back(true);
+
+  EXPECT_EQ("SELECT 42 WHERE a = 'it''s' AND b = '?' AND c IS NULL AND d = 1",
+            m_db.bind("SELECT ? WHERE a = ? AND b = '?' AND c IS ? AND d = ?", params));
+
+  params.pop_back();
+  EXPECT_THROW(m_db.bind("SELECT ?, ?, ?, ?", params), DbErrors);
+  EXPECT_THROW(m_db.bind("SELECT ?, ?", params), DbErrors);
+}
+
+TEST_F(TestDataset, PreparedStatements)
+{
+  ASSERT_EQ(DB_CONNECTION_OK, m_db.connect(true));
+  std::unique_ptr<Dataset> ds(m_db.CreateDataset());
+  ds->exec("CREATE TABLE song (idSong integer primary key, strTitle text, iYear integer, fRating double, lastPlayed text)");
+
+  field_value never;
+  never.set_isNull();
+  for (int i = 0; i < 10; i++)
+  {
+    std::string title = "Don't Stop " + std::to_string(i);
+    ds->exec("INSERT INTO song (idSong, strTitle, iYear, fRating, lastPlayed) VALUES (NULL, ?, ?, ?, ?)",
+             { title, 1970 + i, i / 2.0, i % 2 ? field_value("2015-01-01") : never });
+  }
+
+  ASSERT_TRUE(ds->query("SELECT * FROM song WHERE iYear >= ? AND strTitle LIKE ? ORDER BY idSong", { 1975, "Don't%" }));
+  ASSERT_EQ(5, ds->num_rows());
+  EXPECT_EQ("Don't Stop 5", ds->fv("strTitle").get_asString());
+  EXPECT_EQ(2.5, ds->fv("fRating").get_asDouble());
+  EXPECT_EQ("2015-01-01", ds->fv("lastPlayed").get_asString());
+  ds->next();
+  EXPECT_EQ(1976, ds->fv("iYear").get_asInt());
+  EXPECT_TRUE(ds->fv("lastPlayed").get_isNull());
+  ds->close();
+
+  // a cached statement can be run again with other values
+  ASSERT_TRUE(ds->query("SELECT * FROM song WHERE iYear >= ? AND strTitle LIKE ? ORDER BY idSong", { 1979, "%" }));
+  EXPECT_EQ(1, ds->num_rows());
+  ds->close();
+
+  ds->exec("UPDATE song SET strTitle = ? WHERE iYear = ?", { "Stop", 1970 });
+  ASSERT_TRUE(ds->query("SELECT strTitle FROM song WHERE idSong = ?", { 1 }));
+  EXPECT_EQ("Stop", ds->fv(0).get_asString());
+  ds->close();
+
+  EXPECT_THROW(ds->exec("UPDATE song SET strTitle = ? WHERE iYear = ?", { "Stop" }), DbErrors);
+  EXPECT_THROW(ds->exec("INSERT INTO nosuchtable VALUES (?)", { 1 }), DbErrors);
+
+  // the table can still be changed (statements aren't left running)
+  ds->exec("DROP TABLE song");
+}
+
+/* Rows inserted through a prepared statement are the same as the ones
+ * inserted with the values formatted into the statement, in one transaction.
+ */
+TEST_F(TestDataset, BoundInsertsMatchFormatted)
+{
+  ASSERT_EQ(DB_CONNECTION_OK, m_db.connect(true));
+  std::unique_ptr<Dataset> ds(m_db.CreateDataset());
+  ds->exec("CREATE TABLE formatted (idSong integer primary key, idAlbum integer, strTitle text, strFileName text, iTrack integer)");
+  ds->exec("CREATE TABLE bound (idSong integer primary key, idAlbum integer, strTitle text, strFileName text, iTrack integer)");
+
+  const int rows = 100;
+  m_db.start_transaction();
+  for (int i = 0; i < rows; i++)
+  {
+    std::string title = "Don't Stop " + std::to_string(i);
+    ds->exec(m_db.prepare("INSERT INTO formatted (idSong, idAlbum, strTitle, strFileName, iTrack) VALUES (NULL, %i, '%s', '%s', %i)",
+                          i / 12, title.c_str(), "/music/Some Artist/Some Album/01 - Some Title.flac", i % 12));
+    ds->exec("INSERT INTO bound (idSong, idAlbum, strTitle, strFileName, iTrack) VALUES (NULL, ?, ?, ?, ?)",
+             { i / 12, title, "/music/Some Artist/Some Album/01 - Some Title.flac", i % 12 });
+  }
+  m_db.commit_transaction();
+
+  ASSERT_TRUE(ds->query("SELECT count(*) FROM formatted f JOIN bound b ON f.idSong = b.idSong "
+                        "WHERE f.idAlbum = b.idAlbum AND f.strTitle = b.strTitle AND f.strFileName = b.strFileName AND f.iTrack = b.iTrack"));
+  EXPECT_EQ(rows, ds->fv(0).get_asInt());
+  ds->close();
+  ASSERT_TRUE(ds->query("SELECT count(*) FROM bound"));
+  EXPECT_EQ(rows, ds->fv(0).get_asInt());
+  ds->close();
+}
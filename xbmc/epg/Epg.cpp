@@ -21,6 +21,7 @@
 #include "guilib/LocalizeStrings.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
+#include "threads/Atomics.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
@@ -34,10 +35,31 @@
 
 #include "../addons/include/xbmc_epg_types.h"
 
+#include <algorithm>
+
 using namespace PVR;
 using namespace EPG;
 using namespace std;
 
+namespace
+{
+  /* m_tags is sorted by start time, these find tags in it */
+  struct StartsBefore
+  {
+    bool operator()(const CEpgInfoTagPtr &tag, const CDateTime &time) const { return tag->StartAsUTC() < time; }
+  };
+
+  template<class Iterator>
+  Iterator FindByStart(Iterator begin, Iterator end, const CDateTime &startTime)
+  {
+    Iterator it = std::lower_bound(begin, end, startTime, StartsBefore());
+    return (it != end && (*it)->StartAsUTC() == startTime) ? it : end;
+  }
+
+  /* shared by all tables, so that a recreated table never reuses a version */
+  volatile long tagsVersion = 0;
+}
+
 CEpg::CEpg(int iEpgID, const std::string &strName /* = "" */, const std::string &strScraperName /* = "" */, bool bLoadedFromDb /* = false */) :
     m_bChanged(!bLoadedFromDb),
     m_bTagsChanged(false),
@@ -46,7 +68,8 @@ CEpg::CEpg(int iEpgID, const std::string &strName /* = "" */, const std::string
     m_iEpgID(iEpgID),
     m_strName(strName),
     m_strScraperName(strScraperName),
-    m_bUpdateLastScanTime(false)
+    m_bUpdateLastScanTime(false),
+    m_iTagsVersion(AtomicIncrement(&tagsVersion))
 {
 }
 
@@ -59,7 +82,8 @@ CEpg::CEpg(const CPVRChannelPtr &channel, bool bLoadedFromDb /* = false */) :
     m_strName(channel->ChannelName()),
     m_strScraperName(channel->EPGScraper()),
     m_pvrChannel(channel),
-    m_bUpdateLastScanTime(false)
+    m_bUpdateLastScanTime(false),
+    m_iTagsVersion(AtomicIncrement(&tagsVersion))
 {
 }
 
@@ -69,7 +93,8 @@ CEpg::CEpg(void) :
     m_bLoaded(false),
     m_bUpdatePending(false),
     m_iEpgID(0),
-    m_bUpdateLastScanTime(false)
+    m_bUpdateLastScanTime(false),
+    m_iTagsVersion(AtomicIncrement(&tagsVersion))
 {
 }
 
@@ -91,8 +116,13 @@ CEpg &CEpg::operator =(const CEpg &right)
   m_lastScanTime      = right.m_lastScanTime;
   m_pvrChannel        = right.m_pvrChannel;
 
-  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = right.m_tags.begin(); it != right.m_tags.end(); ++it)
-    m_tags.insert(make_pair(it->first, it->second));
+  for (vector<CEpgInfoTagPtr>::const_iterator it = right.m_tags.begin(); it != right.m_tags.end(); ++it)
+  {
+    vector<CEpgInfoTagPtr>::iterator pos = lower_bound(m_tags.begin(), m_tags.end(), (*it)->StartAsUTC(), StartsBefore());
+    if (pos == m_tags.end() || (*pos)->StartAsUTC() != (*it)->StartAsUTC())
+      m_tags.insert(pos, *it);
+  }
+  SetTagsChanged();
 
   return *this;
 }
@@ -144,13 +174,14 @@ bool CEpg::HasValidEntries(void) const
 
   return (m_iEpgID > 0 && /* valid EPG ID */
       !m_tags.empty()  && /* contains at least 1 tag */
-      m_tags.rbegin()->second->EndAsUTC() >= CDateTime::GetCurrentDateTime().GetAsUTCDateTime()); /* the last end time hasn't passed yet */
+      m_tags.back()->EndAsUTC() >= CDateTime::GetCurrentDateTime().GetAsUTCDateTime()); /* the last end time hasn't passed yet */
 }
 
 void CEpg::Clear(void)
 {
   CSingleLock lock(m_critSection);
   m_tags.clear();
+  SetTagsChanged();
 }
 
 void CEpg::Cleanup(void)
@@ -163,21 +194,28 @@ void CEpg::Cleanup(void)
 void CEpg::Cleanup(const CDateTime &Time)
 {
   CSingleLock lock(m_critSection);
-  for (map<CDateTime, CEpgInfoTagPtr>::iterator it = m_tags.begin(); it != m_tags.end();)
+  vector<CEpgInfoTagPtr>::iterator keep = m_tags.begin();
+  for (vector<CEpgInfoTagPtr>::iterator it = m_tags.begin(); it != m_tags.end(); ++it)
   {
-    if (it->second->EndAsUTC() < Time)
+    if ((*it)->EndAsUTC() < Time)
     {
-      if (m_nowActiveStart == it->first)
+      if (m_nowActiveStart == (*it)->StartAsUTC())
         m_nowActiveStart.SetValid(false);
 
-      it->second->ClearTimer();
-      it = m_tags.erase(it);
+      (*it)->ClearTimer();
     }
     else
     {
-      ++it;
+      if (keep != it)
+        *keep = *it;
+      ++keep;
     }
   }
+  if (keep != m_tags.end())
+  {
+    m_tags.erase(keep, m_tags.end());
+    SetTagsChanged();
+  }
 }
 
 CEpgInfoTagPtr CEpg::GetTagNow(bool bUpdateIfNeeded /* = true */) const
@@ -185,9 +223,9 @@ CEpgInfoTagPtr CEpg::GetTagNow(bool bUpdateIfNeeded /* = true */) const
   CSingleLock lock(m_critSection);
   if (m_nowActiveStart.IsValid())
   {
-    map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.find(m_nowActiveStart);
-    if (it != m_tags.end() && it->second->IsActive())
-      return it->second;
+    vector<CEpgInfoTagPtr>::const_iterator it = FindByStart(m_tags.begin(), m_tags.end(), m_nowActiveStart);
+    if (it != m_tags.end() && (*it)->IsActive())
+      return *it;
   }
 
   if (bUpdateIfNeeded)
@@ -195,15 +233,15 @@ CEpgInfoTagPtr CEpg::GetTagNow(bool bUpdateIfNeeded /* = true */) const
     CEpgInfoTagPtr lastActiveTag;
 
     /* one of the first items will always match if the list is sorted */
-    for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+    for (vector<CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
     {
-      if (it->second->IsActive())
+      if ((*it)->IsActive())
       {
-        m_nowActiveStart = it->first;
-        return it->second;
+        m_nowActiveStart = (*it)->StartAsUTC();
+        return *it;
       }
-      else if (it->second->WasActive())
-        lastActiveTag = it->second;
+      else if ((*it)->WasActive())
+        lastActiveTag = *it;
     }
 
     /* there might be a gap between the last and next event. return the last if found and it ended not more than 5 minutes ago */
@@ -221,17 +259,18 @@ CEpgInfoTagPtr CEpg::GetTagNext() const
   if (nowTag)
   {
     CSingleLock lock(m_critSection);
-    map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.find(nowTag->StartAsUTC());
+    vector<CEpgInfoTagPtr>::const_iterator it = FindByStart(m_tags.begin(), m_tags.end(), nowTag->StartAsUTC());
     if (it != m_tags.end() && ++it != m_tags.end())
-      return it->second;
+      return *it;
   }
   else if (Size() > 0)
   {
     /* return the first event that is in the future */
-    for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+    CSingleLock lock(m_critSection);
+    for (vector<CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
     {
-      if (it->second->IsUpcoming())
-        return it->second;
+      if ((*it)->IsUpcoming())
+        return *it;
     }
   }
 
@@ -256,10 +295,10 @@ bool CEpg::CheckPlayingEvent(void)
 CEpgInfoTagPtr CEpg::GetTag(const CDateTime &StartTime) const
 {
   CSingleLock lock(m_critSection);
-  map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.find(StartTime);
+  vector<CEpgInfoTagPtr>::const_iterator it = FindByStart(m_tags.begin(), m_tags.end(), StartTime);
   if (it != m_tags.end())
   {
-    return it->second;
+    return *it;
   }
 
   return CEpgInfoTagPtr();
@@ -269,9 +308,9 @@ CEpgInfoTagPtr CEpg::GetTag(int uniqueID) const
 {
   CEpgInfoTagPtr retval;
   CSingleLock lock(m_critSection);
-  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); !retval && it != m_tags.end(); ++it)
-    if (it->second->UniqueBroadcastID() == uniqueID)
-      retval = it->second;
+  for (vector<CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); !retval && it != m_tags.end(); ++it)
+    if ((*it)->UniqueBroadcastID() == uniqueID)
+      retval = *it;
 
   return retval;
 }
@@ -279,10 +318,11 @@ CEpgInfoTagPtr CEpg::GetTag(int uniqueID) const
 CEpgInfoTagPtr CEpg::GetTagBetween(const CDateTime &beginTime, const CDateTime &endTime) const
 {
   CSingleLock lock(m_critSection);
-  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+  for (vector<CEpgInfoTagPtr>::const_iterator it = lower_bound(m_tags.begin(), m_tags.end(), beginTime, StartsBefore());
+       it != m_tags.end() && (*it)->StartAsUTC() <= endTime; ++it)
   {
-    if (it->second->StartAsUTC() >= beginTime && it->second->EndAsUTC() <= endTime)
-      return it->second;
+    if ((*it)->EndAsUTC() <= endTime)
+      return *it;
   }
 
   return CEpgInfoTagPtr();
@@ -291,10 +331,13 @@ CEpgInfoTagPtr CEpg::GetTagBetween(const CDateTime &beginTime, const CDateTime &
 CEpgInfoTagPtr CEpg::GetTagAround(const CDateTime &time) const
 {
   CSingleLock lock(m_critSection);
-  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+  /* only events that start before the given time can be running, the latest is the most likely one */
+  vector<CEpgInfoTagPtr>::const_iterator it = lower_bound(m_tags.begin(), m_tags.end(), time, StartsBefore());
+  while (it != m_tags.begin())
   {
-    if ((it->second->StartAsUTC() < time) && (it->second->EndAsUTC() > time))
-      return it->second;
+    --it;
+    if ((*it)->EndAsUTC() > time)
+      return *it;
   }
 
   return CEpgInfoTagPtr();
@@ -304,13 +347,13 @@ void CEpg::AddEntry(const CEpgInfoTag &tag)
 {
   CEpgInfoTagPtr newTag;
   CSingleLock lock(m_critSection);
-  map<CDateTime, CEpgInfoTagPtr>::iterator itr = m_tags.find(tag.StartAsUTC());
-  if (itr != m_tags.end())
-    newTag = itr->second;
+  vector<CEpgInfoTagPtr>::iterator itr = lower_bound(m_tags.begin(), m_tags.end(), tag.StartAsUTC(), StartsBefore());
+  if (itr != m_tags.end() && (*itr)->StartAsUTC() == tag.StartAsUTC())
+    newTag = *itr;
   else
   {
     newTag.reset(new CEpgInfoTag(this, m_pvrChannel, m_strName, m_pvrChannel ? m_pvrChannel->IconPath() : ""));
-    m_tags.insert(make_pair(tag.StartAsUTC(), newTag));
+    m_tags.insert(itr, newTag);
   }
 
   if (newTag)
@@ -318,6 +361,7 @@ void CEpg::AddEntry(const CEpgInfoTag &tag)
     newTag->Update(tag);
     newTag->SetPVRChannel(m_pvrChannel);
     newTag->SetEpg(this);
+    SetTagsChanged();
   }
 }
 
@@ -325,26 +369,29 @@ bool CEpg::UpdateEntry(const CEpgInfoTag &tag, bool bUpdateDatabase /* = false *
 {
   CEpgInfoTagPtr infoTag;
   CSingleLock lock(m_critSection);
-  map<CDateTime, CEpgInfoTagPtr>::iterator it = m_tags.find(tag.StartAsUTC());
+  vector<CEpgInfoTagPtr>::iterator it = lower_bound(m_tags.begin(), m_tags.end(), tag.StartAsUTC(), StartsBefore());
   bool bNewTag(false);
-  if (it != m_tags.end())
+  if (it != m_tags.end() && (*it)->StartAsUTC() == tag.StartAsUTC())
   {
-    infoTag = it->second;
+    infoTag = *it;
   }
   else
   {
     /* create a new tag if no tag with this ID exists */
     infoTag.reset(new CEpgInfoTag(this, m_pvrChannel, m_strName, m_pvrChannel ? m_pvrChannel->IconPath() : ""));
     infoTag->SetUniqueBroadcastID(tag.UniqueBroadcastID());
-    m_tags.insert(make_pair(tag.StartAsUTC(), infoTag));
+    m_tags.insert(it, infoTag);
     bNewTag = true;
   }
 
-  infoTag->Update(tag, bNewTag);
+  bool bChanged = infoTag->Update(tag, bNewTag);
   infoTag->SetEpg(this);
   infoTag->SetPVRChannel(m_pvrChannel);
+  if (bChanged || bNewTag)
+    SetTagsChanged();
 
-  if (bUpdateDatabase)
+  /* only new and changed events are written, a full guide update mostly repeats what we have */
+  if (bUpdateDatabase && (bChanged || bNewTag))
     m_changedTags.insert(make_pair(infoTag->UniqueBroadcastID(), infoTag));
 
   return true;
@@ -388,8 +435,8 @@ bool CEpg::UpdateEntries(const CEpg &epg, bool bStoreInDb /* = true */)
   CLog::Log(LOGDEBUG, "EPG - %s - %zu entries in memory before merging", __FUNCTION__, m_tags.size());
 #endif
   /* copy over tags */
-  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = epg.m_tags.begin(); it != epg.m_tags.end(); ++it)
-    UpdateEntry(*it->second, bStoreInDb, false);
+  for (vector<CEpgInfoTagPtr>::const_iterator it = epg.m_tags.begin(); it != epg.m_tags.end(); ++it)
+    UpdateEntry(**it, bStoreInDb, false);
 
 #if EPG_DEBUGGING
   CLog::Log(LOGDEBUG, "EPG - %s - %zu entries in memory after merging and before fixing", __FUNCTION__, m_tags.size());
@@ -495,8 +542,8 @@ int CEpg::Get(CFileItemList &results) const
 
   CSingleLock lock(m_critSection);
 
-  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
-    results.Add(CFileItemPtr(new CFileItem(it->second)));
+  for (vector<CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+    results.Add(CFileItemPtr(new CFileItem(*it)));
 
   return results.Size() - iInitialSize;
 }
@@ -510,10 +557,10 @@ int CEpg::Get(CFileItemList &results, const EpgSearchFilter &filter) const
 
   CSingleLock lock(m_critSection);
 
-  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+  for (vector<CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
   {
-    if (filter.FilterEntry(*it->second))
-      results.Add(CFileItemPtr(new CFileItem(it->second)));
+    if (filter.FilterEntry(**it))
+      results.Add(CFileItemPtr(new CFileItem(*it)));
   }
 
   return results.Size() - iInitialSize;
@@ -544,8 +591,9 @@ bool CEpg::Persist(void)
         m_iEpgID = iId;
     }
 
+    /* only what changed since the last call is written, in a single transaction */
     for (std::map<int, CEpgInfoTagPtr>::iterator it = m_deletedTags.begin(); it != m_deletedTags.end(); ++it)
-      database->Delete(*it->second);
+      database->Delete(*it->second, true);
 
     for (std::map<int, CEpgInfoTagPtr>::iterator it = m_changedTags.begin(); it != m_changedTags.end(); ++it)
       it->second->Persist(false);
@@ -569,7 +617,7 @@ CDateTime CEpg::GetFirstDate(void) const
 
   CSingleLock lock(m_critSection);
   if (!m_tags.empty())
-    first = m_tags.begin()->second->StartAsUTC();
+    first = m_tags.front()->StartAsUTC();
 
   return first;
 }
@@ -580,11 +628,29 @@ CDateTime CEpg::GetLastDate(void) const
 
   CSingleLock lock(m_critSection);
   if (!m_tags.empty())
-    last = m_tags.rbegin()->second->StartAsUTC();
+    last = m_tags.back()->StartAsUTC();
 
   return last;
 }
 
+long CEpg::GetTags(std::vector<CEpgInfoTagPtr> &tags) const
+{
+  CSingleLock lock(m_critSection);
+  tags = m_tags;
+  return m_iTagsVersion;
+}
+
+long CEpg::GetTagsVersion(void) const
+{
+  CSingleLock lock(m_critSection);
+  return m_iTagsVersion;
+}
+
+long CEpg::GetLastTagsVersion(void)
+{
+  return tagsVersion;
+}
+
 //@}
 
 /** @name Private methods */
@@ -595,44 +661,46 @@ bool CEpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
   bool bReturn(true);
   CEpgInfoTagPtr previousTag, currentTag;
 
-  for (map<CDateTime, CEpgInfoTagPtr>::iterator it = m_tags.begin(); it != m_tags.end(); it != m_tags.end() ? it++ : it)
+  vector<CEpgInfoTagPtr>::iterator keep = m_tags.begin();
+  for (vector<CEpgInfoTagPtr>::iterator it = m_tags.begin(); it != m_tags.end(); ++it)
   {
-    if (!previousTag)
-    {
-      previousTag = it->second;
-      continue;
-    }
-    currentTag = it->second;
-
-    if (previousTag->EndAsUTC() >= currentTag->EndAsUTC())
+    currentTag = *it;
+    if (previousTag && previousTag->EndAsUTC() >= currentTag->EndAsUTC())
     {
       // delete the current tag. it's completely overlapped
       if (bUpdateDb)
         m_deletedTags.insert(make_pair(currentTag->UniqueBroadcastID(), currentTag));
 
-      if (m_nowActiveStart == it->first)
+      if (m_nowActiveStart == currentTag->StartAsUTC())
         m_nowActiveStart.SetValid(false);
 
-      it->second->ClearTimer();
-      m_tags.erase(it++);
+      currentTag->ClearTimer();
+      continue;
     }
-    else if (previousTag->EndAsUTC() > currentTag->StartAsUTC())
+
+    if (previousTag && previousTag->EndAsUTC() > currentTag->StartAsUTC())
     {
       previousTag->SetEndFromUTC(currentTag->StartAsUTC());
       if (bUpdateDb)
         m_changedTags.insert(make_pair(previousTag->UniqueBroadcastID(), previousTag));
-
-      previousTag = it->second;
-    }
-    else
-    {
-      previousTag = it->second;
     }
+
+    previousTag = currentTag;
+    if (keep != it)
+      *keep = currentTag;
+    ++keep;
   }
+  m_tags.erase(keep, m_tags.end());
+  SetTagsChanged();
 
   return bReturn;
 }
 
+void CEpg::SetTagsChanged(void)
+{
+  m_iTagsVersion = AtomicIncrement(&tagsVersion);
+}
+
 bool CEpg::UpdateFromScraper(time_t start, time_t end)
 {
   bool bGrabSuccess = false;
@@ -772,9 +840,9 @@ bool CEpg::LoadFromClients(time_t start, time_t end)
 CEpgInfoTagPtr CEpg::GetNextEvent(const CEpgInfoTag& tag) const
 {
   CSingleLock lock(m_critSection);
-  map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.find(tag.StartAsUTC());
+  vector<CEpgInfoTagPtr>::const_iterator it = FindByStart(m_tags.begin(), m_tags.end(), tag.StartAsUTC());
   if (it != m_tags.end() && ++it != m_tags.end())
-    return it->second;
+    return *it;
 
   CEpgInfoTagPtr retVal;
   return retVal;
@@ -783,11 +851,11 @@ CEpgInfoTagPtr CEpg::GetNextEvent(const CEpgInfoTag& tag) const
 CEpgInfoTagPtr CEpg::GetPreviousEvent(const CEpgInfoTag& tag) const
 {
   CSingleLock lock(m_critSection);
-  map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.find(tag.StartAsUTC());
+  vector<CEpgInfoTagPtr>::const_iterator it = FindByStart(m_tags.begin(), m_tags.end(), tag.StartAsUTC());
   if (it != m_tags.end() && it != m_tags.begin())
   {
     --it;
-    return it->second;
+    return *it;
   }
 
   CEpgInfoTagPtr retVal;
@@ -829,8 +897,8 @@ void CEpg::SetChannel(const PVR::CPVRChannelPtr &channel)
       channel->SetEpgID(m_iEpgID);
     }
     m_pvrChannel = channel;
-    for (map<CDateTime, CEpgInfoTagPtr>::iterator it = m_tags.begin(); it != m_tags.end(); ++it)
-      it->second->SetPVRChannel(m_pvrChannel);
+    for (vector<CEpgInfoTagPtr>::iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+      (*it)->SetPVRChannel(m_pvrChannel);
   }
 }
 
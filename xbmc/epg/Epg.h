@@ -29,6 +29,8 @@
 #include "utils/Observer.h"
 #include "pvr/channels/PVRChannel.h"
 
+#include <vector>
+
 namespace PVR
 {
   class CPVRChannel;
@@ -214,7 +216,7 @@ namespace EPG
     /*!
      * @brief Update an entry in this EPG.
      * @param tag The tag to update.
-     * @param bUpdateDatabase If set to true, this event will be persisted in the database.
+     * @param bUpdateDatabase If set to true, this event will be persisted in the database if it's new or changed.
      * @param bSort If set to false, epg entries will not be sorted after updating; used for mass updates
      * @return True if it was updated successfully, false otherwise.
      */
@@ -245,6 +247,25 @@ namespace EPG
      */
     int Get(CFileItemList &results, const EpgSearchFilter &filter) const;
 
+    /*!
+     * @brief Get all EPG entries, sorted by start time.
+     * @param tags The vector to store the entries in.
+     * @return The version of the entries, see GetTagsVersion().
+     */
+    long GetTags(std::vector<CEpgInfoTagPtr> &tags) const;
+
+    /*!
+     * @return A number that changes whenever entries are added, removed or changed.
+     * Versions are unique over all tables.
+     */
+    long GetTagsVersion(void) const;
+
+    /*!
+     * @return The version that was given out last, to any table. It changes whenever
+     * the entries of any table change, see GetTagsVersion().
+     */
+    static long GetLastTagsVersion(void);
+
     /*!
      * @brief Persist this table in the database.
      * @return True if the table was persisted, false otherwise.
@@ -348,7 +369,12 @@ namespace EPG
 
     bool IsRemovableTag(const EPG::CEpgInfoTag &tag) const;
 
-    std::map<CDateTime, CEpgInfoTagPtr> m_tags;
+    /*!
+     * @brief Give the entries of this table a new version. Must be called with m_critSection held.
+     */
+    void SetTagsChanged(void);
+
+    std::vector<CEpgInfoTagPtr>         m_tags;            /*!< the events of this table, sorted by start time */
     std::map<int, CEpgInfoTagPtr>       m_changedTags;
     std::map<int, CEpgInfoTagPtr>       m_deletedTags;
     bool                                m_bChanged;        /*!< true if anything changed that needs to be persisted, false otherwise */
@@ -366,5 +392,6 @@ namespace EPG
 
     CCriticalSection                    m_critSection;     /*!< critical section for changes in this table */
     bool                                m_bUpdateLastScanTime;
+    long                                m_iTagsVersion;    /*!< changes whenever m_tags or one of the tags in it changes */
   };
 }
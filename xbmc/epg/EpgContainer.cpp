@@ -61,6 +61,9 @@ CEpgContainer::CEpgContainer(void) :
   m_iNextEpgUpdate = 0;
   m_iDisplayTime = 24 * 60 * 60;
   m_bIgnoreDbForClient = false;
+  m_iReaders = 0;
+  m_iIndexedTagsVersion = 0;
+  m_iRemovedTables = 0;
 }
 
 CEpgContainer::~CEpgContainer(void)
@@ -106,16 +109,14 @@ void CEpgContainer::Clear(bool bClearDb /* = false */)
     CSingleLock lock(m_critSection);
     /* clear all epg tables and remove pointers to epg tables on channels */
     for (EPGMAP_CITR it = m_epgs.begin(); it != m_epgs.end(); it++)
-    {
-      it->second->UnregisterObserver(this);
-      delete it->second;
-    }
+      DeleteTable(it->second);
     m_epgs.clear();
     m_iNextEpgUpdate  = 0;
     m_bStarted = false;
     m_bIsInitialising = true;
     m_iNextEpgId = 0;
   }
+  m_searchIndex.Clear();
 
   /* clear the database entries */
   if (bClearDb && !m_bIgnoreDbForClient)
@@ -239,19 +240,19 @@ void CEpgContainer::LoadFromDB(void)
 
 bool CEpgContainer::PersistTables(void)
 {
-  m_critSection.lock();
-  std::map<unsigned int, CEpg*> copy = m_epgs;
-  m_critSection.unlock();
-  return m_database.Persist(copy);
+  EPGMAP copy;
+  BeginRead(copy);
+  bool bReturn = m_database.Persist(copy);
+  EndRead();
+  return bReturn;
 }
 
 bool CEpgContainer::PersistAll(void)
 {
   bool bReturn(true);
-  m_critSection.lock();
-  std::map<unsigned int, CEpg*> copy = m_epgs;
-  m_critSection.unlock();
-  
+  EPGMAP copy;
+  BeginRead(copy);
+
   for (EPGMAP_CITR it = copy.begin(); it != copy.end() && !m_bStop; it++)
   {
     CEpg *epg = it->second;
@@ -260,6 +261,7 @@ bool CEpgContainer::PersistAll(void)
       bReturn &= epg->Persist();
     }
   }
+  EndRead();
 
   return bReturn;
 }
@@ -323,6 +325,10 @@ void CEpgContainer::Process(void)
         UpdateEPG(true);
     }
 
+    /* index what changed, so that searches don't have to */
+    if (!m_bStop)
+      UpdateSearchIndex();
+
     /* check for updated active tag */
     if (!m_bStop)
       CheckPlayingEvents();
@@ -473,13 +479,46 @@ bool CEpgContainer::DeleteEpg(const CEpg &epg, bool bDeleteFromDatabase /* = fal
   if (bDeleteFromDatabase && !m_bIgnoreDbForClient && m_database.IsOpen())
     m_database.Delete(*it->second);
 
-  it->second->UnregisterObserver(this);
-  delete it->second;
+  DeleteTable(it->second);
   m_epgs.erase(it);
 
   return true;
 }
 
+void CEpgContainer::DeleteTable(CEpg *epg)
+{
+  epg->UnregisterObserver(this);
+  /* the index still holds its entries until the next update */
+  ++m_iRemovedTables;
+  m_iIndexedTagsVersion = 0;
+
+  /* readers may still be using the table, the last one deletes it */
+  if (m_iReaders > 0)
+    m_retiredEpgs.push_back(epg);
+  else
+    delete epg;
+}
+
+void CEpgContainer::BeginRead(EPGMAP &epgs)
+{
+  CSingleLock lock(m_critSection);
+  ++m_iReaders;
+  epgs = m_epgs;
+}
+
+void CEpgContainer::EndRead(void)
+{
+  std::vector<CEpg*> retired;
+  {
+    CSingleLock lock(m_critSection);
+    if (--m_iReaders == 0)
+      retired.swap(m_retiredEpgs);
+  }
+
+  for (std::vector<CEpg*>::const_iterator it = retired.begin(); it != retired.end(); ++it)
+    delete *it;
+}
+
 void CEpgContainer::CloseProgressDialog(void)
 {
   if (m_progressHandle)
@@ -660,9 +699,12 @@ int CEpgContainer::GetEPGAll(CFileItemList &results)
 {
   int iInitialSize = results.Size();
 
-  CSingleLock lock(m_critSection);
-  for (EPGMAP_CITR it = m_epgs.begin(); it != m_epgs.end(); it++)
+  /* every table locks itself while it's read, the container isn't locked meanwhile */
+  EPGMAP epgs;
+  BeginRead(epgs);
+  for (EPGMAP_CITR it = epgs.begin(); it != epgs.end(); it++)
     it->second->Get(results);
+  EndRead();
 
   return results.Size() - iInitialSize;
 }
@@ -671,15 +713,15 @@ const CDateTime CEpgContainer::GetFirstEPGDate(void)
 {
   CDateTime returnValue;
 
-  CSingleLock lock(m_critSection);
-  for (EPGMAP_CITR it = m_epgs.begin(); it != m_epgs.end(); it++)
+  EPGMAP epgs;
+  BeginRead(epgs);
+  for (EPGMAP_CITR it = epgs.begin(); it != epgs.end(); it++)
   {
-    lock.Leave();
     CDateTime entry = it->second->GetFirstDate();
     if (entry.IsValid() && (!returnValue.IsValid() || entry < returnValue))
       returnValue = entry;
-    lock.Enter();
   }
+  EndRead();
 
   return returnValue;
 }
@@ -688,15 +730,15 @@ const CDateTime CEpgContainer::GetLastEPGDate(void)
 {
   CDateTime returnValue;
 
-  CSingleLock lock(m_critSection);
-  for (EPGMAP_CITR it = m_epgs.begin(); it != m_epgs.end(); it++)
+  EPGMAP epgs;
+  BeginRead(epgs);
+  for (EPGMAP_CITR it = epgs.begin(); it != epgs.end(); it++)
   {
-    lock.Leave();
     CDateTime entry = it->second->GetLastDate();
     if (entry.IsValid() && (!returnValue.IsValid() || entry > returnValue))
       returnValue = entry;
-    lock.Enter();
   }
+  EndRead();
 
   return returnValue;
 }
@@ -705,12 +747,35 @@ int CEpgContainer::GetEPGSearch(CFileItemList &results, const EpgSearchFilter &f
 {
   int iInitialSize = results.Size();
 
-  /* get filtered results from all tables */
+  /* every table locks itself while it's read, the container isn't locked meanwhile */
+  EPGMAP epgs;
+  BeginRead(epgs);
+
+  /* look the events up in the index if it's up to date and the filter allows it, scan all tables otherwise */
+  std::vector<CEpgInfoTagPtr> tags;
+  if (IsSearchIndexCurrent() && m_searchIndex.Search(filter, tags))
   {
-    CSingleLock lock(m_critSection);
-    for (EPGMAP_CITR it = m_epgs.begin(); it != m_epgs.end(); it++)
+    /* like CEpg::Get(), skip tables that only have events in the past */
+    std::map<int, bool> validTables;
+    for (std::vector<CEpgInfoTagPtr>::const_iterator it = tags.begin(); it != tags.end(); ++it)
+    {
+      std::map<int, bool>::iterator valid = validTables.find((*it)->EpgID());
+      if (valid == validTables.end())
+      {
+        EPGMAP_CITR epg = epgs.find((unsigned int)(*it)->EpgID());
+        valid = validTables.insert(make_pair((*it)->EpgID(), epg != epgs.end() && epg->second->HasValidEntries())).first;
+      }
+
+      if (valid->second)
+        results.Add(CFileItemPtr(new CFileItem(*it)));
+    }
+  }
+  else
+  {
+    for (EPGMAP_CITR it = epgs.begin(); it != epgs.end(); it++)
       it->second->Get(results, filter);
   }
+  EndRead();
 
   /* remove duplicate entries */
   if (filter.m_bPreventRepeats)
@@ -719,6 +784,34 @@ int CEpgContainer::GetEPGSearch(CFileItemList &results, const EpgSearchFilter &f
   return results.Size() - iInitialSize;
 }
 
+void CEpgContainer::UpdateSearchIndex(void)
+{
+  /* versions are shared by all tables, nothing changed unless a table was removed or the last version did */
+  long iTagsVersion = CEpg::GetLastTagsVersion();
+  unsigned int iRemovedTables;
+  EPGMAP epgs;
+  {
+    CSingleLock lock(m_critSection);
+    if (iTagsVersion == m_iIndexedTagsVersion)
+      return;
+    iRemovedTables = m_iRemovedTables;
+  }
+
+  BeginRead(epgs);
+  m_searchIndex.Update(epgs);
+  EndRead();
+
+  CSingleLock lock(m_critSection);
+  if (iRemovedTables == m_iRemovedTables)
+    m_iIndexedTagsVersion = iTagsVersion;
+}
+
+bool CEpgContainer::IsSearchIndexCurrent(void)
+{
+  CSingleLock lock(m_critSection);
+  return m_iIndexedTagsVersion != 0 && m_iIndexedTagsVersion == CEpg::GetLastTagsVersion();
+}
+
 bool CEpgContainer::CheckPlayingEvents(void)
 {
   bool bReturn(false);
@@ -28,8 +28,10 @@
 
 #include "Epg.h"
 #include "EpgDatabase.h"
+#include "EpgSearchIndex.h"
 
 #include <map>
+#include <vector>
 
 class CFileItemList;
 class CGUIDialogProgressBarHandle;
@@ -282,11 +284,42 @@ namespace EPG
 
     void InsertFromDatabase(int iEpgID, const std::string &strName, const std::string &strScraperName);
 
+    /*!
+     * @brief Reindex the tables that changed since the last call.
+     * Called by the update thread, it returns right away if no table changed.
+     */
+    void UpdateSearchIndex(void);
+
+    /*!
+     * @return True if no table changed since the search index was updated.
+     */
+    bool IsSearchIndexCurrent(void);
+
     typedef std::map<unsigned int, CEpg*> EPGMAP;
     typedef EPGMAP::iterator              EPGMAP_ITR;
     typedef EPGMAP::const_iterator        EPGMAP_CITR;
 
-    CEpgDatabase m_database;           /*!< the EPG database */
+    /*!
+     * @brief Get the tables, to read them without holding the container lock.
+     * Tables that are removed meanwhile aren't deleted before EndRead() is called.
+     * @param epgs The tables.
+     */
+    void BeginRead(EPGMAP &epgs);
+
+    /*!
+     * @brief Done reading the tables returned by BeginRead().
+     */
+    void EndRead(void);
+
+    /*!
+     * @brief Delete a table that was removed from m_epgs, or leave that to the last reader.
+     * The container has to be locked.
+     * @param epg The table.
+     */
+    void DeleteTable(CEpg *epg);
+
+    CEpgDatabase    m_database;        /*!< the EPG database */
+    CEpgSearchIndex m_searchIndex;     /*!< the index GetEPGSearch() looks events up in */
 
     /** @name Configuration */
     //@{
@@ -308,6 +341,10 @@ namespace EPG
     time_t       m_iNextEpgActiveTagCheck; /*!< the time the EPG will be checked for active tag updates */
     unsigned int m_iNextEpgId;             /*!< the next epg ID that will be given to a new table when the db isn't being used */
     EPGMAP       m_epgs;                   /*!< the EPGs in this container */
+    unsigned int m_iReaders;               /*!< the number of readers between BeginRead() and EndRead() */
+    std::vector<CEpg*> m_retiredEpgs;      /*!< removed tables that are deleted once there are no readers */
+    long         m_iIndexedTagsVersion;    /*!< the last tags version when the search index was updated, 0 if it never was */
+    unsigned int m_iRemovedTables;         /*!< the number of tables removed, the search index has to drop them */
     //@}
 
     CGUIDialogProgressBarHandle *  m_progressHandle; /*!< the progress dialog that is visible when updating the first time */
@@ -157,12 +157,15 @@ bool CEpgDatabase::DeleteOldEpgEntries(void)
   return DeleteValues("epgtags", filter);
 }
 
-bool CEpgDatabase::Delete(const CEpgInfoTag &tag)
+bool CEpgDatabase::Delete(const CEpgInfoTag &tag, bool bQueueWrite /* = false */)
 {
   /* tag without a database ID was not persisted */
   if (tag.BroadcastId() <= 0)
     return false;
 
+  if (bQueueWrite)
+    return QueueInsertQuery("DELETE FROM epgtags WHERE idBroadcast = ?;", { tag.BroadcastId() });
+
   Filter filter;
   filter.AppendWhere(PrepareSQL("idBroadcast = %u", tag.BroadcastId()));
 
@@ -205,7 +208,7 @@ int CEpgDatabase::Get(CEpg &epg)
 {
   int iReturn(-1);
 
-  std::string strQuery = PrepareSQL("SELECT * FROM epgtags WHERE idEpg = %u;", epg.EpgID());
+  std::string strQuery = PrepareSQL("SELECT * FROM epgtags WHERE idEpg = %u ORDER BY iStartTime;", epg.EpgID());
   if (ResultQuery(strQuery))
   {
     iReturn = 0;
@@ -347,50 +350,41 @@ int CEpgDatabase::Persist(const CEpgInfoTag &tag, bool bSingleUpdate /* = true *
   tag.FirstAiredAsUTC().GetAsTime(iFirstAired);
 
   int iBroadcastId = tag.BroadcastId();
-  std::string strQuery;
-  
+
   /* Only store the genre string when needed */
   std::string strGenre = (tag.GenreType() == EPG_GENRE_USE_STRING) ? StringUtils::Join(tag.Genre(), g_advancedSettings.m_videoItemSeparator) : "";
 
+  /* the values are bound, so that all tags of an update share one prepared statement */
+  std::string strQuery = "REPLACE INTO epgtags (idEpg, iStartTime, "
+      "iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, iYear, sIMDBNumber, "
+      "sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
+      "iEpisodeId, iEpisodePart, sEpisodeName, iBroadcastUid";
+  BindParams params = { tag.EpgID(), (int)iStartTime, (int)iEndTime,
+      tag.Title(true), tag.PlotOutline(true), tag.Plot(true),
+      tag.OriginalTitle(true), tag.Cast(), tag.Director(), tag.Writer(), tag.Year(), tag.IMDBNumber(),
+      tag.Icon(), tag.GenreType(), tag.GenreSubType(), strGenre,
+      (int)iFirstAired, tag.ParentalRating(), tag.StarRating(), (int)tag.Notify(),
+      tag.SeriesNumber(), tag.EpisodeNumber(), tag.EpisodePart(), tag.EpisodeName(),
+      tag.UniqueBroadcastID() };
+
   if (iBroadcastId < 0)
   {
-    strQuery = PrepareSQL("REPLACE INTO epgtags (idEpg, iStartTime, "
-        "iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, iYear, sIMDBNumber, "
-        "sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
-        "iEpisodeId, iEpisodePart, sEpisodeName, iBroadcastUid) "
-        "VALUES (%u, %u, %u, '%s', '%s', '%s', '%s', '%s', '%s', '%s', %i, '%s', '%s', %i, %i, '%s', %u, %i, %i, %i, %i, %i, %i, '%s', %i);",
-        tag.EpgID(), iStartTime, iEndTime,
-        tag.Title(true).c_str(), tag.PlotOutline(true).c_str(), tag.Plot(true).c_str(),
-        tag.OriginalTitle(true).c_str(), tag.Cast().c_str(), tag.Director().c_str(), tag.Writer().c_str(), tag.Year(), tag.IMDBNumber().c_str(),
-        tag.Icon().c_str(), tag.GenreType(), tag.GenreSubType(), strGenre.c_str(),
-        iFirstAired, tag.ParentalRating(), tag.StarRating(), tag.Notify(),
-        tag.SeriesNumber(), tag.EpisodeNumber(), tag.EpisodePart(), tag.EpisodeName().c_str(),
-        tag.UniqueBroadcastID());
+    strQuery += ") VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
   }
   else
   {
-    strQuery = PrepareSQL("REPLACE INTO epgtags (idEpg, iStartTime, "
-        "iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, iYear, sIMDBNumber, "
-        "sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
-        "iEpisodeId, iEpisodePart, sEpisodeName, iBroadcastUid, idBroadcast) "
-        "VALUES (%u, %u, %u, '%s', '%s', '%s', '%s', '%s', '%s', '%s', %i, '%s', '%s', %i, %i, '%s', %u, %i, %i, %i, %i, %i, %i, '%s', %i, %i);",
-        tag.EpgID(), iStartTime, iEndTime,
-        tag.Title(true).c_str(), tag.PlotOutline(true).c_str(), tag.Plot(true).c_str(),
-        tag.OriginalTitle(true).c_str(), tag.Cast().c_str(), tag.Director().c_str(), tag.Writer().c_str(), tag.Year(), tag.IMDBNumber().c_str(),
-        tag.Icon().c_str(), tag.GenreType(), tag.GenreSubType(), strGenre.c_str(),
-        iFirstAired, tag.ParentalRating(), tag.StarRating(), tag.Notify(),
-        tag.SeriesNumber(), tag.EpisodeNumber(), tag.EpisodePart(), tag.EpisodeName().c_str(),
-        tag.UniqueBroadcastID(), iBroadcastId);
+    strQuery += ", idBroadcast) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
+    params.push_back(iBroadcastId);
   }
 
   if (bSingleUpdate)
   {
-    if (ExecuteQuery(strQuery))
+    if (ExecuteQuery(strQuery, params))
       iReturn = (int) m_pDS->lastinsertid();
   }
   else
   {
-    QueueInsertQuery(strQuery);
+    QueueInsertQuery(strQuery, params);
     iReturn = 0;
   }
 
@@ -0,0 +1,373 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "EpgSearchIndex.h"
+#include "Epg.h"
+#include "EpgSearchFilter.h"
+#include "pvr/channels/PVRChannel.h"
+#include "threads/SingleLock.h"
+#include "utils/StringUtils.h"
+#include "utils/TextSearch.h"
+
+#include "../addons/include/xbmc_epg_types.h"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace EPG;
+
+#define MIN_REMOVED_BEFORE_REBUILD 1024
+
+namespace
+{
+  /* the distinct trigrams of the lower case text. terms are searched for by
+     byte, so these are byte trigrams as well and multi-byte characters simply
+     span several of them */
+  void GetTrigrams(const std::string &strText, std::vector<uint32_t> &trigrams)
+  {
+    std::string strLower(strText);
+    StringUtils::ToLower(strLower);
+
+    trigrams.clear();
+    for (size_t i = 0; i + 3 <= strLower.size(); i++)
+      trigrams.push_back((uint32_t)(uint8_t)strLower[i] << 16 |
+                         (uint32_t)(uint8_t)strLower[i + 1] << 8 |
+                         (uint32_t)(uint8_t)strLower[i + 2]);
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+  }
+
+  void Intersect(std::vector<unsigned int> &a, const std::vector<unsigned int> &b)
+  {
+    std::vector<unsigned int> result;
+    result.reserve(std::min(a.size(), b.size()));
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+    a.swap(result);
+  }
+
+  void SortUnique(std::vector<unsigned int> &ids)
+  {
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  }
+
+  /* narrow the ids down to the ones in restriction, or start with those */
+  void Restrict(std::vector<unsigned int> &ids, std::vector<unsigned int> &restriction, bool &bRestricted)
+  {
+    if (bRestricted)
+      Intersect(ids, restriction);
+    else
+      ids.swap(restriction);
+    bRestricted = true;
+  }
+
+  bool IsUnknownGenre(int iGenreType)
+  {
+    return iGenreType > EPG_EVENT_CONTENTMASK_USERDEFINED || iGenreType < EPG_EVENT_CONTENTMASK_MOVIEDRAMA;
+  }
+
+  bool ShorterPostings(const std::vector<unsigned int> *left, const std::vector<unsigned int> *right)
+  {
+    return left->size() < right->size();
+  }
+
+  bool SortByTableAndStart(const CEpgInfoTagPtr &left, const CEpgInfoTagPtr &right)
+  {
+    if (left->EpgID() != right->EpgID())
+      return left->EpgID() < right->EpgID();
+    return left->StartAsUTC() < right->StartAsUTC();
+  }
+}
+
+CEpgSearchIndex::CEpgSearchIndex(void) :
+    m_iRemoved(0)
+{
+}
+
+void CEpgSearchIndex::Update(const std::map<unsigned int, CEpg*> &epgs)
+{
+  CSingleLock lock(m_critSection);
+
+  /* removed events stay in the postings, start over once they are the majority */
+  if (m_iRemoved > MIN_REMOVED_BEFORE_REBUILD && m_iRemoved > m_docs.size() / 2)
+    Clear();
+
+  for (std::map<unsigned int, Table>::iterator it = m_tables.begin(); it != m_tables.end();)
+  {
+    if (epgs.find(it->first) == epgs.end())
+      RemoveTable(it++);
+    else
+      ++it;
+  }
+
+  std::vector<CEpgInfoTagPtr> tags;
+  for (std::map<unsigned int, CEpg*>::const_iterator it = epgs.begin(); it != epgs.end(); ++it)
+  {
+    std::map<unsigned int, Table>::iterator table = m_tables.find(it->first);
+    if (table != m_tables.end())
+    {
+      if (table->second.version == it->second->GetTagsVersion())
+        continue;
+      RemoveTable(table);
+    }
+
+    long version = it->second->GetTags(tags);
+    AddTable(it->first, tags, version);
+  }
+}
+
+void CEpgSearchIndex::Clear(void)
+{
+  CSingleLock lock(m_critSection);
+  m_docs.clear();
+  m_iRemoved = 0;
+  m_tables.clear();
+  m_textIds.clear();
+  m_textDocs.clear();
+  m_trigrams.clear();
+  m_genres.clear();
+  m_broadcasts.clear();
+  m_untitled.clear();
+}
+
+size_t CEpgSearchIndex::Size(void) const
+{
+  CSingleLock lock(m_critSection);
+  return m_docs.size() - m_iRemoved;
+}
+
+bool CEpgSearchIndex::Search(const EpgSearchFilter &filter, std::vector<CEpgInfoTagPtr> &results) const
+{
+  Postings docs;
+  bool bRestricted(false);
+  results.clear();
+
+  {
+    CSingleLock lock(m_critSection);
+
+    if (filter.m_iUniqueBroadcastId != EPG_SEARCH_UNSET)
+    {
+      Postings broadcastDocs;
+      std::map<int, Postings>::const_iterator it = m_broadcasts.find(filter.m_iUniqueBroadcastId);
+      if (it != m_broadcasts.end())
+        broadcastDocs = it->second;
+      Restrict(docs, broadcastDocs, bRestricted);
+    }
+
+    if (filter.m_iGenreType != EPG_SEARCH_UNSET)
+    {
+      Postings genreDocs;
+      for (std::map<int, Postings>::const_iterator it = m_genres.begin(); it != m_genres.end(); ++it)
+      {
+        if (it->first == filter.m_iGenreType || (filter.m_bIncludeUnknownGenres && IsUnknownGenre(it->first)))
+          genreDocs.insert(genreDocs.end(), it->second.begin(), it->second.end());
+      }
+      SortUnique(genreDocs);
+      Restrict(docs, genreDocs, bRestricted);
+    }
+
+    if (!filter.m_strSearchTerm.empty())
+    {
+      CTextSearch search(filter.m_strSearchTerm, filter.m_bIsCaseSensitive, SEARCH_DEFAULT_OR);
+      Postings textDocs;
+      if (FindDocs(search, textDocs))
+        Restrict(docs, textDocs, bRestricted);
+    }
+
+    if (!bRestricted)
+      return false;
+
+    results.reserve(docs.size());
+    for (Postings::const_iterator it = docs.begin(); it != docs.end(); ++it)
+    {
+      if (m_docs[*it])
+        results.push_back(m_docs[*it]);
+    }
+  }
+
+  /* the index only rules events out, the filter has the final say. that also
+     looks at channels and groups, so don't hold our lock meanwhile */
+  std::vector<CEpgInfoTagPtr>::iterator keep = results.begin();
+  for (std::vector<CEpgInfoTagPtr>::iterator it = results.begin(); it != results.end(); ++it)
+  {
+    if (filter.FilterEntry(**it))
+    {
+      if (keep != it)
+        *keep = *it;
+      ++keep;
+    }
+  }
+  results.erase(keep, results.end());
+  std::sort(results.begin(), results.end(), SortByTableAndStart);
+
+  return true;
+}
+
+void CEpgSearchIndex::AddTable(unsigned int iEpgID, const std::vector<CEpgInfoTagPtr> &tags, long version)
+{
+  Table &table = m_tables[iEpgID];
+  table.version = version;
+  table.docs.clear();
+  table.docs.reserve(tags.size());
+
+  for (std::vector<CEpgInfoTagPtr>::const_iterator it = tags.begin(); it != tags.end(); ++it)
+  {
+    const CEpgInfoTagPtr &tag = *it;
+    unsigned int iDoc = m_docs.size();
+    m_docs.push_back(tag);
+    table.docs.push_back(iDoc);
+
+    /* the real texts, even for locked channels. see FindDocs() */
+    std::string strTitle(tag->Title(true));
+    if (strTitle.empty())
+      m_untitled.push_back(iDoc);
+    else
+      m_textDocs[AddText(strTitle)].push_back(iDoc);
+
+    std::string strPlotOutline(tag->PlotOutline(true));
+    if (!strPlotOutline.empty())
+    {
+      Postings &textDocs = m_textDocs[AddText(strPlotOutline)];
+      if (textDocs.empty() || textDocs.back() != iDoc)
+        textDocs.push_back(iDoc);
+    }
+
+    m_genres[tag->GenreType()].push_back(iDoc);
+    m_broadcasts[tag->UniqueBroadcastID()].push_back(iDoc);
+  }
+}
+
+void CEpgSearchIndex::RemoveTable(std::map<unsigned int, Table>::iterator it)
+{
+  for (Postings::const_iterator doc = it->second.docs.begin(); doc != it->second.docs.end(); ++doc)
+    m_docs[*doc].reset();
+  m_iRemoved += it->second.docs.size();
+  m_tables.erase(it);
+}
+
+unsigned int CEpgSearchIndex::AddText(const std::string &strText)
+{
+  std::pair<std::unordered_map<std::string, unsigned int>::iterator, bool> inserted =
+      m_textIds.insert(std::make_pair(strText, (unsigned int)m_textDocs.size()));
+  if (inserted.second)
+  {
+    unsigned int iText = inserted.first->second;
+    m_textDocs.push_back(Postings());
+
+    std::vector<uint32_t> trigrams;
+    GetTrigrams(strText, trigrams);
+    for (std::vector<uint32_t>::const_iterator it = trigrams.begin(); it != trigrams.end(); ++it)
+      m_trigrams[*it].push_back(iText);
+  }
+
+  return inserted.first->second;
+}
+
+bool CEpgSearchIndex::FindTexts(const std::string &strTerm, Postings &texts) const
+{
+  std::vector<uint32_t> trigrams;
+  GetTrigrams(strTerm, trigrams);
+  if (trigrams.empty())
+    return false;
+
+  /* a text containing the term contains all of its trigrams, start with the rarest */
+  std::vector<const Postings*> lists;
+  for (std::vector<uint32_t>::const_iterator it = trigrams.begin(); it != trigrams.end(); ++it)
+  {
+    std::unordered_map<uint32_t, Postings>::const_iterator list = m_trigrams.find(*it);
+    if (list == m_trigrams.end())
+    {
+      texts.clear();
+      return true;
+    }
+    lists.push_back(&list->second);
+  }
+
+  std::sort(lists.begin(), lists.end(), ShorterPostings);
+
+  texts = *lists[0];
+  for (size_t i = 1; i < lists.size() && !texts.empty(); i++)
+    Intersect(texts, *lists[i]);
+
+  return true;
+}
+
+bool CEpgSearchIndex::FindDocs(const CTextSearch &search, Postings &docs) const
+{
+  /* CTextSearch matches either the title or the plot outline as a whole: all
+     AND terms and one of the OR terms have to be in the same text. NOT terms
+     only rule events out, they can't narrow anything down */
+  Postings texts;
+  bool bRestricted(false);
+
+  const std::vector<std::string> &andTerms = search.GetAndTerms();
+  for (std::vector<std::string>::const_iterator it = andTerms.begin(); it != andTerms.end(); ++it)
+  {
+    Postings termTexts;
+    if (FindTexts(*it, termTexts))
+      Restrict(texts, termTexts, bRestricted);
+  }
+
+  const std::vector<std::string> &orTerms = search.GetOrTerms();
+  if (!orTerms.empty())
+  {
+    Postings orTexts;
+    bool bAnyText(false);
+    for (std::vector<std::string>::const_iterator it = orTerms.begin(); !bAnyText && it != orTerms.end(); ++it)
+    {
+      Postings termTexts;
+      if (FindTexts(*it, termTexts))
+        orTexts.insert(orTexts.end(), termTexts.begin(), termTexts.end());
+      else
+        bAnyText = true;
+    }
+
+    if (!bAnyText)
+    {
+      SortUnique(orTexts);
+      Restrict(texts, orTexts, bRestricted);
+    }
+  }
+
+  if (!bRestricted)
+    return false;
+
+  docs.clear();
+  for (Postings::const_iterator it = texts.begin(); it != texts.end(); ++it)
+    docs.insert(docs.end(), m_textDocs[*it].begin(), m_textDocs[*it].end());
+
+  /* untitled events and events on locked channels are searched with a
+     placeholder title, they always have to be checked */
+  docs.insert(docs.end(), m_untitled.begin(), m_untitled.end());
+  for (std::map<unsigned int, Table>::const_iterator it = m_tables.begin(); it != m_tables.end(); ++it)
+  {
+    const Postings &tableDocs = it->second.docs;
+    if (tableDocs.empty() || !m_docs[tableDocs.front()])
+      continue;
+
+    const CEpgInfoTagPtr &tag = m_docs[tableDocs.front()];
+    if (tag->HasPVRChannel() && tag->ChannelTag()->IsLocked())
+      docs.insert(docs.end(), tableDocs.begin(), tableDocs.end());
+  }
+
+  SortUnique(docs);
+  return true;
+}
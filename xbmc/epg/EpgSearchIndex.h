@@ -0,0 +1,119 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/CriticalSection.h"
+
+#include "EpgInfoTag.h"
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class CTextSearch;
+
+namespace EPG
+{
+  class CEpg;
+  struct EpgSearchFilter;
+
+  /*!
+   * @brief Inverted index over the events of all EPG tables.
+   *
+   * Titles and plot outlines are indexed by their (lower case) trigrams, each
+   * distinct text once since guides repeat the same titles over and over.
+   * Events are also indexed by genre type and unique broadcast id. A search
+   * narrows the events down to the ones that can match the filter and only
+   * runs EpgSearchFilter::FilterEntry() on those, so the results are the
+   * same as when all tables are scanned.
+   *
+   * Tables are reindexed when their tags version changed, see CEpg::GetTagsVersion().
+   */
+  class CEpgSearchIndex
+  {
+  public:
+    CEpgSearchIndex(void);
+
+    /*!
+     * @brief Bring the index up to date with the given tables.
+     * Tables that didn't change since the last call are skipped, tables that aren't
+     * passed anymore are dropped.
+     * @param epgs The tables to index.
+     */
+    void Update(const std::map<unsigned int, CEpg*> &epgs);
+
+    /*!
+     * @brief Remove all tables from the index.
+     */
+    void Clear(void);
+
+    /*!
+     * @brief Find the events that match a filter.
+     * @param filter The filter to apply.
+     * @param results The matching events, sorted by table and start time.
+     * @return False if the filter has nothing the index can narrow the search down with,
+     *         the tables have to be scanned instead then.
+     */
+    bool Search(const EpgSearchFilter &filter, std::vector<CEpgInfoTagPtr> &results) const;
+
+    /*!
+     * @return The number of indexed events.
+     */
+    size_t Size(void) const;
+
+  private:
+    typedef std::vector<unsigned int> Postings; /*!< sorted ids */
+
+    struct Table
+    {
+      long     version;
+      Postings docs;
+    };
+
+    void AddTable(unsigned int iEpgID, const std::vector<CEpgInfoTagPtr> &tags, long version);
+    void RemoveTable(std::map<unsigned int, Table>::iterator it);
+    unsigned int AddText(const std::string &strText);
+
+    /*!
+     * @brief Get the texts a term can be a substring of.
+     * @return False if the term is too short to be looked up, any text can contain it.
+     */
+    bool FindTexts(const std::string &strTerm, Postings &texts) const;
+
+    /*!
+     * @brief Get the events with a title or plot outline the search terms can match.
+     * @return False if the search terms can't narrow the events down.
+     */
+    bool FindDocs(const CTextSearch &search, Postings &docs) const;
+
+    std::vector<CEpgInfoTagPtr>                   m_docs;       /*!< the indexed events, empty pointers for removed ones */
+    unsigned int                                  m_iRemoved;   /*!< the number of removed events in m_docs */
+    std::map<unsigned int, Table>                 m_tables;     /*!< the events of each table, by table id */
+    std::unordered_map<std::string, unsigned int> m_textIds;    /*!< id of every distinct title and plot outline */
+    std::vector<Postings>                         m_textDocs;   /*!< the events using each text */
+    std::unordered_map<uint32_t, Postings>        m_trigrams;   /*!< the texts containing each lower case trigram */
+    std::map<int, Postings>                       m_genres;     /*!< the events of each genre type */
+    std::map<int, Postings>                       m_broadcasts; /*!< the events with each unique broadcast id */
+    Postings                                      m_untitled;   /*!< events without a title, they show up with a placeholder */
+    mutable CCriticalSection                      m_critSection;
+  };
+}
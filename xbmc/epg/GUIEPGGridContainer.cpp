@@ -32,11 +32,14 @@
 #include "GUIInfoManager.h"
 
 #include "epg/Epg.h"
+#include "epg/EpgContainer.h"
 #include "pvr/channels/PVRChannel.h"
 
 #include "GUIEPGGridContainer.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <map>
 
 using namespace PVR;
 using namespace EPG;
@@ -47,6 +50,48 @@ using namespace std;
 #define BLOCKJUMP    4 // how many blocks are jumped with each analogue scroll action
 #define BLOCK_SCROLL_OFFSET 60 / MINSPERBLOCK // how many blocks are jumped if we are at left/right edge of grid
 
+namespace
+{
+  struct StartsAfter
+  {
+    bool operator()(int block, const GridItemsPtr &item) const { return block < item.startBlock; }
+  };
+
+  /* the item covering a block, rows always start at block 0 */
+  template<class Iterator>
+  Iterator FindRowItem(Iterator begin, Iterator end, int block)
+  {
+    Iterator it = std::upper_bound(begin, end, block, StartsAfter());
+    return it == begin ? it : it - 1;
+  }
+
+  void ClearRows(std::vector<GridRow> &rows)
+  {
+    for (std::vector<GridRow>::iterator row = rows.begin(); row != rows.end(); ++row)
+    {
+      for (std::vector<GridItemsPtr>::iterator it = row->items.begin(); it != row->items.end(); ++it)
+      {
+        if (it->item)
+          it->item->ClearProperties();
+      }
+    }
+    rows.clear();
+  }
+
+  bool IsSameRow(const GridRow &row, const GridRow &other)
+  {
+    if (row.programmes.size() != other.programmes.size())
+      return false;
+
+    for (unsigned int i = 0; i < row.programmes.size(); i++)
+    {
+      if (((CFileItem *)row.programmes[i].get())->GetEPGInfoTag() != ((CFileItem *)other.programmes[i].get())->GetEPGInfoTag())
+        return false;
+    }
+    return true;
+  }
+}
+
 CGUIEPGGridContainer::CGUIEPGGridContainer(int parentID, int controlID, float posX, float posY, float width,
                                            float height, int scrollTime, int preloadItems, int timeBlocks, int rulerUnit,
                                            const CTextureInfo& progressIndicatorTexture)
@@ -70,6 +115,7 @@ CGUIEPGGridContainer::CGUIEPGGridContainer(int parentID, int controlID, float po
   m_channelsPerPage       = 0;
   m_channels              = 0;
   m_blocks                = 0;
+  m_gridIndexBlocks       = 0;
   m_scrollTime            = scrollTime ? scrollTime : 1;
   m_item                  = NULL;
   m_lastItem              = NULL;
@@ -355,6 +401,10 @@ void CGUIEPGGridContainer::ProcessProgrammeGrid(unsigned int currentTime, CDirty
 
   int channel = chanOffset;
 
+  CGUIListItemPtr focusedItem;
+  if (m_channelOffset + m_channelCursor < (int)m_gridIndex.size())
+    focusedItem = GetGridItem(m_channelOffset + m_channelCursor, m_blockOffset + m_blockCursor)->item;
+
   while (posB < endB && !m_channelItems.empty())
   {
     if (channel >= (int)m_channelItems.size())
@@ -363,29 +413,19 @@ void CGUIEPGGridContainer::ProcessProgrammeGrid(unsigned int currentTime, CDirty
     // Free memory not used on screen
     FreeProgrammeMemory(channel, blockOffset - cacheBeforeProgramme, blockOffset + m_programmesPerPage + 1 + cacheAfterProgramme);
 
-    int block = blockOffset;
-    float posA2 = posA;
+    std::vector<GridItemsPtr> &items = m_gridIndex[channel].items;
 
-    CGUIListItemPtr item = m_gridIndex[channel][block].item;
-    if (blockOffset > 0 && item == m_gridIndex[channel][blockOffset-1].item)
-    {
-      /* first program starts before current view */
-      int startBlock = blockOffset - 1;
-      while (startBlock >= 0 && m_gridIndex[channel][startBlock].item == item)
-        startBlock--;
-
-      block = startBlock + 1;
-      int missingSection = blockOffset - block;
-      posA2 -= missingSection * m_blockSize;
-    }
+    /* the first programme may start before the current view */
+    std::vector<GridItemsPtr>::iterator it = FindRowItem(items.begin(), items.end(), blockOffset);
+    float posA2 = posA - (blockOffset - it->startBlock) * m_blockSize;
 
-    while (posA2 < endA && !m_programmeItems.empty())   // FOR EACH ITEM ///////////////
+    for (; it != items.end() && posA2 < endA && !m_programmeItems.empty(); ++it)   // FOR EACH ITEM ///////////////
     {
-      item = m_gridIndex[channel][block].item;
+      const CGUIListItemPtr &item = it->item;
       if (!item || !item.get()->IsFileItem())
         break;
 
-      bool focused = (channel == m_channelOffset + m_channelCursor) && (item == m_gridIndex[m_channelOffset + m_channelCursor][m_blockOffset + m_blockCursor].item);
+      bool focused = (channel == m_channelOffset + m_channelCursor) && (item == focusedItem);
 
       // calculate the size to truncate if item is out of grid view
       float truncateSize = 0;
@@ -396,13 +436,12 @@ void CGUIEPGGridContainer::ProcessProgrammeGrid(unsigned int currentTime, CDirty
       }
 
       // truncate item's width
-      m_gridIndex[channel][block].width = m_gridIndex[channel][block].originWidth - truncateSize;
+      it->width = it->originWidth - truncateSize;
 
-      ProcessItem(posA2, posB, item.get(), m_lastChannel, focused, m_programmeLayout, m_focusedProgrammeLayout, currentTime, dirtyregions, m_gridIndex[channel][block].width);
+      ProcessItem(posA2, posB, item.get(), m_lastChannel, focused, m_programmeLayout, m_focusedProgrammeLayout, currentTime, dirtyregions, it->width);
 
       // increment our X position
-      posA2 += m_gridIndex[channel][block].width; // assumes focused & unfocused layouts have equal length
-      block += (int)(m_gridIndex[channel][block].originWidth / m_blockSize);
+      posA2 += it->width; // assumes focused & unfocused layouts have equal length
     }
 
     // increment our Y position
@@ -441,34 +480,28 @@ void CGUIEPGGridContainer::RenderProgrammeGrid()
   float focusedPosX = 0;
   float focusedPosY = 0;
   CGUIListItemPtr focusedItem;
+  CGUIListItemPtr cursorItem;
+  if (m_channelOffset + m_channelCursor < (int)m_gridIndex.size())
+    cursorItem = GetGridItem(m_channelOffset + m_channelCursor, m_blockOffset + m_blockCursor)->item;
+
   while (posB < endB && !m_channelItems.empty())
   {
     if (channel >= (int)m_channelItems.size())
       break;
 
-    int block = blockOffset;
-    float posA2 = posA;
+    const std::vector<GridItemsPtr> &items = m_gridIndex[channel].items;
 
-    CGUIListItemPtr item = m_gridIndex[channel][block].item;
-    if (blockOffset > 0 && item == m_gridIndex[channel][blockOffset-1].item)
-    {
-      /* first program starts before current view */
-      int startBlock = blockOffset - 1;
-      while (startBlock >= 0 && m_gridIndex[channel][startBlock].item == item)
-        startBlock--;
-
-      block = startBlock + 1;
-      int missingSection = blockOffset - block;
-      posA2 -= missingSection * m_blockSize;
-    }
+    /* the first programme may start before the current view */
+    std::vector<GridItemsPtr>::const_iterator it = FindRowItem(items.begin(), items.end(), blockOffset);
+    float posA2 = posA - (blockOffset - it->startBlock) * m_blockSize;
 
-    while (posA2 < endA && !m_programmeItems.empty())   // FOR EACH ITEM ///////////////
+    for (; it != items.end() && posA2 < endA && !m_programmeItems.empty(); ++it)   // FOR EACH ITEM ///////////////
     {
-      item = m_gridIndex[channel][block].item;
+      const CGUIListItemPtr &item = it->item;
       if (!item || !item.get()->IsFileItem())
         break;
 
-      bool focused = (channel == m_channelOffset + m_channelCursor) && (item == m_gridIndex[m_channelOffset + m_channelCursor][m_blockOffset + m_blockCursor].item);
+      bool focused = (channel == m_channelOffset + m_channelCursor) && (item == cursorItem);
 
       // reset to grid start position if first item is out of grid view
       if (posA2 < posA)
@@ -487,8 +520,7 @@ void CGUIEPGGridContainer::RenderProgrammeGrid()
       }
 
       // increment our X position
-      posA2 += m_gridIndex[channel][block].width; // assumes focused & unfocused layouts have equal length
-      block += (int)(m_gridIndex[channel][block].originWidth / m_blockSize);
+      posA2 += it->width; // assumes focused & unfocused layouts have equal length
     }
 
     // increment our Y position
@@ -737,6 +769,10 @@ bool CGUIEPGGridContainer::OnMessage(CGUIMessage& message)
       case GUI_MSG_LABEL_BIND:
         if (message.GetPointer())
         {
+          /* keep the current rows, channels whose EPG didn't change reuse them */
+          std::vector<GridRow> oldRows;
+          oldRows.swap(m_gridIndex);
+
           Reset();
           CFileItemList *items = (CFileItemList *)message.GetPointer();
 
@@ -782,12 +818,14 @@ bool CGUIEPGGridContainer::OnMessage(CGUIMessage& message)
             m_epgItemsPtr.push_back(itemsPointer);
           }
 
-          ClearGridIndex();
-          m_gridIndex.reserve(m_channelItems.size());
-          for (unsigned int i = 0; i < m_channelItems.size(); i++)
+          m_gridIndex.resize(m_channelItems.size());
+          for (unsigned int i = 0; i < m_gridIndex.size(); i++)
           {
-            std::vector<GridItemsPtr> blocks(MAXBLOCKS);
-            m_gridIndex.push_back(blocks);
+            m_gridIndex[i].channelId = -1;
+            m_gridIndex[i].epgVersion = -1;
+            m_gridIndex[i].freedStart = -1;
+            m_gridIndex[i].freedEnd = -1;
+            AddRowItem(m_gridIndex[i], CGUIListItemPtr(), 0, MAXBLOCKS);
           }
 
           FreeItemsMemory();
@@ -808,7 +846,8 @@ bool CGUIEPGGridContainer::OnMessage(CGUIMessage& message)
             m_rulerItems.push_back(rulerItem);
           }
 
-          UpdateItems();
+          UpdateItems(oldRows);
+          ClearRows(oldRows);
           return true;
         }
         break;
@@ -828,7 +867,7 @@ bool CGUIEPGGridContainer::OnMessage(CGUIMessage& message)
   return CGUIControl::OnMessage(message);
 }
 
-void CGUIEPGGridContainer::UpdateItems()
+void CGUIEPGGridContainer::UpdateItems(std::vector<GridRow> &oldRows)
 {
   /* check for invalid start and end time */
   if (m_gridStart >= m_gridEnd)
@@ -853,93 +892,78 @@ void CGUIEPGGridContainer::UpdateItems()
     return;
   }
 
-  CDateTimeSpan blockDuration;
-  blockDuration.SetDateTimeSpan(0, 0, MINSPERBLOCK, 0);
+  /* rows can only be reused when they were built for the same grid */
+  std::map<int, GridRow*> reusableRows;
+  if (m_gridIndexStart == m_gridStart && m_gridIndexBlocks == m_blocks)
+  {
+    for (std::vector<GridRow>::iterator it = oldRows.begin(); it != oldRows.end(); ++it)
+    {
+      if (it->epgVersion != -1)
+        reusableRows[it->channelId] = &*it;
+    }
+  }
 
   long tick(XbmcThreads::SystemClockMillis());
+  unsigned int iReused = 0;
 
   for (unsigned int row = 0; row < m_epgItemsPtr.size(); ++row)
   {
-    CDateTime gridCursor      = m_gridStart; //reset cursor for new channel
-    unsigned long progIdx     = m_epgItemsPtr[row].start;
-    unsigned long lastIdx     = m_epgItemsPtr[row].stop;
-    const CEpgInfoTagPtr info = ((CFileItem *)m_programmeItems[progIdx].get())->GetEPGInfoTag();
+    GridRow &gridRow          = m_gridIndex[row];
+    int start                 = (int)m_epgItemsPtr[row].start;
+    int stop                  = (int)m_epgItemsPtr[row].stop;
+    const CEpgInfoTagPtr info = ((CFileItem *)m_programmeItems[start].get())->GetEPGInfoTag();
     int iEpgId                = info ? info->EpgID() : -1;
+    CPVRChannelPtr channel    = info ? info->ChannelTag() : CPVRChannelPtr();
+    const CEpg *epg           = iEpgId >= 0 ? g_EpgContainer.GetById(iEpgId) : NULL;
 
-    /** FOR EACH BLOCK **********************************************************************/
+    gridRow.channelId  = channel ? channel->ChannelID() : -1;
+    gridRow.epgVersion = epg ? epg->GetTagsVersion() : -1;
+    gridRow.programmes.assign(m_programmeItems.begin() + start, m_programmeItems.begin() + stop + 1);
 
-    for (int block = 0; block < m_blocks; block++)
+    std::map<int, GridRow*>::iterator old = reusableRows.find(gridRow.channelId);
+    if (old != reusableRows.end() && old->second->epgVersion == gridRow.epgVersion &&
+        ((CFileItem *)old->second->channelItem.get())->GetPVRChannelInfoTag() == channel && IsSameRow(*old->second, gridRow))
     {
-      while (progIdx <= lastIdx)
+      /* nothing changed on this channel, keep the old items and their layouts */
+      GridRow &oldRow = *old->second;
+      gridRow.items.swap(oldRow.items);
+      gridRow.programmes.swap(oldRow.programmes);
+      gridRow.freedStart = oldRow.freedStart;
+      gridRow.freedEnd   = oldRow.freedEnd;
+      std::copy(gridRow.programmes.begin(), gridRow.programmes.end(), m_programmeItems.begin() + start);
+      m_channelItems[row] = oldRow.channelItem;
+      m_channelItems[row]->SetInvalid();
+      for (std::vector<GridItemsPtr>::iterator it = gridRow.items.begin(); it != gridRow.items.end(); ++it)
       {
-        CGUIListItemPtr item = m_programmeItems[progIdx];
-        const CEpgInfoTagPtr tag(((CFileItem *)item.get())->GetEPGInfoTag());
-        if (!tag)
-        {
-          progIdx++;
-          continue;
-        }
-
-        if (tag->EpgID() != iEpgId || gridCursor < tag->StartAsUTC() || m_gridEnd <= tag->StartAsUTC())
-          break;
-
-        if (gridCursor < tag->EndAsUTC())
-        {
-          m_gridIndex[row][block].item = item;
-          break;
-        }
-        
-        progIdx++;
+        if (it->item)
+          it->item->SetInvalid();
       }
-
-      gridCursor += blockDuration;
+      reusableRows.erase(old);
+      iReused++;
     }
-
-    /** FOR EACH BLOCK **********************************************************************/
-    int itemSize = 1; // size of the programme in blocks
-    int savedBlock = 0;
-
-    for (int block = 0; block < m_blocks; block++)
+    else
     {
-      CGUIListItemPtr item = m_gridIndex[row][block].item;
-
-      if (item != m_gridIndex[row][block+1].item)
-      {
-        if (!item)
-        {
-          CEpgInfoTagPtr gapTag(CEpgInfoTag::CreateDefaultTag());
-          CFileItemPtr gapItem(new CFileItem(gapTag));
-          for (int i = block ; i > block - itemSize; i--)
-          {
-            m_gridIndex[row][i].item = gapItem;
-          }
-        }
-        else
-        {
-          const CEpgInfoTagPtr tag(((CFileItem *)item.get())->GetEPGInfoTag());
-          if (tag)
-            m_gridIndex[row][savedBlock].item->SetProperty("GenreType", tag->GenreType());
-        }
-
-        m_gridIndex[row][savedBlock].originWidth = itemSize*m_blockSize;
-        m_gridIndex[row][savedBlock].originHeight = m_channelHeight;
-
-        m_gridIndex[row][savedBlock].width = m_gridIndex[row][savedBlock].originWidth;
-        m_gridIndex[row][savedBlock].height = m_gridIndex[row][savedBlock].originHeight;
+      BuildRow(gridRow, iEpgId, start, stop);
+    }
+    gridRow.channelItem = m_channelItems[row];
 
-        itemSize = 1;
-        savedBlock = block+1;
-      }
-      else
-      {
-        itemSize++;
-      }
+    /* block size may have changed with the layout */
+    for (std::vector<GridItemsPtr>::iterator it = gridRow.items.begin(); it != gridRow.items.end(); ++it)
+    {
+      it->originWidth  = it->item ? it->blocks * m_blockSize : 0;
+      it->originHeight = it->item ? m_channelHeight : 0;
+      it->width        = it->originWidth;
+      it->height       = it->originHeight;
     }
   }
 
+  m_gridIndexStart  = m_gridStart;
+  m_gridIndexBlocks = m_blocks;
+
   /******************************************* END ******************************************/
 
-  CLog::Log(LOGDEBUG, "CGUIEPGGridContainer - %s completed successfully in %u ms", __FUNCTION__, (unsigned int)(XbmcThreads::SystemClockMillis()-tick));
+  CLog::Log(LOGDEBUG, "CGUIEPGGridContainer - %s completed successfully in %u ms, %u of %u rows reused", __FUNCTION__,
+      (unsigned int)(XbmcThreads::SystemClockMillis()-tick), iReused, (unsigned int)m_epgItemsPtr.size());
 
   m_channels = (int)m_epgItemsPtr.size();
   m_item = GetItem(m_channelCursor);
@@ -950,6 +974,67 @@ void CGUIEPGGridContainer::UpdateItems()
   GoToNow();
 }
 
+void CGUIEPGGridContainer::BuildRow(GridRow &row, int iEpgId, int start, int stop)
+{
+  row.items.clear();
+  row.freedStart = -1;
+  row.freedEnd   = -1;
+
+  int nextBlock = 0;
+  for (int progIdx = start; progIdx <= stop; ++progIdx)
+  {
+    const CGUIListItemPtr &item = m_programmeItems[progIdx];
+    const CEpgInfoTagPtr tag(((CFileItem *)item.get())->GetEPGInfoTag());
+    if (!tag)
+      continue;
+
+    if (tag->EpgID() != iEpgId || m_gridEnd <= tag->StartAsUTC())
+      break;
+
+    /* a programme covers the blocks starting while it runs */
+    int startBlock = std::max(GetBlockAt(tag->StartAsUTC()), nextBlock);
+    int endBlock   = std::min(GetBlockAt(tag->EndAsUTC()), m_blocks);
+    if (startBlock >= endBlock)
+      continue;
+
+    if (startBlock > nextBlock)
+    {
+      CEpgInfoTagPtr gapTag(CEpgInfoTag::CreateDefaultTag());
+      AddRowItem(row, CGUIListItemPtr(new CFileItem(gapTag)), nextBlock, startBlock);
+    }
+
+    item->SetProperty("GenreType", tag->GenreType());
+    AddRowItem(row, item, startBlock, endBlock);
+    nextBlock = endBlock;
+  }
+
+  /* nothing after the last programme */
+  AddRowItem(row, CGUIListItemPtr(), nextBlock, MAXBLOCKS);
+}
+
+void CGUIEPGGridContainer::AddRowItem(GridRow &row, const CGUIListItemPtr &item, int startBlock, int endBlock)
+{
+  GridItemsPtr gridItem;
+  gridItem.item         = item;
+  gridItem.startBlock   = startBlock;
+  gridItem.blocks       = endBlock - startBlock;
+  gridItem.originWidth  = item ? gridItem.blocks * m_blockSize : 0;
+  gridItem.originHeight = item ? m_channelHeight : 0;
+  gridItem.width        = gridItem.originWidth;
+  gridItem.height       = gridItem.originHeight;
+  row.items.push_back(gridItem);
+}
+
+int CGUIEPGGridContainer::GetBlockAt(const CDateTime &time) const
+{
+  /* the first block starting at or after the given time */
+  int iSeconds = (time - m_gridStart).GetSecondsTotal();
+  if (iSeconds <= 0)
+    return 0;
+
+  return (iSeconds + MINSPERBLOCK * 60 - 1) / (MINSPERBLOCK * 60);
+}
+
 void CGUIEPGGridContainer::ChannelScroll(int amount)
 {
   // increase or decrease the vertical offset
@@ -1026,7 +1111,7 @@ void CGUIEPGGridContainer::OnLeft()
   if (!m_gridIndex.empty() && m_item)
   {
     if (m_channelCursor + m_channelOffset >= 0 && m_blockOffset >= 0 &&
-        m_item->item != m_gridIndex[m_channelCursor + m_channelOffset][m_blockOffset].item)
+        m_item->item != GetGridItem(m_channelCursor + m_channelOffset, m_blockOffset)->item)
     {
       // this is not first item on page
       m_item = GetPrevItem(m_channelCursor);
@@ -1051,7 +1136,7 @@ void CGUIEPGGridContainer::OnRight()
 {
   if (!m_gridIndex.empty() && m_item)
   {
-    if (m_item->item != m_gridIndex[m_channelCursor + m_channelOffset][m_blocksPerPage + m_blockOffset - 1].item)
+    if (m_item->item != GetGridItem(m_channelCursor + m_channelOffset, m_blocksPerPage + m_blockOffset - 1)->item)
     {
       // this is not last item on page
       m_item = GetNextItem(m_channelCursor);
@@ -1170,7 +1255,7 @@ bool CGUIEPGGridContainer::SelectItemFromPoint(const CPoint &point, bool justGri
   if (channelIndex >= m_channels || blockIndex >= m_blocks)
     return false;
   // bail if block isn't occupied
-  if (!m_gridIndex[channelIndex][blockIndex].item)
+  if (!GetGridItem(channelIndex, blockIndex)->item)
     return false;
 
   SetChannel(channel);
@@ -1328,7 +1413,7 @@ int CGUIEPGGridContainer::GetSelectedItem() const
       m_blockCursor + m_blockOffset >= m_blocks)
     return -1;
 
-  CGUIListItemPtr currentItem = m_gridIndex[m_channelCursor + m_channelOffset][m_blockCursor + m_blockOffset].item;
+  CGUIListItemPtr currentItem = GetGridItem(m_channelCursor + m_channelOffset, m_blockCursor + m_blockOffset)->item;
   if (!currentItem)
     return -1;
 
@@ -1415,9 +1500,9 @@ GridItemsPtr *CGUIEPGGridContainer::GetClosestItem(const int &channel)
   }
 
   if (right <= SHORTGAP && right <= left && m_blockCursor + right < m_blocksPerPage)
-    return &m_gridIndex[channel + m_channelOffset][m_blockCursor + right + m_blockOffset];
+    return GetGridItem(channel + m_channelOffset, m_blockCursor + right + m_blockOffset);
 
-  return &m_gridIndex[channel + m_channelOffset][m_blockCursor - left  + m_blockOffset];
+  return GetGridItem(channel + m_channelOffset, m_blockCursor - left  + m_blockOffset);
 }
 
 int CGUIEPGGridContainer::GetItemSize(GridItemsPtr *item)
@@ -1438,13 +1523,14 @@ int CGUIEPGGridContainer::GetBlock(const CGUIListItemPtr &item, const int &chann
 
 int CGUIEPGGridContainer::GetRealBlock(const CGUIListItemPtr &item, const int &channel)
 {
-  int channelIndex = channel + m_channelOffset;
-  int block = 0;
-
-  while (m_gridIndex[channelIndex][block].item != item && block < m_blocks)
-    block++;
+  const std::vector<GridItemsPtr> &items = m_gridIndex[channel + m_channelOffset].items;
+  for (std::vector<GridItemsPtr>::const_iterator it = items.begin(); it != items.end() && it->startBlock < m_blocks; ++it)
+  {
+    if (it->item == item)
+      return it->startBlock;
+  }
 
-  return block;
+  return m_blocks;
 }
 
 GridItemsPtr *CGUIEPGGridContainer::GetNextItem(const int &channel)
@@ -1454,12 +1540,11 @@ GridItemsPtr *CGUIEPGGridContainer::GetNextItem(const int &channel)
   if (channelIndex >= m_channels || blockIndex >= m_blocks)
     return NULL;
 
-  int i = m_blockCursor;
-
-  while (i < m_blocksPerPage && m_gridIndex[channelIndex][i + m_blockOffset].item == m_gridIndex[channelIndex][blockIndex].item)
-    i++;
+  /* the first block after the current item, or the end of the page */
+  const GridItemsPtr *current = GetGridItem(channelIndex, blockIndex);
+  int i = std::min(current->startBlock + current->blocks - m_blockOffset, m_blocksPerPage);
 
-  return &m_gridIndex[channelIndex][i + m_blockOffset];
+  return GetGridItem(channelIndex, i + m_blockOffset);
 }
 
 GridItemsPtr *CGUIEPGGridContainer::GetPrevItem(const int &channel)
@@ -1469,12 +1554,11 @@ GridItemsPtr *CGUIEPGGridContainer::GetPrevItem(const int &channel)
   if (channelIndex >= m_channels || blockIndex >= m_blocks)
     return NULL;
 
-  int i = m_blockCursor;
-
-  while (i > 0 && m_gridIndex[channelIndex][i + m_blockOffset].item == m_gridIndex[channelIndex][blockIndex].item)
-    i--;
+  /* the last block before the current item, or the start of the page */
+  const GridItemsPtr *current = GetGridItem(channelIndex, blockIndex);
+  int i = std::max(current->startBlock - m_blockOffset - 1, 0);
 
-  return &m_gridIndex[channelIndex][i + m_blockOffset];
+  return GetGridItem(channelIndex, i + m_blockOffset);
 }
 
 GridItemsPtr *CGUIEPGGridContainer::GetItem(const int &channel)
@@ -1484,7 +1568,19 @@ GridItemsPtr *CGUIEPGGridContainer::GetItem(const int &channel)
   if (channelIndex >= m_channels || blockIndex >= m_blocks)
     return NULL;
 
-  return &m_gridIndex[channelIndex][blockIndex];
+  return GetGridItem(channelIndex, blockIndex);
+}
+
+GridItemsPtr *CGUIEPGGridContainer::GetGridItem(int channel, int block)
+{
+  std::vector<GridItemsPtr> &items = m_gridIndex[channel].items;
+  return &*FindRowItem(items.begin(), items.end(), block);
+}
+
+const GridItemsPtr *CGUIEPGGridContainer::GetGridItem(int channel, int block) const
+{
+  const std::vector<GridItemsPtr> &items = m_gridIndex[channel].items;
+  return &*FindRowItem(items.begin(), items.end(), block);
 }
 
 void CGUIEPGGridContainer::SetFocus(bool focus)
@@ -1640,16 +1736,7 @@ std::string CGUIEPGGridContainer::GetDescription() const
 
 void CGUIEPGGridContainer::ClearGridIndex(void)
 {
-  for (unsigned int i = 0; i < m_gridIndex.size(); i++)
-  {
-    for (int block = 0; block < m_blocks; block++)
-    {
-      if (m_gridIndex[i][block].item)
-        m_gridIndex[i][block].item.get()->ClearProperties();
-    }
-    m_gridIndex[i].clear();
-  }
-  m_gridIndex.clear();
+  ClearRows(m_gridIndex);
 }
 
 void CGUIEPGGridContainer::Reset()
@@ -1662,6 +1749,7 @@ void CGUIEPGGridContainer::Reset()
   m_rulerItems.clear();
   m_epgItemsPtr.clear();
 
+  m_item        = NULL;
   m_lastItem    = NULL;
   m_lastChannel = NULL;
 }
@@ -1677,13 +1765,18 @@ void CGUIEPGGridContainer::GoToEnd()
   int blocksEnd = 0;   // the end block of the last epg element for the selected channel
   int blocksStart = 0; // the start block of the last epg element for the selected channel
   int blockOffset = 0; // the block offset to scroll to
-  for (int blockIndex = m_blocks; blockIndex >= 0 && (!blocksEnd || !blocksStart); blockIndex--)
+  if (m_channelCursor + m_channelOffset < (int)m_gridIndex.size())
   {
-    if (!blocksEnd && m_gridIndex[m_channelCursor + m_channelOffset][blockIndex].item != NULL)
-      blocksEnd = blockIndex;
-    if (blocksEnd && m_gridIndex[m_channelCursor + m_channelOffset][blocksEnd].item != 
-                     m_gridIndex[m_channelCursor + m_channelOffset][blockIndex].item)
-      blocksStart = blockIndex + 1;
+    const std::vector<GridItemsPtr> &items = m_gridIndex[m_channelCursor + m_channelOffset].items;
+    for (std::vector<GridItemsPtr>::const_reverse_iterator it = items.rbegin(); it != items.rend(); ++it)
+    {
+      if (it->item)
+      {
+        blocksStart = it->startBlock;
+        blocksEnd   = it->startBlock + it->blocks - 1;
+        break;
+      }
+    }
   }
   if (blocksEnd - blocksStart > m_blocksPerPage)
     blockOffset = blocksStart;
@@ -1868,40 +1961,23 @@ void CGUIEPGGridContainer::FreeChannelMemory(int keepStart, int keepEnd)
 
 void CGUIEPGGridContainer::FreeProgrammeMemory(int channel, int keepStart, int keepEnd)
 {
+  GridRow &row = m_gridIndex[channel];
+  if (keepStart == row.freedStart && keepEnd == row.freedEnd)
+    return; // nothing scrolled out of view since the last call
+
+  row.freedStart = keepStart;
+  row.freedEnd   = keepEnd;
+
   if (keepStart < keepEnd)
-  { // remove before keepStart and after keepEnd
-    if (keepStart > 0 && keepStart < m_blocks)
+  { // remove before keepStart and after keepEnd, but not the items partially visible
+    for (std::vector<GridItemsPtr>::iterator it = row.items.begin(); it != row.items.end(); ++it)
     {
-      // if item exist and block is not part of visible item
-      CGUIListItemPtr last = m_gridIndex[channel][keepStart].item;
-      for (int i = keepStart - 1 ; i > 0 ; i--)
-      {
-        if (m_gridIndex[channel][i].item && m_gridIndex[channel][i].item != last)
-        {
-          m_gridIndex[channel][i].item->FreeMemory();
-          // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
-          // but we can make use of condition needed to not call FreeMemory() on item that is partially visible
-          // to avoid calling FreeMemory() multiple times on item that ocupy few blocks in a row
-          last = m_gridIndex[channel][i].item;
-        }
-      }
-    }
+      if (!it->item)
+        continue;
 
-    if (keepEnd > 0 && keepEnd < m_blocks)
-    {
-      CGUIListItemPtr last = m_gridIndex[channel][keepEnd].item;
-      for (int i = keepEnd + 1 ; i < m_blocks ; i++)
-      {
-        // if item exist and block is not part of visible item
-        if (m_gridIndex[channel][i].item && m_gridIndex[channel][i].item != last)
-        {
-          m_gridIndex[channel][i].item->FreeMemory();
-          // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
-          // but we can make use of condition needed to not call FreeMemory() on item that is partially visible
-          // to avoid calling FreeMemory() multiple times on item that ocupy few blocks in a row
-          last = m_gridIndex[channel][i].item;
-        }
-      }
+      if ((keepStart > 0 && keepStart < m_blocks && it->startBlock + it->blocks <= keepStart) ||
+          (keepEnd > 0 && keepEnd < m_blocks && it->startBlock > keepEnd))
+        it->item->FreeMemory();
     }
   }
 }
@@ -39,6 +39,20 @@ namespace EPG
     float originHeight;
     float width;
     float height;
+    int startBlock; //! first block covered by the item
+    int blocks;     //! number of blocks covered by the item
+  };
+
+  struct GridRow
+  {
+    int channelId;                      //! id of the channel shown in this row
+    long epgVersion;                    //! tags version of the channel's EPG when the row was built, -1 if unknown
+    int freedStart;                     //! blocks kept in memory the last time memory was freed
+    int freedEnd;
+    CGUIListItemPtr channelItem;        //! the channel item of this row
+    std::vector<CGUIListItemPtr> programmes; //! the programme items of this channel, as they were bound
+    std::vector<GridItemsPtr> items;    //! programmes and gaps in block order. the first one starts at block 0,
+                                        //! the last one has no item and covers everything past the last programme
   };
 
   class CGUIEPGGridContainer : public IGUIContainer
@@ -97,7 +111,10 @@ namespace EPG
     bool OnClick(int actionID);
     bool SelectItemFromPoint(const CPoint &point, bool justGrid = true);
 
-    void UpdateItems();
+    void UpdateItems(std::vector<GridRow> &oldRows);
+    void BuildRow(GridRow &row, int iEpgId, int start, int stop);
+    void AddRowItem(GridRow &row, const CGUIListItemPtr &item, int startBlock, int endBlock);
+    int GetBlockAt(const CDateTime &time) const;
 
     void SetChannel(int channel);
     void SetBlock(int block);
@@ -108,6 +125,8 @@ namespace EPG
     void Reset();
     void ClearGridIndex(void);
 
+    GridItemsPtr *GetGridItem(int channel, int block);
+    const GridItemsPtr *GetGridItem(int channel, int block) const;
     GridItemsPtr *GetItem(const int &channel);
     GridItemsPtr *GetNextItem(const int &channel);
     GridItemsPtr *GetPrevItem(const int &channel);
@@ -207,7 +226,9 @@ namespace EPG
 
     CGUITexture m_guiProgressIndicatorTexture;
 
-    std::vector<std::vector<GridItemsPtr> > m_gridIndex;
+    std::vector<GridRow> m_gridIndex;
+    CDateTime m_gridIndexStart;   //! grid start the rows were built for
+    int m_gridIndexBlocks;        //! number of blocks the rows were built for
     GridItemsPtr *m_item;
     CGUIListItem *m_lastItem;
     CGUIListItem *m_lastChannel;
@@ -0,0 +1,290 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "epg/Epg.h"
+#include "epg/EpgSearchFilter.h"
+#include "epg/EpgSearchIndex.h"
+#include "utils/StringUtils.h"
+
+#include "../addons/include/xbmc_epg_types.h"
+
+#include "gtest/gtest.h"
+
+#include <map>
+#include <string.h>
+#include <vector>
+
+using namespace EPG;
+
+namespace
+{
+const time_t guideStart = 1420070400; // 2015-01-01 00:00 UTC
+
+void AddEvent(CEpg &epg, unsigned int iUniqueId, time_t start, int iDuration,
+              const std::string &strTitle, const std::string &strPlotOutline, int iGenreType)
+{
+  EPG_TAG tag;
+  memset(&tag, 0, sizeof(tag));
+  tag.iUniqueBroadcastId = iUniqueId;
+  tag.strTitle           = strTitle.c_str();
+  tag.startTime          = start;
+  tag.endTime            = start + iDuration;
+  tag.strPlotOutline     = strPlotOutline.c_str();
+  tag.iGenreType         = iGenreType;
+  epg.UpdateEntry(&tag);
+}
+
+/* like EpgSearchFilter::Reset(), without asking the container for the guide's time span */
+void ResetFilter(EpgSearchFilter &filter)
+{
+  filter.m_strSearchTerm            = "";
+  filter.m_bIsCaseSensitive         = false;
+  filter.m_bSearchInDescription     = false;
+  filter.m_iGenreType               = EPG_SEARCH_UNSET;
+  filter.m_iGenreSubType            = EPG_SEARCH_UNSET;
+  filter.m_iMinimumDuration         = EPG_SEARCH_UNSET;
+  filter.m_iMaximumDuration         = EPG_SEARCH_UNSET;
+  filter.m_startDateTime            = CDateTime(2000, 1, 1, 0, 0, 0);
+  filter.m_endDateTime              = CDateTime(2100, 1, 1, 0, 0, 0);
+  filter.m_bIncludeUnknownGenres    = false;
+  filter.m_bPreventRepeats          = false;
+  filter.m_bIsRadio                 = false;
+  filter.m_iChannelNumber           = EPG_SEARCH_UNSET;
+  filter.m_bFTAOnly                 = false;
+  filter.m_iChannelGroup            = EPG_SEARCH_UNSET;
+  filter.m_bIgnorePresentTimers     = true;
+  filter.m_bIgnorePresentRecordings = true;
+  filter.m_iUniqueBroadcastId       = EPG_SEARCH_UNSET;
+}
+
+/* what searching did before the index */
+std::vector<CEpgInfoTagPtr> Scan(const std::map<unsigned int, CEpg*> &epgs, const EpgSearchFilter &filter)
+{
+  std::vector<CEpgInfoTagPtr> results, tags;
+  for (std::map<unsigned int, CEpg*>::const_iterator it = epgs.begin(); it != epgs.end(); ++it)
+  {
+    it->second->GetTags(tags);
+    for (std::vector<CEpgInfoTagPtr>::const_iterator tag = tags.begin(); tag != tags.end(); ++tag)
+    {
+      if (filter.FilterEntry(**tag))
+        results.push_back(*tag);
+    }
+  }
+  return results;
+}
+
+class TestEpgSearchIndex : public testing::Test
+{
+protected:
+  TestEpgSearchIndex() : news(1, "One"), sports(2, "Two"), movies(3, "Three")
+  {
+    AddEvent(news,   101, guideStart,        1800, "The News",         "Headlines from around the world", EPG_EVENT_CONTENTMASK_NEWSCURRENTAFFAIRS);
+    AddEvent(news,   102, guideStart + 1800, 3600, "Late Night News",  "The day in review",               EPG_EVENT_CONTENTMASK_NEWSCURRENTAFFAIRS);
+    AddEvent(news,   103, guideStart + 5400, 3600, "Nature",           "Wildlife of the Serengeti",       EPG_EVENT_CONTENTMASK_EDUCATIONALSCIENCE);
+    AddEvent(sports, 201, guideStart,        7200, "Football Live",    "Cup final, live from Wembley",    EPG_EVENT_CONTENTMASK_SPORTS);
+    AddEvent(sports, 202, guideStart + 7200, 1800, "Sports News",      "Results and highlights",          EPG_EVENT_CONTENTMASK_SPORTS);
+    AddEvent(sports, 203, guideStart + 9000, 1800, "Ice Hockey",       "",                                0x05);
+    AddEvent(movies, 301, guideStart,        5400, "Doctor Who",       "The Doctor meets the news team",  EPG_EVENT_CONTENTMASK_MOVIEDRAMA);
+    AddEvent(movies, 302, guideStart + 5400, 6000, "Night at the Museum", "Family comedy",                EPG_EVENT_CONTENTMASK_MOVIEDRAMA);
+    AddEvent(movies, 303, guideStart + 11400, 5400, "Être et avoir",   "Documentaire",                    EPG_EVENT_CONTENTMASK_MOVIEDRAMA);
+
+    epgs[1] = &news;
+    epgs[2] = &sports;
+    epgs[3] = &movies;
+    index.Update(epgs);
+    ResetFilter(filter);
+  }
+
+  void ExpectSameAsScan()
+  {
+    SCOPED_TRACE(filter.m_strSearchTerm);
+    std::vector<CEpgInfoTagPtr> results;
+    ASSERT_TRUE(index.Search(filter, results));
+    EXPECT_EQ(Scan(epgs, filter), results);
+  }
+
+  CEpg news, sports, movies;
+  std::map<unsigned int, CEpg*> epgs;
+  CEpgSearchIndex index;
+  EpgSearchFilter filter;
+};
+}
+
+TEST_F(TestEpgSearchIndex, SearchTerms)
+{
+  const char *terms[] = { "news", "NEWS", "\"night news\"", "night", "doctor and news", "news and sports",
+                          "news or nature", "news not late", "wembley", "hockey", "museum", "être", "doc", "xyz" };
+  for (unsigned int i = 0; i < sizeof(terms) / sizeof(terms[0]); i++)
+  {
+    filter.m_strSearchTerm = terms[i];
+    ExpectSameAsScan();
+  }
+
+  filter.m_strSearchTerm = "news";
+  std::vector<CEpgInfoTagPtr> results;
+  ASSERT_TRUE(index.Search(filter, results));
+  ASSERT_EQ(4U, results.size());
+  EXPECT_EQ(101, results[0]->UniqueBroadcastID());
+  EXPECT_EQ(102, results[1]->UniqueBroadcastID());
+  EXPECT_EQ(202, results[2]->UniqueBroadcastID());
+  EXPECT_EQ(301, results[3]->UniqueBroadcastID());
+
+  filter.m_bIsCaseSensitive = true;
+  filter.m_strSearchTerm = "News";
+  ExpectSameAsScan();
+  filter.m_strSearchTerm = "Doctor";
+  ExpectSameAsScan();
+}
+
+TEST_F(TestEpgSearchIndex, Attributes)
+{
+  filter.m_iGenreType = EPG_EVENT_CONTENTMASK_SPORTS;
+  ExpectSameAsScan();
+
+  filter.m_bIncludeUnknownGenres = true;
+  ExpectSameAsScan();
+
+  filter.m_strSearchTerm = "hockey";
+  ExpectSameAsScan();
+
+  ResetFilter(filter);
+  filter.m_iUniqueBroadcastId = 302;
+  std::vector<CEpgInfoTagPtr> results;
+  ASSERT_TRUE(index.Search(filter, results));
+  ASSERT_EQ(1U, results.size());
+  EXPECT_EQ("Night at the Museum", results[0]->Title());
+
+  filter.m_iUniqueBroadcastId = 999;
+  ExpectSameAsScan();
+}
+
+TEST_F(TestEpgSearchIndex, NotIndexable)
+{
+  std::vector<CEpgInfoTagPtr> results;
+
+  // nothing that narrows the search down, the tables have to be scanned
+  EXPECT_FALSE(index.Search(filter, results));
+  filter.m_strSearchTerm = "ne";
+  EXPECT_FALSE(index.Search(filter, results));
+  filter.m_strSearchTerm = "not news";
+  EXPECT_FALSE(index.Search(filter, results));
+  filter.m_strSearchTerm = "news or ne";
+  EXPECT_FALSE(index.Search(filter, results));
+
+  // a short term next to a long one is left to the filter
+  filter.m_strSearchTerm = "news and ne";
+  ExpectSameAsScan();
+}
+
+TEST_F(TestEpgSearchIndex, Incremental)
+{
+  EXPECT_EQ(9U, index.Size());
+
+  filter.m_strSearchTerm = "weather";
+  std::vector<CEpgInfoTagPtr> results;
+  ASSERT_TRUE(index.Search(filter, results));
+  EXPECT_TRUE(results.empty());
+
+  // a new event and a changed one
+  AddEvent(news, 104, guideStart + 9000, 600, "Weather", "Rain later", EPG_EVENT_CONTENTMASK_NEWSCURRENTAFFAIRS);
+  AddEvent(sports, 202, guideStart + 7200, 1800, "Sports News and Weather", "Results and highlights", EPG_EVENT_CONTENTMASK_SPORTS);
+  index.Update(epgs);
+  EXPECT_EQ(10U, index.Size());
+  ExpectSameAsScan();
+  ASSERT_TRUE(index.Search(filter, results));
+  EXPECT_EQ(2U, results.size());
+
+  // removed events and tables
+  news.Cleanup(CDateTime(2015, 1, 1, 1, 0, 0));
+  epgs.erase(3);
+  index.Update(epgs);
+  EXPECT_EQ(6U, index.Size());
+  ExpectSameAsScan();
+  filter.m_strSearchTerm = "doctor";
+  ASSERT_TRUE(index.Search(filter, results));
+  EXPECT_TRUE(results.empty());
+
+  index.Clear();
+  EXPECT_EQ(0U, index.Size());
+}
+
+TEST(TestEpgSearchIndexGuide, SameAsScan)
+{
+  // two days of half hour slots on 10 channels, titles from a pool like real guides repeat them
+  const unsigned int channels = 10, slots = 2 * 48;
+  const char *words[] = { "news", "world", "night", "live", "show", "family", "great", "british", "cooking",
+                          "football", "doctor", "house", "garden", "love", "island", "crime", "story", "secret",
+                          "wild", "planet", "city", "kitchen", "quiz", "star", "dance", "history", "war" };
+  const unsigned int wordCount = sizeof(words) / sizeof(words[0]);
+
+  std::vector<CEpg*> tables;
+  std::map<unsigned int, CEpg*> epgs;
+  unsigned int seed = 1;
+  for (unsigned int c = 0; c < channels; c++)
+  {
+    CEpg *epg = new CEpg(c + 1, StringUtils::Format("Channel %u", c + 1));
+    for (unsigned int s = 0; s < slots; s++)
+    {
+      seed = seed * 1103515245 + 12345;
+      unsigned int show = (seed >> 16) % 300;
+      std::string title = StringUtils::Format("%s %s %u", words[show % wordCount], words[(show / wordCount) % wordCount], show);
+      std::string plot = StringUtils::Format("The %s of the %s, episode %u", words[(show * 7) % wordCount], words[(seed >> 8) % wordCount], s);
+      AddEvent(*epg, c * slots + s + 1, guideStart + s * 1800, 1800, title, plot, (show % 11 + 1) << 4);
+    }
+    tables.push_back(epg);
+    epgs[c + 1] = epg;
+  }
+
+  CEpgSearchIndex index;
+  index.Update(epgs);
+  EXPECT_EQ(channels * slots, index.Size());
+
+  EpgSearchFilter filter;
+  ResetFilter(filter);
+  const char *terms[] = { "cooking", "\"wild planet\"", "crime and story", "secret 123", "\"episode 17\"", "breaking" };
+  const unsigned int termCount = sizeof(terms) / sizeof(terms[0]);
+  for (unsigned int i = 0; i < termCount; i++)
+  {
+    SCOPED_TRACE(terms[i]);
+    filter.m_strSearchTerm = terms[i];
+    std::vector<CEpgInfoTagPtr> results;
+    ASSERT_TRUE(index.Search(filter, results));
+    EXPECT_EQ(Scan(epgs, filter), results);
+  }
+
+  // after an update of a single table the results still match
+  AddEvent(*tables[0], 1, guideStart, 1800, "Breaking News", "", EPG_EVENT_CONTENTMASK_NEWSCURRENTAFFAIRS);
+  index.Update(epgs);
+  for (unsigned int i = 0; i < termCount; i++)
+  {
+    SCOPED_TRACE(terms[i]);
+    filter.m_strSearchTerm = terms[i];
+    std::vector<CEpgInfoTagPtr> results;
+    ASSERT_TRUE(index.Search(filter, results));
+    EXPECT_EQ(Scan(epgs, filter), results);
+  }
+  filter.m_strSearchTerm = "breaking";
+  std::vector<CEpgInfoTagPtr> results;
+  ASSERT_TRUE(index.Search(filter, results));
+  EXPECT_EQ(1U, results.size());
+
+  for (std::vector<CEpg*>::iterator it = tables.begin(); it != tables.end(); ++it)
+    delete *it;
+}
@@ -0,0 +1,149 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ArchiveIndexCache.h"
+#include "Directory.h"
+#include "URL.h"
+#include "utils/Archive.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+
+#include <algorithm>
+
+#define INDEX_CACHE_PATH    "special://temp/archivecache/"
+#define INDEX_CACHE_VERSION 1
+#define INDEX_END_MARKER    0x58444E49 // "INDX"
+
+using namespace XFILE;
+
+CArchiveIndexCache::CArchiveIndexCache(const std::string &type, const std::string &archive, const struct __stat64 &stat)
+  : m_type(type),
+    m_archive(archive),
+    m_size(stat.st_size),
+    m_mtime(stat.st_mtime),
+    m_ar(NULL)
+{
+  Crc32 crc;
+  crc.ComputeFromLowerCase(m_type + ":" + m_archive);
+  m_cacheFile = StringUtils::Format(INDEX_CACHE_PATH "%08x.idx", (unsigned __int32)crc);
+}
+
+CArchiveIndexCache::~CArchiveIndexCache()
+{
+  Abort();
+}
+
+CArchive *CArchiveIndexCache::Load(int version)
+{
+  Abort();
+
+  // without a modification time we can't tell whether the archive changed
+  if (m_mtime == 0 || !m_file.Open(m_cacheFile))
+    return NULL;
+
+  m_ar = new CArchive(&m_file, CArchive::load);
+
+  int cacheVersion = 0, entriesVersion = 0;
+  std::string type, archive;
+  int64_t size = 0, mtime = 0;
+  *m_ar >> cacheVersion;
+  if (cacheVersion == INDEX_CACHE_VERSION)
+    *m_ar >> entriesVersion >> type >> archive >> size >> mtime;
+
+  // the file name is a crc of the path, so check it really is ours
+  if (cacheVersion != INDEX_CACHE_VERSION || entriesVersion != version ||
+      type != m_type || archive != m_archive || size != m_size || mtime != m_mtime)
+  {
+    Abort();
+    return NULL;
+  }
+
+  CLog::Log(LOGDEBUG, "%s - using cached index of %s", __FUNCTION__, CURL::GetRedacted(m_archive).c_str());
+  return m_ar;
+}
+
+CArchive *CArchiveIndexCache::Store(int version)
+{
+  Abort();
+
+  if (m_mtime == 0)
+    return NULL;
+
+  // written under another name first, so that an interrupted write can't
+  // leave a truncated index behind
+  CDirectory::Create(INDEX_CACHE_PATH);
+  if (!m_file.OpenForWrite(m_cacheFile + ".tmp", true))
+    return NULL;
+
+  m_ar = new CArchive(&m_file, CArchive::store);
+  *m_ar << (int)INDEX_CACHE_VERSION << version << m_type << m_archive << m_size << m_mtime;
+  return m_ar;
+}
+
+bool CArchiveIndexCache::CanHold(uint64_t count, unsigned int minEntrySize)
+{
+  if (!m_ar || m_ar->IsStoring())
+    return false;
+
+  int64_t length = m_file.GetLength();
+  return length > 0 && count <= (uint64_t)length / std::max(minEntrySize, 1u);
+}
+
+bool CArchiveIndexCache::Close()
+{
+  if (!m_ar)
+    return false;
+
+  bool storing = m_ar->IsStoring();
+  int marker = INDEX_END_MARKER;
+  if (storing)
+    *m_ar << marker;
+  else
+    *m_ar >> marker;
+
+  m_ar->Close();
+  delete m_ar;
+  m_ar = NULL;
+  m_file.Close();
+
+  if (storing)
+  {
+    CFile::Delete(m_cacheFile);
+    return CFile::Rename(m_cacheFile + ".tmp", m_cacheFile);
+  }
+  return marker == INDEX_END_MARKER;
+}
+
+void CArchiveIndexCache::Abort()
+{
+  if (!m_ar)
+    return;
+
+  bool storing = m_ar->IsStoring();
+  m_ar->Close();
+  delete m_ar;
+  m_ar = NULL;
+  m_file.Close();
+
+  // an index that wasn't completely written is of no use
+  if (storing)
+    CFile::Delete(m_cacheFile + ".tmp");
+}
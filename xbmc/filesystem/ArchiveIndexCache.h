@@ -0,0 +1,108 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "File.h"
+
+#include <stdint.h>
+#include <string>
+
+class CArchive;
+
+namespace XFILE
+{
+  /*!
+   \brief Persistent (on disk) cache of the listing of an archive
+
+   Listing an archive means reading its central directory or, for RAR sets,
+   the headers in every volume, which takes seconds for large archives on
+   network shares. The listing is stored in the temp folder and used as long
+   as the size and modification time of the archive are unchanged, so after
+   a restart an archive only costs a stat.
+
+   \code
+   CArchiveIndexCache index("zip", path, statData);
+   if (CArchive *ar = index.Load(MY_VERSION))
+   {
+     // read the entries
+     if (index.Close())
+       return true; // complete and up to date
+   }
+   // list the archive, then
+   if (CArchive *ar = index.Store(MY_VERSION))
+   {
+     // write the entries
+     index.Close();
+   }
+   \endcode
+   */
+  class CArchiveIndexCache
+  {
+  public:
+    /*!
+     \param type the kind of archive, e.g. "zip"
+     \param archive path of the archive (of its first volume)
+     \param stat status of the archive
+     */
+    CArchiveIndexCache(const std::string &type, const std::string &archive, const struct __stat64 &stat);
+    ~CArchiveIndexCache();
+
+    /*! \brief Open the stored index for reading
+     \param version version of the format of the entries
+     \return the archive to read the entries from, NULL if there is no index of this version of the archive
+     */
+    CArchive *Load(int version);
+
+    /*! \brief Open the index for writing, replacing a stored one
+     \param version version of the format of the entries
+     \return the archive to write the entries to, NULL on failure
+     */
+    CArchive *Store(int version);
+
+    /*! \brief Check a number of entries read from the index against its size
+     Entry counts come from disk, check them before allocating for them.
+     \param count number of entries about to be loaded
+     \param minEntrySize lower bound of the size of a stored entry, in bytes
+     \return true if the index is large enough to hold that many entries
+     */
+    bool CanHold(uint64_t count, unsigned int minEntrySize);
+
+    /*! \brief Finish loading or storing
+     An index that is not closed after storing is dropped.
+     \return true if the complete index was read or written
+     */
+    bool Close();
+
+  private:
+    CArchiveIndexCache(const CArchiveIndexCache&);
+    CArchiveIndexCache& operator=(const CArchiveIndexCache&);
+
+    /*! \brief Stop loading or storing, dropping a partly written index */
+    void Abort();
+
+    std::string m_type;
+    std::string m_archive;
+    int64_t m_size;
+    int64_t m_mtime;
+    std::string m_cacheFile;
+    CFile m_file;
+    CArchive *m_ar;
+  };
+}
@@ -327,6 +327,15 @@ long CCurlFile::CReadState::Connect(unsigned int size)
     return -1;
   }
 
+  // seeks that had to reconnect are cheap as long as the connection could be reused
+  long connects;
+  if (CURLE_OK == g_curlInterface.easy_getinfo(m_easyHandle, CURLINFO_NUM_CONNECTS, &connects))
+  {
+    g_curlInterface.AddConnection(connects == 0);
+    if (connects > 0)
+      CLog::Log(LOGDEBUG, "CurlFile::CReadState::Connect - Opened a new connection");
+  }
+
   double length;
   if (CURLE_OK == g_curlInterface.easy_getinfo(m_easyHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length))
   {
@@ -439,6 +448,10 @@ void CCurlFile::SetCommonOptions(CReadState* state)
 
   g_curlInterface.easy_setopt(h, CURLOPT_DEBUGFUNCTION, debug_callback);
 
+  // share DNS lookups and SSL sessions with all other handles
+  if (g_curlInterface.GetShareHandle())
+    g_curlInterface.easy_setopt(h, CURLOPT_SHARE, g_curlInterface.GetShareHandle());
+
   if( g_advancedSettings.m_logLevel >= LOG_LEVEL_DEBUG )
     g_curlInterface.easy_setopt(h, CURLOPT_VERBOSE, TRUE);
   else
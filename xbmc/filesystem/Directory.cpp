@@ -151,6 +151,13 @@ bool CDirectory::GetDirectory(const CURL& url, CFileItemList &items, const CHint
     // check our cache for this path
     if (g_directoryCache.GetDirectory(realURL.Get(), items, (hints.flags & DIR_FLAG_READ_CACHE) == DIR_FLAG_READ_CACHE))
       items.SetURL(url);
+    else if ((hints.flags & DIR_FLAG_READ_CACHE) && pDirectory->AllowPersistentCache(realURL) &&
+             g_directoryCache.GetPersistentDirectory(realURL, items))
+    {
+      // the directory is unchanged since we last listed it
+      items.SetURL(url);
+      g_directoryCache.SetDirectory(realURL.Get(), items, pDirectory->GetCacheType(url));
+    }
     else
     {
       // need to clear the cache (in case the directory fetch fails)
@@ -158,6 +165,11 @@ bool CDirectory::GetDirectory(const CURL& url, CFileItemList &items, const CHint
       if (!(hints.flags & DIR_FLAG_BYPASS_CACHE))
         g_directoryCache.ClearDirectory(realURL.Get());
 
+      // taken before listing, so that changes made while listing aren't stored as seen
+      int64_t mtime = 0;
+      bool persist = !(hints.flags & DIR_FLAG_BYPASS_CACHE) && pDirectory->AllowPersistentCache(realURL) &&
+                     g_directoryCache.GetPersistentDirectoryTime(realURL, mtime);
+
       pDirectory->SetFlags(hints.flags);
 
       bool result = false, cancel = false;
@@ -215,7 +227,11 @@ bool CDirectory::GetDirectory(const CURL& url, CFileItemList &items, const CHint
 
       // cache the directory, if necessary
       if (!(hints.flags & DIR_FLAG_BYPASS_CACHE))
+      {
         g_directoryCache.SetDirectory(realURL.Get(), items, pDirectory->GetCacheType(url));
+        if (persist)
+          g_directoryCache.SetPersistentDirectory(realURL, items, mtime);
+      }
     }
 
     // now filter for allowed files
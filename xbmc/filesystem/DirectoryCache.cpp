@@ -19,8 +19,14 @@
  */
 
 #include "DirectoryCache.h"
+#include "File.h"
 #include "FileItem.h"
+#include "URL.h"
+#include "settings/AdvancedSettings.h"
 #include "threads/SingleLock.h"
+#include "utils/Archive.h"
+#include "utils/auto_buffer.h"
+#include "utils/Crc32.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "utils/StringUtils.h"
@@ -28,9 +34,28 @@
 
 #include <algorithm>
 
+#define PERSISTENT_CACHE_PATH           "special://temp/dircache/"
+#define PERSISTENT_CACHE_VERSION        2
+#define PERSISTENT_CACHE_MAX_SIZE       (64 * 1024 * 1024) // larger listings are taken as corrupt
+#define PERSISTENT_CACHE_MAX_FILES      1000
+#define PERSISTENT_CACHE_CHECK_INTERVAL 100 // stores between checks of the number of cached listings
+
 using namespace std;
 using namespace XFILE;
 
+namespace
+{
+/*! Start of a persistent cache file, describing the archived listing that follows
+ it, so that a truncated or corrupt file is spotted before it is read.
+ */
+struct PersistentCacheHeader
+{
+  uint32_t version;
+  uint32_t crc;    ///< crc of the archived listing
+  uint64_t length; ///< length of the archived listing
+};
+}
+
 CDirectoryCache::CDir::CDir(DIR_CACHE_TYPE cacheType)
 {
   m_cacheType = cacheType;
@@ -52,6 +77,8 @@ void CDirectoryCache::CDir::SetLastAccess(unsigned int &accessCounter)
 CDirectoryCache::CDirectoryCache(void)
 {
   m_accessCounter = 0;
+  m_persistentPathCreated = false;
+  m_persistentStores = 0;
 #ifdef _DEBUG
   m_cacheHits = 0;
   m_cacheMisses = 0;
@@ -196,6 +223,190 @@ bool CDirectoryCache::FileExists(const std::string& strFile, bool& bInCache)
   return false;
 }
 
+bool CDirectoryCache::GetPersistentDirectory(const CURL& url, CFileItemList &items)
+{
+  if (!g_advancedSettings.m_networkPersistentDirCache)
+    return false;
+
+  CFile file;
+  if (!file.Open(GetPersistentCacheFile(url)))
+    return false;
+
+  // the file comes from disk, check that it's complete and intact before reading anything from it
+  PersistentCacheHeader header;
+  int64_t length = file.GetLength();
+  if (length < (int64_t)sizeof(header) || length - (int64_t)sizeof(header) > PERSISTENT_CACHE_MAX_SIZE ||
+      file.Read(&header, sizeof(header)) != (ssize_t)sizeof(header) ||
+      header.version != PERSISTENT_CACHE_VERSION || header.length != (uint64_t)(length - sizeof(header)))
+    return false;
+
+  XUTILS::auto_buffer buffer((size_t)header.length);
+  if (file.Read(buffer.get(), buffer.size()) != (ssize_t)buffer.size())
+    return false;
+  Crc32 crc;
+  crc.Compute(buffer.get(), buffer.size());
+  if ((uint32_t)crc != header.crc || file.Seek(sizeof(header)) != (int64_t)sizeof(header))
+    return false;
+
+  std::string path;
+  int64_t mtime = 0;
+  CArchive ar(&file, CArchive::load);
+  ar >> path;
+  ar >> mtime;
+
+  // the cache file is keyed on a crc of the path, so check it really is ours,
+  // and that the directory hasn't changed since we listed it
+  int64_t currentTime;
+  if (path != GetPersistentPath(url) || !GetDirectoryTime(url, currentTime) || currentTime != mtime)
+  {
+#ifdef _DEBUG
+    m_cacheMisses++;
+#endif
+    return false;
+  }
+
+  ar >> items;
+  ar.Close();
+
+  // credentials aren't stored, put those of the listed url back
+  if (!url.GetUserName().empty() || !url.GetPassWord().empty())
+  {
+    std::string withoutCredentials = url.GetWithoutUserDetails();
+    std::string withCredentials = url.Get();
+    URIUtils::RemoveSlashAtEnd(withoutCredentials);
+    URIUtils::RemoveSlashAtEnd(withCredentials);
+    for (int i = 0; i < items.Size(); i++)
+    {
+      const std::string &itemPath = items[i]->GetPath();
+      if (StringUtils::StartsWith(itemPath, withoutCredentials))
+        items[i]->SetPath(withCredentials + itemPath.substr(withoutCredentials.size()));
+    }
+  }
+
+  CLog::Log(LOGDEBUG, "%s - using cached listing of %s (%i items)", __FUNCTION__, url.GetRedacted().c_str(), items.Size());
+#ifdef _DEBUG
+  m_cacheHits += items.Size();
+#endif
+  return true;
+}
+
+bool CDirectoryCache::GetPersistentDirectoryTime(const CURL& url, int64_t &mtime)
+{
+  if (!g_advancedSettings.m_networkPersistentDirCache)
+    return false;
+
+  // a listing without a modification time can't be revalidated, so don't store it
+  return GetDirectoryTime(url, mtime);
+}
+
+void CDirectoryCache::SetPersistentDirectory(const CURL& url, const CFileItemList &items, int64_t mtime)
+{
+  if (!g_advancedSettings.m_networkPersistentDirCache)
+    return;
+
+  // credentials are never written to disk, GetPersistentDirectory() puts them back
+  std::string storedPath = GetPersistentPath(url);
+  CFileItemList stored;
+  stored.Copy(items);
+  stored.SetPath(storedPath);
+  for (int i = 0; i < stored.Size(); i++)
+  {
+    CURL itemURL(stored[i]->GetPath());
+    if (!itemURL.GetUserName().empty() || !itemURL.GetPassWord().empty())
+      stored[i]->SetPath(itemURL.GetWithoutUserDetails());
+  }
+
+  // one writer at a time, two listings of the same directory share a file
+  CSingleLock lock(m_persistentSection);
+
+  if (!m_persistentPathCreated)
+    m_persistentPathCreated = CDirectory::Create(PERSISTENT_CACHE_PATH);
+
+  // the header holds the length and crc of the archived listing, so archive that first
+  std::string cacheFile = GetPersistentCacheFile(url);
+  std::string listingFile = cacheFile + ".listing";
+  CFile file;
+  if (!file.OpenForWrite(listingFile, true))
+    return;
+  CArchive ar(&file, CArchive::store);
+  ar << storedPath;
+  ar << mtime;
+  ar << stored;
+  ar.Close();
+  file.Close();
+
+  XUTILS::auto_buffer buffer;
+  bool loaded = file.LoadFile(listingFile, buffer) > 0 && buffer.size() <= PERSISTENT_CACHE_MAX_SIZE;
+  CFile::Delete(listingFile);
+  if (!loaded)
+    return;
+
+  PersistentCacheHeader header;
+  Crc32 crc;
+  crc.Compute(buffer.get(), buffer.size());
+  header.version = PERSISTENT_CACHE_VERSION;
+  header.crc = crc;
+  header.length = buffer.size();
+
+  // written under another name first, so that an interrupted write can't
+  // leave a truncated listing behind
+  std::string tmpFile = cacheFile + ".tmp";
+  if (!file.OpenForWrite(tmpFile, true))
+    return;
+  bool written = file.Write(&header, sizeof(header)) == (ssize_t)sizeof(header) &&
+                 file.Write(buffer.get(), buffer.size()) == (ssize_t)buffer.size();
+  file.Close();
+
+  CFile::Delete(cacheFile);
+  if (!written || !CFile::Rename(tmpFile, cacheFile))
+  {
+    CFile::Delete(tmpFile);
+    return;
+  }
+
+  if (m_persistentStores++ % PERSISTENT_CACHE_CHECK_INTERVAL == 0)
+    CheckPersistentCacheSize();
+}
+
+void CDirectoryCache::CheckPersistentCacheSize()
+{
+  CFileItemList files;
+  if (!CDirectory::GetDirectory(PERSISTENT_CACHE_PATH, files, ".fi", DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_BYPASS_CACHE) ||
+      files.Size() <= PERSISTENT_CACHE_MAX_FILES)
+    return;
+
+  // drop the listings that were stored longest ago
+  files.Sort(SortByDate, SortOrderAscending);
+  for (int i = 0; i < files.Size() - PERSISTENT_CACHE_MAX_FILES; i++)
+    CFile::Delete(files[i]->GetPath());
+}
+
+std::string CDirectoryCache::GetPersistentPath(const CURL& url)
+{
+  std::string path = url.GetWithoutUserDetails();
+  URIUtils::RemoveSlashAtEnd(path);
+  return path;
+}
+
+std::string CDirectoryCache::GetPersistentCacheFile(const CURL& url)
+{
+  // named after a crc of the whole url, so listings made with different credentials are kept apart
+  std::string path = url.Get();
+  URIUtils::RemoveSlashAtEnd(path);
+  Crc32 crc;
+  crc.ComputeFromLowerCase(path);
+  return StringUtils::Format(PERSISTENT_CACHE_PATH "%08x.fi", (unsigned __int32)crc);
+}
+
+bool CDirectoryCache::GetDirectoryTime(const CURL& url, int64_t &mtime)
+{
+  struct __stat64 buffer;
+  if (CFile::Stat(url, &buffer) != 0 || buffer.st_mtime == 0)
+    return false;
+  mtime = buffer.st_mtime;
+  return true;
+}
+
 void CDirectoryCache::Clear()
 {
   // this routine clears everything
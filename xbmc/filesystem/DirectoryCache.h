@@ -27,6 +27,7 @@
 #include <set>
 
 class CFileItem;
+class CURL;
 
 namespace XFILE
 {
@@ -57,6 +58,39 @@ namespace XFILE
     void Clear();
     void AddFile(const std::string& strFile);
     bool FileExists(const std::string& strPath, bool& bInCache);
+
+    /*! \brief Retrieve a directory listing from the persistent (on disk) cache.
+     The cached listing is only used if the modification time of the directory is
+     unchanged since it was stored, which costs a single stat of the directory.
+     Modifying a file in place doesn't change the modification time of its
+     directory, so the size and date of such a file stay as they were listed until
+     a file is added, removed or renamed in the directory.
+     \param url the directory to retrieve.
+     \param items [out] the cached listing.
+     \return true if an up to date listing was found, false otherwise.
+     \sa SetPersistentDirectory
+     */
+    bool GetPersistentDirectory(const CURL& url, CFileItemList &items);
+
+    /*! \brief Get the modification time to store a listing under.
+     Call this before listing the directory, so that a change made while
+     listing isn't stored as already seen.
+     \param url the directory that is about to be listed.
+     \param mtime [out] the modification time of the directory.
+     \return true if a listing of the directory can be stored, false otherwise.
+     \sa SetPersistentDirectory
+     */
+    bool GetPersistentDirectoryTime(const CURL& url, int64_t &mtime);
+
+    /*! \brief Store a directory listing in the persistent (on disk) cache.
+     Credentials in the url and item paths are not stored. The least recently
+     stored listings are dropped once there are too many.
+     \param url the directory that was listed.
+     \param items the listing to store.
+     \param mtime the modification time of the directory from before it was listed.
+     \sa GetPersistentDirectory, GetPersistentDirectoryTime
+     */
+    void SetPersistentDirectory(const CURL& url, const CFileItemList &items, int64_t mtime);
 #ifdef _DEBUG
     void PrintStats() const;
 #endif
@@ -70,10 +104,19 @@ namespace XFILE
     typedef std::map<std::string, CDir*>::const_iterator ciCache;
     void Delete(iCache i);
 
+    void CheckPersistentCacheSize();
+    static std::string GetPersistentCacheFile(const CURL& url);
+    static std::string GetPersistentPath(const CURL& url);
+    static bool GetDirectoryTime(const CURL& url, int64_t &mtime);
+
     CCriticalSection m_cs;
 
     unsigned int m_accessCounter;
 
+    CCriticalSection m_persistentSection;
+    bool m_persistentPathCreated;
+    unsigned int m_persistentStores;
+
 #ifdef _DEBUG
     unsigned int m_cacheHits;
     unsigned int m_cacheMisses;
@@ -0,0 +1,202 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "DirectoryChangeJournal.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "utils/URIUtils.h"
+
+#ifdef HAVE_INOTIFY
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#define JOURNAL_EVENTS (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+#endif
+
+using namespace XFILE;
+
+CDirectoryChangeJournal& CDirectoryChangeJournal::Get()
+{
+  static CDirectoryChangeJournal sJournal;
+  return sJournal;
+}
+
+CDirectoryChangeJournal::CDirectoryChangeJournal()
+  : m_fd(-1)
+{
+#ifdef HAVE_INOTIFY
+  m_fd = inotify_init();
+  if (m_fd >= 0)
+    fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+  else
+    CLog::Log(LOGWARNING, "CDirectoryChangeJournal: inotify not available (%d)", errno);
+#endif
+}
+
+CDirectoryChangeJournal::~CDirectoryChangeJournal()
+{
+#ifdef HAVE_INOTIFY
+  if (m_fd >= 0)
+    close(m_fd); // drops all watches
+#endif
+}
+
+static bool GetLocalPath(const std::string &path, std::string &localPath)
+{
+  if (URIUtils::IsSpecial(path))
+    return GetLocalPath(CSpecialProtocol::TranslatePath(path), localPath);
+
+  // only plain paths on the local filesystem, anything with a protocol may
+  // be remote or an archive
+  if (path.empty() || path.find("://") != std::string::npos)
+    return false;
+
+  localPath = path;
+  URIUtils::RemoveSlashAtEnd(localPath);
+  if (localPath.empty())
+    localPath = path;
+  return true;
+}
+
+bool CDirectoryChangeJournal::Watch(const std::string &root, const std::vector<std::string> &dirs)
+{
+  CSingleLock lock(m_section);
+  // events still queued for the old watches must not mark the new state
+  ProcessEvents();
+  Forget(root);
+  if (m_fd < 0)
+    return false;
+
+#ifdef HAVE_INOTIFY
+  CTree &tree = m_trees[root];
+  tree.changed = false;
+  for (std::vector<std::string>::const_iterator it = dirs.begin(); it != dirs.end(); ++it)
+  {
+    std::string localPath;
+    int wd = -1;
+    if (GetLocalPath(*it, localPath))
+      wd = inotify_add_watch(m_fd, localPath.c_str(), JOURNAL_EVENTS);
+    if (wd < 0)
+    {
+      // ENOSPC means we ran out of watches (fs.inotify.max_user_watches)
+      if (errno == ENOSPC)
+        CLog::Log(LOGDEBUG, "CDirectoryChangeJournal: out of inotify watches, not watching %s", root.c_str());
+      Forget(root);
+      return false;
+    }
+    tree.watches.push_back(wd);
+    m_watches[wd].insert(root);
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+void CDirectoryChangeJournal::SetHash(const std::string &root, const std::string &hash)
+{
+  CSingleLock lock(m_section);
+  std::map<std::string, CTree>::iterator it = m_trees.find(root);
+  if (it != m_trees.end())
+    it->second.hash = hash;
+}
+
+bool CDirectoryChangeJournal::IsUnchanged(const std::string &root, const std::string &hash)
+{
+  CSingleLock lock(m_section);
+  if (hash.empty())
+    return false;
+
+  ProcessEvents();
+
+  std::map<std::string, CTree>::const_iterator it = m_trees.find(root);
+  return it != m_trees.end() && !it->second.changed && it->second.hash == hash;
+}
+
+void CDirectoryChangeJournal::Forget(const std::string &root)
+{
+  CSingleLock lock(m_section);
+  std::map<std::string, CTree>::iterator it = m_trees.find(root);
+  if (it == m_trees.end())
+    return;
+
+  for (std::vector<int>::const_iterator wd = it->second.watches.begin(); wd != it->second.watches.end(); ++wd)
+    ReleaseWatch(*wd, root);
+  m_trees.erase(it);
+}
+
+void CDirectoryChangeJournal::ReleaseWatch(int wd, const std::string &root)
+{
+  std::map<int, std::set<std::string> >::iterator it = m_watches.find(wd);
+  if (it == m_watches.end())
+    return;
+
+  it->second.erase(root);
+  if (it->second.empty())
+  {
+#ifdef HAVE_INOTIFY
+    inotify_rm_watch(m_fd, wd);
+#endif
+    m_watches.erase(it);
+  }
+}
+
+void CDirectoryChangeJournal::MarkChanged(int wd)
+{
+  std::map<int, std::set<std::string> >::const_iterator it = m_watches.find(wd);
+  if (it == m_watches.end())
+    return;
+
+  for (std::set<std::string>::const_iterator root = it->second.begin(); root != it->second.end(); ++root)
+    m_trees[*root].changed = true;
+}
+
+void CDirectoryChangeJournal::ProcessEvents()
+{
+#ifdef HAVE_INOTIFY
+  if (m_fd < 0)
+    return;
+
+  char buf[4096 + sizeof(struct inotify_event) + NAME_MAX + 1] __attribute__((aligned(__alignof__(struct inotify_event))));
+  ssize_t len;
+  while ((len = read(m_fd, buf, sizeof(buf))) > 0)
+  {
+    for (ssize_t i = 0; i + (ssize_t)sizeof(struct inotify_event) <= len;)
+    {
+      const struct inotify_event *e = (const struct inotify_event*)(buf + i);
+      if (e->mask & IN_Q_OVERFLOW)
+      {
+        // events were lost, we can't vouch for anything any more
+        CLog::Log(LOGDEBUG, "CDirectoryChangeJournal: event queue overflowed");
+        for (std::map<std::string, CTree>::iterator it = m_trees.begin(); it != m_trees.end(); ++it)
+          it->second.changed = true;
+      }
+      else
+        MarkChanged(e->wd);
+      i += sizeof(struct inotify_event) + e->len;
+    }
+  }
+#endif
+}
@@ -0,0 +1,99 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/CriticalSection.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace XFILE
+{
+  /*!
+   \brief Keeps track of changes to local folder trees between library scans
+
+   A tree is armed with the hash a scanner computed for it. As long as no
+   entry was created, deleted or renamed in any of its folders since then,
+   IsUnchanged() confirms the hash without touching the filesystem.
+
+   Uses inotify where available and only handles local paths. Everywhere
+   else nothing is ever reported as unchanged, so callers simply fall back
+   to checking the filesystem.
+   */
+  class CDirectoryChangeJournal
+  {
+  public:
+    static CDirectoryChangeJournal& Get();
+
+    /*!
+     \brief start watching the folders of a tree
+     Any hash the tree was armed with before is dropped.
+     \param root the root of the tree
+     \param dirs all folders of the tree, including the root
+     \return true if every folder is being watched
+     */
+    bool Watch(const std::string &root, const std::vector<std::string> &dirs);
+
+    /*!
+     \brief arm a watched tree with the hash computed after Watch()
+     Changes seen in between are kept, so the hash is never confirmed for a
+     tree that changed while it was being hashed.
+     */
+    void SetHash(const std::string &root, const std::string &hash);
+
+    /*!
+     \brief check whether a tree is still in the state it was armed with
+     \param root the root of the tree
+     \param hash the hash the caller has stored for the tree
+     \return true if the tree was armed with hash and nothing changed since
+     */
+    bool IsUnchanged(const std::string &root, const std::string &hash);
+
+    /*!
+     \brief stop watching a tree
+     */
+    void Forget(const std::string &root);
+
+  private:
+    CDirectoryChangeJournal();
+    ~CDirectoryChangeJournal();
+    CDirectoryChangeJournal(const CDirectoryChangeJournal&);
+    CDirectoryChangeJournal& operator=(const CDirectoryChangeJournal&);
+
+    void ProcessEvents();
+    void MarkChanged(int wd);
+    void ReleaseWatch(int wd, const std::string &root);
+
+    struct CTree
+    {
+      CTree() : changed(true) {}
+      std::vector<int> watches;
+      std::string hash;
+      bool changed;
+    };
+
+    CCriticalSection m_section;
+    int m_fd;
+    std::map<std::string, CTree> m_trees;
+    std::map<int, std::set<std::string> > m_watches; ///< trees using each watch
+  };
+}
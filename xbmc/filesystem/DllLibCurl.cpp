@@ -21,6 +21,7 @@
 #include "threads/SystemClock.h"
 #include "system.h"
 #include "DllLibCurl.h"
+#include "settings/AdvancedSettings.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
@@ -62,6 +63,19 @@ unsigned long ssl_thread_id(void)
 
 using namespace XCURL;
 
+/* locks for the data of the share handle, curl uses them from any thread */
+static CCriticalSection g_shareLocks[CURL_LOCK_DATA_LAST];
+
+static void share_lock_callback(CURL_HANDLE *handle, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+  g_shareLocks[data].lock();
+}
+
+static void share_unlock_callback(CURL_HANDLE *handle, curl_lock_data data, void *userptr)
+{
+  g_shareLocks[data].unlock();
+}
+
 /* okey this is damn ugly. our dll loader doesn't allow for postload, preunload functions */
 static long g_curlReferences = 0;
 #if(0)
@@ -92,6 +106,15 @@ bool DllLibCurlGlobal::Load()
   /* check idle will clean up the last one */
   g_curlReferences = 2;
 
+  m_share = share_init();
+  if (m_share)
+  {
+    share_setopt(m_share, CURLSHOPT_LOCKFUNC, share_lock_callback);
+    share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, share_unlock_callback);
+    share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  }
+
 #if defined(HAS_CURL_STATIC)
   // Initialize ssl locking array
   m_sslLockArray = new CCriticalSection*[CRYPTO_num_locks()];
@@ -113,6 +136,10 @@ void DllLibCurlGlobal::Unload()
     if (!IsLoaded())
       return;
 
+    if (m_share)
+      share_cleanup(m_share);
+    m_share = NULL;
+
     // close libcurl
     global_cleanup();
 
@@ -143,8 +170,8 @@ void DllLibCurlGlobal::CheckIdle()
     return;
 
   CSingleLock lock(m_critSection);
-  /* 20 seconds idle time before closing handle */
-  const unsigned int idletime = 30000;
+  /* idle time before closing handle, and with it the connections it keeps alive */
+  const unsigned int idletime = g_advancedSettings.m_curlidletimeout * 1000;
 
   VEC_CURLSESSIONS::iterator it = m_sessions.begin();
   while(it != m_sessions.end())
@@ -152,6 +179,7 @@ void DllLibCurlGlobal::CheckIdle()
     if( !it->m_busy && (XbmcThreads::SystemClockMillis() - it->m_idletimestamp) > idletime )
     {
       CLog::Log(LOGINFO, "%s - Closing session to %s://%s (easy=%p, multi=%p)\n", __FUNCTION__, it->m_protocol.c_str(), it->m_hostname.c_str(), (void*)it->m_easy, (void*)it->m_multi);
+      CLog::Log(LOGDEBUG, "%s - %u connections were new, %u reused", __FUNCTION__, m_connectionsCreated, m_connectionsReused);
 
       // It's important to clean up multi *before* cleaning up easy, because the multi cleanup
       // code accesses stuff in the easy's structure.
@@ -327,3 +355,19 @@ void DllLibCurlGlobal::easy_duplicate(CURL_HANDLE* easy, CURLM* multi, CURL_HAND
   }
   return;
 }
+
+void DllLibCurlGlobal::AddConnection(bool reused)
+{
+  CSingleLock lock(m_critSection);
+  if (reused)
+    m_connectionsReused++;
+  else
+    m_connectionsCreated++;
+}
+
+void DllLibCurlGlobal::GetConnectionStats(unsigned int &created, unsigned int &reused)
+{
+  CSingleLock lock(m_critSection);
+  created = m_connectionsCreated;
+  reused = m_connectionsReused;
+}
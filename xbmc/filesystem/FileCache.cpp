@@ -26,6 +26,7 @@
 #include "URL.h"
 
 #include "CircularCache.h"
+#include "SegmentCache.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
@@ -113,6 +114,13 @@ CFileCache::CFileCache(bool useDoubleCache)
    m_writePos = 0;
    if (g_advancedSettings.m_cacheMemBufferSize == 0)
      m_pCache = new CSimpleFileCache();
+   else if (g_advancedSettings.m_cacheSegmentedSize > 0)
+   {
+     // keeps any number of cached ranges, so it replaces the double cache as well
+     m_pCache = new CSegmentCache(std::max(g_advancedSettings.m_cacheSegmentedSize, g_advancedSettings.m_cacheMemBufferSize),
+                                  g_advancedSettings.m_cacheMemBufferSize);
+     useDoubleCache = false;
+   }
    else
    {
      size_t front = g_advancedSettings.m_cacheMemBufferSize;
@@ -133,7 +133,8 @@ bool IDirectory::ProcessRequirements()
   }
   else if (type == "error")
   {
-    CGUIDialogOK::ShowAndGetInput(m_requirements["heading"], m_requirements["line1"], m_requirements["line2"], m_requirements["line3"]);
+    const CVariant &requirements = m_requirements;
+    CGUIDialogOK::ShowAndGetInput(requirements["heading"], requirements["line1"], requirements["line2"], requirements["line3"]);
   }
   m_requirements.clear();
   return false;
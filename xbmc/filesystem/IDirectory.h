@@ -120,6 +120,16 @@ public:
   */
   virtual DIR_CACHE_TYPE GetCacheType(const CURL& url) const { return DIR_CACHE_ONCE; };
 
+  /*!
+  \brief Whether listings of this directory may be kept in the persistent directory cache.
+  Persistently cached listings are revalidated by the modification time of the directory,
+  so only filesystems that update it when entries are added or removed should allow this.
+  \param url Directory at hand.
+  \return Returns true if the listing may be persisted.
+  \sa CDirectoryCache::GetPersistentDirectory
+  */
+  virtual bool AllowPersistentCache(const CURL& url) const { return false; };
+
   void SetMask(const std::string& strMask);
   void SetFlags(int flags);
 
@@ -29,21 +29,99 @@
 #include "settings/AdvancedSettings.h"
 #include "FileItem.h"
 #include "utils/log.h"
+#include "filesystem/ArchiveIndexCache.h"
 #include "filesystem/File.h"
 #include "URL.h"
 
 #include "dialogs/GUIDialogYesNo.h"
 #include "dialogs/GUIDialogProgress.h"
 #include "guilib/GUIWindowManager.h"
+#include "utils/Archive.h"
 #include "utils/StringUtils.h"
 
 #include <set>
 
 #define EXTRACTION_WARN_SIZE 50*1024*1024
+#define RAR_INDEX_VERSION 1
+#define RAR_INDEX_MIN_ENTRY 45 // the fixed size fields of a stored entry
 
 using namespace std;
 using namespace XFILE;
 
+#ifdef HAS_FILESYSTEM_RAR
+/* the list is built the way urarlib_list() does, so it's freed by urarlib_freelist() */
+static bool LoadRarIndex(CArchiveIndexCache &index, ArchiveList_struct* &pList)
+{
+  CArchive *ar = index.Load(RAR_INDEX_VERSION);
+  if (!ar)
+    return false;
+
+  unsigned int count = 0;
+  *ar >> count;
+  if (!index.CanHold(count, RAR_INDEX_MIN_ENTRY))
+    return false;
+
+  ArchiveList_struct *pFirst = NULL, *pPrev = NULL;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    ArchiveList_struct *pCurr = (ArchiveList_struct *)calloc(1, sizeof(ArchiveList_struct));
+    if (!pCurr)
+      break;
+    if (pPrev)
+      pPrev->next = pCurr;
+    else
+      pFirst = pCurr;
+    pPrev = pCurr;
+
+    std::string name;
+    std::wstring nameW;
+    char hostOS, unpVer, method;
+    *ar >> name >> nameW >> pCurr->item.NameSize >> pCurr->item.PackSize >> pCurr->item.UnpSize;
+    *ar >> hostOS >> pCurr->item.FileCRC >> pCurr->item.FileTime >> unpVer >> method;
+    *ar >> pCurr->item.FileAttr >> pCurr->item.iOffset;
+    pCurr->item.HostOS = (unsigned char)hostOS;
+    pCurr->item.UnpVer = (unsigned char)unpVer;
+    pCurr->item.Method = (unsigned char)method;
+    pCurr->item.Name = (char *)malloc(name.size() + 1);
+    pCurr->item.NameW = (wchar_t *)malloc((nameW.size() + 1) * sizeof(wchar_t));
+    if (pCurr->item.Name)
+      strcpy(pCurr->item.Name, name.c_str());
+    if (pCurr->item.NameW)
+      wcscpy(pCurr->item.NameW, nameW.c_str());
+  }
+
+  if (!index.Close() || !pFirst)
+  {
+    urarlib_freelist(pFirst);
+    return false;
+  }
+  pList = pFirst;
+  return true;
+}
+
+static void StoreRarIndex(CArchiveIndexCache &index, ArchiveList_struct *pList)
+{
+  CArchive *ar = index.Store(RAR_INDEX_VERSION);
+  if (!ar)
+    return;
+
+  unsigned int count = 0;
+  for (ArchiveList_struct *pIterator = pList; pIterator; pIterator = pIterator->next)
+    count++;
+  *ar << count;
+
+  for (ArchiveList_struct *pIterator = pList; pIterator; pIterator = pIterator->next)
+  {
+    const RAR20_archive_entry &item = pIterator->item;
+    *ar << std::string(item.Name ? item.Name : "") << std::wstring(item.NameW ? item.NameW : L"");
+    *ar << item.NameSize << item.PackSize << item.UnpSize;
+    *ar << (char)item.HostOS << item.FileCRC << item.FileTime << (char)item.UnpVer << (char)item.Method;
+    *ar << item.FileAttr << item.iOffset;
+  }
+  index.Close();
+}
+#endif
+
 CFileInfo::CFileInfo()
 {
   m_strCachedPath.clear();
@@ -305,8 +383,23 @@ bool CRarManager::GetFilesInRar(CFileItemList& vecpItems, const std::string& str
   map<std::string,pair<ArchiveList_struct*,vector<CFileInfo> > >::iterator it = m_ExFiles.find(strRarPath);
   if (it == m_ExFiles.end())
   {
-    if( urarlib_list((char*) strRarPath.c_str(), &pFileList, NULL) )
+    // reading the headers of all volumes is slow, use the index of an
+    // earlier session if the first volume is unchanged
+    struct __stat64 statData = {};
+    CFile::Stat(strRarPath, &statData);
+    CArchiveIndexCache index("rar", strRarPath, statData);
+
+    bool complete = false;
+    if (LoadRarIndex(index, pFileList))
       m_ExFiles.insert(make_pair(strRarPath,make_pair(pFileList,vector<CFileInfo>())));
+    else if( urarlib_list((char*) strRarPath.c_str(), &pFileList, NULL, false, &complete) )
+    {
+      m_ExFiles.insert(make_pair(strRarPath,make_pair(pFileList,vector<CFileInfo>())));
+      // the index is only checked against the first volume, so a set with
+      // missing volumes must not be stored or it would stay incomplete
+      if (complete)
+        StoreRarIndex(index, pFileList);
+    }
     else
     {
       if( pFileList ) urarlib_freelist(pFileList);
@@ -32,6 +32,7 @@ public:
   virtual ~CSMBDirectory(void);
   virtual bool GetDirectory(const CURL& url, CFileItemList &items);
   virtual DIR_CACHE_TYPE GetCacheType(const CURL& url) const { return DIR_CACHE_ONCE; };
+  virtual bool AllowPersistentCache(const CURL& url) const { return true; };
   virtual bool Create(const CURL& url);
   virtual bool Exists(const CURL& url);
   virtual bool Remove(const CURL& url);
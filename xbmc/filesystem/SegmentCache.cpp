@@ -0,0 +1,366 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <string.h>
+#include "threads/SystemClock.h"
+#include "threads/SingleLock.h"
+#include "SegmentCache.h"
+
+using namespace XFILE;
+
+CSegmentCache::CSegmentCache(size_t size, size_t front)
+ : CCacheStrategy()
+ , m_cur(0)
+ , m_end(0)
+ , m_size(std::max(size, 2 * BLOCK_SIZE))
+ , m_front(std::min(front, m_size - BLOCK_SIZE))
+ , m_used(0)
+ , m_stamp(0)
+{
+}
+
+CSegmentCache::~CSegmentCache()
+{
+  Close();
+}
+
+int CSegmentCache::Open()
+{
+  CSingleLock lock(m_sync);
+  Clear();
+  m_cur = 0;
+  m_end = 0;
+  return CACHE_RC_OK;
+}
+
+void CSegmentCache::Close()
+{
+  CSingleLock lock(m_sync);
+  Clear();
+}
+
+void CSegmentCache::Clear()
+{
+  for (BlockMap::iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+    delete[] it->second.data;
+  m_blocks.clear();
+  m_used = 0;
+}
+
+bool CSegmentCache::Contains(int64_t pos) const
+{
+  if (pos < 0)
+    return false;
+
+  BlockMap::const_iterator it = m_blocks.find(pos / BLOCK_SIZE);
+  if (it == m_blocks.end())
+    return false;
+
+  size_t offset = (size_t)(pos % BLOCK_SIZE);
+  return offset >= it->second.beg && offset < it->second.end;
+}
+
+/* Returns the end of the cached segment holding pos, following
+ * the chain of blocks that are filled up to their boundary.
+ * pos has to be a cached position.
+ */
+int64_t CSegmentCache::SegmentEnd(int64_t pos) const
+{
+  int64_t index = pos / BLOCK_SIZE;
+  BlockMap::const_iterator it = m_blocks.find(index);
+  int64_t end = index * BLOCK_SIZE + it->second.end;
+
+  while (it->second.end == BLOCK_SIZE)
+  {
+    ++it;
+    if (it == m_blocks.end() || it->first != index + 1 || it->second.beg != 0)
+      break;
+    index = it->first;
+    end = index * BLOCK_SIZE + it->second.end;
+  }
+  return end;
+}
+
+/* Amount of data that can be read from the current position
+ * without waiting for the writer.
+ */
+int64_t CSegmentCache::Available() const
+{
+  if (m_cur < m_end)
+    return m_end - m_cur;
+  if (Contains(m_cur))
+    return SegmentEnd(m_cur) - m_cur;
+  return 0;
+}
+
+size_t CSegmentCache::FrontLimit() const
+{
+  int64_t front = m_end - m_cur;
+  if (front <= 0)
+    return m_front;
+  if (front >= (int64_t)m_front)
+    return 0;
+  return m_front - (size_t)front;
+}
+
+bool CSegmentCache::CanAllocate() const
+{
+  if (m_used + BLOCK_SIZE <= m_size)
+    return true;
+
+  int64_t first = std::min(m_cur, m_end) / BLOCK_SIZE;
+  int64_t last  = std::max(m_cur, m_end) / BLOCK_SIZE;
+  for (BlockMap::const_iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+  {
+    if (it->first < first || it->first > last)
+      return true;
+  }
+  return false;
+}
+
+/* Drops the least recently used block that is not between
+ * the read and the write position.
+ */
+bool CSegmentCache::EvictBlock()
+{
+  int64_t first = std::min(m_cur, m_end) / BLOCK_SIZE;
+  int64_t last  = std::max(m_cur, m_end) / BLOCK_SIZE;
+
+  BlockMap::iterator oldest = m_blocks.end();
+  for (BlockMap::iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+  {
+    if (it->first >= first && it->first <= last)
+      continue;
+    // stamps are compared relative to the current one so wrapping is harmless
+    if (oldest == m_blocks.end() || m_stamp - it->second.stamp > m_stamp - oldest->second.stamp)
+      oldest = it;
+  }
+
+  if (oldest == m_blocks.end())
+    return false;
+
+  delete[] oldest->second.data;
+  m_blocks.erase(oldest);
+  m_used -= BLOCK_SIZE;
+  return true;
+}
+
+size_t CSegmentCache::GetMaxWriteSize(const size_t& iRequestSize)
+{
+  CSingleLock lock(m_sync);
+
+  size_t limit = std::min(iRequestSize, FrontLimit());
+  if (limit == 0 || CanAllocate())
+    return limit;
+
+  // only what fits in the block currently written to
+  size_t room = 0;
+  if (m_blocks.find(m_end / BLOCK_SIZE) != m_blocks.end())
+    room = BLOCK_SIZE - (size_t)(m_end % BLOCK_SIZE);
+  return std::min(limit, room);
+}
+
+/**
+ * Writes at the end of the active segment, allocating blocks as
+ * needed. Will write less than requested if the unread data would
+ * exceed the front size, or if no block can be evicted to make room.
+ *
+ * Data that is already cached at the write position is overwritten,
+ * so two segments merge when the active one reaches the next one.
+ */
+int CSegmentCache::WriteToCache(const char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  len = std::min(len, FrontLimit());
+
+  size_t written = 0;
+  while (written < len)
+  {
+    int64_t index  = m_end / BLOCK_SIZE;
+    size_t  offset = (size_t)(m_end % BLOCK_SIZE);
+
+    BlockMap::iterator it = m_blocks.find(index);
+    if (it == m_blocks.end())
+    {
+      if (m_used + BLOCK_SIZE > m_size && !EvictBlock())
+        break;
+
+      CBlock block;
+      block.data  = new uint8_t[BLOCK_SIZE];
+      block.beg   = offset;
+      block.end   = offset;
+      block.stamp = m_stamp;
+      it = m_blocks.insert(std::make_pair(index, block)).first;
+      m_used += BLOCK_SIZE;
+    }
+
+    CBlock& block = it->second;
+    size_t size = std::min(len - written, BLOCK_SIZE - offset);
+    memcpy(block.data + offset, buf + written, size);
+
+    // a block only holds one range, drop what isn't connected to the new data
+    if (offset <= block.end && offset + size >= block.beg)
+    {
+      block.beg = std::min(block.beg, offset);
+      block.end = std::max(block.end, offset + size);
+    }
+    else
+    {
+      block.beg = offset;
+      block.end = offset + size;
+    }
+    block.stamp = ++m_stamp;
+
+    m_end   += size;
+    written += size;
+  }
+
+  if (written > 0)
+    m_written.Set();
+
+  return written;
+}
+
+/**
+ * Reads data from cache. Will only read up till the
+ * end of the current block, so multiple calls may be
+ * needed to read everything that is available.
+ */
+int CSegmentCache::ReadFromCache(char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  BlockMap::iterator it = m_blocks.find(m_cur / BLOCK_SIZE);
+  size_t offset = (size_t)(m_cur % BLOCK_SIZE);
+  if (it == m_blocks.end() || offset < it->second.beg || offset >= it->second.end)
+  {
+    if (IsEndOfInput())
+      return 0;
+    else
+      return CACHE_RC_WOULD_BLOCK;
+  }
+
+  CBlock& block = it->second;
+  if (len > block.end - offset)
+    len = block.end - offset;
+
+  if (len == 0)
+    return 0;
+
+  memcpy(buf, block.data + offset, len);
+  block.stamp = ++m_stamp;
+  m_cur += len;
+
+  m_space.Set();
+
+  return len;
+}
+
+int64_t CSegmentCache::WaitForData(unsigned int minimum, unsigned int millis)
+{
+  CSingleLock lock(m_sync);
+  int64_t avail = Available();
+
+  if (millis == 0 || IsEndOfInput())
+    return avail;
+
+  if (minimum > m_front)
+    minimum = m_front;
+
+  XbmcThreads::EndTime endtime(millis);
+  while (!IsEndOfInput() && avail < minimum && !endtime.IsTimePast())
+  {
+    lock.Leave();
+    m_written.WaitMSec(50); // may miss the deadline. shouldn't be a problem.
+    lock.Enter();
+    avail = Available();
+  }
+
+  return avail;
+}
+
+int64_t CSegmentCache::Seek(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+
+  // if seek is a bit over what we have, try to wait a few seconds for the data to be available.
+  // we try to avoid a (heavy) seek on the source
+  if (pos >= m_end && pos < m_end + 100000)
+  {
+    m_cur = m_end;
+    lock.Leave();
+    WaitForData((unsigned int)(pos - m_cur), 5000);
+    lock.Enter();
+  }
+
+  // only positions in the active segment can be read without moving
+  // the writer, anything else has to go through Reset()
+  if (pos == m_end || (pos < m_end && Contains(pos) && SegmentEnd(pos) >= m_end))
+  {
+    m_cur = pos;
+    return pos;
+  }
+
+  return CACHE_RC_ERROR;
+}
+
+bool CSegmentCache::Reset(int64_t pos, bool clearAnyway)
+{
+  CSingleLock lock(m_sync);
+  if (clearAnyway)
+    Clear();
+  else if (IsCachedPosition(pos))
+  {
+    m_end = CachedDataEndPosIfSeekTo(pos);
+    m_cur = pos;
+    return false;
+  }
+  m_end = pos;
+  m_cur = pos;
+
+  return true;
+}
+
+int64_t CSegmentCache::CachedDataEndPosIfSeekTo(int64_t iFilePosition)
+{
+  CSingleLock lock(m_sync);
+  if (Contains(iFilePosition))
+    return SegmentEnd(iFilePosition);
+  return iFilePosition;
+}
+
+int64_t CSegmentCache::CachedDataEndPos()
+{
+  CSingleLock lock(m_sync);
+  return m_end;
+}
+
+bool CSegmentCache::IsCachedPosition(int64_t iFilePosition)
+{
+  CSingleLock lock(m_sync);
+  return iFilePosition == m_end || Contains(iFilePosition);
+}
+
+CCacheStrategy *CSegmentCache::CreateNew()
+{
+  return new CSegmentCache(m_size, m_front);
+}
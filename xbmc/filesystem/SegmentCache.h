@@ -0,0 +1,97 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "CacheStrategy.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+#include <map>
+
+namespace XFILE {
+
+/**
+ * Cache strategy that keeps any number of cached ranges of the file.
+ *
+ * Data is stored in fixed size blocks keyed by their position in the file.
+ * Each block holds one contiguous range, and adjacent blocks chain into the
+ * cached segments. The reader and writer always work on the same (active)
+ * segment; a seek to a position held by another segment is reported as a
+ * cache miss so that CFileCache moves the writer there, after which the
+ * already cached data is served locally while the source continues at the
+ * end of that segment. When the memory budget is used up, the least
+ * recently used blocks outside the unread part of the active segment are
+ * dropped.
+ */
+class CSegmentCache : public CCacheStrategy
+{
+public:
+  CSegmentCache(size_t size, size_t front);
+  virtual ~CSegmentCache();
+
+  virtual int Open();
+  virtual void Close();
+
+  virtual size_t GetMaxWriteSize(const size_t& iRequestSize);
+  virtual int WriteToCache(const char *buf, size_t len);
+  virtual int ReadFromCache(char *buf, size_t len);
+  virtual int64_t WaitForData(unsigned int minimum, unsigned int iMillis);
+
+  virtual int64_t Seek(int64_t pos);
+  virtual bool Reset(int64_t pos, bool clearAnyway=true);
+
+  virtual int64_t CachedDataEndPosIfSeekTo(int64_t iFilePosition);
+  virtual int64_t CachedDataEndPos();
+  virtual bool IsCachedPosition(int64_t iFilePosition);
+
+  virtual CCacheStrategy *CreateNew();
+
+  static const size_t BLOCK_SIZE = 256 * 1024;
+
+protected:
+  struct CBlock
+  {
+    uint8_t      *data;
+    size_t        beg;   /**< offset in block of beginning of valid data */
+    size_t        end;   /**< offset in block of end of valid data */
+    unsigned int  stamp; /**< last access, for lru eviction */
+  };
+  typedef std::map<int64_t, CBlock> BlockMap;
+
+  bool    Contains(int64_t pos) const;
+  int64_t SegmentEnd(int64_t pos) const;
+  int64_t Available() const;
+  size_t  FrontLimit() const;
+  bool    CanAllocate() const;
+  bool    EvictBlock();
+  void    Clear();
+
+  BlockMap          m_blocks;
+  int64_t           m_cur;     /**< current reading index in file */
+  int64_t           m_end;     /**< index in file of the next write */
+  size_t            m_size;    /**< maximum size of all blocks */
+  size_t            m_front;   /**< maximum amount of unread data */
+  size_t            m_used;    /**< size of all allocated blocks */
+  unsigned int      m_stamp;
+  CCriticalSection  m_sync;
+  CEvent            m_written;
+};
+
+} // namespace XFILE
@@ -21,7 +21,9 @@
 #include "system.h"
 #include "ZipManager.h"
 #include "URL.h"
+#include "ArchiveIndexCache.h"
 #include "File.h"
+#include "utils/Archive.h"
 #include "utils/CharsetConverter.h"
 #include "utils/log.h"
 #include "utils/EndianSwap.h"
@@ -33,9 +35,31 @@
 #define min(a,b)            (((a) < (b)) ? (a) : (b))
 #endif
 
+#define ZIP_INDEX_VERSION 1
+#define ZIP_INDEX_MIN_ENTRY 46 // the fixed size fields of a stored entry
+
 using namespace XFILE;
 using namespace std;
 
+static void ArchiveZipEntry(CArchive &ar, SZipEntry &ze)
+{
+  if (ar.IsStoring())
+  {
+    ar << ze.header << ze.version << ze.flags << ze.method << ze.mod_time << ze.mod_date << ze.crc32;
+    ar << ze.csize << ze.usize << ze.flength << ze.elength << ze.eclength << ze.clength;
+    ar << ze.lhdrOffset << ze.offset << std::string(ze.name);
+  }
+  else
+  {
+    std::string name;
+    ar >> ze.header >> ze.version >> ze.flags >> ze.method >> ze.mod_time >> ze.mod_date >> ze.crc32;
+    ar >> ze.csize >> ze.usize >> ze.flength >> ze.elength >> ze.eclength >> ze.clength;
+    ar >> ze.lhdrOffset >> ze.offset >> name;
+    ZeroMemory(ze.name, 255);
+    strncpy(ze.name, name.c_str(), name.size()>254 ? 254 : name.size());
+  }
+}
+
 CZipManager::CZipManager()
 {
 }
@@ -74,6 +98,30 @@ bool CZipManager::GetZipList(const CURL& url, vector<SZipEntry>& items)
       mZipDate.erase(it2);
   }
 
+  // listed before, possibly in an earlier session
+  CArchiveIndexCache index("zip", strFile, m_StatData);
+  if (CArchive *ar = index.Load(ZIP_INDEX_VERSION))
+  {
+    unsigned int count = 0;
+    *ar >> count;
+    vector<SZipEntry> entries;
+    bool valid = index.CanHold(count, ZIP_INDEX_MIN_ENTRY);
+    if (valid)
+    {
+      entries.resize(count);
+      for (vector<SZipEntry>::iterator it = entries.begin(); it != entries.end(); ++it)
+        ArchiveZipEntry(*ar, *it);
+    }
+
+    if (valid && index.Close())
+    {
+      items.insert(items.end(), entries.begin(), entries.end());
+      mZipDate.insert(make_pair(strFile,m_StatData.st_mtime));
+      mZipMap.insert(make_pair(strFile,items));
+      return true;
+    }
+  }
+
   CFile mFile;
   if (!mFile.Open(strFile))
   {
@@ -220,6 +268,14 @@ bool CZipManager::GetZipList(const CURL& url, vector<SZipEntry>& items)
 
   mZipMap.insert(make_pair(strFile,items));
   mFile.Close();
+
+  if (CArchive *ar = index.Store(ZIP_INDEX_VERSION))
+  {
+    *ar << (unsigned int)items.size();
+    for (vector<SZipEntry>::iterator it = items.begin(); it != items.end(); ++it)
+      ArchiveZipEntry(*ar, *it);
+    index.Close();
+  }
   return true;
 }
 
@@ -0,0 +1,100 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/Directory.h"
+#include "filesystem/DirectoryCache.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/Thread.h"
+#include "FileItem.h"
+#include "URL.h"
+#include "utils/auto_buffer.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestDirectoryCache, Persistent)
+{
+  std::string tmppath = CSpecialProtocol::TranslatePath("special://temp/");
+  tmppath = URIUtils::AddFileToFolder(tmppath, "TestDirectoryCache");
+  ASSERT_TRUE(XFILE::CDirectory::Create(tmppath));
+  const CURL url(tmppath);
+
+  CFileItemList items;
+  items.Add(CFileItemPtr(new CFileItem(URIUtils::AddFileToFolder(tmppath, "file.mkv"), false)));
+
+  bool persistent = g_advancedSettings.m_networkPersistentDirCache;
+  g_advancedSettings.m_networkPersistentDirCache = true;
+
+  int64_t mtime = 0;
+  ASSERT_TRUE(g_directoryCache.GetPersistentDirectoryTime(url, mtime));
+  g_directoryCache.SetPersistentDirectory(url, items, mtime);
+  CFileItemList cached;
+  EXPECT_TRUE(g_directoryCache.GetPersistentDirectory(url, cached));
+  ASSERT_EQ(1, cached.Size());
+  EXPECT_STREQ(items[0]->GetPath().c_str(), cached[0]->GetPath().c_str());
+
+  // a truncated cache file is ignored
+  CFileItemList cacheFiles;
+  ASSERT_TRUE(XFILE::CDirectory::GetDirectory("special://temp/dircache/", cacheFiles, ".fi", XFILE::DIR_FLAG_NO_FILE_DIRS | XFILE::DIR_FLAG_BYPASS_CACHE));
+  ASSERT_EQ(1, cacheFiles.Size());
+  XFILE::CFile file;
+  XUTILS::auto_buffer data;
+  ASSERT_LT(0, file.LoadFile(cacheFiles[0]->GetPath(), data));
+  ASSERT_TRUE(file.OpenForWrite(cacheFiles[0]->GetPath(), true));
+  EXPECT_EQ((ssize_t)data.size() - 1, file.Write(data.get(), data.size() - 1));
+  file.Close();
+  cached.Clear();
+  EXPECT_FALSE(g_directoryCache.GetPersistentDirectory(url, cached));
+
+  // as is one that was damaged
+  data.get()[data.size() - 1] ^= 0xff;
+  ASSERT_TRUE(file.OpenForWrite(cacheFiles[0]->GetPath(), true));
+  EXPECT_EQ((ssize_t)data.size(), file.Write(data.get(), data.size()));
+  file.Close();
+  EXPECT_FALSE(g_directoryCache.GetPersistentDirectory(url, cached));
+
+  g_directoryCache.SetPersistentDirectory(url, items, mtime);
+  EXPECT_TRUE(g_directoryCache.GetPersistentDirectory(url, cached));
+
+  // adding a file changes the mtime of the directory, invalidating the listing
+  XbmcThreads::ThreadSleep(1100);
+  std::string newfile = URIUtils::AddFileToFolder(tmppath, "new.mkv");
+  ASSERT_TRUE(file.OpenForWrite(newfile, true));
+  file.Close();
+  cached.Clear();
+  EXPECT_FALSE(g_directoryCache.GetPersistentDirectory(url, cached));
+
+  // a change made while the directory is listed isn't stored as seen
+  ASSERT_TRUE(g_directoryCache.GetPersistentDirectoryTime(url, mtime));
+  XbmcThreads::ThreadSleep(1100);
+  std::string changedfile = URIUtils::AddFileToFolder(tmppath, "changed.mkv");
+  ASSERT_TRUE(file.OpenForWrite(changedfile, true));
+  file.Close();
+  g_directoryCache.SetPersistentDirectory(url, items, mtime);
+  cached.Clear();
+  EXPECT_FALSE(g_directoryCache.GetPersistentDirectory(url, cached));
+
+  g_advancedSettings.m_networkPersistentDirCache = persistent;
+  EXPECT_TRUE(XFILE::CFile::Delete(changedfile));
+  EXPECT_TRUE(XFILE::CFile::Delete(newfile));
+  EXPECT_TRUE(XFILE::CDirectory::Remove(tmppath));
+}
@@ -0,0 +1,78 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "filesystem/Directory.h"
+#include "filesystem/DirectoryChangeJournal.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+TEST(TestDirectoryChangeJournal, RemotePathsAreNotWatched)
+{
+  CDirectoryChangeJournal &journal = CDirectoryChangeJournal::Get();
+  std::vector<std::string> dirs(1, "smb://server/share/show/");
+  EXPECT_FALSE(journal.Watch(dirs[0], dirs));
+  journal.SetHash(dirs[0], "hash");
+  EXPECT_FALSE(journal.IsUnchanged(dirs[0], "hash"));
+}
+
+#ifdef HAVE_INOTIFY
+TEST(TestDirectoryChangeJournal, ReportsChanges)
+{
+  std::string root = URIUtils::AddFileToFolder(CSpecialProtocol::TranslatePath("special://temp/"), "TestDirectoryChangeJournal/");
+  std::string season = URIUtils::AddFileToFolder(root, "season 1/");
+  std::string extra = URIUtils::AddFileToFolder(season, "extras/");
+  ASSERT_TRUE(CDirectory::Create(root));
+  ASSERT_TRUE(CDirectory::Create(season));
+
+  std::vector<std::string> dirs;
+  dirs.push_back(root);
+  dirs.push_back(season);
+
+  CDirectoryChangeJournal &journal = CDirectoryChangeJournal::Get();
+  EXPECT_TRUE(journal.Watch(root, dirs));
+  EXPECT_FALSE(journal.IsUnchanged(root, "hash")); // not armed yet
+  journal.SetHash(root, "hash");
+  EXPECT_TRUE(journal.IsUnchanged(root, "hash"));
+  EXPECT_FALSE(journal.IsUnchanged(root, "other"));
+
+  // a change below the root is noticed
+  ASSERT_TRUE(CDirectory::Create(extra));
+  EXPECT_FALSE(journal.IsUnchanged(root, "hash"));
+
+  // and stays until the tree is watched again
+  EXPECT_FALSE(journal.IsUnchanged(root, "hash"));
+  dirs.push_back(extra);
+  EXPECT_TRUE(journal.Watch(root, dirs));
+  journal.SetHash(root, "hash2");
+  EXPECT_TRUE(journal.IsUnchanged(root, "hash2"));
+
+  EXPECT_TRUE(CDirectory::Remove(extra));
+  EXPECT_FALSE(journal.IsUnchanged(root, "hash2"));
+
+  journal.Forget(root);
+  EXPECT_TRUE(CDirectory::Remove(season));
+  EXPECT_TRUE(CDirectory::Remove(root));
+}
+#endif
@@ -0,0 +1,164 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/SegmentCache.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace XFILE;
+
+static const int64_t BLOCK = CSegmentCache::BLOCK_SIZE;
+
+static void WriteRange(CSegmentCache &cache, int64_t pos, int64_t size)
+{
+  std::vector<char> buf(size);
+  for (int64_t i = 0; i < size; i++)
+    buf[i] = (char)((pos + i) % 251);
+
+  int64_t written = 0;
+  while (written < size)
+  {
+    int ret = cache.WriteToCache(&buf[written], size - written);
+    ASSERT_GT(ret, 0);
+    written += ret;
+  }
+}
+
+static void CheckRange(CSegmentCache &cache, int64_t pos, int64_t size)
+{
+  std::vector<char> buf(size);
+  int64_t read = 0;
+  while (read < size)
+  {
+    int ret = cache.ReadFromCache(&buf[read], size - read);
+    ASSERT_GT(ret, 0);
+    read += ret;
+  }
+  for (int64_t i = 0; i < size; i++)
+    ASSERT_EQ((char)((pos + i) % 251), buf[i]);
+}
+
+TEST(TestSegmentCache, ReadWrite)
+{
+  CSegmentCache cache(8 * BLOCK, 4 * BLOCK);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  EXPECT_TRUE(cache.Reset(0));
+
+  WriteRange(cache, 0, 3 * BLOCK + 100);
+  EXPECT_EQ(3 * BLOCK + 100, cache.WaitForData(0, 0));
+  CheckRange(cache, 0, 3 * BLOCK + 100);
+
+  char c;
+  EXPECT_EQ(CACHE_RC_WOULD_BLOCK, cache.ReadFromCache(&c, 1));
+  cache.EndOfInput();
+  EXPECT_EQ(0, cache.ReadFromCache(&c, 1));
+  cache.Close();
+}
+
+TEST(TestSegmentCache, FrontLimit)
+{
+  CSegmentCache cache(8 * BLOCK, 2 * BLOCK);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  cache.Reset(0);
+
+  WriteRange(cache, 0, 2 * BLOCK);
+  EXPECT_EQ(0U, cache.GetMaxWriteSize(1000));
+  EXPECT_EQ(0, cache.WriteToCache("x", 1));
+
+  CheckRange(cache, 0, 1000);
+  EXPECT_EQ(1000U, cache.GetMaxWriteSize(1000));
+}
+
+TEST(TestSegmentCache, KeepsSegmentsAcrossSeeks)
+{
+  CSegmentCache cache(16 * BLOCK, 4 * BLOCK);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  cache.Reset(0);
+
+  // first segment, partly read
+  WriteRange(cache, 0, BLOCK + 1000);
+  CheckRange(cache, 0, 500);
+
+  // seek far ahead, not cached yet
+  const int64_t far = 100 * BLOCK + 123;
+  EXPECT_FALSE(cache.IsCachedPosition(far));
+  EXPECT_EQ(far, cache.CachedDataEndPosIfSeekTo(far));
+  EXPECT_EQ(CACHE_RC_ERROR, cache.Seek(far));
+  EXPECT_TRUE(cache.Reset(far, false));
+  WriteRange(cache, far, 2 * BLOCK);
+  CheckRange(cache, far, 1000);
+  EXPECT_EQ(far + 500, cache.Seek(far + 500));
+  CheckRange(cache, far + 500, 500);
+
+  // the first segment is still there
+  EXPECT_TRUE(cache.IsCachedPosition(700));
+  EXPECT_EQ(BLOCK + 1000, cache.CachedDataEndPosIfSeekTo(700));
+
+  // but reading it requires the writer to move
+  EXPECT_EQ(CACHE_RC_ERROR, cache.Seek(700));
+  EXPECT_FALSE(cache.Reset(700, false));
+  EXPECT_EQ(BLOCK + 1000, cache.CachedDataEndPos());
+  CheckRange(cache, 700, BLOCK + 300);
+
+  // continue the first segment until it joins a third one
+  cache.Reset(3 * BLOCK, false);
+  WriteRange(cache, 3 * BLOCK, BLOCK);
+  cache.Reset(BLOCK + 1000, false);
+  WriteRange(cache, BLOCK + 1000, 2 * BLOCK - 1000);
+  EXPECT_EQ(4 * BLOCK, cache.CachedDataEndPosIfSeekTo(0));
+  EXPECT_EQ(4 * BLOCK, cache.CachedDataEndPosIfSeekTo(BLOCK + 1000));
+
+  // the far segment is unaffected
+  EXPECT_EQ(far + 2 * BLOCK, cache.CachedDataEndPosIfSeekTo(far));
+
+  // a full reset drops everything
+  EXPECT_TRUE(cache.Reset(0, true));
+  EXPECT_FALSE(cache.IsCachedPosition(far));
+}
+
+TEST(TestSegmentCache, EvictsLeastRecentlyUsed)
+{
+  CSegmentCache cache(4 * BLOCK, 2 * BLOCK);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // four single block segments, each read completely
+  for (int i = 0; i < 4; i++)
+  {
+    cache.Reset(i * 10 * BLOCK, false);
+    WriteRange(cache, i * 10 * BLOCK, BLOCK);
+    CheckRange(cache, i * 10 * BLOCK, BLOCK);
+  }
+
+  // use the first segment again
+  EXPECT_FALSE(cache.Reset(0, false));
+  CheckRange(cache, 0, BLOCK);
+
+  // a new segment has to evict the oldest, which is now the second one
+  cache.Reset(50 * BLOCK, false);
+  WriteRange(cache, 50 * BLOCK, BLOCK);
+
+  EXPECT_TRUE(cache.IsCachedPosition(0));
+  EXPECT_FALSE(cache.IsCachedPosition(10 * BLOCK));
+  EXPECT_TRUE(cache.IsCachedPosition(20 * BLOCK));
+  EXPECT_TRUE(cache.IsCachedPosition(30 * BLOCK));
+  EXPECT_TRUE(cache.IsCachedPosition(50 * BLOCK));
+}
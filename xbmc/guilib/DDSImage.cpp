@@ -118,11 +118,13 @@ bool CDDSImage::ReadFile(const std::string &inputFile)
   return true;
 }
 
-bool CDDSImage::Create(const std::string &outputFile, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga, double maxMSE)
+bool CDDSImage::Create(const std::string &outputFile, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga, double maxMSE, bool fast)
 {
   if (!brga)
     return false;
-  if (!Compress(width, height, pitch, brga, maxMSE))
+  if (fast)
+    CompressFast(width, height, pitch, brga);
+  else if (!Compress(width, height, pitch, brga, maxMSE))
   { // use ARGB
     Allocate(width, height, XB_FMT_A8R8G8B8);
     for (unsigned int i = 0; i < height; i++)
@@ -160,6 +162,28 @@ unsigned int CDDSImage::GetStorageRequirements(unsigned int width, unsigned int
   }
 }
 
+void CDDSImage::CompressFast(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga)
+{
+  bool alpha = false;
+  for (unsigned int y = 0; y < height && !alpha; y++)
+  {
+    unsigned char const *pixel = brga + y * pitch + 3;
+    for (unsigned int x = 0; x < width; x++, pixel += 4)
+    {
+      if (*pixel != 0xff)
+      {
+        alpha = true;
+        break;
+      }
+    }
+  }
+
+  // range fit is far quicker than the default cluster fit, and good enough for artwork
+  int flags = (alpha ? squish::kDxt5 : squish::kDxt1) | squish::kSourceBGRA | squish::kColourRangeFit;
+  Allocate(width, height, alpha ? XB_FMT_DXT5 : XB_FMT_DXT1);
+  squish::CompressImage(brga, width, height, pitch, m_data, flags);
+}
+
 bool CDDSImage::Compress(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga, double maxMSE)
 {
   // first try DXT1, which is only 4bits/pixel
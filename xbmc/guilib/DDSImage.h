@@ -45,9 +45,10 @@ public:
    \param pitch pitch of the pixel buffer
    \param argb pixel buffer
    \param maxMSE maximum mean square error to allow, ignored if 0 (the default)
+   \param fast use the fast (range fit) compressor and pick DXT1 or DXT5 by whether the image has alpha, ignores maxMSE
    \return true on successful image creation, false otherwise
    */
-  bool Create(const std::string &file, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0);
+  bool Create(const std::string &file, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0, bool fast = false);
   
   /*! \brief Decompress a DXT1/3/5 image to the given buffer
    Assumes the buffer has been allocated to at least width*height*4
@@ -76,6 +77,14 @@ private:
    */
   bool Compress(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0);
 
+  /*! \brief Compress an ARGB buffer into a DXT1 image, or DXT5 if it has alpha, as fast as possible
+   \param width width of the pixel buffer
+   \param height height of the pixel buffer
+   \param pitch pitch of the pixel buffer
+   \param argb pixel buffer
+   */
+  void CompressFast(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb);
+
   static unsigned int GetStorageRequirements(unsigned int width, unsigned int height, unsigned int format);
   enum {
     ddsd_caps        = 0x00000001,
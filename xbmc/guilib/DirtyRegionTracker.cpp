@@ -20,6 +20,7 @@
 
 #include "DirtyRegionTracker.h"
 #include "settings/AdvancedSettings.h"
+#include "utils/FrameProfiler.h"
 #include "utils/log.h"
 #include <stdio.h>
 
@@ -73,6 +74,7 @@ const CDirtyRegionList &CDirtyRegionTracker::GetMarkedRegions() const
 
 CDirtyRegionList CDirtyRegionTracker::GetDirtyRegions()
 {
+  CFrameProfileScope profile(FRAME_STAGE_DIRTY_REGIONS);
   CDirtyRegionList output;
 
   if (m_solver)
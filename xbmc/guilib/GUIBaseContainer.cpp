@@ -28,10 +28,12 @@
 #include "utils/SortUtils.h"
 #include "utils/StringUtils.h"
 #include "FileItem.h"
+#include "GUILargeTextureManager.h"
 #include "input/Key.h"
 #include "utils/MathUtils.h"
 #include "utils/XBMCTinyXML.h"
 #include "listproviders/IListProvider.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 
 using namespace std;
@@ -121,6 +123,7 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
   end += cacheAfter * m_layout->Size(m_orientation);
 
   int current = offset - cacheBefore;
+  unsigned int requestDistance = g_largeTextureManager.SetRequestDistance(0);
   while (pos < end && m_items.size())
   {
     int itemNo = CorrectOffset(current, 0);
@@ -130,7 +133,8 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
     if (itemNo >= 0)
     {
       CGUIListItemPtr item = m_items[itemNo];
-      // render our item
+      // render our item, images of preloaded items are loaded after the visible ones
+      g_largeTextureManager.SetRequestDistance(requestDistance + GetRowDistance(current, offset));
       if (m_orientation == VERTICAL)
         ProcessItem(origin.x, pos, item, focused, currentTime, dirtyregions);
       else
@@ -140,6 +144,7 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
     pos += focused ? m_focusedLayout->Size(m_orientation) : m_layout->Size(m_orientation);
     current++;
   }
+  g_largeTextureManager.SetRequestDistance(requestDistance);
 
   // when we are scrolling up, offset will become lower (integer division, see offset calc)
   // to have same behaviour when scrolling down, we need to set page control to offset+1
@@ -1257,14 +1262,16 @@ int CGUIBaseContainer::GetCurrentPage() const
 
 void CGUIBaseContainer::GetCacheOffsets(int &cacheBefore, int &cacheAfter) const
 {
+  // while scrolling, preload at least the configured number of rows ahead
+  int prefetch = std::max(m_cacheItems, g_advancedSettings.m_guiPrefetchRows);
   if (m_scroller.IsScrollingDown())
   {
     cacheBefore = 0;
-    cacheAfter = m_cacheItems;
+    cacheAfter = prefetch;
   }
   else if (m_scroller.IsScrollingUp())
   {
-    cacheBefore = m_cacheItems;
+    cacheBefore = prefetch;
     cacheAfter = 0;
   }
   else
@@ -1274,6 +1281,15 @@ void CGUIBaseContainer::GetCacheOffsets(int &cacheBefore, int &cacheAfter) const
   }
 }
 
+unsigned int CGUIBaseContainer::GetRowDistance(int row, int offset) const
+{
+  if (row < offset)
+    return offset - row;
+  if (row > offset + m_itemsPerPage)
+    return row - offset - m_itemsPerPage;
+  return 0;
+}
+
 void CGUIBaseContainer::SetCursor(int cursor)
 {
   m_cursor = cursor;
@@ -166,6 +166,10 @@ protected:
 
   void UpdateScrollByLetter();
   void GetCacheOffsets(int &cacheBefore, int &cacheAfter) const;
+  /*! \brief distance in rows of a row from the rows in view, starting at offset
+   \sa CGUILargeTextureManager::SetRequestDistance
+   */
+  unsigned int GetRowDistance(int row, int offset) const;
   int GetCacheCount() const { return m_cacheItems; };
   bool ScrollingDown() const { return m_scroller.IsScrollingDown(); };
   bool ScrollingUp() const { return m_scroller.IsScrollingUp(); };
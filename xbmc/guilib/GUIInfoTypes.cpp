@@ -121,11 +121,12 @@ void CGUIInfoColor::Parse(const std::string &label, int context)
     m_color = g_colorManager.GetColor(label);
 }
 
-CGUIInfoLabel::CGUIInfoLabel() : m_dirty(false)
+CGUIInfoLabel::CGUIInfoLabel() : m_dirty(false), m_versionsValid(false), m_versionsContext(0), m_versionsPreferImage(false)
 {
 }
 
-CGUIInfoLabel::CGUIInfoLabel(const std::string &label, const std::string &fallback /*= ""*/, int context /*= 0*/) : m_dirty(false)
+CGUIInfoLabel::CGUIInfoLabel(const std::string &label, const std::string &fallback /*= ""*/, int context /*= 0*/)
+  : m_dirty(false), m_versionsValid(false), m_versionsContext(0), m_versionsPreferImage(false)
 {
   SetLabel(label, fallback, context);
 }
@@ -150,10 +151,22 @@ const std::string &CGUIInfoLabel::GetLabel(int contextWindow, bool preferImage,
   bool needsUpdate = m_dirty;
   if (!m_info.empty())
   {
+    // portions resolved for another context or type have to be resolved again
+    bool versionsValid = m_versionsValid && m_versionsContext == contextWindow && m_versionsPreferImage == preferImage;
+    m_versionsValid = true;
+    m_versionsContext = contextWindow;
+    m_versionsPreferImage = preferImage;
+
     for (vector<CInfoPortion>::const_iterator portion = m_info.begin(); portion != m_info.end(); ++portion)
     {
       if (portion->m_info)
       {
+        // nothing the portion depends on changed since it was resolved
+        unsigned int version = g_infoManager.GetInfoVersion(portion->m_info);
+        if (version && versionsValid && version == portion->m_version)
+          continue;
+        portion->m_version = version;
+
         std::string infoLabel;
         if (preferImage)
           infoLabel = g_infoManager.GetImage(portion->m_info, contextWindow, fallback);
@@ -172,6 +185,7 @@ const std::string &CGUIInfoLabel::GetLabel(int contextWindow, bool preferImage,
 const std::string &CGUIInfoLabel::GetItemLabel(const CGUIListItem *item, bool preferImages, std::string *fallback /*= NULL*/) const
 {
   bool needsUpdate = m_dirty;
+  m_versionsValid = false;
   if (item->IsFileItem() && !m_info.empty())
   {
     for (vector<CInfoPortion>::const_iterator portion = m_info.begin(); portion != m_info.end(); ++portion)
@@ -393,6 +407,7 @@ CGUIInfoLabel::CInfoPortion::CInfoPortion(int info, const std::string &prefix, c
   m_postfix(postfix)
 {
   m_info = info;
+  m_version = 0;
   m_escaped = escaped;
   // filter our prefix and postfix for comma's
   StringUtils::Replace(m_prefix, "$COMMA", ",");
@@ -163,6 +163,7 @@ private:
     bool NeedsUpdate(const std::string &label) const;
     std::string Get() const;
     int m_info;
+    mutable unsigned int m_version; ///< version of the info when it was last resolved, see CGUIInfoManager::GetInfoVersion()
   private:
     bool m_escaped;
     mutable std::string m_label;
@@ -171,6 +172,9 @@ private:
   };
 
   mutable bool        m_dirty;
+  mutable bool        m_versionsValid;   ///< whether the portion versions are for the context and type below
+  mutable int         m_versionsContext;
+  mutable bool        m_versionsPreferImage;
   mutable std::string m_label;
   std::string m_fallback;
   std::vector<CInfoPortion> m_info;
@@ -21,6 +21,7 @@
 #include "GUIPanelContainer.h"
 #include "GUIListItem.h"
 #include "GUIInfoManager.h"
+#include "GUILargeTextureManager.h"
 #include "input/Key.h"
 
 #include <cassert>
@@ -66,6 +67,7 @@ void CGUIPanelContainer::Process(unsigned int currentTime, CDirtyRegionList &dir
 
   int current = (offset - cacheBefore) * m_itemsPerRow;
   int col = 0;
+  unsigned int requestDistance = g_largeTextureManager.SetRequestDistance(0);
   while (pos < end && m_items.size())
   {
     if (current >= (int)m_items.size())
@@ -75,6 +77,8 @@ void CGUIPanelContainer::Process(unsigned int currentTime, CDirtyRegionList &dir
       CGUIListItemPtr item = m_items[current];
       bool focused = (current == GetOffset() * m_itemsPerRow + GetCursor()) && m_bHasFocus;
 
+      // images of preloaded rows are loaded after the visible ones
+      g_largeTextureManager.SetRequestDistance(requestDistance + GetRowDistance(current / m_itemsPerRow, offset));
       if (m_orientation == VERTICAL)
         ProcessItem(origin.x + col * m_layout->Size(HORIZONTAL), pos, item, focused, currentTime, dirtyregions);
       else
@@ -90,6 +94,7 @@ void CGUIPanelContainer::Process(unsigned int currentTime, CDirtyRegionList &dir
     }
     current++;
   }
+  g_largeTextureManager.SetRequestDistance(requestDistance);
 
   // when we are scrolling up, offset will become lower (integer division, see offset calc)
   // to have same behaviour when scrolling down, we need to set page control to offset+1
@@ -217,6 +217,15 @@ CBaseTexture *CBaseTexture::LoadFromFileInMemory(unsigned char *buffer, size_t b
   return NULL;
 }
 
+CBaseTexture *CBaseTexture::LoadFromFileBuffer(const std::string& texturePath, unsigned char* buffer, size_t bufferSize, unsigned int idealWidth, unsigned int idealHeight, bool autoRotate, const std::string& strMimeType)
+{
+  CTexture *texture = new CTexture();
+  if (texture->LoadFromFileBufferInternal(texturePath, buffer, bufferSize, idealWidth, idealHeight, autoRotate, strMimeType))
+    return texture;
+  delete texture;
+  return NULL;
+}
+
 bool CBaseTexture::LoadFromFileInternal(const std::string& texturePath, unsigned int maxWidth, unsigned int maxHeight, bool autoRotate, bool requirePixels, const std::string& strMimeType)
 {
   if (URIUtils::HasExtension(texturePath, ".dds"))
@@ -230,9 +239,6 @@ bool CBaseTexture::LoadFromFileInternal(const std::string& texturePath, unsigned
     return false;
   }
 
-  unsigned int width = maxWidth ? std::min(maxWidth, g_Windowing.GetMaxTextureSize()) : g_Windowing.GetMaxTextureSize();
-  unsigned int height = maxHeight ? std::min(maxHeight, g_Windowing.GetMaxTextureSize()) : g_Windowing.GetMaxTextureSize();
-
   // Read image into memory to use our vfs
   XFILE::CFile file;
   XFILE::auto_buffer buf;
@@ -240,6 +246,17 @@ bool CBaseTexture::LoadFromFileInternal(const std::string& texturePath, unsigned
   if (file.LoadFile(texturePath, buf) <= 0)
     return false;
 
+  return LoadFromFileBufferInternal(texturePath, (unsigned char *)buf.get(), buf.size(), maxWidth, maxHeight, autoRotate, strMimeType);
+}
+
+bool CBaseTexture::LoadFromFileBufferInternal(const std::string& texturePath, unsigned char* buffer, size_t bufferSize, unsigned int maxWidth, unsigned int maxHeight, bool autoRotate, const std::string& strMimeType)
+{
+  if (!buffer || !bufferSize)
+    return false;
+
+  unsigned int width = maxWidth ? std::min(maxWidth, g_Windowing.GetMaxTextureSize()) : g_Windowing.GetMaxTextureSize();
+  unsigned int height = maxHeight ? std::min(maxHeight, g_Windowing.GetMaxTextureSize()) : g_Windowing.GetMaxTextureSize();
+
   IImage* pImage;
 
   if(strMimeType.empty())
@@ -247,11 +264,11 @@ bool CBaseTexture::LoadFromFileInternal(const std::string& texturePath, unsigned
   else
     pImage = ImageFactory::CreateLoaderFromMimeType(strMimeType);
 
-  if (!LoadIImage(pImage, (unsigned char *)buf.get(), buf.size(), width, height, autoRotate))
+  if (!LoadIImage(pImage, buffer, bufferSize, width, height, autoRotate))
   {
     delete pImage;
     pImage = ImageFactory::CreateFallbackLoader(texturePath);
-    if (!LoadIImage(pImage, (unsigned char *)buf.get(), buf.size(), width, height))
+    if (!LoadIImage(pImage, buffer, bufferSize, width, height))
     {
       CLog::Log(LOGDEBUG, "%s - Load of %s failed.", __FUNCTION__, texturePath.c_str());
       delete pImage;
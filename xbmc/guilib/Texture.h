@@ -72,6 +72,23 @@ public:
   static CBaseTexture *LoadFromFileInMemory(unsigned char* buffer, size_t bufferSize, const std::string& mimeType,
                                             unsigned int idealWidth = 0, unsigned int idealHeight = 0);
 
+  /*! \brief Load a texture from a file that has already been read into memory
+   Same as LoadFromFile(), but leaves reading the file to the caller, so that reading and decoding
+   of images can be done separately.
+   \param texturePath the path the file was read from, used to pick the image loader.
+   \param buffer the memory buffer holding the file.
+   \param bufferSize the size of buffer.
+   \param idealWidth the ideal width of the texture (defaults to 0, no ideal width).
+   \param idealHeight the ideal height of the texture (defaults to 0, no ideal height).
+   \param autoRotate whether the textures should be autorotated based on EXIF information (defaults to false).
+   \param strMimeType mimetype of the given texture if available (defaults to empty)
+   \return a CBaseTexture pointer to the created texture - NULL if the texture failed to load.
+   \sa LoadFromFile
+   */
+  static CBaseTexture *LoadFromFileBuffer(const std::string& texturePath, unsigned char* buffer, size_t bufferSize,
+                                          unsigned int idealWidth = 0, unsigned int idealHeight = 0,
+                                          bool autoRotate = false, const std::string& strMimeType = "");
+
   bool LoadFromMemory(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, bool hasAlpha, unsigned char* pixels);
   bool LoadPaletted(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, const unsigned char *pixels, const COLOR *palette);
 
@@ -112,6 +129,7 @@ protected:
   bool LoadFromFileInMem(unsigned char* buffer, size_t size, const std::string& mimeType,
                          unsigned int maxWidth, unsigned int maxHeight);
   bool LoadFromFileInternal(const std::string& texturePath, unsigned int maxWidth, unsigned int maxHeight, bool autoRotate, bool requirePixels, const std::string& strMimeType = "");
+  bool LoadFromFileBufferInternal(const std::string& texturePath, unsigned char* buffer, size_t bufferSize, unsigned int maxWidth, unsigned int maxHeight, bool autoRotate, const std::string& strMimeType);
   bool LoadIImage(IImage* pImage, unsigned char* buffer, unsigned int bufSize, unsigned int width, unsigned int height, bool autoRotate=false);
   // helpers for computation of texture parameters for compressed textures
   unsigned int GetPitch(unsigned int width) const;
@@ -20,6 +20,7 @@
 
 #include "TextureDX.h"
 #include "windowing/WindowingFactory.h"
+#include "utils/FrameProfiler.h"
 #include "utils/log.h"
 
 #ifdef HAS_DX
@@ -79,6 +80,7 @@ void CDXTexture::LoadToGPU()
     // nothing to load - probably same image (no change)
     return;
   }
+  CFrameProfileScope profile(FRAME_STAGE_TEXTURE_UPLOAD);
 
   if (m_texture.Get() == NULL)
   {
@@ -21,6 +21,7 @@
 #include "system.h"
 #include "Texture.h"
 #include "windowing/WindowingFactory.h"
+#include "utils/FrameProfiler.h"
 #include "utils/log.h"
 #include "utils/GLUtils.h"
 #include "guilib/TextureManager.h"
@@ -61,6 +62,7 @@ void CGLTexture::LoadToGPU()
     // nothing to load - probably same image (no change)
     return;
   }
+  CFrameProfileScope profile(FRAME_STAGE_TEXTURE_UPLOAD);
   if (m_texture == 0)
   {
     // Have OpenGL generate a texture object handle for us
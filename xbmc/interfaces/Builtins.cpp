@@ -66,6 +66,7 @@
 #include "video/VideoLibraryQueue.h"
 #include "Util.h"
 #include "URL.h"
+#include "TextureCacheJob.h"
 #include "music/MusicDatabase.h"
 #include "cores/IPlayer.h"
 #include "pvr/channels/PVRChannel.h"
@@ -190,6 +191,7 @@ const BUILT_IN commands[] = {
   { "UpdateLibrary",              true,   "Update the selected library (music or video)" },
   { "CleanLibrary",               true,   "Clean the video/music library" },
   { "ExportLibrary",              true,   "Export the video/music library" },
+  { "PrecacheArt",                false,  "Cache the artwork of the video and music libraries" },
   { "PageDown",                   true,   "Send a page down event to the pagecontrol with given id" },
   { "PageUp",                     true,   "Send a page up event to the pagecontrol with given id" },
   { "Container.Refresh",          false,  "Refresh current listing" },
@@ -1574,6 +1576,10 @@ int CBuiltins::Execute(const std::string& execString)
         CLog::Log(LOGERROR, "CleanLibrary is not possible while scanning for media info");
     }
   }
+  else if (execute == "precacheart")
+  {
+    CJobManager::GetInstance().AddJob(new CTexturePrecacheJob(), NULL);
+  }
   else if (execute == "exportlibrary" && !params.empty())
   {
     int iHeading = 647;
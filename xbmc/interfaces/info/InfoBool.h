@@ -71,6 +71,12 @@ public:
    */
   virtual void Update(const CGUIListItem *item) {};
 
+  /*! \brief Whether the value of this info bool never changes, e.g. for "true"
+   \param value set to the value of the info bool if it is constant
+   \return true if the value is constant
+   */
+  virtual bool IsConstant(bool &value) const { return false; };
+
   const std::string &GetExpression() const { return m_expression; }
   bool ListItemDependent() const { return m_listItemDependent; }
 protected:
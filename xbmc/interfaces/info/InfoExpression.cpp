@@ -24,6 +24,7 @@
 #include "GUIInfoManager.h"
 #include <list>
 #include <memory>
+#include <stdlib.h>
 
 using namespace std;
 using namespace INFO;
@@ -39,44 +40,65 @@ void InfoSingle::Update(const CGUIListItem *item)
   m_value = g_infoManager.GetBool(m_condition, m_context, item);
 }
 
+bool InfoSingle::IsConstant(bool &value) const
+{
+  int condition = abs(m_condition);
+  if (condition != SYSTEM_ALWAYS_TRUE && condition != SYSTEM_ALWAYS_FALSE)
+    return false;
+
+  value = (condition == SYSTEM_ALWAYS_TRUE) ^ (m_condition < 0);
+  return true;
+}
+
 InfoExpression::InfoExpression(const std::string &expression, int context)
-: InfoBool(expression, context)
+: InfoBool(expression, context), m_start(RESULT_FALSE)
 {
   if (!Parse(expression))
   {
     CLog::Log(LOGERROR, "Error parsing boolean expression %s", expression.c_str());
-    m_expression_tree = std::make_shared<InfoLeaf>(g_infoManager.Register("false", 0), false);
+    m_leaves.clear();
+    m_program.clear();
+    m_start = RESULT_FALSE;
+    m_listItemDependent = false;
   }
 }
 
 void InfoExpression::Update(const CGUIListItem *item)
 {
-  m_value = m_expression_tree->Evaluate(item);
+  unsigned int next = m_start;
+  while (next < RESULT_FALSE)
+  {
+    const Instruction &instruction = m_program[next];
+    next = (instruction.leaf->Get(item) ^ instruction.invert) ? instruction.onTrue : instruction.onFalse;
+  }
+  m_value = (next == RESULT_TRUE);
+}
+
+bool InfoExpression::IsConstant(bool &value) const
+{
+  if (m_start < RESULT_FALSE)
+    return false;
+
+  value = (m_start == RESULT_TRUE);
+  return true;
 }
 
 /* Expressions are rewritten at parse time into a form which favours the
- * formation of groups of associative nodes. These groups are then reordered at
- * evaluation time such that nodes whose value renders the evaluation of the
- * remainder of the group unnecessary tend to be evaluated first (these are
- * true nodes for OR subexpressions, or false nodes for AND subexpressions).
- * The end effect is to minimise the number of leaf nodes that need to be
- * evaluated in order to determine the value of the expression. The runtime
- * adaptability has the advantage of not being customised for any particular skin.
+ * formation of groups of associative nodes, and the resulting tree is then
+ * compiled into a flat program. Each instruction tests a single leaf and
+ * names the instruction to continue with, or the value of the expression,
+ * for either outcome. Evaluation thus only touches the leaves it needs, in
+ * a single loop instead of recursing through the tree.
  *
  * The modifications to the expression at parse time fall into two groups:
  * 1) Moving logical NOTs so that they are only applied to leaf nodes.
- *    For example, rewriting ![A+B]|C as !A|!B|C allows reordering such that
- *    any of the three leaves can be evaluated first.
+ *    For example, rewriting ![A+B]|C as !A|!B|C puts all three leaves into
+ *    the same group.
  * 2) Combining adjacent AND or OR operations such that each path from the root
  *    to a leaf encounters a strictly alternating pattern of AND and OR
  *    operations. So [A|B]|[C|D+[[E|F]|G] becomes A|B|C|[D+[E|F|G]].
  */
 
-bool InfoExpression::InfoLeaf::Evaluate(const CGUIListItem *item)
-{
-  return m_invert ^ m_info->Get(item);
-}
-
 InfoExpression::InfoAssociativeGroup::InfoAssociativeGroup(
     node_type_t type,
     const InfoSubexpressionPtr &left,
@@ -97,27 +119,42 @@ void InfoExpression::InfoAssociativeGroup::Merge(std::shared_ptr<InfoAssociative
   m_children.splice(m_children.end(), other->m_children);
 }
 
-bool InfoExpression::InfoAssociativeGroup::Evaluate(const CGUIListItem *item)
+/* Children are compiled last to first, so each child knows which instruction
+ * follows it. In an AND group a false child makes the whole group false and a
+ * true one moves on to the next child, OR groups are the other way around.
+ * Leaves with a constant value are folded into the jumps that lead to them,
+ * as are leaves whose outcome doesn't matter.
+ */
+unsigned int InfoExpression::Compile(const InfoSubexpressionPtr &node, unsigned int onTrue, unsigned int onFalse)
 {
-  /* Handle either AND or OR by using the relation
-   * A AND B == !(!A OR !B)
-   * to convert ANDs into ORs
-   */
-  std::list<InfoSubexpressionPtr>::iterator last = m_children.end();
-  std::list<InfoSubexpressionPtr>::iterator it = m_children.begin();
-  bool use_and = (m_type == NODE_AND);
-  bool result = use_and ^ (*it)->Evaluate(item);
-  while (!result && ++it != last)
+  if (node->Type() == NODE_LEAF)
   {
-    result = use_and ^ (*it)->Evaluate(item);
-    if (result)
-    {
-      /* Move this child to the head of the list so we evaluate faster next time */
-      m_children.push_front(*it);
-      m_children.erase(it);
-    }
+    const InfoLeaf &leaf = *std::static_pointer_cast<InfoLeaf>(node);
+    bool value;
+    if (leaf.Info()->IsConstant(value))
+      return (value ^ leaf.Invert()) ? onTrue : onFalse;
+    if (onTrue == onFalse)
+      return onTrue;
+
+    /* Propagate any listItem dependency from the leaf to the expression */
+    m_listItemDependent |= leaf.Info()->ListItemDependent();
+    m_leaves.push_back(leaf.Info());
+
+    Instruction instruction;
+    instruction.leaf = leaf.Info().get();
+    instruction.invert = leaf.Invert();
+    instruction.onTrue = onTrue;
+    instruction.onFalse = onFalse;
+    m_program.push_back(instruction);
+    return m_program.size() - 1;
   }
-  return use_and ^ result;
+
+  const std::list<InfoSubexpressionPtr> &children = std::static_pointer_cast<InfoAssociativeGroup>(node)->Children();
+  bool use_and = (node->Type() == NODE_AND);
+  unsigned int next = use_and ? onTrue : onFalse;
+  for (std::list<InfoSubexpressionPtr>::const_reverse_iterator it = children.rbegin(); it != children.rend(); ++it)
+    next = use_and ? Compile(*it, next, onFalse) : Compile(*it, onTrue, next);
+  return next;
 }
 
 /* Expressions are parsed using the shunting-yard algorithm. Binary operators
@@ -249,8 +286,6 @@ bool InfoExpression::Parse(const std::string &expression)
           CLog::Log(LOGERROR, "Bad operand '%s'", operand.c_str());
           return false;
         }
-        /* Propagate any listItem dependency from the operand to the expression */
-        m_listItemDependent |= info->ListItemDependent();
         nodes.push(std::make_shared<InfoLeaf>(info, invert));
         /* Reuse operand string for next operand */
         operand.clear();
@@ -300,13 +335,11 @@ bool InfoExpression::Parse(const std::string &expression)
       CLog::Log(LOGERROR, "Bad operand '%s'", operand.c_str());
       return false;
     }
-    /* Propagate any listItem dependency from the operand to the expression */
-    m_listItemDependent |= info->ListItemDependent();
     nodes.push(std::make_shared<InfoLeaf>(info, invert));
   }
   while (!operator_stack.empty())
     OperatorPop(operator_stack, invert, nodes);
 
-  m_expression_tree = nodes.top();
+  m_start = Compile(nodes.top(), RESULT_TRUE, RESULT_FALSE);
   return true;
 }
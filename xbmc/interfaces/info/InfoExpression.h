@@ -38,11 +38,15 @@ public:
   virtual ~InfoSingle() {};
 
   virtual void Update(const CGUIListItem *item);
+  virtual bool IsConstant(bool &value) const;
 private:
   int m_condition;             ///< actual condition this represents
 };
 
 /*! \brief Class to wrap active boolean expressions
+
+ Expressions are parsed into a tree which is then compiled into a flat
+ program of leaf tests, see Compile().
  */
 class InfoExpression : public InfoBool
 {
@@ -51,6 +55,7 @@ public:
   virtual ~InfoExpression() {};
 
   virtual void Update(const CGUIListItem *item);
+  virtual bool IsConstant(bool &value) const;
 private:
   typedef enum
   {
@@ -69,12 +74,11 @@ private:
     NODE_OR,
   } node_type_t;
 
-  // An abstract base class for nodes in the expression tree
+  // An abstract base class for nodes in the expression tree, only used while parsing
   class InfoSubexpression
   {
   public:
     virtual ~InfoSubexpression(void) {}; // so we can destruct derived classes using a pointer to their base class
-    virtual bool Evaluate(const CGUIListItem *item) = 0;
     virtual node_type_t Type() const=0;
   };
 
@@ -85,8 +89,9 @@ private:
   {
   public:
     InfoLeaf(InfoPtr info, bool invert) : m_info(info), m_invert(invert) {};
-    virtual bool Evaluate(const CGUIListItem *item);
     virtual node_type_t Type() const { return NODE_LEAF; };
+    const InfoPtr &Info() const { return m_info; };
+    bool Invert() const { return m_invert; };
   private:
     InfoPtr m_info;
     bool m_invert;
@@ -99,17 +104,36 @@ private:
     InfoAssociativeGroup(node_type_t type, const InfoSubexpressionPtr &left, const InfoSubexpressionPtr &right);
     void AddChild(const InfoSubexpressionPtr &child);
     void Merge(std::shared_ptr<InfoAssociativeGroup> other);
-    virtual bool Evaluate(const CGUIListItem *item);
     virtual node_type_t Type() const { return m_type; };
+    const std::list<InfoSubexpressionPtr> &Children() const { return m_children; };
   private:
     node_type_t m_type;
     std::list<InfoSubexpressionPtr> m_children;
   };
 
+  enum
+  {
+    RESULT_FALSE = 0xfffffffe, ///< jump target ending the evaluation with false
+    RESULT_TRUE  = 0xffffffff, ///< jump target ending the evaluation with true
+  };
+
+  // A single step of a compiled expression
+  struct Instruction
+  {
+    InfoBool *leaf;       ///< the condition to test, owned by m_leaves
+    bool invert;          ///< whether the condition is negated
+    unsigned int onTrue;  ///< instruction to continue with if the (negated) condition is true, or the result
+    unsigned int onFalse; ///< instruction to continue with if it is false, or the result
+  };
+
   static operator_t GetOperator(char ch);
   static void OperatorPop(std::stack<operator_t> &operator_stack, bool &invert, std::stack<InfoSubexpressionPtr> &nodes);
   bool Parse(const std::string &expression);
-  InfoSubexpressionPtr m_expression_tree;
+  unsigned int Compile(const InfoSubexpressionPtr &node, unsigned int onTrue, unsigned int onFalse);
+
+  std::vector<InfoPtr> m_leaves;        ///< the conditions tested by the program
+  std::vector<Instruction> m_program;   ///< the compiled expression
+  unsigned int m_start;                 ///< the first instruction, or the result if the expression is constant
 };
 
 };
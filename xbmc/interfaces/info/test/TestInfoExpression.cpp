@@ -0,0 +1,191 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "interfaces/info/InfoExpression.h"
+#include "FileItem.h"
+#include "GUIInfoManager.h"
+#include "filesystem/Directory.h"
+#include "settings/Settings.h"
+#include "test/TestUtils.h"
+#include "utils/StringUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+#include "gtest/gtest.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace INFO;
+
+// settings without callbacks, used as the inputs of the expressions
+#define A "system.getbool(filelists.showparentdiritems)"
+#define B "system.getbool(filelists.showextensions)"
+#define C "system.getbool(filelists.ignorethewhensorting)"
+
+namespace
+{
+const char *settings[] = { "filelists.showparentdiritems", "filelists.showextensions", "filelists.ignorethewhensorting" };
+
+class CSettingsRestore
+{
+public:
+  CSettingsRestore()
+  {
+    for (unsigned int i = 0; i < 3; i++)
+      m_values[i] = CSettings::Get().GetBool(settings[i]);
+  }
+  ~CSettingsRestore()
+  {
+    for (unsigned int i = 0; i < 3; i++)
+      CSettings::Get().SetBool(settings[i], m_values[i]);
+    g_infoManager.ResetCache();
+  }
+private:
+  bool m_values[3];
+};
+
+/* the inputs are the bits of a truth table row, A being the lowest */
+bool Evaluate(const InfoPtr &info, unsigned int inputs)
+{
+  for (unsigned int i = 0; i < 3; i++)
+    CSettings::Get().SetBool(settings[i], (inputs & (1 << i)) != 0);
+  g_infoManager.ResetCache();
+  return info->Get();
+}
+
+void CollectConditions(const TiXmlElement *element, std::set<std::string> &conditions)
+{
+  for (; element; element = element->NextSiblingElement())
+  {
+    const char *condition = element->Attribute("condition");
+    if (condition)
+      conditions.insert(condition);
+
+    const std::string &name = element->ValueStr();
+    if ((name == "visible" || name == "enable" || name == "selected" || name == "usealttexture") && element->FirstChild())
+      conditions.insert(element->FirstChild()->ValueStr());
+
+    CollectConditions(element->FirstChildElement(), conditions);
+  }
+}
+}
+
+TEST(TestInfoExpression, TruthTables)
+{
+  const struct
+  {
+    const char   *expression;
+    unsigned int  truthTable;
+  } expressions[] = {
+    { A "+" B,                             0x88 },
+    { A "|" B "+" C,                       0xea },
+    { "![" A "+" B "]|" C,                 0xf7 },
+    { "!" A "+!" B "+!" C,                 0x01 },
+    { "[" A "|" B "]+[" B "|" C "]+![" A "+" C "]", 0x4c },
+    { "!![" A "|!" C "]",                  0xaf },
+    { "true+" A,                           0xaa },
+    { "false|!" B,                         0x33 },
+    { A "+false|" C,                       0xf0 },
+    { "[" A "|true]+[" B "|!" B "]",       0xff },
+  };
+
+  CSettingsRestore restore;
+  for (unsigned int e = 0; e < sizeof(expressions) / sizeof(expressions[0]); e++)
+  {
+    SCOPED_TRACE(expressions[e].expression);
+    InfoPtr info = g_infoManager.Register(expressions[e].expression);
+    ASSERT_TRUE(info != NULL);
+
+    // twice, so that evaluations don't depend on the ones before
+    for (unsigned int inputs = 0; inputs < 16; inputs++)
+      EXPECT_EQ((expressions[e].truthTable & (1 << (inputs & 7))) != 0, Evaluate(info, inputs & 7)) << "inputs " << (inputs & 7);
+  }
+}
+
+TEST(TestInfoExpression, ConstantFolding)
+{
+  bool value;
+
+  InfoPtr info = g_infoManager.Register("!false");
+  ASSERT_TRUE(info != NULL);
+  EXPECT_TRUE(info->IsConstant(value));
+  EXPECT_TRUE(value);
+
+  // the outcome of the setting doesn't matter
+  info = g_infoManager.Register("false+" A);
+  ASSERT_TRUE(info != NULL);
+  EXPECT_TRUE(info->IsConstant(value));
+  EXPECT_FALSE(value);
+  EXPECT_FALSE(info->Get());
+
+  info = g_infoManager.Register("[true|" A "]+![false+" B "]");
+  ASSERT_TRUE(info != NULL);
+  EXPECT_TRUE(info->IsConstant(value));
+  EXPECT_TRUE(value);
+
+  info = g_infoManager.Register(A "|!true");
+  ASSERT_TRUE(info != NULL);
+  EXPECT_FALSE(info->IsConstant(value));
+}
+
+TEST(TestInfoExpression, SkinConditions)
+{
+  // every condition of the default skin compiles and evaluates
+  CFileItemList items;
+  ASSERT_TRUE(XFILE::CDirectory::GetDirectory(XBMC_REF_FILE_PATH("addons/skin.confluence/720p/"), items, ".xml"));
+
+  std::set<std::string> conditions;
+  for (int i = 0; i < items.Size(); i++)
+  {
+    CXBMCTinyXML doc;
+    if (doc.LoadFile(items[i]->GetPath()))
+      CollectConditions(doc.RootElement(), conditions);
+  }
+
+  std::vector<InfoPtr> infos;
+  for (std::set<std::string>::const_iterator it = conditions.begin(); it != conditions.end(); ++it)
+  {
+    // skin includes and variables aren't loaded here
+    if (it->find('$') != std::string::npos)
+      continue;
+    InfoPtr info = g_infoManager.Register(*it);
+    EXPECT_TRUE(info != NULL) << *it;
+    if (info)
+      infos.push_back(info);
+  }
+  ASSERT_FALSE(infos.empty());
+
+  // nothing changes between the frames, neither may the results (apart from the clock)
+  std::vector<bool> values;
+  g_infoManager.ResetCache();
+  for (std::vector<InfoPtr>::const_iterator it = infos.begin(); it != infos.end(); ++it)
+    values.push_back((*it)->Get());
+  g_infoManager.ResetCache();
+  for (size_t i = 0; i < infos.size(); i++)
+  {
+    std::string expression = infos[i]->GetExpression();
+    StringUtils::ToLower(expression);
+    if (expression.find("system.time") == std::string::npos && expression.find("system.date") == std::string::npos)
+    {
+      EXPECT_EQ(values[i], infos[i]->Get()) << expression;
+    }
+  }
+}
@@ -49,7 +49,7 @@ using namespace MUSIC_INFO;
 using namespace JSONRPC;
 using namespace XFILE;
 
-bool CFileItemHandler::GetField(const std::string &field, const CVariant &info, const CFileItemPtr &item, CVariant &result, bool &fetchedArt, CThumbLoader *thumbLoader /* = NULL */)
+bool CFileItemHandler::GetField(const std::string &field, CVariant &info, const CFileItemPtr &item, CVariant &result, bool &fetchedArt, CThumbLoader *thumbLoader /* = NULL */)
 {
   if (result.isMember(field) && !result[field].empty())
     return true;
@@ -65,10 +65,10 @@ bool CFileItemHandler::GetField(const std::string &field, const CVariant &info,
     }
   }
 
-  // check for serialized values
+  // check for serialized values, the serialization is thrown away afterwards
   if (info.isMember(field) && !info[field].isNull())
   {
-    result[field] = info[field];
+    result[field].swap(info[field]);
     return true;
   }
 
@@ -193,7 +193,11 @@ void CFileItemHandler::FillDetails(const ISerializable *info, const CFileItemPtr
 
   CVariant serialization;
   info->Serialize(serialization);
+  FillDetails(serialization, item, fields, result, thumbLoader);
+}
 
+void CFileItemHandler::FillDetails(CVariant &serialization, const CFileItemPtr &item, std::set<std::string> &fields, CVariant &result, CThumbLoader *thumbLoader)
+{
   bool fetchedArt = false;
 
   std::set<std::string> originalFields = fields;
@@ -369,7 +373,13 @@ void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char
     if (item->HasPictureInfoTag())
       FillDetails(item->GetPictureInfoTag(), item, fields, object, thumbLoader);
     
-    FillDetails(item.get(), item, fields, object, thumbLoader);
+    // the info tags have been handled above, don't serialize them once more
+    if (!fields.empty())
+    {
+      CVariant serialization;
+      item->SerializeFields(serialization);
+      FillDetails(serialization, item, fields, object, thumbLoader);
+    }
 
     if (deleteThumbloader)
       delete thumbLoader;
@@ -381,10 +391,15 @@ void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char
 
   if (resultname)
   {
+    // items can be large, move them into the result instead of copying
     if (append)
-      result[resultname].append(object);
+    {
+      CVariant &list = result[resultname];
+      list.append(CVariant());
+      list[list.size() - 1].swap(object);
+    }
     else
-      result[resultname] = object;
+      result[resultname].swap(object);
   }
 }
 
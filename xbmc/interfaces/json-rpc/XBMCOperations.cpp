@@ -21,6 +21,7 @@
 #include "XBMCOperations.h"
 #include "ApplicationMessenger.h"
 #include "Util.h"
+#include "utils/FrameProfiler.h"
 #include "utils/Variant.h"
 #include "powermanagement/PowerManager.h"
 
@@ -92,3 +93,12 @@ JSONRPC_STATUS CXBMCOperations::GetInfoBooleans(const std::string &method, ITran
 
   return OK;
 }
+
+JSONRPC_STATUS CXBMCOperations::GetFrameStats(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  CFrameProfiler::Get().GetStats(result);
+  if (parameterObject["reset"].asBoolean())
+    CFrameProfiler::Get().Reset();
+
+  return OK;
+}
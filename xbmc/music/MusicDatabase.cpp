@@ -472,9 +472,48 @@ std::string CMusicDatabase::LoadCuesheet(const std::string& fullSongPath)
   return strCuesheet;
 }
 
+bool CMusicDatabase::LoadCuesheets(const std::set<std::string> &paths, CueCache &cuesheets)
+{
+  if (NULL == m_pDB.get() || NULL == m_pDS.get())
+    return false;
+
+  try
+  {
+    // a few hundred paths per query keep the statements short
+    std::set<std::string>::const_iterator path = paths.begin();
+    while (path != paths.end())
+    {
+      std::vector<std::string> batch;
+      for (; path != paths.end() && batch.size() < 500; ++path)
+        batch.push_back(PrepareSQL("'%s'", path->c_str()));
+
+      std::string strSQL = "SELECT path.strPath, cue.strFileName, cue.strCuesheet FROM cue JOIN path ON path.idPath = cue.idPath "
+                           "WHERE path.strPath IN (" + StringUtils::Join(batch, ",") + ")";
+      if (!m_pDS->query(strSQL.c_str()))
+        return false;
+
+      while (!m_pDS->eof())
+      {
+        cuesheets[m_pDS->fv(0).get_asString() + m_pDS->fv(1).get_asString()] = m_pDS->fv(2).get_asString();
+        m_pDS->next();
+      }
+      m_pDS->close();
+    }
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
 bool CMusicDatabase::AddAlbum(CAlbum& album)
 {
-  BeginTransaction();
+  // the scanner batches several albums into one transaction
+  bool transaction = !InTransaction();
+  if (transaction)
+    BeginTransaction();
 
   album.idAlbum = AddAlbum(album.strAlbum,
                            album.strMusicBrainzAlbumID,
@@ -532,13 +571,16 @@ bool CMusicDatabase::AddAlbum(CAlbum& album)
                                                         ++albumArt)
     SetArtForItem(album.idAlbum, MediaTypeAlbum, albumArt->first, albumArt->second);
 
-  CommitTransaction();
+  if (transaction)
+    CommitTransaction();
   return true;
 }
 
 bool CMusicDatabase::UpdateAlbum(CAlbum& album)
 {
-  BeginTransaction();
+  bool transaction = !InTransaction();
+  if (transaction)
+    BeginTransaction();
 
   UpdateAlbum(album.idAlbum,
               album.strAlbum, album.strMusicBrainzAlbumID,
@@ -605,7 +647,8 @@ bool CMusicDatabase::UpdateAlbum(CAlbum& album)
   if (!album.art.empty())
     SetArtForItem(album.idAlbum, MediaTypeAlbum, album.art);
 
-  CommitTransaction();
+  if (transaction)
+    CommitTransaction();
   return true;
 }
 
@@ -637,43 +680,37 @@ int CMusicDatabase::AddSong(const int idAlbum,
     bHasKaraoke = CKaraokeLyricsFactory::HasLyrics(strPathAndFileName);
 #endif
 
+    bool found;
     if (!strMusicBrainzTrackID.empty())
-      strSQL = PrepareSQL("SELECT * FROM song WHERE idAlbum = %i AND strMusicBrainzTrackID = '%s'",
-                          idAlbum,
-                          strMusicBrainzTrackID.c_str());
+    {
+      strSQL = "SELECT * FROM song WHERE idAlbum = ? AND strMusicBrainzTrackID = ?";
+      found = m_pDS->query(strSQL, { idAlbum, strMusicBrainzTrackID });
+    }
     else
-      strSQL = PrepareSQL("SELECT * FROM song WHERE idAlbum=%i AND strFileName='%s' AND strTitle='%s' AND strMusicBrainzTrackID IS NULL",
-                          idAlbum,
-                          strFileName.c_str(),
-                          strTitle.c_str());
-
-    if (!m_pDS->query(strSQL.c_str()))
+    {
+      strSQL = "SELECT * FROM song WHERE idAlbum = ? AND strFileName = ? AND strTitle = ? AND strMusicBrainzTrackID IS NULL";
+      found = m_pDS->query(strSQL, { idAlbum, strFileName, strTitle });
+    }
+    if (!found)
       return -1;
 
     if (m_pDS->num_rows() == 0)
     {
       m_pDS->close();
-      strSQL=PrepareSQL("INSERT INTO song (idSong,idAlbum,idPath,strArtists,strGenres,strTitle,iTrack,iDuration,iYear,strFileName,strMusicBrainzTrackID,iTimesPlayed,iStartOffset,iEndOffset,lastplayed,rating,comment) values (NULL, %i, %i, '%s', '%s', '%s', %i, %i, %i, '%s'",
-                    idAlbum,
-                    idPath,
-                    artistString.c_str(),
-                    StringUtils::Join(genres, g_advancedSettings.m_musicItemSeparator).c_str(),
-                    strTitle.c_str(),
-                    iTrack, iDuration, iYear,
-                    strFileName.c_str());
 
+      dbiplus::field_value musicBrainzTrackID(strMusicBrainzTrackID);
       if (strMusicBrainzTrackID.empty())
-        strSQL += PrepareSQL(",NULL");
-      else
-        strSQL += PrepareSQL(",'%s'", strMusicBrainzTrackID.c_str());
-
-      if (dtLastPlayed.IsValid())
-        strSQL += PrepareSQL(",%i,%i,%i,'%s','%c','%s')",
-                      iTimesPlayed, iStartOffset, iEndOffset, dtLastPlayed.GetAsDBDateTime().c_str(), rating, strComment.c_str());
-      else
-        strSQL += PrepareSQL(",%i,%i,%i,NULL,'%c','%s')",
-                      iTimesPlayed, iStartOffset, iEndOffset, rating, strComment.c_str());
-      m_pDS->exec(strSQL.c_str());
+        musicBrainzTrackID.set_isNull();
+      dbiplus::field_value lastPlayed(dtLastPlayed.IsValid() ? dtLastPlayed.GetAsDBDateTime() : "");
+      if (!dtLastPlayed.IsValid())
+        lastPlayed.set_isNull();
+
+      strSQL = "INSERT INTO song (idSong,idAlbum,idPath,strArtists,strGenres,strTitle,iTrack,iDuration,iYear,strFileName,strMusicBrainzTrackID,iTimesPlayed,iStartOffset,iEndOffset,lastplayed,rating,comment) "
+               "VALUES (NULL, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+      m_pDS->exec(strSQL, { idAlbum, idPath, artistString,
+                            StringUtils::Join(genres, g_advancedSettings.m_musicItemSeparator),
+                            strTitle, iTrack, iDuration, iYear, strFileName, musicBrainzTrackID,
+                            iTimesPlayed, iStartOffset, iEndOffset, lastPlayed, rating, strComment });
       idSong = (int)m_pDS->lastinsertid();
     }
     else
@@ -1084,14 +1121,14 @@ int CMusicDatabase::AddGenre(const std::string& strGenre1)
       return it->second;
 
 
-    strSQL=PrepareSQL("select * from genre where strGenre like '%s'", strGenre.c_str());
-    m_pDS->query(strSQL.c_str());
+    strSQL = "select * from genre where strGenre like ?";
+    m_pDS->query(strSQL, { strGenre });
     if (m_pDS->num_rows() == 0)
     {
       m_pDS->close();
       // doesnt exists, add it
-      strSQL=PrepareSQL("insert into genre (idGenre, strGenre) values( NULL, '%s' )", strGenre.c_str());
-      m_pDS->exec(strSQL.c_str());
+      strSQL = "insert into genre (idGenre, strGenre) values( NULL, ? )";
+      m_pDS->exec(strSQL, { strGenre });
 
       int idGenre = (int)m_pDS->lastinsertid();
       m_genreCache.insert(pair<std::string, int>(strGenre1, idGenre));
@@ -1337,10 +1374,8 @@ bool CMusicDatabase::DeleteArtistDiscography(int idArtist)
 
 bool CMusicDatabase::AddSongArtist(int idArtist, int idSong, std::string strArtist, std::string joinPhrase, bool featured, int iOrder)
 {
-  std::string strSQL;
-  strSQL=PrepareSQL("replace into song_artist (idArtist, idSong, strArtist, strJoinPhrase, boolFeatured, iOrder) values(%i,%i,'%s','%s',%i,%i)",
-                    idArtist, idSong, strArtist.c_str(), joinPhrase.c_str(), featured == true ? 1 : 0, iOrder);
-  return ExecuteQuery(strSQL);
+  return ExecuteQuery("replace into song_artist (idArtist, idSong, strArtist, strJoinPhrase, boolFeatured, iOrder) values(?,?,?,?,?,?)",
+                      { idArtist, idSong, strArtist, joinPhrase, featured ? 1 : 0, iOrder });
 };
 
 bool CMusicDatabase::DeleteSongArtistsBySong(int idSong)
@@ -1350,10 +1385,8 @@ bool CMusicDatabase::DeleteSongArtistsBySong(int idSong)
 
 bool CMusicDatabase::AddAlbumArtist(int idArtist, int idAlbum, std::string strArtist, std::string joinPhrase, bool featured, int iOrder)
 {
-  std::string strSQL;
-  strSQL=PrepareSQL("replace into album_artist (idArtist, idAlbum, strArtist, strJoinPhrase, boolFeatured, iOrder) values(%i,%i,'%s','%s',%i,%i)",
-                    idArtist, idAlbum, strArtist.c_str(), joinPhrase.c_str(), featured == true ? 1 : 0, iOrder);
-  return ExecuteQuery(strSQL);
+  return ExecuteQuery("replace into album_artist (idArtist, idAlbum, strArtist, strJoinPhrase, boolFeatured, iOrder) values(?,?,?,?,?,?)",
+                      { idArtist, idAlbum, strArtist, joinPhrase, featured ? 1 : 0, iOrder });
 };
 
 bool CMusicDatabase::DeleteAlbumArtistsByAlbum(int idAlbum)
@@ -1366,10 +1399,8 @@ bool CMusicDatabase::AddSongGenre(int idGenre, int idSong, int iOrder)
   if (idGenre == -1 || idSong == -1)
     return true;
 
-  std::string strSQL;
-  strSQL=PrepareSQL("replace into song_genre (idGenre, idSong, iOrder) values(%i,%i,%i)",
-                    idGenre, idSong, iOrder);
-  return ExecuteQuery(strSQL);
+  return ExecuteQuery("replace into song_genre (idGenre, idSong, iOrder) values(?,?,?)",
+                      { idGenre, idSong, iOrder });
 };
 
 bool CMusicDatabase::DeleteSongGenresBySong(int idSong)
@@ -1382,10 +1413,8 @@ bool CMusicDatabase::AddAlbumGenre(int idGenre, int idAlbum, int iOrder)
   if (idGenre == -1 || idAlbum == -1)
     return true;
   
-  std::string strSQL;
-  strSQL=PrepareSQL("replace into album_genre (idGenre, idAlbum, iOrder) values(%i,%i,%i)",
-                    idGenre, idAlbum, iOrder);
-  return ExecuteQuery(strSQL);
+  return ExecuteQuery("replace into album_genre (idGenre, idAlbum, iOrder) values(?,?,?)",
+                      { idGenre, idAlbum, iOrder });
 };
 
 bool CMusicDatabase::DeleteAlbumGenresByAlbum(int idAlbum)
@@ -1605,14 +1634,14 @@ int CMusicDatabase::AddPath(const std::string& strPath1)
     if (it != m_pathCache.end())
       return it->second;
 
-    strSQL=PrepareSQL( "select * from path where strPath='%s'", strPath.c_str());
-    m_pDS->query(strSQL.c_str());
+    strSQL = "select * from path where strPath=?";
+    m_pDS->query(strSQL, { strPath });
     if (m_pDS->num_rows() == 0)
     {
       m_pDS->close();
       // doesnt exists, add it
-      strSQL=PrepareSQL("insert into path (idPath, strPath) values( NULL, '%s' )", strPath.c_str());
-      m_pDS->exec(strSQL.c_str());
+      strSQL = "insert into path (idPath, strPath) values( NULL, ? )";
+      m_pDS->exec(strSQL, { strPath });
 
       int idPath = (int)m_pDS->lastinsertid();
       m_pathCache.insert(pair<std::string, int>(strPath, idPath));
@@ -3600,6 +3629,7 @@ bool CMusicDatabase::GetSongsByWhere(const std::string &baseDir, const Filter &f
     items.Reserve(results.size());
     const dbiplus::query_data &data = m_pDS->get_result_set().records;
     int count = 0;
+    std::set<std::string> paths;
     for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); ++it)
     {
       unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
@@ -3612,6 +3642,7 @@ bool CMusicDatabase::GetSongsByWhere(const std::string &baseDir, const Filter &f
         // HACK for sorting by database returned order
         item->m_iprogramCount = ++count;
         items.Add(item);
+        paths.insert(record->at(song_strPath).get_asString());
       }
       catch (...)
       {
@@ -3624,10 +3655,19 @@ bool CMusicDatabase::GetSongsByWhere(const std::string &baseDir, const Filter &f
     // cleanup
     m_pDS->close();
 
-    // Load some info from embedded cuesheet if present (now only ReplayGain)
-    CueInfoLoader cueLoader;
-    for (int i = 0; i < items.Size(); ++i)
-      cueLoader.Load(LoadCuesheet(items[i]->GetMusicInfoTag()->GetURL()), items[i]);
+    // Load some info from embedded cuesheet if present (now only ReplayGain).
+    // Get the cuesheets of the songs' paths in one go instead of two queries per song.
+    CueCache cuesheets;
+    if (LoadCuesheets(paths, cuesheets) && !cuesheets.empty())
+    {
+      CueInfoLoader cueLoader;
+      for (int i = 0; i < items.Size(); ++i)
+      {
+        CueCache::const_iterator cuesheet = cuesheets.find(items[i]->GetMusicInfoTag()->GetURL());
+        if (cuesheet != cuesheets.end())
+          cueLoader.Load(cuesheet->second, items[i]);
+      }
+    }
 
     CLog::Log(LOGDEBUG, "%s(%s) - took %d ms", __FUNCTION__, filter.where.c_str(), XbmcThreads::SystemClockMillis() - time);
     return true;
@@ -5592,6 +5632,29 @@ string CMusicDatabase::GetArtistArtForItem(int mediaId, const string &mediaType,
   return GetSingleValue(query, m_pDS2);
 }
 
+bool CMusicDatabase::GetArtURLs(vector<string> &urls)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    m_pDS->query("SELECT DISTINCT url FROM art");
+    while (!m_pDS->eof())
+    {
+      urls.push_back(m_pDS->fv(0).get_asString());
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
 bool CMusicDatabase::GetFilter(CDbUrl &musicUrl, Filter &filter, SortDescription &sorting)
 {
   if (!musicUrl.IsValid())
@@ -462,6 +462,12 @@ public:
    */
   std::string GetArtistArtForItem(int mediaId, const std::string &mediaType, const std::string &artType);
 
+  /*! \brief Fetch the urls of all art in the database.
+   \param urls [out] the original urls of the art, appended to any already present.
+   \return true if the query succeeded, false otherwise.
+   */
+  bool GetArtURLs(std::vector<std::string> &urls);
+
 protected:
   std::map<std::string, int> m_artistCache;
   std::map<std::string, int> m_genreCache;
@@ -471,6 +477,12 @@ protected:
   typedef std::map<std::string, std::string> CueCache;
   CueCache m_cueCache;
 
+  /*! \brief Get the cuesheets of all songs in the given paths at once
+   \param paths the paths of the songs
+   \param cuesheets [out] the cuesheets by full song path
+   */
+  bool LoadCuesheets(const std::set<std::string> &paths, CueCache &cuesheets);
+
   virtual void CreateTables();
   virtual void CreateAnalytics();
   virtual int GetMinSchemaVersion() const { return 18; }
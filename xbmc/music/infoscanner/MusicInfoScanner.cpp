@@ -53,6 +53,7 @@
 #include "addons/AddonManager.h"
 #include "addons/Scraper.h"
 #include "CueDocument.h"
+#include "utils/JobManager.h"
 
 #include <algorithm>
 
@@ -63,6 +64,40 @@ using namespace MUSICDATABASEDIRECTORY;
 using namespace MUSIC_GRABBER;
 using namespace ADDON;
 
+#define FOLDERS_PER_TRANSACTION 32
+
+/*! \brief Reads the tags of a folder for the scanner
+ The scanner keeps count of the jobs alive, so that it doesn't finish while
+ a cancelled or running job still refers to it.
+ */
+class CMusicInfoScanner::CTagReaderJob : public CJob
+{
+public:
+  CTagReaderJob(CMusicInfoScanner *scanner, const ScanFolderPtr &folder)
+    : m_scanner(scanner), m_folder(folder)
+  {
+    CSingleLock lock(m_scanner->m_readSection);
+    m_scanner->m_reading++;
+  }
+
+  virtual ~CTagReaderJob()
+  {
+    CSingleLock lock(m_scanner->m_readSection);
+    m_scanner->m_reading--;
+    m_scanner->m_readEvent.Set();
+  }
+
+  virtual const char *GetType() const { return "musictagreader"; }
+
+  virtual bool DoWork()
+  {
+    return m_scanner->ScanTags(m_folder->items, m_folder->scannedItems, m_folder->files) != INFO_CANCELLED;
+  }
+
+  CMusicInfoScanner *m_scanner;
+  ScanFolderPtr m_folder;
+};
+
 CMusicInfoScanner::CMusicInfoScanner() : CThread("MusicInfoScanner"), m_fileCountReader(this, "MusicFileCounter")
 {
   m_bRunning = false;
@@ -72,6 +107,8 @@ CMusicInfoScanner::CMusicInfoScanner() : CThread("MusicInfoScanner"), m_fileCoun
   m_currentItem=0;
   m_itemCount=0;
   m_flags = 0;
+  m_reading = 0;
+  m_filesRead = 0;
 }
 
 CMusicInfoScanner::~CMusicInfoScanner()
@@ -128,6 +165,13 @@ void CMusicInfoScanner::Process()
       // result in unexpected behaviour.
       m_bCanInterrupt = false;
       m_needsCleanup = false;
+      m_filesRead = 0;
+      {
+        CSingleLock lock(m_readSection);
+        m_readFolders.clear();
+        m_readJobs.clear();
+        m_reading = 0;
+      }
 
       bool commit = true;
       for (std::set<std::string>::const_iterator it = m_pathsToScan.begin(); it != m_pathsToScan.end(); ++it)
@@ -151,6 +195,12 @@ void CMusicInfoScanner::Process()
         }
       }
 
+      // wait for the tag readers (folders still being read are dropped if we were stopped)
+      WriteFolders(0);
+
+      // the batches are committed without counting the songs each time
+      g_infoManager.SetLibraryBool(LIBRARY_HAS_MUSIC, m_musicDatabase.GetSongsCount() > 0);
+
       if (commit)
       {
         g_infoManager.ResetLibraryBools();
@@ -178,6 +228,9 @@ void CMusicInfoScanner::Process()
       
       tick = XbmcThreads::SystemClockMillis() - tick;
       CLog::Log(LOGNOTICE, "My Music: Scanning for music info using worker thread, operation took %s", StringUtils::SecondsToTimeString(tick / 1000).c_str());
+      if (m_filesRead > 0)
+        CLog::Log(LOGNOTICE, "My Music: Read the tags of %u files with %i readers (%.1f files/s)",
+                  m_filesRead, g_advancedSettings.m_iMusicLibraryTagReaders, m_filesRead * 1000.0f / std::max(tick, 1u));
     }
     if (m_scanType == 1) // load album info
     {
@@ -398,6 +451,7 @@ void CMusicInfoScanner::Stop()
     m_musicDatabase.Interupt();
 
   StopThread(false);
+  m_readEvent.Set();
 }
 
 void CMusicInfoScanner::CleanDatabase(bool showProgress /* = true */)
@@ -466,15 +520,9 @@ bool CMusicInfoScanner::DoScan(const std::string& strDirectory)
     items.FilterCueItems();
     items.Sort(SortByLabel, SortOrderAscending);
 
-    // and then scan in the new information
-    if (RetrieveMusicInfo(strDirectory, items) > 0)
-    {
-      if (m_handle)
-        OnDirectoryScanned(strDirectory);
-    }
-
-    // save information about this folder
-    m_musicDatabase.SetPathHash(strDirectory, hash);
+    // and then scan in the new information. The folder is written to the database
+    // (and its hash saved) once its tags are read.
+    ReadFolder(strDirectory, items, hash);
   }
   else
   { // path is the same - no need to rescan
@@ -511,7 +559,7 @@ bool CMusicInfoScanner::DoScan(const std::string& strDirectory)
   return !m_bStop;
 }
 
-INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList& scannedItems)
+INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList& scannedItems, int &files) const
 {
   vector<string> regexps = g_advancedSettings.m_audioExcludeFromScanRegExps;
 
@@ -528,7 +576,7 @@ INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList&
     if (pItem->m_bIsFolder || pItem->IsPlayList() || pItem->IsPicture() || pItem->IsLyrics())
       continue;
 
-    m_currentItem++;
+    files++;
 
     CMusicInfoTag& tag = *pItem->GetMusicInfoTag();
     if (!tag.Loaded())
@@ -538,9 +586,6 @@ INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList&
         pLoader->Load(pItem->GetPath(), tag);
     }
 
-    if (m_handle && m_itemCount>0)
-      m_handle->SetPercentage(m_currentItem / (float)m_itemCount * 100);
-
     if (!tag.Loaded() && !pItem->HasCueDocument())
     {
       CLog::Log(LOGDEBUG, "%s - No tag found for: %s", __FUNCTION__, pItem->GetPath().c_str());
@@ -734,7 +779,135 @@ void CMusicInfoScanner::FileItemsToAlbums(CFileItemList& items, VECALBUMS& album
   }
 }
 
-int CMusicInfoScanner::RetrieveMusicInfo(const std::string& strDirectory, CFileItemList& items)
+void CMusicInfoScanner::ReadFolder(const std::string& strDirectory, const CFileItemList& items, const std::string& hash)
+{
+  ScanFolderPtr folder(new CScanFolder);
+  folder->path = strDirectory;
+  folder->hash = hash;
+  folder->items.SetPath(items.GetPath());
+  // subfolders are scanned by DoScan(), the readers only get the files
+  for (int i = 0; i < items.Size(); ++i)
+  {
+    if (!items[i]->m_bIsFolder)
+      folder->items.Add(items[i]);
+  }
+
+  unsigned int readers = std::max(g_advancedSettings.m_iMusicLibraryTagReaders, 1);
+  WriteFolders(readers - 1);
+
+  // hold the lock so that the job can't complete before its id is stored
+  CSingleLock lock(m_readSection);
+  CTagReaderJob *job = new CTagReaderJob(this, folder);
+  unsigned int jobID = CJobManager::GetInstance().AddJob(job, this);
+  if (jobID)
+    m_readJobs.insert(jobID);
+  else
+    delete job;
+}
+
+void CMusicInfoScanner::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CSingleLock lock(m_readSection);
+  m_readJobs.erase(jobID);
+  if (success && !m_bStop)
+    m_readFolders.push_back(static_cast<CTagReaderJob*>(job)->m_folder);
+  m_readEvent.Set();
+}
+
+void CMusicInfoScanner::CancelReaders()
+{
+  std::set<unsigned int> jobs;
+  {
+    CSingleLock lock(m_readSection);
+    jobs.swap(m_readJobs);
+  }
+
+  // cancelled jobs are deleted right away, running ones don't call back anymore
+  for (std::set<unsigned int>::const_iterator it = jobs.begin(); it != jobs.end(); ++it)
+    CJobManager::GetInstance().CancelJob(*it);
+}
+
+void CMusicInfoScanner::WriteFolders(unsigned int maxReading)
+{
+  // don't hold the database locked while scraping online
+  bool batch = !(m_flags & SCAN_ONLINE);
+  unsigned int written = 0;
+
+  while (true)
+  {
+    ScanFolderPtr folder;
+    {
+      CSingleLock lock(m_readSection);
+      if (!m_readFolders.empty())
+      {
+        folder = m_readFolders.front();
+        m_readFolders.pop_front();
+      }
+      else if (m_reading <= maxReading)
+        break;
+    }
+
+    if (!folder)
+    {
+      // once stopped, the readers are cancelled and their folders are dropped,
+      // but the jobs still have to be gone before the scan can finish
+      if (m_bStop)
+        CancelReaders();
+
+      // all readers are busy - commit what we have while we wait
+      if (written)
+      {
+        CommitFolders();
+        written = 0;
+      }
+      m_readEvent.Wait();
+      continue;
+    }
+
+    if (m_bStop)
+      continue;
+
+    if (batch && written == 0)
+      m_musicDatabase.BeginTransaction();
+
+    WriteFolder(*folder);
+
+    if (batch && ++written >= FOLDERS_PER_TRANSACTION)
+    {
+      CommitFolders();
+      written = 0;
+    }
+  }
+
+  if (written)
+    CommitFolders();
+}
+
+void CMusicInfoScanner::CommitFolders()
+{
+  // CMusicDatabase::CommitTransaction() counts the songs for the library bools,
+  // Process() does that once at the end of the scan instead
+  m_musicDatabase.CDatabase::CommitTransaction();
+}
+
+void CMusicInfoScanner::WriteFolder(CScanFolder& folder)
+{
+  m_filesRead += folder.files;
+  m_currentItem += folder.files;
+  if (m_handle && m_itemCount>0)
+    m_handle->SetPercentage(m_currentItem / (float)m_itemCount * 100);
+
+  if (RetrieveMusicInfo(folder.path, folder.items, folder.scannedItems) > 0)
+  {
+    if (m_handle)
+      OnDirectoryScanned(folder.path);
+  }
+
+  // save information about this folder
+  m_musicDatabase.SetPathHash(folder.path, folder.hash);
+}
+
+int CMusicInfoScanner::RetrieveMusicInfo(const std::string& strDirectory, const CFileItemList& items, CFileItemList& scannedItems)
 {
   MAPSONGS songsMap;
 
@@ -742,8 +915,7 @@ int CMusicInfoScanner::RetrieveMusicInfo(const std::string& strDirectory, CFileI
   if (m_musicDatabase.RemoveSongsFromPath(strDirectory, songsMap))
     m_needsCleanup = true;
 
-  CFileItemList scannedItems;
-  if (ScanTags(items, scannedItems) == INFO_CANCELLED || scannedItems.Size() == 0)
+  if (scannedItems.Size() == 0)
     return 0;
 
   VECALBUMS albums;
@@ -18,11 +18,18 @@
  *  <http://www.gnu.org/licenses/>.
  *
  */
+#include "FileItem.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
 #include "threads/Thread.h"
 #include "music/MusicDatabase.h"
+#include "utils/Job.h"
 #include "MusicAlbumInfo.h"
 #include "MusicInfoScraper.h"
 
+#include <deque>
+#include <memory>
+
 class CAlbum;
 class CArtist;
 class CGUIDialogProgressBarHandle;
@@ -41,7 +48,7 @@ enum INFO_RET
   INFO_ADDED 
 };
 
-class CMusicInfoScanner : CThread, public IRunnable
+class CMusicInfoScanner : CThread, public IRunnable, public IJobCallback
 {
 public:
   /*! \brief Flags for controlling the scanning process
@@ -165,26 +172,64 @@ public:
    \param artist [in] an artist
    */
   std::map<std::string, std::string> GetArtistArtwork(const CArtist& artist);
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
 protected:
   virtual void Process();
 
-  /*! \brief Scan in the ID3/Ogg/FLAC tags for a bunch of FileItems
-   Given a list of FileItems, scan in the tags for those FileItems
-   and populate a new FileItemList with the files that were successfully scanned.
-   Any files which couldn't be scanned (no/bad tags) are discarded in the process.
-   \param items [in] list of FileItems to scan
-   \param scannedItems [in] list to populate with the scannedItems
+  /*! \brief A folder whose tags are read by one of the tag reader jobs
+   */
+  struct CScanFolder
+  {
+    CScanFolder() : files(0) {}
+    std::string path;
+    std::string hash;          ///< path hash to store once the folder is in the database
+    CFileItemList items;       ///< the files of the folder
+    CFileItemList scannedItems;///< the files (and cue sheet tracks) with tags
+    int files;                 ///< number of files whose tags were read
+  };
+  typedef std::shared_ptr<CScanFolder> ScanFolderPtr;
+  class CTagReaderJob;
+
+  /*! \brief Add the albums and songs found in a folder to the database
+   \param strDirectory [in] the folder
+   \param items [in] the folder listing
+   \param scannedItems [in] the files of the folder with tags, see ScanTags()
+   \return the number of songs added
    */
-  int RetrieveMusicInfo(const std::string& strDirectory, CFileItemList& items);
+  int RetrieveMusicInfo(const std::string& strDirectory, const CFileItemList& items, CFileItemList& scannedItems);
 
   /*! \brief Scan in the ID3/Ogg/FLAC tags for a bunch of FileItems
     Given a list of FileItems, scan in the tags for those FileItems
    and populate a new FileItemList with the files that were successfully scanned.
    Any files which couldn't be scanned (no/bad tags) are discarded in the process.
+   Safe to be called from the tag reader jobs.
    \param items [in] list of FileItems to scan
    \param scannedItems [in] list to populate with the scannedItems
+   \param files [out] the number of files whose tags were read
+   */
+  INFO_RET ScanTags(const CFileItemList& items, CFileItemList& scannedItems, int &files) const;
+
+  /*! \brief Hand a changed folder to the tag readers
+   Blocks while all readers are busy, writing the folders they finished in the meantime.
+   \param strDirectory [in] the folder
+   \param items [in] the folder listing
+   \param hash [in] the hash to store for the folder once it is in the database
+   */
+  void ReadFolder(const std::string& strDirectory, const CFileItemList& items, const std::string& hash);
+
+  /*! \brief Write the folders the tag readers have finished to the database
+   Several folders are batched into a single transaction.
+   \param maxReading [in] return once no more than this many folders are still being read
+   */
+  void WriteFolders(unsigned int maxReading);
+  void WriteFolder(CScanFolder& folder);
+
+  /*! \brief Cancel the tag reader jobs that haven't finished yet
+   Jobs already running still complete, WriteFolders(0) waits for them.
    */
-  INFO_RET ScanTags(const CFileItemList& items, CFileItemList& scannedItems);
+  void CancelReaders();
+  void CommitFolders();
   int GetPathHash(const CFileItemList &items, std::string &hash);
   void GetAlbumArtwork(long id, const CAlbum &artist);
 
@@ -222,5 +267,12 @@ protected:
   std::set<std::string> m_seenPaths;
   int m_flags;
   CThread m_fileCountReader;
+
+  CCriticalSection m_readSection;
+  CEvent m_readEvent;
+  std::deque<ScanFolderPtr> m_readFolders; ///< folders whose tags are read, waiting to be written
+  std::set<unsigned int> m_readJobs;       ///< ids of the tag reader jobs that haven't completed
+  unsigned int m_reading;                  ///< tag reader jobs alive, they refer to the scanner until destroyed
+  unsigned int m_filesRead;
 };
 }
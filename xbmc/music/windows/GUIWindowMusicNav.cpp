@@ -807,6 +807,12 @@ void CGUIWindowMusicNav::FrameMove()
     SET_CONTROL_LABEL(CONTROL_LABELEMPTY,g_localizeStrings.Get(745)+'\n'+g_localizeStrings.Get(746));
   else
     SET_CONTROL_LABEL(CONTROL_LABELEMPTY,"");
+
+  // load thumbs of the items in view first
+  int item = m_viewControl.GetSelectedItem();
+  if (m_thumbLoader.IsLoading() && item >= 0 && item < m_vecItems->Size())
+    m_thumbLoader.SetFocusItem(m_vecItems->Get(item));
+
   CGUIWindowMusicBase::FrameMove();
 }
 
@@ -0,0 +1,473 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ImageScaler.h"
+#include "utils/CPUInfo.h"
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+#ifdef TARGET_WINDOWS
+#if (_M_IX86_FP>1 || defined(_M_X64)) && !defined(__SSE2__)
+#define __SSE2__
+#endif
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* the avx2 kernels are compiled for that target only, the
+ * rest of the build doesn't need to be built for avx2 */
+#if defined(__SSE2__) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define HAS_SCALER_AVX2
+#define SCALER_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(__SSE2__) && defined(_MSC_VER) && _MSC_VER >= 1800
+#define HAS_SCALER_AVX2
+#define SCALER_TARGET_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define HAS_SCALER_NEON
+#include <arm_neon.h>
+#endif
+
+#define WEIGHT_BITS       14 // weights are 1.14 fixed point
+#define INTERMEDIATE_BITS 7  // intermediate values are 8.7 fixed point
+#define HORIZONTAL_SHIFT  (WEIGHT_BITS - INTERMEDIATE_BITS)
+#define VERTICAL_SHIFT    (WEIGHT_BITS + INTERMEDIATE_BITS)
+
+namespace
+{
+
+inline uint8_t ClampByte(int32_t value)
+{
+  return value < 0 ? 0 : (value > 255 ? 255 : (uint8_t)value);
+}
+
+inline int32_t WeightPair(const int16_t *weights)
+{
+  // two neighbouring weights as the low and high half of a 32 bit lane,
+  // which is what pmaddwd multiplies interleaved pairs with
+  int32_t pair;
+  memcpy(&pair, weights, sizeof(pair));
+  return pair;
+}
+
+/*
+ * C
+ */
+
+void HorizontalC(const uint8_t *src, const uint32_t *offsets, const int16_t *weights, unsigned int taps,
+                 int16_t *dst, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++, weights += taps, dst += 4)
+  {
+    const uint8_t *pixel = src + offsets[i] * 4;
+    int32_t sum[4] = { 0, 0, 0, 0 };
+    for (unsigned int k = 0; k < taps; k++, pixel += 4)
+    {
+      sum[0] += pixel[0] * weights[k];
+      sum[1] += pixel[1] * weights[k];
+      sum[2] += pixel[2] * weights[k];
+      sum[3] += pixel[3] * weights[k];
+    }
+    for (unsigned int c = 0; c < 4; c++)
+      dst[c] = (int16_t)((sum[c] + (1 << (HORIZONTAL_SHIFT - 1))) >> HORIZONTAL_SHIFT);
+  }
+}
+
+void VerticalTail(const int16_t * const *rows, const int16_t *weights, unsigned int taps,
+                  uint8_t *dst, unsigned int start, unsigned int count)
+{
+  for (unsigned int i = start; i < count; i++)
+  {
+    int32_t sum = 0;
+    for (unsigned int k = 0; k < taps; k++)
+      sum += rows[k][i] * weights[k];
+    dst[i] = ClampByte((sum + (1 << (VERTICAL_SHIFT - 1))) >> VERTICAL_SHIFT);
+  }
+}
+
+void VerticalC(const int16_t * const *rows, const int16_t *weights, unsigned int taps,
+               uint8_t *dst, unsigned int count)
+{
+  VerticalTail(rows, weights, taps, dst, 0, count);
+}
+
+const ImageScalerKernels kernelsC =
+{
+  HorizontalC,
+  VerticalC
+};
+
+/*
+ * SSE2
+ */
+
+#ifdef __SSE2__
+
+void HorizontalSSE2(const uint8_t *src, const uint32_t *offsets, const int16_t *weights, unsigned int taps,
+                    int16_t *dst, unsigned int count)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi32(1 << (HORIZONTAL_SHIFT - 1));
+  for (unsigned int i = 0; i < count; i++, weights += taps, dst += 4)
+  {
+    const uint8_t *pixel = src + offsets[i] * 4;
+    __m128i sum = zero;
+    for (unsigned int k = 0; k < taps; k += 4, pixel += 16)
+    {
+      // four pixels, interleaved to b0 b1 g0 g1 r0 r1 a0 a1 and b2 b3 g2 g3 ...
+      __m128i px = _mm_loadu_si128((const __m128i*)pixel);
+      __m128i p01 = _mm_unpacklo_epi8(px, zero);
+      __m128i p23 = _mm_unpackhi_epi8(px, zero);
+      p01 = _mm_unpacklo_epi16(p01, _mm_srli_si128(p01, 8));
+      p23 = _mm_unpacklo_epi16(p23, _mm_srli_si128(p23, 8));
+      sum = _mm_add_epi32(sum, _mm_madd_epi16(p01, _mm_set1_epi32(WeightPair(weights + k))));
+      sum = _mm_add_epi32(sum, _mm_madd_epi16(p23, _mm_set1_epi32(WeightPair(weights + k + 2))));
+    }
+    sum = _mm_srai_epi32(_mm_add_epi32(sum, round), HORIZONTAL_SHIFT);
+    _mm_storel_epi64((__m128i*)dst, _mm_packs_epi32(sum, sum));
+  }
+}
+
+void VerticalSSE2(const int16_t * const *rows, const int16_t *weights, unsigned int taps,
+                  uint8_t *dst, unsigned int count)
+{
+  const __m128i round = _mm_set1_epi32(1 << (VERTICAL_SHIFT - 1));
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i lo = _mm_setzero_si128();
+    __m128i hi = _mm_setzero_si128();
+    for (unsigned int k = 0; k < taps; k += 2)
+    {
+      __m128i r0 = _mm_loadu_si128((const __m128i*)(rows[k] + i));
+      __m128i r1 = _mm_loadu_si128((const __m128i*)(rows[k + 1] + i));
+      __m128i w  = _mm_set1_epi32(WeightPair(weights + k));
+      lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(r0, r1), w));
+      hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(r0, r1), w));
+    }
+    lo = _mm_srai_epi32(_mm_add_epi32(lo, round), VERTICAL_SHIFT);
+    hi = _mm_srai_epi32(_mm_add_epi32(hi, round), VERTICAL_SHIFT);
+    __m128i out = _mm_packs_epi32(lo, hi);
+    _mm_storel_epi64((__m128i*)(dst + i), _mm_packus_epi16(out, out));
+  }
+  VerticalTail(rows, weights, taps, dst, i, count);
+}
+
+const ImageScalerKernels kernelsSSE2 =
+{
+  HorizontalSSE2,
+  VerticalSSE2
+};
+
+#endif // __SSE2__
+
+/*
+ * AVX2
+ */
+
+#ifdef HAS_SCALER_AVX2
+
+SCALER_TARGET_AVX2 void HorizontalAVX2(const uint8_t *src, const uint32_t *offsets, const int16_t *weights, unsigned int taps,
+                                       int16_t *dst, unsigned int count)
+{
+  // interleaves the two 16 bit pixels of each lane to b0 b1 g0 g1 r0 r1 a0 a1
+  const __m256i interleave = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15,
+                                              0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+  // the first weight pair to the low lane, the second to the high lane
+  const __m256i spread = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+  const __m128i round = _mm_set1_epi32(1 << (HORIZONTAL_SHIFT - 1));
+  for (unsigned int i = 0; i < count; i++, weights += taps, dst += 4)
+  {
+    const uint8_t *pixel = src + offsets[i] * 4;
+    __m256i sum = _mm256_setzero_si256();
+    for (unsigned int k = 0; k < taps; k += 4, pixel += 16)
+    {
+      __m256i px = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)pixel));
+      __m256i w  = _mm256_castsi128_si256(_mm_loadl_epi64((const __m128i*)(weights + k)));
+      px = _mm256_shuffle_epi8(px, interleave);
+      w  = _mm256_permutevar8x32_epi32(w, spread);
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(px, w));
+    }
+    __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    total = _mm_srai_epi32(_mm_add_epi32(total, round), HORIZONTAL_SHIFT);
+    _mm_storel_epi64((__m128i*)dst, _mm_packs_epi32(total, total));
+  }
+}
+
+SCALER_TARGET_AVX2 void VerticalAVX2(const int16_t * const *rows, const int16_t *weights, unsigned int taps,
+                                     uint8_t *dst, unsigned int count)
+{
+  const __m256i round = _mm256_set1_epi32(1 << (VERTICAL_SHIFT - 1));
+  unsigned int i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    __m256i lo = _mm256_setzero_si256();
+    __m256i hi = _mm256_setzero_si256();
+    for (unsigned int k = 0; k < taps; k += 2)
+    {
+      __m256i r0 = _mm256_loadu_si256((const __m256i*)(rows[k] + i));
+      __m256i r1 = _mm256_loadu_si256((const __m256i*)(rows[k + 1] + i));
+      __m256i w  = _mm256_set1_epi32(WeightPair(weights + k));
+      lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(r0, r1), w));
+      hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(r0, r1), w));
+    }
+    lo = _mm256_srai_epi32(_mm256_add_epi32(lo, round), VERTICAL_SHIFT);
+    hi = _mm256_srai_epi32(_mm256_add_epi32(hi, round), VERTICAL_SHIFT);
+    // unpack and pack both work per 128 bit lane, so the values are back in
+    // order after packing. The bytes end up in the 1st and 3rd quadword.
+    __m256i out = _mm256_packs_epi32(lo, hi);
+    out = _mm256_permute4x64_epi64(_mm256_packus_epi16(out, out), 0x08);
+    _mm_storeu_si128((__m128i*)(dst + i), _mm256_castsi256_si128(out));
+  }
+  VerticalTail(rows, weights, taps, dst, i, count);
+}
+
+const ImageScalerKernels kernelsAVX2 =
+{
+  HorizontalAVX2,
+  VerticalAVX2
+};
+
+#endif // HAS_SCALER_AVX2
+
+/*
+ * NEON
+ */
+
+#ifdef HAS_SCALER_NEON
+
+void HorizontalNEON(const uint8_t *src, const uint32_t *offsets, const int16_t *weights, unsigned int taps,
+                    int16_t *dst, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++, weights += taps, dst += 4)
+  {
+    const uint8_t *pixel = src + offsets[i] * 4;
+    uint32x4_t sum = vdupq_n_u32(0);
+    for (unsigned int k = 0; k < taps; k += 2, pixel += 8)
+    {
+      uint16x8_t px = vmovl_u8(vld1_u8(pixel));
+      sum = vmlal_n_u16(sum, vget_low_u16(px), (uint16_t)weights[k]);
+      sum = vmlal_n_u16(sum, vget_high_u16(px), (uint16_t)weights[k + 1]);
+    }
+    vst1_s16(dst, vreinterpret_s16_u16(vrshrn_n_u32(sum, HORIZONTAL_SHIFT)));
+  }
+}
+
+void VerticalNEON(const int16_t * const *rows, const int16_t *weights, unsigned int taps,
+                  uint8_t *dst, unsigned int count)
+{
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    int32x4_t lo = vdupq_n_s32(0);
+    int32x4_t hi = vdupq_n_s32(0);
+    for (unsigned int k = 0; k < taps; k++)
+    {
+      int16x8_t row = vld1q_s16(rows[k] + i);
+      lo = vmlal_n_s16(lo, vget_low_s16(row), weights[k]);
+      hi = vmlal_n_s16(hi, vget_high_s16(row), weights[k]);
+    }
+    lo = vrshrq_n_s32(lo, VERTICAL_SHIFT);
+    hi = vrshrq_n_s32(hi, VERTICAL_SHIFT);
+    vst1_u8(dst + i, vqmovn_u16(vcombine_u16(vqmovun_s32(lo), vqmovun_s32(hi))));
+  }
+  VerticalTail(rows, weights, taps, dst, i, count);
+}
+
+const ImageScalerKernels kernelsNEON =
+{
+  HorizontalNEON,
+  VerticalNEON
+};
+
+#endif // HAS_SCALER_NEON
+
+const ImageScalerKernels* GetKernelSet(ImageScalerKernelSet set)
+{
+  switch (set)
+  {
+    case IMAGE_SCALER_KERNELS_C:
+      return &kernelsC;
+#ifdef __SSE2__
+    case IMAGE_SCALER_KERNELS_SSE2:
+      return &kernelsSSE2;
+#endif
+#ifdef HAS_SCALER_AVX2
+    case IMAGE_SCALER_KERNELS_AVX2:
+      return &kernelsAVX2;
+#endif
+#ifdef HAS_SCALER_NEON
+    case IMAGE_SCALER_KERNELS_NEON:
+      return &kernelsNEON;
+#endif
+    default:
+      return NULL;
+  }
+}
+
+bool KernelsSupported(ImageScalerKernelSet set)
+{
+  if (!GetKernelSet(set))
+    return false;
+
+  unsigned int features = g_cpuInfo.GetCPUFeatures();
+  switch (set)
+  {
+    case IMAGE_SCALER_KERNELS_SSE2:
+      return (features & CPU_FEATURE_SSE2) != 0;
+    case IMAGE_SCALER_KERNELS_AVX2:
+      return (features & CPU_FEATURE_AVX2) != 0;
+    case IMAGE_SCALER_KERNELS_NEON:
+#if defined(__aarch64__)
+      return true;
+#else
+      return (features & CPU_FEATURE_NEON) != 0;
+#endif
+    default:
+      return true;
+  }
+}
+
+/*!
+ \brief work out which source pixels make up each output pixel along one axis
+ Output pixel i covers the source range [i * in / out, (i + 1) * in / out). Each
+ source pixel is weighted by how much of it lies in that range. All output
+ pixels use the same number of taps, padded with zero weights and shifted
+ back at the end so they never read past the last source pixel.
+ */
+bool BuildFilter(unsigned int in, unsigned int out, unsigned int &taps,
+                 std::vector<uint32_t> &offsets, std::vector<int16_t> &weights)
+{
+  taps = (in + out - 1) / out + 1;
+  taps = (taps + 3) & ~3;
+  if (taps > in)
+    return false;
+
+  offsets.resize(out);
+  weights.assign(out * taps, 0);
+  for (unsigned int i = 0; i < out; i++)
+  {
+    // positions are in units of 1/out source pixels
+    uint64_t start = (uint64_t)i * in;
+    uint64_t end = start + in;
+    uint32_t first = (uint32_t)(start / out);
+    uint32_t last = (uint32_t)((end + out - 1) / out);
+    uint32_t offset = std::min(first, in - taps);
+    offsets[i] = offset;
+
+    int16_t *w = &weights[i * taps];
+    int sum = 0;
+    unsigned int largest = first - offset;
+    for (uint32_t j = first; j < last; j++)
+    {
+      uint64_t from = std::max(start, (uint64_t)j * out);
+      uint64_t to = std::min(end, (uint64_t)(j + 1) * out);
+      int weight = (int)((((to - from) << WEIGHT_BITS) + in / 2) / in);
+      w[j - offset] = (int16_t)weight;
+      sum += weight;
+      if (weight > w[largest])
+        largest = j - offset;
+    }
+    // rounding may leave the sum a little off, which would tint flat areas
+    w[largest] += (int16_t)((1 << WEIGHT_BITS) - sum);
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+const ImageScalerKernels *CImageScaler::m_kernels = NULL;
+ImageScalerKernelSet CImageScaler::m_kernelSet = IMAGE_SCALER_KERNELS_C;
+
+bool CImageScaler::Downscale(const uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                             uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch)
+{
+  if (in_pixels == NULL || out_pixels == NULL || out_width == 0 || out_height == 0 ||
+      out_width > in_width || out_height > in_height)
+    return false;
+
+  unsigned int hTaps, vTaps;
+  std::vector<uint32_t> hOffsets, vOffsets;
+  std::vector<int16_t> hWeights, vWeights;
+  if (!BuildFilter(in_width, out_width, hTaps, hOffsets, hWeights) ||
+      !BuildFilter(in_height, out_height, vTaps, vOffsets, vWeights))
+    return false;
+
+  const ImageScalerKernels &kernels = Kernels();
+
+  // ring of horizontally scaled rows, source row r is kept in slot r % vTaps
+  const unsigned int rowSize = out_width * 4;
+  std::vector<int16_t> ring(vTaps * rowSize);
+  std::vector<const int16_t*> rows(vTaps);
+  unsigned int next = 0;
+
+  for (unsigned int y = 0; y < out_height; y++)
+  {
+    const unsigned int first = vOffsets[y];
+    if (next < first)
+      next = first;
+    for (; next < first + vTaps; next++)
+      kernels.Horizontal(in_pixels + next * in_pitch, &hOffsets[0], &hWeights[0], hTaps,
+                         &ring[(next % vTaps) * rowSize], out_width);
+
+    for (unsigned int k = 0; k < vTaps; k++)
+      rows[k] = &ring[((first + k) % vTaps) * rowSize];
+    kernels.Vertical(&rows[0], &vWeights[y * vTaps], vTaps, out_pixels + y * out_pitch, rowSize);
+  }
+  return true;
+}
+
+const ImageScalerKernels& CImageScaler::Kernels()
+{
+  if (!m_kernels)
+  {
+    static const ImageScalerKernelSet sets[] = { IMAGE_SCALER_KERNELS_AVX2, IMAGE_SCALER_KERNELS_SSE2,
+                                                 IMAGE_SCALER_KERNELS_NEON, IMAGE_SCALER_KERNELS_C };
+    for (unsigned int i = 0; i < sizeof(sets) / sizeof(sets[0]); i++)
+    {
+      if (SetKernels(sets[i]))
+        break;
+    }
+  }
+  return *m_kernels;
+}
+
+bool CImageScaler::SetKernels(ImageScalerKernelSet set)
+{
+  if (!KernelsSupported(set))
+    return false;
+
+  m_kernelSet = set;
+  m_kernels   = GetKernelSet(set);
+  return true;
+}
+
+ImageScalerKernelSet CImageScaler::GetKernels()
+{
+  Kernels();
+  return m_kernelSet;
+}
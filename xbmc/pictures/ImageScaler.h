@@ -0,0 +1,100 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+
+/*!
+ \brief instruction sets the image scaler kernels are available for
+ \sa CImageScaler::SetKernels
+ */
+enum ImageScalerKernelSet
+{
+  IMAGE_SCALER_KERNELS_C = 0,
+  IMAGE_SCALER_KERNELS_SSE2,
+  IMAGE_SCALER_KERNELS_AVX2,
+  IMAGE_SCALER_KERNELS_NEON
+};
+
+/*!
+ \brief one implementation of the passes of CImageScaler
+
+ Weights are 1.14 fixed point and sum up to 1 for each output value.
+ Intermediate rows hold 8.7 fixed point values, 4 per pixel.
+ */
+struct ImageScalerKernels
+{
+  /*! \brief scale a row of BGRA pixels horizontally
+   \param src the source row
+   \param offsets index of the first source pixel of each output pixel
+   \param weights taps weights per output pixel
+   \param taps number of source pixels per output pixel, a multiple of 4
+   \param dst the intermediate row, 4 values per output pixel
+   \param count number of output pixels
+   */
+  void (*Horizontal)(const uint8_t *src, const uint32_t *offsets, const int16_t *weights, unsigned int taps,
+                     int16_t *dst, unsigned int count);
+
+  /*! \brief combine intermediate rows into an output row
+   \param rows taps intermediate rows
+   \param weights taps weights, one per row
+   \param taps number of rows, a multiple of 4
+   \param dst the output row
+   \param count number of values, 4 per pixel
+   */
+  void (*Vertical)(const int16_t * const *rows, const int16_t *weights, unsigned int taps,
+                   uint8_t *dst, unsigned int count);
+};
+
+/*!
+ \brief Downscaler for 32 bit BGRA images
+
+ Each output pixel is the average of the source area it covers (a box
+ filter with fractional coverage at the edges), which is what thumbnails
+ and cached artwork need. Scaling is done in two separable passes in fixed
+ point: source rows are scaled horizontally once into a small ring of
+ intermediate rows, which are then combined into the output rows.
+
+ The passes are available as C, SSE2, AVX2 and NEON kernels which give
+ identical results. The best one the cpu supports is picked the first time
+ an image is scaled.
+ */
+class CImageScaler
+{
+public:
+  /*! \brief scale an image down
+   \return false if the image can't be scaled this way, e.g. because it
+           is made larger in either direction or is too small
+   */
+  static bool Downscale(const uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                        uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch);
+
+  /*! \brief select the kernels to use
+   \return false if the kernels are not part of this build or not supported by the cpu
+   */
+  static bool SetKernels(ImageScalerKernelSet set);
+  static ImageScalerKernelSet GetKernels();
+
+private:
+  static const ImageScalerKernels& Kernels();
+
+  static const ImageScalerKernels *m_kernels;
+  static ImageScalerKernelSet m_kernelSet;
+};
@@ -26,6 +26,7 @@
 #include <algorithm>
 
 #include "Picture.h"
+#include "ImageScaler.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "FileItem.h"
@@ -206,6 +207,23 @@ bool CPicture::CacheTexture(CBaseTexture *texture, uint32_t &dest_width, uint32_
 
 bool CPicture::CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, uint32_t pitch, int orientation, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest)
 {
+  uint32_t *buffer = NULL;
+  if (!ScaleForCache(pixels, width, height, pitch, orientation, dest_width, dest_height, buffer))
+    return false;
+
+  bool success;
+  if (buffer)
+    success = CreateThumbnailFromSurface((unsigned char*)buffer, dest_width, dest_height, dest_width * 4, dest);
+  else
+    success = CreateThumbnailFromSurface(pixels, width, height, pitch, dest);
+  delete[] buffer;
+  return success;
+}
+
+bool CPicture::ScaleForCache(uint8_t *pixels, uint32_t width, uint32_t height, uint32_t pitch, int orientation, uint32_t &dest_width, uint32_t &dest_height, uint32_t* &result)
+{
+  result = NULL;
+
   // if no max width or height is specified, don't resize
   if (dest_width == 0)
     dest_width = width;
@@ -227,35 +245,29 @@ bool CPicture::CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, ui
 
   if (width > dest_width || height > dest_height || orientation)
   {
-    bool success = false;
-
     dest_width = std::min(width, dest_width);
     dest_height = std::min(height, dest_height);
 
     // create a buffer large enough for the resulting image
     GetScale(width, height, dest_width, dest_height);
     uint32_t *buffer = new uint32_t[dest_width * dest_height];
-    if (buffer)
+    if (ScaleImage(pixels, width, height, pitch,
+                   (uint8_t *)buffer, dest_width, dest_height, dest_width * 4))
     {
-      if (ScaleImage(pixels, width, height, pitch,
-                     (uint8_t *)buffer, dest_width, dest_height, dest_width * 4))
+      if (!orientation || OrientateImage(buffer, dest_width, dest_height, orientation))
       {
-        if (!orientation || OrientateImage(buffer, dest_width, dest_height, orientation))
-        {
-          success = CreateThumbnailFromSurface((unsigned char*)buffer, dest_width, dest_height, dest_width * 4, dest);
-        }
+        result = buffer;
+        return true;
       }
-      delete[] buffer;
     }
-    return success;
-  }
-  else
-  { // no orientation needed
-    dest_width = width;
-    dest_height = height;
-    return CreateThumbnailFromSurface(pixels, width, height, pitch, dest);
+    delete[] buffer;
+    return false;
   }
-  return false;
+
+  // no scaling or orientation needed
+  dest_width = width;
+  dest_height = height;
+  return true;
 }
 
 bool CPicture::CreateTiledThumb(const std::vector<std::string> &files, const std::string &thumb)
@@ -330,6 +342,10 @@ void CPicture::GetScale(unsigned int width, unsigned int height, unsigned int &o
 bool CPicture::ScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
                           uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch)
 {
+  // the dedicated scaler handles the common case of making an image smaller
+  if (CImageScaler::Downscale(in_pixels, in_width, in_height, in_pitch, out_pixels, out_width, out_height, out_pitch))
+    return true;
+
   struct SwsContext *context = sws_getContext(in_width, in_height, PIX_FMT_BGRA,
                                                          out_width, out_height, PIX_FMT_BGRA,
                                                          SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
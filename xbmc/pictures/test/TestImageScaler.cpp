@@ -0,0 +1,115 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "pictures/ImageScaler.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+namespace
+{
+const ImageScalerKernelSet kernelSets[]  = { IMAGE_SCALER_KERNELS_C, IMAGE_SCALER_KERNELS_SSE2,
+                                             IMAGE_SCALER_KERNELS_AVX2, IMAGE_SCALER_KERNELS_NEON };
+const char*                kernelNames[] = { "C", "SSE2", "AVX2", "NEON" };
+const unsigned             kernelCount   = sizeof(kernelSets) / sizeof(kernelSets[0]);
+
+class CKernelsRestore
+{
+public:
+  CKernelsRestore() : m_set(CImageScaler::GetKernels()) {}
+  ~CKernelsRestore() { CImageScaler::SetKernels(m_set); }
+private:
+  ImageScalerKernelSet m_set;
+};
+
+std::vector<uint8_t> Noise(unsigned int width, unsigned int height, unsigned int pitch, unsigned int seed)
+{
+  std::vector<uint8_t> pixels(pitch * height);
+  for (size_t i = 0; i < pixels.size(); i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    pixels[i] = (uint8_t)(seed >> 16);
+  }
+  return pixels;
+}
+}
+
+TEST(TestImageScaler, KernelsMatchC)
+{
+  CKernelsRestore restore;
+
+  // odd sizes and padded pitches so that every kernel has to handle tails
+  const unsigned int sizes[][4] = { { 1920, 1080, 356, 200 }, { 1001, 777, 333, 250 }, { 640, 480, 639, 479 }, { 64, 9, 7, 3 } };
+  for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+  {
+    const unsigned int width = sizes[s][0], height = sizes[s][1];
+    const unsigned int outWidth = sizes[s][2], outHeight = sizes[s][3];
+    const unsigned int pitch = width * 4 + 12, outPitch = outWidth * 4 + 4;
+    std::vector<uint8_t> in = Noise(width, height, pitch, s + 1);
+
+    std::vector<uint8_t> ref(outPitch * outHeight);
+    ASSERT_TRUE(CImageScaler::SetKernels(IMAGE_SCALER_KERNELS_C));
+    ASSERT_TRUE(CImageScaler::Downscale(&in[0], width, height, pitch, &ref[0], outWidth, outHeight, outPitch));
+
+    for (unsigned k = 0; k < kernelCount; k++)
+    {
+      if (!CImageScaler::SetKernels(kernelSets[k]))
+        continue;
+      SCOPED_TRACE(kernelNames[k]);
+
+      std::vector<uint8_t> out(outPitch * outHeight);
+      ASSERT_TRUE(CImageScaler::Downscale(&in[0], width, height, pitch, &out[0], outWidth, outHeight, outPitch));
+      for (unsigned int y = 0; y < outHeight; y++)
+        ASSERT_TRUE(std::equal(&ref[y * outPitch], &ref[y * outPitch] + outWidth * 4, &out[y * outPitch]));
+    }
+  }
+}
+
+TEST(TestImageScaler, BoxAverage)
+{
+  // halving averages each 2x2 block, flat areas stay flat
+  const uint8_t block[] = { 10, 20, 30, 255,   30, 40, 50, 255,
+                            50, 60, 70, 255,   70, 80, 90, 255 };
+  std::vector<uint8_t> in(64 * 8 * 4);
+  for (unsigned int y = 0; y < 8; y++)
+  {
+    for (unsigned int x = 0; x < 64; x++)
+      std::copy(block + ((y & 1) * 2 + (x & 1)) * 4, block + ((y & 1) * 2 + (x & 1)) * 4 + 4, &in[(y * 64 + x) * 4]);
+  }
+
+  std::vector<uint8_t> out(32 * 4 * 4);
+  ASSERT_TRUE(CImageScaler::Downscale(&in[0], 64, 8, 64 * 4, &out[0], 32, 4, 32 * 4));
+  for (unsigned int i = 0; i < 32 * 4; i++)
+  {
+    EXPECT_EQ(40, out[i * 4 + 0]);
+    EXPECT_EQ(50, out[i * 4 + 1]);
+    EXPECT_EQ(60, out[i * 4 + 2]);
+    EXPECT_EQ(255, out[i * 4 + 3]);
+  }
+}
+
+TEST(TestImageScaler, Unsupported)
+{
+  std::vector<uint8_t> in(16 * 16 * 4), out(32 * 32 * 4);
+  EXPECT_FALSE(CImageScaler::Downscale(&in[0], 16, 16, 16 * 4, &out[0], 32, 8, 32 * 4));
+  EXPECT_FALSE(CImageScaler::Downscale(&in[0], 16, 16, 16 * 4, &out[0], 8, 0, 8 * 4));
+  EXPECT_FALSE(CImageScaler::Downscale(&in[0], 3, 3, 3 * 4, &out[0], 1, 1, 4));
+}
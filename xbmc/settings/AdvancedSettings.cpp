@@ -255,6 +255,11 @@ void CAdvancedSettings::Initialize()
   m_fanartRes = 1080;
   m_imageRes = 720;
   m_useDDSFanart = false;
+  m_textureCacheFetchThreads = 4;
+  m_textureCacheDecodeThreads = 2;
+  m_textureCacheScaleThreads = 1;
+  m_textureCacheEncodeThreads = 2;
+  m_textureCacheCompress = false;
 
   m_sambaclienttimeout = 10;
   m_sambadoscodepage = "";
@@ -271,6 +276,7 @@ void CAdvancedSettings::Initialize()
   m_bMusicLibraryAlbumsSortByArtistThenYear = false;
   m_bMusicLibraryCleanOnUpdate = false;
   m_iMusicLibraryRecentlyAddedItems = 25;
+  m_iMusicLibraryTagReaders = 4;
   m_strMusicLibraryAlbumFormat = "";
   m_strMusicLibraryAlbumFormatRight = "";
   m_prioritiseAPEv2tags = false;
@@ -286,6 +292,8 @@ void CAdvancedSettings::Initialize()
   m_bVideoLibraryImportWatchedState = false;
   m_bVideoLibraryImportResumePoint = false;
   m_bVideoScannerIgnoreErrors = false;
+  m_bVideoScannerIncremental = true;
+  m_bVideoScannerUseChangeJournal = false;
   m_iVideoLibraryDateAdded = 1; // prefer mtime over ctime and current time
 
   m_iEpgLingerTime = 60 * 24;           /* keep 24 hours by default */
@@ -308,6 +316,7 @@ void CAdvancedSettings::Initialize()
   m_curlconnecttimeout = 10;
   m_curllowspeedtime = 20;
   m_curlretries = 2;
+  m_curlidletimeout = 30;
   m_curlDisableIPV6 = false;      //Certain hardware/OS combinations have trouble
                                   //with ipv6.
 
@@ -357,6 +366,8 @@ void CAdvancedSettings::Initialize()
   // the following setting determines the readRate of a player data
   // as multiply of the default data read rate
   m_readBufferFactor = 4.0f;
+  m_networkPersistentDirCache = false;
+  m_cacheSegmentedSize = 0;
   m_addonPackageFolderSize = 200;
 
   m_jsonOutputCompact = true;
@@ -368,6 +379,7 @@ void CAdvancedSettings::Initialize()
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 3;
   m_guiDirtyRegionNoFlipTimeout = 0;
+  m_guiPrefetchRows = 2;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
 
@@ -734,6 +746,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetBoolean(pElement, "allitemsonbottom", m_bMusicLibraryAllItemsOnBottom);
     XMLUtils::GetBoolean(pElement, "albumssortbyartistthenyear", m_bMusicLibraryAlbumsSortByArtistThenYear);
     XMLUtils::GetBoolean(pElement, "cleanonupdate", m_bMusicLibraryCleanOnUpdate);
+    XMLUtils::GetInt(pElement, "tagreaders", m_iMusicLibraryTagReaders, 1, 16);
     XMLUtils::GetString(pElement, "albumformat", m_strMusicLibraryAlbumFormat);
     XMLUtils::GetString(pElement, "albumformatright", m_strMusicLibraryAlbumFormatRight);
     XMLUtils::GetString(pElement, "itemseparator", m_musicItemSeparator);
@@ -758,6 +771,8 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
   if (pElement)
   {
     XMLUtils::GetBoolean(pElement, "ignoreerrors", m_bVideoScannerIgnoreErrors);
+    XMLUtils::GetBoolean(pElement, "incremental", m_bVideoScannerIncremental);
+    XMLUtils::GetBoolean(pElement, "changejournal", m_bVideoScannerUseChangeJournal);
   }
 
   // Backward-compatibility of ExternalPlayer config
@@ -780,10 +795,13 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "curlclienttimeout", m_curlconnecttimeout, 1, 1000);
     XMLUtils::GetInt(pElement, "curllowspeedtime", m_curllowspeedtime, 1, 1000);
     XMLUtils::GetInt(pElement, "curlretries", m_curlretries, 0, 10);
+    XMLUtils::GetInt(pElement, "curlidletimeout", m_curlidletimeout, 1, 3600);
     XMLUtils::GetBoolean(pElement,"disableipv6", m_curlDisableIPV6);
     XMLUtils::GetUInt(pElement, "cachemembuffersize", m_cacheMemBufferSize);
     XMLUtils::GetUInt(pElement, "buffermode", m_networkBufferMode, 0, 3);
     XMLUtils::GetFloat(pElement, "readbufferfactor", m_readBufferFactor);
+    XMLUtils::GetBoolean(pElement, "persistentdircache", m_networkPersistentDirCache);
+    XMLUtils::GetUInt(pElement, "segmentedcachesize", m_cacheSegmentedSize);
   }
 
   pElement = pRootElement->FirstChildElement("jsonrpc");
@@ -995,6 +1013,16 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
 #if !defined(TARGET_RASPBERRY_PI)
   XMLUtils::GetBoolean(pRootElement, "useddsfanart", m_useDDSFanart);
 #endif
+
+  pElement = pRootElement->FirstChildElement("texturecache");
+  if (pElement)
+  {
+    XMLUtils::GetUInt(pElement, "fetchthreads", m_textureCacheFetchThreads, 1, 16);
+    XMLUtils::GetUInt(pElement, "decodethreads", m_textureCacheDecodeThreads, 1, 16);
+    XMLUtils::GetUInt(pElement, "scalethreads", m_textureCacheScaleThreads, 1, 16);
+    XMLUtils::GetUInt(pElement, "encodethreads", m_textureCacheEncodeThreads, 1, 16);
+    XMLUtils::GetBoolean(pElement, "compress", m_textureCacheCompress);
+  }
   XMLUtils::GetBoolean(pRootElement, "playlistasfolders", m_playlistAsFolders);
   XMLUtils::GetBoolean(pRootElement, "detectasudf", m_detectAsUdf);
 
@@ -1137,6 +1165,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetInt(pElement, "nofliptimeout",             m_guiDirtyRegionNoFlipTimeout);
+    XMLUtils::GetInt(pElement, "prefetchrows",              m_guiPrefetchRows, 0, 20);
   }
 
   std::string seekSteps;
@@ -252,6 +252,11 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
      */
     unsigned int GetThumbSize() const { return m_imageRes / 2; };
     bool m_useDDSFanart;
+    unsigned int m_textureCacheFetchThreads;  ///< \brief threads reading images to cache
+    unsigned int m_textureCacheDecodeThreads; ///< \brief threads decoding images to cache
+    unsigned int m_textureCacheScaleThreads;  ///< \brief threads resizing images to cache
+    unsigned int m_textureCacheEncodeThreads; ///< \brief threads saving cached images
+    bool m_textureCacheCompress;              ///< \brief keep block compressed (.dds) versions of cached images for the GUI
 
     int m_sambaclienttimeout;
     std::string m_sambadoscodepage;
@@ -268,6 +273,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_bMusicLibraryAllItemsOnBottom;
     bool m_bMusicLibraryAlbumsSortByArtistThenYear;
     bool m_bMusicLibraryCleanOnUpdate;
+    int m_iMusicLibraryTagReaders;
     std::string m_strMusicLibraryAlbumFormat;
     std::string m_strMusicLibraryAlbumFormatRight;
     bool m_prioritiseAPEv2tags;
@@ -285,6 +291,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_bVideoLibraryImportResumePoint;
 
     bool m_bVideoScannerIgnoreErrors;
+    bool m_bVideoScannerIncremental;
+    bool m_bVideoScannerUseChangeJournal;
     int m_iVideoLibraryDateAdded;
 
     std::set<std::string> m_vecTokens;
@@ -310,6 +318,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_curlconnecttimeout;
     int m_curllowspeedtime;
     int m_curlretries;
+    int m_curlidletimeout;          // seconds an unused connection is kept alive
     bool m_curlDisableIPV6;
 
     bool m_fullScreen;
@@ -362,11 +371,14 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    int  m_guiPrefetchRows;
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
     unsigned int m_networkBufferMode;
     float m_readBufferFactor;
+    bool m_networkPersistentDirCache; ///< \brief keep listings of network shares on disk, revalidated by directory mtime
+    unsigned int m_cacheSegmentedSize; ///< \brief memory for keeping several cached ranges of a file, 0 for a single range
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
@@ -88,6 +88,7 @@ void CSkinSettings::SetString(int setting, const string &label)
   if (it != m_strings.end())
   {
     it->second.value = label;
+    g_infoManager.InvalidateInfoSource(CGUIInfoManager::INFOSOURCE_SKIN);
     return;
   }
 
@@ -135,6 +136,7 @@ void CSkinSettings::SetBool(int setting, bool set)
   if (it != m_bools.end())
   {
     it->second.value = set;
+    g_infoManager.InvalidateInfoSource(CGUIInfoManager::INFOSOURCE_SKIN);
     return;
   }
 
@@ -153,6 +155,7 @@ void CSkinSettings::Reset(const string &setting)
     if (StringUtils::EqualsNoCase(settingName, it->second.name))
     {
       it->second.value.clear();
+      g_infoManager.InvalidateInfoSource(CGUIInfoManager::INFOSOURCE_SKIN);
       return;
     }
   }
@@ -163,6 +166,7 @@ void CSkinSettings::Reset(const string &setting)
     if (StringUtils::EqualsNoCase(settingName, it->second.name))
     {
       it->second.value = false;
+      g_infoManager.InvalidateInfoSource(CGUIInfoManager::INFOSOURCE_SKIN);
       return;
     }
   }
@@ -186,6 +190,7 @@ void CSkinSettings::Reset()
       it->second.value.clear();
   }
 
+  g_infoManager.InvalidateInfoSource(CGUIInfoManager::INFOSOURCE_SKIN);
   g_infoManager.ResetCache();
 }
 
@@ -227,6 +232,7 @@ bool CSkinSettings::Load(const TiXmlNode *settings)
     }
     pChild = pChild->NextSiblingElement(XML_SETTING);
   }
+  g_infoManager.InvalidateInfoSource(CGUIInfoManager::INFOSOURCE_SKIN);
 
   return true;
 }
@@ -275,6 +281,7 @@ void CSkinSettings::Clear()
   CSingleLock lock(m_critical);
   m_strings.clear();
   m_bools.clear();
+  g_infoManager.InvalidateInfoSource(CGUIInfoManager::INFOSOURCE_SKIN);
 }
 
 std::string CSkinSettings::GetCurrentSkin() const
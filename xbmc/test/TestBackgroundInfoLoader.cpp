@@ -0,0 +1,137 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "BackgroundInfoLoader.h"
+#include "FileItem.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
+#include "utils/Variant.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+class CRecordingLoader : public CBackgroundInfoLoader
+{
+public:
+  CRecordingLoader() : m_focus(-1), m_jumpAfter(0), m_jumpTo(-1) {}
+
+  virtual bool LoadItemCached(CFileItem* pItem)
+  {
+    m_cached.push_back(Index(pItem));
+    if ((int)m_cached.size() == m_jumpAfter)
+      SetFocusItem(m_pVecItems->Get(m_jumpTo));
+    return false;
+  }
+
+  virtual bool LoadItemLookup(CFileItem* pItem)
+  {
+    m_lookups.push_back(Index(pItem));
+    return false;
+  }
+
+  int m_focus;
+  int m_jumpAfter;
+  int m_jumpTo;
+  std::vector<int> m_cached;
+  std::vector<int> m_lookups;
+
+protected:
+  virtual void OnLoaderStart()
+  {
+    if (m_focus >= 0)
+      SetFocusItem(m_pVecItems->Get(m_focus));
+  }
+
+private:
+  int Index(const CFileItem *item) const
+  {
+    return (int)item->GetProperty("index").asInteger();
+  }
+};
+
+void FillItems(CFileItemList &items, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    CFileItemPtr item(new CFileItem(StringUtils::Format("item %i", i)));
+    item->SetProperty("index", i);
+    items.Add(item);
+  }
+}
+
+void WaitForLoader(CBackgroundInfoLoader &loader)
+{
+  while (loader.IsLoading())
+    XbmcThreads::ThreadSleep(1);
+}
+}
+
+TEST(TestBackgroundInfoLoader, InOrder)
+{
+  CFileItemList items;
+  FillItems(items, 100);
+
+  CRecordingLoader loader;
+  loader.Load(items);
+  WaitForLoader(loader);
+
+  ASSERT_EQ(100U, loader.m_cached.size());
+  ASSERT_EQ(100U, loader.m_lookups.size());
+  for (int i = 0; i < 100; i++)
+  {
+    EXPECT_EQ(i, loader.m_cached[i]);
+    EXPECT_EQ(i, loader.m_lookups[i]);
+  }
+}
+
+TEST(TestBackgroundInfoLoader, FocusFirst)
+{
+  CFileItemList items;
+  FillItems(items, 1000);
+
+  // start around item 500, jump to item 100 while on the second page
+  CRecordingLoader loader;
+  loader.m_focus = 500;
+  loader.m_jumpAfter = 30;
+  loader.m_jumpTo = 100;
+  loader.Load(items);
+  WaitForLoader(loader);
+
+  // every item is loaded once
+  ASSERT_EQ(1000U, loader.m_cached.size());
+  std::vector<int> sorted(loader.m_cached);
+  std::sort(sorted.begin(), sorted.end());
+  for (int i = 0; i < 1000; i++)
+    ASSERT_EQ(i, sorted[i]);
+
+  // the page in view and the next one, then the page around the new focus
+  for (int i = 0; i < 40; i++)
+    EXPECT_EQ(490 + i, loader.m_cached[i]);
+  for (int i = 0; i < 20; i++)
+    EXPECT_EQ(90 + i, loader.m_cached[40 + i]);
+
+  // lookups start at the last item in view
+  ASSERT_EQ(1000U, loader.m_lookups.size());
+  EXPECT_EQ(90, loader.m_lookups[0]);
+}
@@ -0,0 +1,107 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIInfoManager.h"
+#include "guilib/GUIInfoTypes.h"
+#include "settings/SkinSettings.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+
+#define SKIN_STRING_LABEL "$INFO[Skin.String(TestGUIInfoTypes)]"
+
+namespace
+{
+// changes the skin string without telling anyone, like a source that isn't versioned would
+void SetStringQuietly(int setting, const std::string &value)
+{
+  const_cast<std::string&>(CSkinSettings::Get().GetString(setting)) = value;
+}
+}
+
+class TestGUIInfoLabel : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    m_setting = CSkinSettings::Get().TranslateString("TestGUIInfoTypes");
+    CSkinSettings::Get().SetString(m_setting, "one");
+  }
+
+  virtual void TearDown()
+  {
+    CSkinSettings::Get().SetString(m_setting, "");
+  }
+
+  int m_setting;
+};
+
+TEST_F(TestGUIInfoLabel, SkinStringResolvedOnSet)
+{
+  CGUIInfoLabel label(SKIN_STRING_LABEL);
+  EXPECT_EQ("one", label.GetLabel(0));
+
+  // frames go by, the label is kept until the skin settings change
+  SetStringQuietly(m_setting, "two");
+  g_infoManager.ResetCache();
+  EXPECT_EQ("one", label.GetLabel(0));
+  g_infoManager.ResetCache();
+  EXPECT_EQ("one", label.GetLabel(0));
+
+  CSkinSettings::Get().SetString(m_setting, "three");
+  EXPECT_EQ("three", label.GetLabel(0));
+}
+
+TEST_F(TestGUIInfoLabel, UnclassifiedVersion)
+{
+  EXPECT_EQ(0U, g_infoManager.GetInfoVersion(0));
+  EXPECT_EQ(0U, g_infoManager.GetInfoVersion(g_infoManager.TranslateString("System.BuildVersion")));
+  EXPECT_EQ(0U, g_infoManager.GetInfoVersion(g_infoManager.TranslateString("System.FreeMemory")));
+  EXPECT_EQ(0U, g_infoManager.GetInfoVersion(g_infoManager.TranslateString("Container.FolderPath")));
+
+  // whereas versioned labels change version along with their source
+  int info = g_infoManager.TranslateString("Skin.String(TestGUIInfoTypes)");
+  unsigned int version = g_infoManager.GetInfoVersion(info);
+  EXPECT_NE(0U, version);
+  EXPECT_EQ(version, g_infoManager.GetInfoVersion(info));
+  CSkinSettings::Get().SetString(m_setting, "two");
+  EXPECT_NE(version, g_infoManager.GetInfoVersion(info));
+}
+
+TEST_F(TestGUIInfoLabel, ContextAndImageResolved)
+{
+  CGUIInfoLabel label(SKIN_STRING_LABEL);
+  EXPECT_EQ("one", label.GetLabel(0));
+
+  // another context window is resolved again
+  SetStringQuietly(m_setting, "two");
+  EXPECT_EQ("one", label.GetLabel(0));
+  EXPECT_EQ("two", label.GetLabel(1));
+
+  // and so is asking for an image instead
+  SetStringQuietly(m_setting, "three");
+  EXPECT_EQ("two", label.GetLabel(1));
+  EXPECT_EQ("three", label.GetLabel(1, true));
+
+  // as is going back to the first context
+  SetStringQuietly(m_setting, "four");
+  EXPECT_EQ("four", label.GetLabel(0));
+}
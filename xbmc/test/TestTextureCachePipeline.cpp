@@ -0,0 +1,256 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TextureCacheJob.h"
+#include "TextureCachePipeline.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/Atomics.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+// none of the images exist, so every job fails in its fetch stage
+std::string GetImage(int i)
+{
+  return StringUtils::Format("special://temp/texturecachepipeline/%i.jpg", i);
+}
+
+class CCountedJob : public CTextureCacheJob
+{
+public:
+  CCountedJob(const std::string &url, volatile long &deleted)
+    : CTextureCacheJob(url)
+    , m_deleted(deleted)
+  {
+  }
+
+  virtual ~CCountedJob()
+  {
+    AtomicIncrement(&m_deleted);
+  }
+
+private:
+  volatile long &m_deleted;
+};
+
+/*! Keeps a processing list like CTextureCache does, and holds jobs for
+ m_gateUrl in OnCachingStart() until the gate is opened.
+ */
+class CTestCallback : public ITextureCacheCallback
+{
+public:
+  CTestCallback() : m_refused(0), m_succeeded(0) {}
+
+  virtual bool OnCachingStart(CTextureCacheJob *job)
+  {
+    {
+      CSingleLock lock(m_section);
+      m_started.push_back(job->m_url);
+      if (!m_processing.insert(job->m_url).second)
+      {
+        m_refused++;
+        return false;
+      }
+    }
+    if (job->m_url == m_gateUrl)
+    {
+      m_blocked.Set();
+      m_gate.WaitMSec(5000);
+    }
+    return true;
+  }
+
+  virtual void OnCachingComplete(bool success, CTextureCacheJob *job)
+  {
+    CSingleLock lock(m_section);
+    m_processing.erase(job->m_url);
+    m_completed.push_back(job->m_url);
+    if (success)
+      m_succeeded++;
+  }
+
+  CCriticalSection m_section;
+  std::vector<std::string> m_started;
+  std::vector<std::string> m_completed;
+  std::set<std::string> m_processing;
+  volatile long m_refused;
+  int m_succeeded;
+
+  std::string m_gateUrl;
+  CEvent m_gate;
+  CEvent m_blocked;
+};
+
+class CPipelineStopper : public CThread
+{
+public:
+  CPipelineStopper(CTextureCachePipeline &pipeline)
+    : CThread("TestTextureCachePipeline")
+    , m_pipeline(pipeline)
+  {
+  }
+
+protected:
+  virtual void Process()
+  {
+    m_pipeline.Stop();
+  }
+
+private:
+  CTextureCachePipeline &m_pipeline;
+};
+
+bool WaitForCount(volatile long &count, long expected, unsigned int milliseconds)
+{
+  CCriticalSection section;
+  for (unsigned int i = 0; i < milliseconds; i++)
+  {
+    {
+      CSingleLock lock(section); // kick any memory syncs
+      if (count == expected)
+        return true;
+    }
+    XbmcThreads::ThreadSleep(1);
+  }
+  return false;
+}
+}
+
+class TestTextureCachePipeline : public ::testing::Test
+{
+protected:
+  TestTextureCachePipeline() : m_deleted(0) {}
+
+  virtual void SetUp()
+  {
+    m_fetchThreads = g_advancedSettings.m_textureCacheFetchThreads;
+  }
+
+  virtual void TearDown()
+  {
+    g_advancedSettings.m_textureCacheFetchThreads = m_fetchThreads;
+  }
+
+  unsigned int m_fetchThreads;
+  volatile long m_deleted;
+};
+
+TEST_F(TestTextureCachePipeline, Ordering)
+{
+  // a single fetch worker takes the jobs in the order they were added
+  g_advancedSettings.m_textureCacheFetchThreads = 1;
+  CTestCallback callback;
+  CTextureCachePipeline pipeline(&callback);
+
+  std::vector<std::string> images;
+  for (int i = 0; i < 10; i++)
+  {
+    images.push_back(GetImage(i));
+    EXPECT_TRUE(pipeline.AddJob(new CCountedJob(images.back(), m_deleted), true));
+  }
+  ASSERT_TRUE(pipeline.WaitIdle(5000));
+
+  EXPECT_EQ(images, callback.m_started);
+  EXPECT_EQ(images, callback.m_completed);
+  EXPECT_EQ(0, callback.m_succeeded);
+  EXPECT_EQ(0U, pipeline.GetCompletedCount());
+  EXPECT_EQ(10, m_deleted);
+}
+
+TEST_F(TestTextureCachePipeline, SameUrlCachedOnce)
+{
+  // requests for an image that is being cached are refused by the callback while the first is running
+  g_advancedSettings.m_textureCacheFetchThreads = 4;
+  CTestCallback callback;
+  callback.m_gateUrl = GetImage(0);
+  CTextureCachePipeline pipeline(&callback);
+
+  for (int i = 0; i < 4; i++)
+    EXPECT_TRUE(pipeline.AddJob(new CCountedJob(GetImage(0), m_deleted)));
+
+  ASSERT_TRUE(callback.m_blocked.WaitMSec(5000));
+  EXPECT_TRUE(WaitForCount(callback.m_refused, 3, 5000));
+  EXPECT_TRUE(WaitForCount(m_deleted, 3, 5000));
+  callback.m_gate.Set();
+  ASSERT_TRUE(pipeline.WaitIdle(5000));
+
+  EXPECT_EQ(4U, callback.m_started.size());
+  ASSERT_EQ(1U, callback.m_completed.size());
+  EXPECT_EQ(GetImage(0), callback.m_completed[0]);
+  EXPECT_TRUE(callback.m_processing.empty());
+  EXPECT_EQ(4, m_deleted);
+
+  // once it's done the image may be requested again
+  EXPECT_TRUE(pipeline.AddJob(new CCountedJob(GetImage(0), m_deleted)));
+  ASSERT_TRUE(pipeline.WaitIdle(5000));
+  EXPECT_EQ(2U, callback.m_completed.size());
+  EXPECT_EQ(5, m_deleted);
+}
+
+TEST_F(TestTextureCachePipeline, Stop)
+{
+  g_advancedSettings.m_textureCacheFetchThreads = 1;
+  CTestCallback callback;
+  callback.m_gateUrl = GetImage(0);
+  CTextureCachePipeline pipeline(&callback);
+
+  // the first job holds up the only fetch worker, the others stay queued
+  EXPECT_TRUE(pipeline.AddJob(new CCountedJob(GetImage(0), m_deleted)));
+  ASSERT_TRUE(callback.m_blocked.WaitMSec(5000));
+  for (int i = 1; i < 6; i++)
+    EXPECT_TRUE(pipeline.AddJob(new CCountedJob(GetImage(i), m_deleted)));
+
+  // queued jobs are dropped right away, Stop() waits for the running one
+  CPipelineStopper stopper(pipeline);
+  stopper.Create();
+  EXPECT_TRUE(WaitForCount(m_deleted, 5, 5000));
+  EXPECT_FALSE(stopper.WaitForThreadExit(100));
+
+  // nothing is taken while stopped
+  EXPECT_FALSE(pipeline.AddJob(new CCountedJob(GetImage(6), m_deleted)));
+  EXPECT_EQ(6, m_deleted);
+
+  callback.m_gate.Set();
+  EXPECT_TRUE(stopper.WaitForThreadExit(5000));
+  EXPECT_TRUE(pipeline.WaitIdle(0));
+
+  // only the running job was started, and it is passed back as failed
+  ASSERT_EQ(1U, callback.m_started.size());
+  ASSERT_EQ(1U, callback.m_completed.size());
+  EXPECT_EQ(GetImage(0), callback.m_completed[0]);
+  EXPECT_EQ(0, callback.m_succeeded);
+  EXPECT_EQ(7, m_deleted);
+
+  // and jobs are taken again after Start()
+  pipeline.Start();
+  EXPECT_TRUE(pipeline.AddJob(new CCountedJob(GetImage(7), m_deleted)));
+  ASSERT_TRUE(pipeline.WaitIdle(5000));
+  EXPECT_EQ(2U, callback.m_started.size());
+  EXPECT_EQ(8, m_deleted);
+}
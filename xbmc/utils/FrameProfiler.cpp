@@ -0,0 +1,209 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FrameProfiler.h"
+#include "threads/SingleLock.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
+
+#include <algorithm>
+
+// upper bucket limits in microseconds, chosen around the frame periods of
+// the common refresh rates. The last bucket takes everything above.
+static const uint32_t bucketLimits[] = { 1000, 2000, 4000, 8000, 12000, 16700, 20000, 25000,
+                                         33400, 41700, 50000, 66700, 100000, 200000, 0 };
+static const unsigned int bucketCount = sizeof(bucketLimits) / sizeof(bucketLimits[0]);
+
+static const char* stageNames[FRAME_STAGE_COUNT] = { "frame", "process", "dirtyregions", "render",
+                                                     "fontcache", "textureupload", "video", "present" };
+
+CFrameProfiler::CStage::CStage()
+  : m_frames(FRAME_PROFILER_FRAMES, 0),
+    m_histogram(bucketCount, 0),
+    m_next(0),
+    m_count(0),
+    m_sum(0)
+{
+}
+
+void CFrameProfiler::CStage::Push(uint32_t us)
+{
+  if (m_count == FRAME_PROFILER_FRAMES)
+  {
+    // the oldest frame leaves the ring
+    uint32_t old = m_frames[m_next];
+    m_histogram[GetBucket(old)]--;
+    m_sum -= old;
+  }
+  else
+    m_count++;
+
+  m_frames[m_next] = us;
+  m_histogram[GetBucket(us)]++;
+  m_sum += us;
+  m_next = (m_next + 1) % FRAME_PROFILER_FRAMES;
+}
+
+void CFrameProfiler::CStage::Reset()
+{
+  std::fill(m_histogram.begin(), m_histogram.end(), 0);
+  m_next = 0;
+  m_count = 0;
+  m_sum = 0;
+}
+
+void CFrameProfiler::CStage::GetStats(FrameStageStats &stats) const
+{
+  stats.frames = m_count;
+  stats.histogram = m_histogram;
+  stats.average = stats.median = stats.p95 = stats.maximum = 0.0f;
+  if (m_count == 0)
+    return;
+
+  std::vector<uint32_t> sorted(m_frames.begin(), m_frames.begin() + m_count);
+  std::sort(sorted.begin(), sorted.end());
+  stats.average = m_sum / 1000.0f / m_count;
+  stats.median  = sorted[(m_count - 1) / 2] / 1000.0f;
+  stats.p95     = sorted[(m_count - 1) * 95 / 100] / 1000.0f;
+  stats.maximum = sorted.back() / 1000.0f;
+}
+
+CFrameProfiler& CFrameProfiler::Get()
+{
+  static CFrameProfiler sProfiler;
+  return sProfiler;
+}
+
+CFrameProfiler::CFrameProfiler()
+  : m_frameStart(0),
+    m_frequency(CurrentHostFrequency())
+{
+  std::fill(m_current, m_current + FRAME_STAGE_COUNT, 0);
+}
+
+void CFrameProfiler::AddTime(FrameStage stage, int64_t ticks)
+{
+  CSingleLock lock(m_section);
+  m_current[stage] += ticks;
+}
+
+void CFrameProfiler::EndFrame()
+{
+  int64_t now = CurrentHostCounter();
+
+  CSingleLock lock(m_section);
+  if (m_frameStart)
+  {
+    m_current[FRAME_STAGE_FRAME] = now - m_frameStart;
+    for (unsigned int i = 0; i < FRAME_STAGE_COUNT; i++)
+    {
+      int64_t us = m_current[i] * 1000000 / m_frequency;
+      m_stages[i].Push((uint32_t)std::min<int64_t>(us, 0xFFFFFFFF));
+    }
+  }
+  std::fill(m_current, m_current + FRAME_STAGE_COUNT, 0);
+  m_frameStart = now;
+}
+
+void CFrameProfiler::Reset()
+{
+  CSingleLock lock(m_section);
+  for (unsigned int i = 0; i < FRAME_STAGE_COUNT; i++)
+    m_stages[i].Reset();
+  std::fill(m_current, m_current + FRAME_STAGE_COUNT, 0);
+  m_frameStart = 0;
+}
+
+void CFrameProfiler::GetStats(std::vector<FrameStageStats> &stats) const
+{
+  stats.clear();
+  stats.resize(FRAME_STAGE_COUNT);
+
+  CSingleLock lock(m_section);
+  for (unsigned int i = 0; i < FRAME_STAGE_COUNT; i++)
+  {
+    stats[i].name = stageNames[i];
+    m_stages[i].GetStats(stats[i]);
+  }
+}
+
+void CFrameProfiler::GetStats(CVariant &stats) const
+{
+  std::vector<FrameStageStats> stages;
+  GetStats(stages);
+
+  stats = CVariant(CVariant::VariantTypeObject);
+  stats["frames"] = stages[FRAME_STAGE_FRAME].frames;
+  stats["buckets"] = CVariant(CVariant::VariantTypeArray);
+  for (unsigned int i = 0; i < bucketCount; i++)
+    stats["buckets"].push_back(GetBucketLimit(i));
+
+  stats["stages"] = CVariant(CVariant::VariantTypeObject);
+  for (std::vector<FrameStageStats>::const_iterator it = stages.begin(); it != stages.end(); ++it)
+  {
+    CVariant stage(CVariant::VariantTypeObject);
+    stage["average"] = it->average;
+    stage["median"] = it->median;
+    stage["p95"] = it->p95;
+    stage["max"] = it->maximum;
+    stage["histogram"] = CVariant(CVariant::VariantTypeArray);
+    for (std::vector<unsigned int>::const_iterator bucket = it->histogram.begin(); bucket != it->histogram.end(); ++bucket)
+      stage["histogram"].push_back(*bucket);
+    stats["stages"][it->name] = stage;
+  }
+}
+
+const char* CFrameProfiler::GetStageName(FrameStage stage)
+{
+  if (stage < 0 || stage >= FRAME_STAGE_COUNT)
+    return "";
+  return stageNames[stage];
+}
+
+float CFrameProfiler::GetBucketLimit(unsigned int bucket)
+{
+  if (bucket >= bucketCount)
+    return 0.0f;
+  return bucketLimits[bucket] / 1000.0f;
+}
+
+unsigned int CFrameProfiler::GetBucketCount()
+{
+  return bucketCount;
+}
+
+unsigned int CFrameProfiler::GetBucket(uint32_t us)
+{
+  unsigned int bucket = 0;
+  while (bucket < bucketCount - 1 && us > bucketLimits[bucket])
+    bucket++;
+  return bucket;
+}
+
+CFrameProfileScope::CFrameProfileScope(FrameStage stage)
+  : m_stage(stage),
+    m_start(CurrentHostCounter())
+{
+}
+
+CFrameProfileScope::~CFrameProfileScope()
+{
+  CFrameProfiler::Get().AddTime(m_stage, CurrentHostCounter() - m_start);
+}
@@ -0,0 +1,166 @@
+#pragma once
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/CriticalSection.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define FRAME_PROFILER_FRAMES 256
+
+class CVariant;
+
+/*!
+ \brief Stages of a GUI frame the frame profiler keeps timings for
+
+ Stages may nest, e.g. font caching and texture uploads usually happen
+ while processing or rendering, so their time is included in those too.
+ */
+enum FrameStage
+{
+  FRAME_STAGE_FRAME = 0,     ///< the whole frame, from one presented frame to the next
+  FRAME_STAGE_PROCESS,       ///< processing of the windows and controls
+  FRAME_STAGE_DIRTY_REGIONS, ///< solving of the dirty regions
+  FRAME_STAGE_RENDER,        ///< rendering of the GUI and video into the back buffer
+  FRAME_STAGE_FONT_CACHE,    ///< rasterizing glyphs into the font caches
+  FRAME_STAGE_TEXTURE_UPLOAD,///< uploading textures to the GPU
+  FRAME_STAGE_VIDEO,         ///< rendering of the current video picture
+  FRAME_STAGE_PRESENT,       ///< presenting the back buffer
+  FRAME_STAGE_COUNT
+};
+
+/*!
+ \brief Timing statistics of one frame stage over the most recent frames
+ All times are in milliseconds.
+ */
+struct FrameStageStats
+{
+  FrameStageStats() : frames(0), average(0.0f), median(0.0f), p95(0.0f), maximum(0.0f) {}
+
+  std::string name;
+  unsigned int frames;                  ///< number of frames the statistics cover
+  float average;
+  float median;
+  float p95;
+  float maximum;
+  std::vector<unsigned int> histogram;  ///< frames per bucket, see CFrameProfiler::GetBucketLimit()
+};
+
+/*!
+ \brief Low overhead per stage frame timings
+
+ Time spent in each stage is summed up over a frame. When the frame ends
+ the sums are stored in a ring buffer of the last FRAME_PROFILER_FRAMES
+ frames per stage, along with a histogram of the same frames which is
+ kept up to date as frames enter and leave the ring.
+
+ Recording is always on, it only costs a couple of counter reads per
+ stage and frame.
+ */
+class CFrameProfiler
+{
+public:
+  static CFrameProfiler& Get();
+
+  /*!
+   \brief add time spent in a stage during the current frame
+   \param stage the stage the time was spent in
+   \param ticks the time in CurrentHostCounter() ticks
+   */
+  void AddTime(FrameStage stage, int64_t ticks);
+
+  /*!
+   \brief end the current frame
+   Stores the time added to each stage and the time since the previous
+   call as the frame time.
+   */
+  void EndFrame();
+
+  /*!
+   \brief drop all recorded frames
+   */
+  void Reset();
+
+  /*!
+   \brief get the statistics of all stages
+   \param stats will hold one entry per stage, in FrameStage order
+   */
+  void GetStats(std::vector<FrameStageStats> &stats) const;
+
+  /*!
+   \brief get the statistics of all stages as a JSON-RPC friendly object
+   */
+  void GetStats(CVariant &stats) const;
+
+  static const char* GetStageName(FrameStage stage);
+
+  /*!
+   \brief get the upper limit of a histogram bucket
+   \param bucket index of the bucket
+   \return the upper limit in milliseconds, 0 for the last bucket which has no limit
+   */
+  static float GetBucketLimit(unsigned int bucket);
+  static unsigned int GetBucketCount();
+
+private:
+  CFrameProfiler();
+  CFrameProfiler(const CFrameProfiler&);
+  CFrameProfiler& operator=(const CFrameProfiler&);
+
+  static unsigned int GetBucket(uint32_t us);
+
+  class CStage
+  {
+  public:
+    CStage();
+    void Push(uint32_t us);
+    void Reset();
+    void GetStats(FrameStageStats &stats) const;
+
+  private:
+    std::vector<uint32_t> m_frames;     ///< ring of frame times in microseconds
+    std::vector<unsigned int> m_histogram;
+    unsigned int m_next;
+    unsigned int m_count;
+    uint64_t m_sum;
+  };
+
+  mutable CCriticalSection m_section;
+  CStage m_stages[FRAME_STAGE_COUNT];
+  int64_t m_current[FRAME_STAGE_COUNT]; ///< ticks spent in each stage during the current frame
+  int64_t m_frameStart;
+  int64_t m_frequency;
+};
+
+/*!
+ \brief Adds the time spent in a scope to a frame stage
+ */
+class CFrameProfileScope
+{
+public:
+  explicit CFrameProfileScope(FrameStage stage);
+  ~CFrameProfileScope();
+
+private:
+  FrameStage m_stage;
+  int64_t m_start;
+};
@@ -18,114 +18,223 @@
  *
  */
 
-#include <locale>
+#include <math.h>
+#include <stdio.h>
 
 #include "JSONVariantWriter.h"
 
 using namespace std;
 
-string CJSONVariantWriter::Write(const CVariant &value, bool compact)
+namespace
 {
-  string output;
+// what a response of a few items needs, saves most reallocations
+const size_t INITIAL_BUFFER_SIZE = 4096;
 
-  yajl_gen g = yajl_gen_alloc(NULL);
-  yajl_gen_config(g, yajl_gen_beautify, compact ? 0 : 1);
-  yajl_gen_config(g, yajl_gen_indent_string, "\t");
+template<typename T>
+void WriteUnsigned(T value, string &output)
+{
+  char buffer[24];
+  char *end = buffer + sizeof(buffer);
+  char *start = end;
+  do
+  {
+    *--start = (char)('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  output.append(start, end - start);
+}
 
-  // Set locale to classic ("C") to ensure valid JSON numbers
-#ifndef TARGET_WINDOWS
-  const char *currentLocale = setlocale(LC_NUMERIC, NULL);
-  std::string backupLocale;
-  if (currentLocale != NULL && (currentLocale[0] != 'C' || currentLocale[1] != 0))
+void WriteInteger(int64_t value, string &output)
+{
+  if (value < 0)
   {
-    backupLocale = currentLocale;
-    setlocale(LC_NUMERIC, "C");
+    output += '-';
+    WriteUnsigned(0 - (uint64_t)value, output);
   }
-#else  // TARGET_WINDOWS
-  const wchar_t* const currentLocale = _wsetlocale(LC_NUMERIC, NULL);
-  std::wstring backupLocale;
-  if (currentLocale != NULL && (currentLocale[0] != L'C' || currentLocale[1] != 0))
+  else
+    WriteUnsigned((uint64_t)value, output);
+}
+
+void WriteDouble(double value, string &output)
+{
+  // JSON has no representation for these
+  if (isnan(value) || isinf(value))
   {
-    backupLocale = currentLocale;
-    _wsetlocale(LC_NUMERIC, L"C");
+    output.append("null", 4);
+    return;
   }
-#endif // TARGET_WINDOWS
 
-  if (InternalWrite(g, value))
+  char buffer[64];
+  int length = snprintf(buffer, sizeof(buffer), "%.20g", value);
+  if (length <= 0 || length >= (int)sizeof(buffer))
   {
-    const unsigned char * buffer;
-
-    size_t length;
-    yajl_gen_get_buf(g, &buffer, &length);
-    output = string((const char *)buffer, length);
+    output.append("null", 4);
+    return;
   }
 
-  // Re-set locale to what it was before using yajl
-#ifndef TARGET_WINDOWS
-  if (!backupLocale.empty())
-    setlocale(LC_NUMERIC, backupLocale.c_str());
-#else  // TARGET_WINDOWS
-  if (!backupLocale.empty())
-    _wsetlocale(LC_NUMERIC, backupLocale.c_str());
-#endif // TARGET_WINDOWS
+  // snprintf uses the decimal point of the current locale, replace it by a
+  // dot instead of switching the (process wide) locale around every write
+  bool integral = true;
+  bool separator = false;
+  for (int i = 0; i < length; i++)
+  {
+    char c = buffer[i];
+    if ((c >= '0' && c <= '9') || c == '-')
+      separator = false;
+    else if (c == 'e' || c == 'E' || c == '+')
+    {
+      integral = false;
+      separator = false;
+    }
+    else
+    {
+      integral = false;
+      if (!separator)
+        output += '.';
+      separator = true;
+      continue;
+    }
+    output += c;
+  }
 
-  yajl_gen_clear(g);
-  yajl_gen_free(g);
+  // keep it a double for the reader
+  if (integral)
+    output.append(".0", 2);
+}
+}
 
+string CJSONVariantWriter::Write(const CVariant &value, bool compact)
+{
+  string output;
+  Write(value, output, compact);
   return output;
 }
 
-bool CJSONVariantWriter::InternalWrite(yajl_gen g, const CVariant &value)
+void CJSONVariantWriter::Write(const CVariant &value, string &output, bool compact)
 {
-  bool success = false;
+  if (output.capacity() - output.size() < INITIAL_BUFFER_SIZE)
+    output.reserve(output.size() + INITIAL_BUFFER_SIZE);
+
+  InternalWrite(value, output, compact, 0);
+  if (!compact)
+    output += '\n';
+}
 
+void CJSONVariantWriter::InternalWrite(const CVariant &value, string &output, bool compact, unsigned int depth)
+{
   switch (value.type())
   {
   case CVariant::VariantTypeInteger:
-    success = yajl_gen_status_ok == yajl_gen_integer(g, (long long int)value.asInteger());
+    WriteInteger(value.asInteger(), output);
     break;
   case CVariant::VariantTypeUnsignedInteger:
-    success = yajl_gen_status_ok == yajl_gen_integer(g, (long long int)value.asUnsignedInteger());
+    WriteUnsigned(value.asUnsignedInteger(), output);
     break;
   case CVariant::VariantTypeDouble:
-    success = yajl_gen_status_ok == yajl_gen_double(g, value.asDouble());
+    WriteDouble(value.asDouble(), output);
     break;
   case CVariant::VariantTypeBoolean:
-    success = yajl_gen_status_ok == yajl_gen_bool(g, value.asBoolean() ? 1 : 0);
+    if (value.asBoolean())
+      output.append("true", 4);
+    else
+      output.append("false", 5);
     break;
   case CVariant::VariantTypeString:
-    success = yajl_gen_status_ok == yajl_gen_string(g, (const unsigned char*)value.c_str(), (size_t)value.size());
+    WriteString(value.c_str(), value.size(), output);
     break;
   case CVariant::VariantTypeArray:
-    success = yajl_gen_status_ok == yajl_gen_array_open(g);
-
-    for (CVariant::const_iterator_array itr = value.begin_array(); itr != value.end_array() && success; ++itr)
-      success &= InternalWrite(g, *itr);
+    output += '[';
+    if (!compact)
+      output += '\n';
 
-    if (success)
-      success = yajl_gen_status_ok == yajl_gen_array_close(g);
+    for (CVariant::const_iterator_array itr = value.begin_array(); itr != value.end_array(); ++itr)
+    {
+      if (itr != value.begin_array())
+        output.append(compact ? "," : ",\n");
+      if (!compact)
+        WriteIndent(depth + 1, output);
+      InternalWrite(*itr, output, compact, depth + 1);
+    }
 
+    if (!compact)
+    {
+      output += '\n';
+      WriteIndent(depth, output);
+    }
+    output += ']';
     break;
   case CVariant::VariantTypeObject:
-    success = yajl_gen_status_ok == yajl_gen_map_open(g);
+    output += '{';
+    if (!compact)
+      output += '\n';
 
-    for (CVariant::const_iterator_map itr = value.begin_map(); itr != value.end_map() && success; ++itr)
+    for (CVariant::const_iterator_map itr = value.begin_map(); itr != value.end_map(); ++itr)
     {
-      success &= yajl_gen_status_ok == yajl_gen_string(g, (const unsigned char*)itr->first.c_str(), (size_t)itr->first.length());
-      if (success)
-        success &= InternalWrite(g, itr->second);
+      if (itr != value.begin_map())
+        output.append(compact ? "," : ",\n");
+      if (!compact)
+        WriteIndent(depth + 1, output);
+      WriteString(itr->first.c_str(), itr->first.size(), output);
+      output.append(compact ? ":" : ": ");
+      InternalWrite(itr->second, output, compact, depth + 1);
     }
 
-    if (success)
-      success &= yajl_gen_status_ok == yajl_gen_map_close(g);
-
+    if (!compact)
+    {
+      output += '\n';
+      WriteIndent(depth, output);
+    }
+    output += '}';
     break;
   case CVariant::VariantTypeConstNull:
   case CVariant::VariantTypeNull:
   default:
-    success = yajl_gen_status_ok == yajl_gen_null(g);
+    output.append("null", 4);
     break;
   }
+}
+
+void CJSONVariantWriter::WriteString(const char *str, size_t length, string &output)
+{
+  static const char hex[] = "0123456789ABCDEF";
 
-  return success;
+  output += '"';
+
+  // copy runs of characters that don't need escaping in one go
+  const char *run = str;
+  const char *end = str + length;
+  for (const char *c = str; c != end; ++c)
+  {
+    const unsigned char ch = (unsigned char)*c;
+    if (ch >= 0x20 && ch != '"' && ch != '\\')
+      continue;
+
+    output.append(run, c - run);
+    run = c + 1;
+
+    switch (ch)
+    {
+    case '"':  output.append("\\\"", 2); break;
+    case '\\': output.append("\\\\", 2); break;
+    case '\b': output.append("\\b", 2); break;
+    case '\f': output.append("\\f", 2); break;
+    case '\n': output.append("\\n", 2); break;
+    case '\r': output.append("\\r", 2); break;
+    case '\t': output.append("\\t", 2); break;
+    default:
+      {
+        char escaped[] = { '\\', 'u', '0', '0', hex[ch >> 4], hex[ch & 0xF] };
+        output.append(escaped, sizeof(escaped));
+      }
+      break;
+    }
+  }
+  output.append(run, end - run);
+
+  output += '"';
+}
+
+void CJSONVariantWriter::WriteIndent(unsigned int depth, string &output)
+{
+  output.append(depth, '\t');
 }
@@ -19,13 +19,31 @@
  *
  */
 
+#include <string>
+
 #include "Variant.h"
-#include <yajl/yajl_gen.h>
 
+/*!
+ \brief Writes a CVariant as JSON
+
+ The output is generated directly into a string buffer, numbers are always
+ written in the "C" locale regardless of the locale of the process.
+ Beautified output is indented with tabs and ends with a newline.
+ */
 class CJSONVariantWriter
 {
 public:
   static std::string Write(const CVariant &value, bool compact);
+
+  /*! \brief Append the JSON representation of a value to a buffer
+   \param value the value to write
+   \param output the buffer to append to, e.g. a reused response buffer
+   \param compact whether to leave out all whitespace
+   */
+  static void Write(const CVariant &value, std::string &output, bool compact);
+
 private:
-  static bool InternalWrite(yajl_gen g, const CVariant &value);
+  static void InternalWrite(const CVariant &value, std::string &output, bool compact, unsigned int depth);
+  static void WriteString(const char *str, size_t length, std::string &output);
+  static void WriteIndent(unsigned int depth, std::string &output);
 };
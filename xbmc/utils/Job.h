@@ -78,6 +78,7 @@ public:
 };
 
 class CJobManager;
+class CJobWorkItem;
 
 /*!
  \ingroup jobs
@@ -111,7 +112,7 @@ public:
     PRIORITY_NORMAL,
     PRIORITY_HIGH
   };
-  CJob() { m_callback = NULL; };
+  CJob() { m_workItem = NULL; };
 
   /*!
    \brief Destructor for job objects.
@@ -166,5 +167,5 @@ public:
   virtual bool ShouldCancel(unsigned int progress, unsigned int total) const;
 private:
   friend class CJobManager;
-  CJobManager *m_callback;
+  CJobWorkItem *m_workItem;
 };
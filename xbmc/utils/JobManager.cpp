@@ -23,6 +23,7 @@
 #include <functional>
 #include <stdexcept>
 #include "threads/SingleLock.h"
+#include "utils/CPUInfo.h"
 #include "utils/log.h"
 
 #include "system.h"
@@ -31,8 +32,8 @@ using namespace std;
 
 bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
 {
-  if (m_callback)
-    return m_callback->OnJobProgress(progress, total, this);
+  if (m_workItem)
+    return CJobManager::GetInstance().OnJobProgress(progress, total, this);
   return false;
 }
 
@@ -181,41 +182,70 @@ CJobManager &CJobManager::GetInstance()
 CJobManager::CJobManager()
 {
   m_jobCounter = 0;
-  m_running = true;
+  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+    m_injection[priority] = NULL;
   m_pauseJobs = false;
+  m_processing = 0;
+  m_idleWorkers = 0;
+  m_running = true;
 }
 
 void CJobManager::Restart()
 {
-  CSingleLock lock(m_section);
-
-  if (m_running)
+  if (m_running.exchange(true))
     throw std::logic_error("CJobManager already running");
-  m_running = true;
 }
 
 void CJobManager::CancelJobs()
 {
-  CSingleLock lock(m_section);
   m_running = false;
 
-  // clear any pending jobs
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+  // clear any pending jobs and cancel any callbacks on jobs still processing
+  for (unsigned int shard = 0; shard < REGISTRY_SHARDS; ++shard)
   {
-    for_each(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), mem_fun_ref(&CWorkItem::FreeJob));
-    m_jobQueue[priority].clear();
+    std::vector<CJobWorkItem*> queued;
+    {
+      CSingleLock lock(m_registry[shard].section);
+      for (Registry::const_iterator i = m_registry[shard].items.begin(); i != m_registry[shard].items.end(); ++i)
+      {
+        i->second->m_callback = NULL;
+        if (i->second->m_state == CJobWorkItem::STATE_QUEUED)
+        {
+          ++i->second->m_refs;
+          queued.push_back(i->second);
+        }
+      }
+    }
+    for (std::vector<CJobWorkItem*>::iterator i = queued.begin(); i != queued.end(); ++i)
+    {
+      CancelQueuedJob(*i);
+      (*i)->Release();
+    }
   }
 
-  // cancel any callbacks on jobs still processing
-  for_each(m_processing.begin(), m_processing.end(), mem_fun_ref(&CWorkItem::Cancel));
-
   // tell our workers to finish
-  while (m_workers.size())
+  while (true)
   {
-    lock.Leave();
+    {
+      CSharedLock lock(m_workerSection);
+      if (m_workers.empty())
+        break;
+    }
     m_jobEvent.Set();
     Sleep(0); // yield after setting the event to give the workers some time to die
-    lock.Enter();
+  }
+
+  // workers hand their remaining (cancelled) jobs back to the injection queue
+  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+  {
+    CJobWorkItem *item = m_injection[priority].exchange(NULL);
+    while (item)
+    {
+      CJobWorkItem *next = item->m_next;
+      CancelQueuedJob(item);
+      item->Release();
+      item = next;
+    }
   }
 }
 
@@ -225,111 +255,262 @@ CJobManager::~CJobManager()
 
 unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
-
   if (!m_running)
     return 0;
 
   // increment the job counter, ensuring 0 (invalid job) is never hit
-  m_jobCounter++;
-  if (m_jobCounter == 0)
-    m_jobCounter++;
+  unsigned int id = ++m_jobCounter;
+  if (id == 0)
+    id = ++m_jobCounter;
 
   // create a work item for this job
-  CWorkItem work(job, m_jobCounter, priority, callback);
-  m_jobQueue[priority].push_back(work);
+  CJobWorkItem *item = new CJobWorkItem(job, id, priority, callback);
+  job->m_workItem = item;
+  ++item->m_refs; // hold on to the item until we're done with it here
+  RegisterJob(item);
+  PushInjectedJob(item);
 
-  StartWorkers(priority);
-  return work.m_id;
+  // we may have raced with CancelJobs(), in which case the job is cancelled here
+  if (m_running)
+    StartWorkers(priority);
+  else
+    CancelQueuedJob(item);
+  item->Release();
+  return id;
 }
 
 void CJobManager::CancelJob(unsigned int jobID)
 {
-  CSingleLock lock(m_section);
+  RegistryShard &shard = m_registry[jobID % REGISTRY_SHARDS];
+  CSingleLock lock(shard.section);
+
+  Registry::iterator i = shard.items.find(jobID);
+  if (i == shard.items.end())
+    return;
+
+  CJobWorkItem *item = i->second;
+  if (item->m_state == CJobWorkItem::STATE_RUNNING)
+  {
+    item->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
+    return;
+  }
+  ++item->m_refs;
+  lock.Leave();
 
-  // check whether we have this job in the queue
+  // the job may have been picked up by a worker in the meantime
+  if (!CancelQueuedJob(item))
+    item->m_callback = NULL;
+  item->Release();
+}
+
+bool CJobManager::CancelQueuedJob(CJobWorkItem *item)
+{
+  int expected = CJobWorkItem::STATE_QUEUED;
+  if (!item->m_state.compare_exchange_strong(expected, CJobWorkItem::STATE_CANCELLED))
+    return false;
+
+  // we own the job now - the worker popping the item will only drop its reference
+  CJob *job = item->m_job;
+  item->m_job = NULL;
+  UnregisterJob(item);
+  delete job;
+  item->Release();
+  return true;
+}
+
+void CJobManager::RegisterJob(CJobWorkItem *item)
+{
+  RegistryShard &shard = m_registry[item->m_id % REGISTRY_SHARDS];
+  CSingleLock lock(shard.section);
+  shard.items.insert(std::make_pair(item->m_id, item));
+}
+
+void CJobManager::UnregisterJob(CJobWorkItem *item)
+{
+  RegistryShard &shard = m_registry[item->m_id % REGISTRY_SHARDS];
+  CSingleLock lock(shard.section);
+  shard.items.erase(item->m_id);
+}
+
+void CJobManager::PushInjectedJob(CJobWorkItem *item)
+{
+  std::atomic<CJobWorkItem*> &head = m_injection[item->m_priority];
+  item->m_next = head.load();
+  while (!head.compare_exchange_weak(item->m_next, item))
+    ;
+}
+
+bool CJobManager::HasQueuedJobs() const
+{
   for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
   {
-    JobQueue::iterator i = find(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), jobID);
-    if (i != m_jobQueue[priority].end())
-    {
-      delete i->m_job;
-      m_jobQueue[priority].erase(i);
-      return;
-    }
+    if (priority == CJob::PRIORITY_LOW_PAUSABLE && m_pauseJobs)
+      continue;
+    if (m_injection[priority].load() != NULL)
+      return true;
   }
-  // or if we're processing it
-  Processing::iterator it = find(m_processing.begin(), m_processing.end(), jobID);
-  if (it != m_processing.end())
-    it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
+  return false;
 }
 
 void CJobManager::StartWorkers(CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
-
   // check how many free threads we have
-  if (m_processing.size() >= GetMaxWorkers(priority))
+  if (m_processing >= GetMaxWorkers(priority))
     return;
 
   // do we have any sleeping threads?
-  if (m_processing.size() < m_workers.size())
+  if (m_idleWorkers > 0)
   {
     m_jobEvent.Set();
     return;
   }
 
   // everyone is busy - we need more workers
-  m_workers.push_back(new CJobWorker(this));
+  CExclusiveLock lock(m_workerSection);
+  if (m_workers.size() < GetMaxWorkers(CJob::PRIORITY_HIGH))
+    m_workers.push_back(new CJobWorker(this));
 }
 
-CJob *CJobManager::PopJob()
+bool CJobManager::ReserveWorkerSlot(CJob::PRIORITY priority)
+{
+  unsigned int processing = m_processing;
+  while (processing < GetMaxWorkers(priority))
+  {
+    if (m_processing.compare_exchange_weak(processing, processing + 1))
+      return true;
+  }
+  return false;
+}
+
+CJobWorkItem *CJobManager::PopLocalJob(CJobWorker *worker, CJob::PRIORITY priority)
+{
+  CSingleLock lock(worker->m_queueSection);
+  CJobWorker::LocalQueue &queue = worker->m_queue[priority];
+  if (queue.empty())
+    return NULL;
+
+  CJobWorkItem *item = queue.front();
+  queue.pop_front();
+  return item;
+}
+
+CJobWorkItem *CJobManager::PopInjectedJob(CJobWorker *worker, CJob::PRIORITY priority)
+{
+  CJobWorkItem *item = m_injection[priority].exchange(NULL);
+  if (!item)
+    return NULL;
+
+  // the injection queue is a stack, so reverse it to get the jobs in the order they were added
+  CJobWorkItem *oldest = NULL;
+  while (item)
+  {
+    CJobWorkItem *next = item->m_next;
+    item->m_next = oldest;
+    oldest = item;
+    item = next;
+  }
+
+  // keep the rest of the batch in our own queue, where other workers may steal them
+  CSingleLock lock(worker->m_queueSection);
+  for (item = oldest->m_next; item; item = item->m_next)
+    worker->m_queue[priority].push_back(item);
+  return oldest;
+}
+
+CJobWorkItem *CJobManager::StealJob(CJobWorker *worker, CJob::PRIORITY priority)
+{
+  CJobWorkItem *item = NULL;
+  std::vector<CJobWorkItem*> stolen;
+
+  CSharedLock workersLock(m_workerSection);
+  for (Workers::iterator i = m_workers.begin(); i != m_workers.end() && !item; ++i)
+  {
+    CJobWorker *victim = *i;
+    if (victim == worker)
+      continue;
+
+    CSingleLock lock(victim->m_queueSection);
+    CJobWorker::LocalQueue &queue = victim->m_queue[priority];
+    if (queue.empty())
+      continue;
+
+    // take the oldest job to run, along with half of what remains
+    item = queue.front();
+    queue.pop_front();
+    for (size_t count = queue.size() / 2; count > 0; --count)
+    {
+      stolen.push_back(queue.front());
+      queue.pop_front();
+    }
+  }
+  workersLock.Leave();
+
+  if (!stolen.empty())
+  {
+    CSingleLock lock(worker->m_queueSection);
+    worker->m_queue[priority].insert(worker->m_queue[priority].end(), stolen.begin(), stolen.end());
+  }
+  return item;
+}
+
+CJob *CJobManager::PopJob(CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
   for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW_PAUSABLE; --priority)
   {
     // Check whether we're pausing pausable jobs
     if (priority == CJob::PRIORITY_LOW_PAUSABLE && m_pauseJobs)
       continue;
 
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
+    if (!ReserveWorkerSlot(CJob::PRIORITY(priority)))
+      continue;
+
+    while (true)
     {
-      // pop the job off the queue
-      CWorkItem job = m_jobQueue[priority].front();
-      m_jobQueue[priority].pop_front();
-
-      // add to the processing vector
-      m_processing.push_back(job);
-      job.m_job->m_callback = this;
-      return job.m_job;
+      CJobWorkItem *item = PopLocalJob(worker, CJob::PRIORITY(priority));
+      if (!item)
+        item = PopInjectedJob(worker, CJob::PRIORITY(priority));
+      if (!item)
+        item = StealJob(worker, CJob::PRIORITY(priority));
+      if (!item)
+        break;
+
+      int expected = CJobWorkItem::STATE_QUEUED;
+      if (item->m_state.compare_exchange_strong(expected, CJobWorkItem::STATE_RUNNING))
+        return item->m_job;
+
+      // job was cancelled while queued - drop the queue's reference
+      item->Release();
     }
+    --m_processing;
   }
   return NULL;
 }
 
 void CJobManager::PauseJobs()
 {
-  CSingleLock lock(m_section);
   m_pauseJobs = true;
 }
 
 void CJobManager::UnPauseJobs()
 {
-  CSingleLock lock(m_section);
   m_pauseJobs = false;
+  // wake any sleeping workers so the paused jobs are picked up
+  m_jobEvent.Set();
 }
 
 bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 {
-  CSingleLock lock(m_section);
-
   if (m_pauseJobs)
     return false;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
+  for (unsigned int shard = 0; shard < REGISTRY_SHARDS; ++shard)
   {
-    if (priority == it->m_priority)
-      return true;
+    CSingleLock lock(m_registry[shard].section);
+    for (Registry::const_iterator it = m_registry[shard].items.begin(); it != m_registry[shard].items.end(); ++it)
+    {
+      if (it->second->m_state == CJobWorkItem::STATE_RUNNING && priority == it->second->m_priority)
+        return true;
+    }
   }
   return false;
 }
@@ -337,57 +518,67 @@ bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 int CJobManager::IsProcessing(const std::string &type) const
 {
   int jobsMatched = 0;
-  CSingleLock lock(m_section);
 
   if (m_pauseJobs)
     return 0;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
+  for (unsigned int shard = 0; shard < REGISTRY_SHARDS; ++shard)
   {
-    if (type == std::string(it->m_job->GetType()))
-      jobsMatched++;
+    CSingleLock lock(m_registry[shard].section);
+    for (Registry::const_iterator it = m_registry[shard].items.begin(); it != m_registry[shard].items.end(); ++it)
+    {
+      if (it->second->m_state == CJobWorkItem::STATE_RUNNING && type == std::string(it->second->m_job->GetType()))
+        jobsMatched++;
+    }
   }
   return jobsMatched;
 }
 
-CJob *CJobManager::GetNextJob(const CJobWorker *worker)
+CJob *CJobManager::GetNextJob(CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
   while (m_running)
   {
     // grab a job off the queue if we have one
-    CJob *job = PopJob();
+    CJob *job = PopJob(worker);
+    if (job)
+      return job;
+
+    // announce that we're going to sleep before looking one last time, so that
+    // a job added in the meantime either is found here or wakes us up
+    ++m_idleWorkers;
+    job = PopJob(worker);
+    bool newJob = true;
+    if (!job) // no jobs are left - sleep for 30 seconds to allow new jobs to come in
+      newJob = m_jobEvent.WaitMSec(30000);
+    --m_idleWorkers;
     if (job)
       return job;
-    // no jobs are left - sleep for 30 seconds to allow new jobs to come in
-    lock.Leave();
-    bool newJob = m_jobEvent.WaitMSec(30000);
-    lock.Enter();
     if (!newJob)
       break;
   }
-  // ensure no jobs have come in during the period after
-  // timeout and before we held the lock
-  CJob *job = PopJob();
+  // ensure no jobs have come in during the period after timeout
+  CJob *job = m_running ? PopJob(worker) : NULL;
   if (job)
     return job;
   // have no jobs
   RemoveWorker(worker);
+
+  // a job may have been added while we were leaving, with no one left to run it
+  if (m_running && HasQueuedJobs())
+    StartWorkers(CJob::PRIORITY_LOW_PAUSABLE);
   return NULL;
 }
 
 bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
 {
-  CSingleLock lock(m_section);
-  // find the job in the processing queue, and check whether it's cancelled (no callback)
-  Processing::const_iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  // check whether the job has been cancelled (no callback)
+  CJobWorkItem *item = job->m_workItem;
+  if (item && item->m_state == CJobWorkItem::STATE_RUNNING)
   {
-    CWorkItem item(*i);
-    lock.Leave(); // leave section prior to call
-    if (item.m_callback)
+    IJobCallback *callback = item->m_callback;
+    if (callback)
     {
-      item.m_callback->OnJobProgress(item.m_id, progress, total, job);
+      callback->OnJobProgress(item->m_id, progress, total, job);
       return false;
     }
   }
@@ -396,43 +587,58 @@ bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const
 
 void CJobManager::OnJobComplete(bool success, CJob *job)
 {
-  CSingleLock lock(m_section);
-  // remove the job from the processing queue
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  CJobWorkItem *item = job->m_workItem;
+  if (!item)
+    return;
+
+  // tell any listeners we're done with the job, then delete it
+  try
   {
-    // tell any listeners we're done with the job, then delete it
-    CWorkItem item(*i);
-    lock.Leave();
-    try
-    {
-      if (item.m_callback)
-        item.m_callback->OnJobComplete(item.m_id, success, item.m_job);
-    }
-    catch (...)
-    {
-      CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
-    }
-    lock.Enter();
-    Processing::iterator j = find(m_processing.begin(), m_processing.end(), job);
-    if (j != m_processing.end())
-      m_processing.erase(j);
-    lock.Leave();
-    item.FreeJob();
+    IJobCallback *callback = item->m_callback;
+    if (callback)
+      callback->OnJobComplete(item->m_id, success, job);
   }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, job->GetType());
+  }
+  UnregisterJob(item);
+  --m_processing;
+
+  item->m_job = NULL;
+  delete job;
+  item->Release(); // registry reference
+  item->Release(); // queue reference
 }
 
 void CJobManager::RemoveWorker(const CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
-  // remove our worker
+  CExclusiveLock lock(m_workerSection);
   Workers::iterator i = find(m_workers.begin(), m_workers.end(), worker);
-  if (i != m_workers.end())
-    m_workers.erase(i); // workers auto-delete
+  if (i == m_workers.end())
+    return;
+
+  // hand back any jobs left in the worker's queue so that others can pick them up.
+  // This is done before the worker is removed, as CancelJobs() takes an empty
+  // list of workers to mean all jobs have been handed back.
+  CJobWorker *owner = const_cast<CJobWorker*>(worker);
+  {
+    CSingleLock queueLock(owner->m_queueSection);
+    for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+    {
+      for (CJobWorker::LocalQueue::iterator it = owner->m_queue[priority].begin(); it != owner->m_queue[priority].end(); ++it)
+        PushInjectedJob(*it);
+      owner->m_queue[priority].clear();
+    }
+  }
+
+  // remove our worker
+  m_workers.erase(i); // workers auto-delete
 }
 
 unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority)
 {
-  static const unsigned int max_workers = 5;
+  // scale with the number of cores, but never drop below the historic five workers
+  static const unsigned int max_workers = std::max(5, g_cpuInfo.getCPUCount() + 1);
   return max_workers - (CJob::PRIORITY_HIGH - priority);
 }
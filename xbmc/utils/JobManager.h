@@ -19,15 +19,59 @@
  *
  */
 
+#include <atomic>
+#include <deque>
+#include <map>
 #include <queue>
 #include <vector>
 #include <string>
 #include "threads/CriticalSection.h"
+#include "threads/SharedSection.h"
 #include "threads/Thread.h"
 #include "Job.h"
 
 class CJobManager;
 
+/*!
+ \ingroup jobs
+ \brief A job scheduled on the CJobManager, together with its bookkeeping.
+
+ Work items are shared between the job registry (used for lookup by id) and
+ whichever queue currently holds them, and are reference counted so that
+ either side may let go first. The state is only ever moved away from QUEUED
+ once, which decides whether a worker runs the job or a canceller deletes it.
+ */
+class CJobWorkItem
+{
+public:
+  enum STATE
+  {
+    STATE_QUEUED = 0,
+    STATE_RUNNING,
+    STATE_CANCELLED
+  };
+
+  CJobWorkItem(CJob *job, unsigned int id, CJob::PRIORITY priority, IJobCallback *callback)
+    : m_job(job), m_id(id), m_callback(callback), m_priority(priority),
+      m_state(STATE_QUEUED), m_refs(2), m_next(NULL)
+  {
+  }
+
+  void Release()
+  {
+    if (--m_refs == 0)
+      delete this;
+  }
+
+  CJob                       *m_job;
+  unsigned int                m_id;
+  std::atomic<IJobCallback*>  m_callback;
+  CJob::PRIORITY              m_priority;
+  std::atomic<int>            m_state;
+  std::atomic<int>            m_refs;
+  CJobWorkItem               *m_next; ///< link in the lock-free injection queue
+};
+
 class CJobWorker : public CThread
 {
 public:
@@ -36,7 +80,13 @@ public:
 
   void Process();
 private:
+  friend class CJobManager;
+
+  typedef std::deque<CJobWorkItem*> LocalQueue;
+
   CJobManager  *m_jobManager;
+  LocalQueue    m_queue[CJob::PRIORITY_HIGH+1]; ///< jobs owned by this worker, may be stolen by others
+  CCriticalSection m_queueSection;
 };
 
 /*!
@@ -170,43 +220,15 @@ private:
  priority levels.  Lower priority jobs are executed only if there are sufficient
  spare worker threads free to allow for higher priority jobs that may arise.
 
+ New jobs are pushed onto a lock-free injection queue per priority.  Workers
+ take the whole injection queue into their own deque when they run dry and
+ steal from the deques of other workers, so bursts of jobs are spread over all
+ workers without a single lock being taken for every job.
+
  \sa CJob and IJobCallback
  */
 class CJobManager
 {
-  class CWorkItem
-  {
-  public:
-    CWorkItem(CJob *job, unsigned int id, CJob::PRIORITY priority, IJobCallback *callback)
-    {
-      m_job = job;
-      m_id = id;
-      m_callback = callback;
-      m_priority = priority;
-    }
-    bool operator==(unsigned int jobID) const
-    {
-      return m_id == jobID;
-    };
-    bool operator==(const CJob *job) const
-    {
-      return m_job == job;
-    };
-    void FreeJob()
-    {
-      delete m_job;
-      m_job = NULL;
-    };
-    void Cancel()
-    {
-      m_callback = NULL;
-    };
-    CJob         *m_job;
-    unsigned int  m_id;
-    IJobCallback *m_callback;
-    CJob::PRIORITY m_priority;
-  };
-
 public:
   /*!
    \brief The only way through which the global instance of the CJobManager should be accessed.
@@ -267,6 +289,12 @@ public:
    */
   void UnPauseJobs();
 
+  /*!
+   \brief Whether jobs with priority PRIORITY_LOW_PAUSABLE are currently paused
+   \sa PauseJobs()
+   */
+  bool IsPaused() const { return m_pauseJobs; }
+
   /*!
    \brief Checks to see if any jobs with specific priority are currently processing.
    \param priority to search for
@@ -283,7 +311,7 @@ protected:
    \param worker a pointer to the current CJobWorker instance requesting a job.
    \sa CJob
    */
-  CJob *GetNextJob(const CJobWorker *worker);
+  CJob *GetNextJob(CJobWorker *worker);
 
   /*!
    \brief Callback from CJobWorker after a job has completed.
@@ -312,27 +340,60 @@ private:
   CJobManager const& operator=(CJobManager const&);
   virtual ~CJobManager();
 
-  /*! \brief Pop a job off the job queue and add to the processing queue ready to process
+  /*! \brief Pop a job off the job queues and mark it as processing
+   Looks at the worker's own queue first, then the injection queue and finally
+   steals from the other workers.
+   \param worker the worker that is going to process the job
    \return the job to process, NULL if no jobs are available
    */
-  CJob *PopJob();
+  CJob *PopJob(CJobWorker *worker);
+
+  CJobWorkItem *PopLocalJob(CJobWorker *worker, CJob::PRIORITY priority);
+  CJobWorkItem *PopInjectedJob(CJobWorker *worker, CJob::PRIORITY priority);
+  CJobWorkItem *StealJob(CJobWorker *worker, CJob::PRIORITY priority);
+
+  void PushInjectedJob(CJobWorkItem *item);
+  bool HasQueuedJobs() const;
+
+  /*! \brief Reserve a processing slot for a job of the given priority
+   \return true if fewer than GetMaxWorkers(priority) jobs are being processed
+   */
+  bool ReserveWorkerSlot(CJob::PRIORITY priority);
+
+  /*! \brief Move a queued job into the cancelled state and delete it
+   \return true if the job was still queued and has been cancelled
+   */
+  bool CancelQueuedJob(CJobWorkItem *item);
+
+  void RegisterJob(CJobWorkItem *item);
+  void UnregisterJob(CJobWorkItem *item);
 
   void StartWorkers(CJob::PRIORITY priority);
   void RemoveWorker(const CJobWorker *worker);
   static unsigned int GetMaxWorkers(CJob::PRIORITY priority);
 
-  unsigned int m_jobCounter;
+  static const unsigned int REGISTRY_SHARDS = 16;
 
-  typedef std::deque<CWorkItem>    JobQueue;
-  typedef std::vector<CWorkItem>   Processing;
+  typedef std::map<unsigned int, CJobWorkItem*> Registry;
   typedef std::vector<CJobWorker*> Workers;
 
-  JobQueue   m_jobQueue[CJob::PRIORITY_HIGH+1];
-  bool       m_pauseJobs;
-  Processing m_processing;
-  Workers    m_workers;
+  /*! \brief All queued and processing jobs by id, sharded to keep the locks uncontended */
+  struct RegistryShard
+  {
+    mutable CCriticalSection section;
+    Registry                 items;
+  };
 
-  CCriticalSection m_section;
-  CEvent           m_jobEvent;
-  bool             m_running;
+  std::atomic<unsigned int>  m_jobCounter;
+  std::atomic<CJobWorkItem*> m_injection[CJob::PRIORITY_HIGH+1];
+  RegistryShard              m_registry[REGISTRY_SHARDS];
+  std::atomic<bool>          m_pauseJobs;
+  std::atomic<unsigned int>  m_processing;
+  std::atomic<unsigned int>  m_idleWorkers;
+
+  CSharedSection   m_workerSection;
+  Workers          m_workers;
+
+  CEvent            m_jobEvent;
+  std::atomic<bool> m_running;
 };
@@ -24,11 +24,17 @@
 #include "Util.h"
 #include "XBDateTime.h"
 #include "settings/AdvancedSettings.h"
+#include "threads/Condition.h"
+#include "threads/SingleLock.h"
 #include "utils/CharsetConverter.h"
+#include "utils/CPUInfo.h"
+#include "utils/JobManager.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
 
 #include <algorithm>
+#include <locale>
+#include <memory>
 
 using namespace std;
 
@@ -638,6 +644,393 @@ map<SortBy, Fields> fillSortingFields()
 map<SortBy, SortUtils::SortPreparator> SortUtils::m_preparators = fillPreparators();
 map<SortBy, Fields> SortUtils::m_sortingFields = fillSortingFields();
 
+namespace
+{
+/*
+ Labels are compared the way StringUtils::AlphaNumericCompare() does it:
+ runs of up to 15 digits by their value, other characters one by one, case
+ insensitive for ASCII and in the collation order of the system locale.
+ Instead of doing that on every comparison, each label is turned into a
+ key once. A key is a sequence of integer tokens, the collation rank of a
+ character or the value of a number, that compare like the label.
+ */
+const unsigned int SORT_KEY_VALUE_BITS = 50;                                 // 10^15 < 2^50
+const unsigned int SORT_KEY_MAX_RANKS  = 1 << (64 - SORT_KEY_VALUE_BITS);
+const unsigned int SORT_KEY_MAX_DIGITS = 15;
+
+// lists at least this long are sorted on multiple threads
+const size_t PARALLEL_SORT_MIN_ITEMS  = 8192;
+const size_t PARALLEL_SORT_MIN_CHUNK  = 4096;
+
+inline wchar_t foldCase(wchar_t c)
+{
+  return (c >= L'A' && c <= L'Z') ? c + (L'a' - L'A') : c;
+}
+
+inline bool isDigit(wchar_t c)
+{
+  return c >= L'0' && c <= L'9';
+}
+
+class CCollationRanks
+{
+public:
+  /*! \brief Assign ranks to all characters used in the given labels
+   \return false if keys can't reproduce the comparison of these labels
+   */
+  bool Build(const std::vector<std::wstring> &labels)
+  {
+    for (std::vector<std::wstring>::const_iterator label = labels.begin(); label != labels.end(); ++label)
+    {
+      for (std::wstring::const_iterator c = label->begin(); c != label->end(); ++c)
+        m_chars.push_back(foldCase(*c));
+    }
+    std::sort(m_chars.begin(), m_chars.end());
+    m_chars.erase(std::unique(m_chars.begin(), m_chars.end()), m_chars.end());
+    if (m_chars.size() > SORT_KEY_MAX_RANKS)
+      return false;
+
+    const std::collate<wchar_t> &coll = std::use_facet< std::collate<wchar_t> >(g_langInfo.GetSystemLocale());
+    std::vector<wchar_t> collated(m_chars);
+    std::sort(collated.begin(), collated.end(), CollateLess(coll));
+
+    // characters the locale considers equal get the same rank
+    std::vector<uint64_t> ranks(collated.size());
+    for (size_t i = 1; i < collated.size(); i++)
+      ranks[i] = ranks[i - 1] + (coll.compare(&collated[i - 1], &collated[i - 1] + 1, &collated[i], &collated[i] + 1) != 0 ? 1 : 0);
+
+    m_ranks.resize(m_chars.size());
+    uint64_t minDigit = SORT_KEY_MAX_RANKS, maxDigit = 0;
+    for (size_t i = 0; i < collated.size(); i++)
+    {
+      m_ranks[std::lower_bound(m_chars.begin(), m_chars.end(), collated[i]) - m_chars.begin()] = ranks[i];
+      if (isDigit(collated[i]))
+      {
+        minDigit = std::min(minDigit, ranks[i]);
+        maxDigit = std::max(maxDigit, ranks[i]);
+      }
+    }
+
+    // a number is ranked like its first digit. That only works if no other
+    // character sorts in between digits, which is the case in all locales
+    // we know of, but better safe than sorry.
+    for (size_t i = 0; i < collated.size(); i++)
+    {
+      if (!isDigit(collated[i]) && ranks[i] >= minDigit && ranks[i] <= maxDigit)
+        return false;
+    }
+    m_number = minDigit << SORT_KEY_VALUE_BITS;
+
+    return true;
+  }
+
+  void MakeKey(const std::wstring &label, std::vector<uint64_t> &key) const
+  {
+    key.reserve(label.size());
+    const wchar_t *c = label.c_str();
+    const wchar_t *end = c + label.size();
+    while (c < end)
+    {
+      if (isDigit(*c))
+      {
+        uint64_t value = 0;
+        const wchar_t *digits = c;
+        while (c < end && isDigit(*c) && c < digits + SORT_KEY_MAX_DIGITS)
+          value = value * 10 + (*c++ - L'0');
+        key.push_back(m_number | value);
+      }
+      else
+      {
+        size_t index = std::lower_bound(m_chars.begin(), m_chars.end(), foldCase(*c)) - m_chars.begin();
+        key.push_back(m_ranks[index] << SORT_KEY_VALUE_BITS);
+        c++;
+      }
+    }
+  }
+
+private:
+  struct CollateLess
+  {
+    CollateLess(const std::collate<wchar_t> &coll) : m_coll(coll) {}
+    bool operator()(const wchar_t &left, const wchar_t &right) const
+    {
+      return m_coll.compare(&left, &left + 1, &right, &right + 1) < 0;
+    }
+    const std::collate<wchar_t> &m_coll;
+  };
+
+  std::vector<wchar_t> m_chars;   ///< all characters used, sorted by value
+  std::vector<uint64_t> m_ranks;  ///< collation rank of each of m_chars
+  uint64_t m_number;              ///< token bits of a number
+};
+
+struct SortEntry
+{
+  unsigned int group; ///< on top, folders, files and on bottom
+  unsigned int index; ///< position in the unsorted list, keeps the sort stable
+  std::vector<uint64_t> key;
+};
+
+struct SortEntryLess
+{
+  SortEntryLess(bool descending) : m_descending(descending) {}
+
+  bool operator()(const SortEntry *left, const SortEntry *right) const
+  {
+    if (left->group != right->group)
+      return left->group < right->group;
+
+    // items sorted on top or bottom keep their order
+    if (left->group == SORT_GROUP_FOLDER || left->group == SORT_GROUP_FILE)
+    {
+      int result = Compare(left->key, right->key);
+      if (result != 0)
+        return m_descending ? result > 0 : result < 0;
+    }
+    return left->index < right->index;
+  }
+
+  static int Compare(const std::vector<uint64_t> &left, const std::vector<uint64_t> &right)
+  {
+    size_t length = std::min(left.size(), right.size());
+    for (size_t i = 0; i < length; i++)
+    {
+      if (left[i] != right[i])
+        return left[i] < right[i] ? -1 : 1;
+    }
+    return left.size() < right.size() ? -1 : (left.size() > right.size() ? 1 : 0);
+  }
+
+  enum
+  {
+    SORT_GROUP_TOP = 0,
+    SORT_GROUP_FOLDER,
+    SORT_GROUP_FILE,
+    SORT_GROUP_BOTTOM
+  };
+
+  bool m_descending;
+};
+
+typedef std::vector<const SortEntry*> SortEntries;
+
+/*!
+ \brief Sorts or merges ranges of a list on the job manager's workers
+
+ The calling thread takes part and runs every task no worker has picked up
+ yet, so a busy or stopped job manager only makes it slower.
+ */
+class CParallelSort
+{
+public:
+  static void Sort(SortEntries &entries, const SortEntryLess &less)
+  {
+    size_t chunks = std::min((size_t)std::max(g_cpuInfo.getCPUCount(), 1), entries.size() / PARALLEL_SORT_MIN_CHUNK);
+    if (entries.size() < PARALLEL_SORT_MIN_ITEMS || chunks < 2)
+    {
+      std::sort(entries.begin(), entries.end(), less);
+      return;
+    }
+
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i <= chunks; i++)
+      bounds.push_back(entries.size() * i / chunks);
+
+    // sort the chunks, then merge neighbours until one is left
+    std::vector<CTask> tasks;
+    for (size_t i = 0; i < chunks; i++)
+      tasks.push_back(CTask(bounds[i], bounds[i], bounds[i + 1]));
+    Run(entries, less, tasks);
+
+    while (bounds.size() > 2)
+    {
+      std::vector<size_t> merged;
+      tasks.clear();
+      for (size_t i = 0; i + 2 < bounds.size(); i += 2)
+      {
+        tasks.push_back(CTask(bounds[i], bounds[i + 1], bounds[i + 2]));
+        merged.push_back(bounds[i]);
+      }
+      if (bounds.size() % 2 == 0) // odd number of ranges, the last one is done
+        merged.push_back(bounds[bounds.size() - 2]);
+      merged.push_back(bounds.back());
+      Run(entries, less, tasks);
+      bounds.swap(merged);
+    }
+  }
+
+private:
+  struct CTask
+  {
+    CTask(size_t begin, size_t middle, size_t end) : begin(begin), middle(middle), end(end), claimed(false) {}
+    size_t begin;
+    size_t middle; ///< equal to begin for sorting, the start of the second half for merging
+    size_t end;
+    bool claimed;
+  };
+
+  struct CState
+  {
+    CState(SortEntries &entries, const SortEntryLess &less, const std::vector<CTask> &tasks)
+      : entries(entries), less(less), tasks(tasks), running(0) {}
+
+    bool Claim(size_t task)
+    {
+      CSingleLock lock(section);
+      if (tasks[task].claimed)
+        return false;
+      tasks[task].claimed = true;
+      running++;
+      return true;
+    }
+
+    void Execute(size_t task)
+    {
+      const CTask &t = tasks[task];
+      if (t.middle == t.begin)
+        std::sort(entries.begin() + t.begin, entries.begin() + t.end, less);
+      else
+        std::inplace_merge(entries.begin() + t.begin, entries.begin() + t.middle, entries.begin() + t.end, less);
+
+      CSingleLock lock(section);
+      running--;
+      done.notifyAll();
+    }
+
+    SortEntries &entries;
+    SortEntryLess less;
+    std::vector<CTask> tasks;
+    unsigned int running;
+    CCriticalSection section;
+    XbmcThreads::ConditionVariable done;
+  };
+
+  class CTaskJob : public CJob
+  {
+  public:
+    CTaskJob(const std::shared_ptr<CState> &state, size_t task) : m_state(state), m_task(task) {}
+    virtual const char *GetType() const { return "sort"; }
+    virtual bool DoWork()
+    {
+      if (m_state->Claim(m_task))
+        m_state->Execute(m_task);
+      return true;
+    }
+  private:
+    std::shared_ptr<CState> m_state;
+    size_t m_task;
+  };
+
+  static void Run(SortEntries &entries, const SortEntryLess &less, const std::vector<CTask> &tasks)
+  {
+    // jobs may run after we're done here, by then all tasks of their state
+    // are claimed and they don't touch the entries
+    std::shared_ptr<CState> state(new CState(entries, less, tasks));
+    for (size_t i = 1; i < tasks.size(); i++)
+      CJobManager::GetInstance().AddJob(new CTaskJob(state, i), NULL, CJob::PRIORITY_HIGH);
+
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+      if (state->Claim(i))
+        state->Execute(i);
+    }
+
+    CSingleLock lock(state->section);
+    while (state->running > 0)
+      state->done.wait(lock);
+  }
+};
+
+inline const SortItem& getSortItem(const SortItem &item) { return item; }
+inline const SortItem& getSortItem(const SortItemPtr &item) { return *item; }
+
+/*!
+ \brief Sort items by the label stored as FieldSort using precomputed keys
+ \param limit number of items needed at the front of the list, 0 for all
+ \return false if the items can't be sorted this way
+ */
+template<class Items>
+bool sortByKeys(Items &items, SortOrder sortOrder, SortAttribute attributes, size_t limit)
+{
+  const bool handleFolders = !(attributes & SortAttributeIgnoreFolders);
+  std::vector<SortEntry> entries(items.size());
+  std::vector<std::wstring> labels(items.size());
+  size_t folders = 0, regular = 0;
+  for (size_t i = 0; i < items.size(); i++)
+  {
+    const SortItem &item = getSortItem(items[i]);
+    SortEntry &entry = entries[i];
+    entry.index = i;
+
+    SortItem::const_iterator it = item.find(FieldSort);
+    if (it == item.end())
+      return false;
+
+    SortSpecial special = SortSpecialNone;
+    if ((it = item.find(FieldSortSpecial)) != item.end() && it->second.asInteger() <= (int64_t)SortSpecialOnBottom)
+      special = (SortSpecial)it->second.asInteger();
+
+    if (special == SortSpecialOnTop)
+      entry.group = SortEntryLess::SORT_GROUP_TOP;
+    else if (special == SortSpecialOnBottom)
+      entry.group = SortEntryLess::SORT_GROUP_BOTTOM;
+    else
+    {
+      regular++;
+      entry.group = SortEntryLess::SORT_GROUP_FILE;
+      if (handleFolders && (it = item.find(FieldFolder)) != item.end())
+      {
+        folders++;
+        if (it->second.asBoolean())
+          entry.group = SortEntryLess::SORT_GROUP_FOLDER;
+      }
+      labels[i] = item.at(FieldSort).asWideString();
+    }
+  }
+
+  // items without a folder flag aren't ordered against folders and files,
+  // only the comparison of the sorters can handle that (special items don't count)
+  if (folders != 0 && folders != regular)
+    return false;
+
+  CCollationRanks ranks;
+  if (!ranks.Build(labels))
+    return false;
+
+  SortEntries sorted(entries.size());
+  for (size_t i = 0; i < entries.size(); i++)
+  {
+    ranks.MakeKey(labels[i], entries[i].key);
+    sorted[i] = &entries[i];
+  }
+  labels.clear();
+
+  SortEntryLess less(sortOrder == SortOrderDescending);
+  if (limit > 0 && limit < sorted.size())
+    std::partial_sort(sorted.begin(), sorted.begin() + limit, sorted.end(), less);
+  else
+    CParallelSort::Sort(sorted, less);
+
+  Items result;
+  result.reserve(items.size());
+  for (SortEntries::const_iterator entry = sorted.begin(); entry != sorted.end(); ++entry)
+    result.push_back(std::move(items[(*entry)->index]));
+  items.swap(result);
+
+  return true;
+}
+}
+
+bool SortUtils::sortByKeys(SortOrder sortOrder, SortAttribute attributes, DatabaseResults& items, size_t limit)
+{
+  return ::sortByKeys(items, sortOrder, attributes, limit);
+}
+
+bool SortUtils::sortByKeys(SortOrder sortOrder, SortAttribute attributes, SortItems& items, size_t limit)
+{
+  return ::sortByKeys(items, sortOrder, attributes, limit);
+}
+
 void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, DatabaseResults& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
 {
   if (sortBy != SortByNone)
@@ -663,8 +1056,10 @@ void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attribute
         item->insert(pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
       }
 
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorter(sortOrder, attributes));
+      // Do the sorting, only the first limitEnd items need to be in order
+      size_t limit = limitEnd > 0 ? (size_t)limitEnd : 0;
+      if (!sortByKeys(sortOrder, attributes, items, limit))
+        std::stable_sort(items.begin(), items.end(), getSorter(sortOrder, attributes));
     }
   }
 
@@ -702,8 +1097,10 @@ void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attribute
         (*item)->insert(pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
       }
 
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorterIndirect(sortOrder, attributes));
+      // Do the sorting, only the first limitEnd items need to be in order
+      size_t limit = limitEnd > 0 ? (size_t)limitEnd : 0;
+      if (!sortByKeys(sortOrder, attributes, items, limit))
+        std::stable_sort(items.begin(), items.end(), getSorterIndirect(sortOrder, attributes));
     }
   }
 
@@ -145,6 +145,15 @@ public:
   typedef bool (*SorterIndirect) (const SortItemPtr &, const SortItemPtr &);
   
 private:
+  friend class TestSortUtilsHelper;
+
+  /*! \brief Sort prepared items (with FieldSort set) by precomputed collation keys
+   \param limit number of items needed at the front of the list, 0 for all
+   \return false if the items need the comparison of the sorters instead
+   */
+  static bool sortByKeys(SortOrder sortOrder, SortAttribute attributes, DatabaseResults& items, size_t limit);
+  static bool sortByKeys(SortOrder sortOrder, SortAttribute attributes, SortItems& items, size_t limit);
+
   static const SortPreparator& getPreparator(SortBy sortBy);
   static Sorter getSorter(SortOrder sortOrder, SortAttribute attributes);
   static SorterIndirect getSorterIndirect(SortOrder sortOrder, SortAttribute attributes);
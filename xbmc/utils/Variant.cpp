@@ -20,6 +20,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 #include <sstream>
 
 #include "Variant.h"
@@ -130,9 +131,21 @@ double str2double(const wstring &str, double fallback /* = 0.0 */)
 
 CVariant CVariant::ConstNullVariant = CVariant::VariantTypeConstNull;
 
+namespace
+{
+struct KeyLess
+{
+  bool operator()(const std::pair<std::string, CVariant> &member, const std::string &key) const
+  {
+    return member.first < key;
+  }
+};
+}
+
 CVariant::CVariant(VariantType type)
 {
   m_type = type;
+  m_stringLength = 0;
 
   switch (type)
   {
@@ -149,7 +162,7 @@ CVariant::CVariant(VariantType type)
       m_data.dvalue = 0.0;
       break;
     case VariantTypeString:
-      m_data.string = new string();
+      m_data.smallString[0] = '\0';
       break;
     case VariantTypeWideString:
       m_data.wstring = new wstring();
@@ -210,20 +223,29 @@ CVariant::CVariant(bool boolean)
 
 CVariant::CVariant(const char *str)
 {
-  m_type = VariantTypeString;
-  m_data.string = new string(str);
+  initString(str, strlen(str));
 }
 
 CVariant::CVariant(const char *str, unsigned int length)
 {
-  m_type = VariantTypeString;
-  m_data.string = new string(str, length);
+  initString(str, length);
 }
 
 CVariant::CVariant(const string &str)
 {
-  m_type = VariantTypeString;
-  m_data.string = new string(str);
+  initString(str.c_str(), str.size());
+}
+
+CVariant::CVariant(string &&str)
+{
+  if (str.size() <= SMALL_STRING_SIZE)
+    initString(str.c_str(), str.size());
+  else
+  {
+    m_type = VariantTypeString;
+    m_stringLength = HEAP_STRING;
+    m_data.string = new string(std::move(str));
+  }
 }
 
 CVariant::CVariant(const wchar_t *str)
@@ -257,8 +279,10 @@ CVariant::CVariant(const std::map<std::string, std::string> &strMap)
 {
   m_type = VariantTypeObject;
   m_data.map = new VariantMap;
+  m_data.map->reserve(strMap.size());
+  // a std::map is sorted already
   for (std::map<std::string, std::string>::const_iterator it = strMap.begin(); it != strMap.end(); ++it)
-    m_data.map->insert(make_pair(it->first, CVariant(it->second)));
+    m_data.map->push_back(make_pair(it->first, CVariant(it->second)));
 }
 
 CVariant::CVariant(const std::map<std::string, CVariant> &variantMap)
@@ -269,8 +293,18 @@ CVariant::CVariant(const std::map<std::string, CVariant> &variantMap)
 
 CVariant::CVariant(const CVariant &variant)
 {
-  m_type = VariantTypeNull;
-  *this = variant;
+  copy(variant);
+}
+
+CVariant::CVariant(CVariant &&rhs) throw()
+{
+  m_type = rhs.m_type;
+  m_stringLength = rhs.m_stringLength;
+  m_data = rhs.m_data;
+
+  // the constant null stays what it is, everything else is ours now
+  if (rhs.m_type != VariantTypeConstNull)
+    rhs.m_type = VariantTypeNull;
 }
 
 CVariant::~CVariant()
@@ -281,7 +315,10 @@ CVariant::~CVariant()
 void CVariant::cleanup()
 {
   if (m_type == VariantTypeString)
-    delete m_data.string;
+  {
+    if (m_stringLength == HEAP_STRING)
+      delete m_data.string;
+  }
   else if (m_type == VariantTypeWideString)
     delete m_data.wstring;
   else if (m_type == VariantTypeArray)
@@ -291,6 +328,76 @@ void CVariant::cleanup()
   m_type = VariantTypeNull;
 }
 
+void CVariant::copy(const CVariant &rhs)
+{
+  m_type = rhs.m_type;
+  m_stringLength = rhs.m_stringLength;
+
+  switch (m_type)
+  {
+  case VariantTypeString:
+    if (m_stringLength == HEAP_STRING)
+      m_data.string = new string(*rhs.m_data.string);
+    else
+      m_data = rhs.m_data;
+    break;
+  case VariantTypeWideString:
+    m_data.wstring = new wstring(*rhs.m_data.wstring);
+    break;
+  case VariantTypeArray:
+    m_data.array = new VariantArray(*rhs.m_data.array);
+    break;
+  case VariantTypeObject:
+    m_data.map = new VariantMap(*rhs.m_data.map);
+    break;
+  default:
+    m_data = rhs.m_data;
+    break;
+  }
+}
+
+void CVariant::initString(const char *str, size_t length)
+{
+  m_type = VariantTypeString;
+  if (length <= SMALL_STRING_SIZE)
+  {
+    memcpy(m_data.smallString, str, length);
+    m_data.smallString[length] = '\0';
+    m_stringLength = (uint8_t)length;
+  }
+  else
+  {
+    m_data.string = new string(str, length);
+    m_stringLength = HEAP_STRING;
+  }
+}
+
+const char *CVariant::stringData() const
+{
+  return m_stringLength == HEAP_STRING ? m_data.string->c_str() : m_data.smallString;
+}
+
+size_t CVariant::stringLength() const
+{
+  return m_stringLength == HEAP_STRING ? m_data.string->size() : m_stringLength;
+}
+
+CVariant::VariantMap::iterator CVariant::findMember(const std::string &key)
+{
+  VariantMap::iterator it = std::lower_bound(m_data.map->begin(), m_data.map->end(), key, KeyLess());
+  if (it != m_data.map->end() && it->first == key)
+    return it;
+  return m_data.map->end();
+}
+
+CVariant::VariantMap::const_iterator CVariant::findMember(const std::string &key) const
+{
+  VariantMap::const_iterator it = std::lower_bound(m_data.map->begin(), m_data.map->end(), key, KeyLess());
+  if (it != m_data.map->end() && it->first == key)
+    return it;
+  return m_data.map->end();
+}
+
 bool CVariant::isInteger() const
 {
   return m_type == VariantTypeInteger;
@@ -352,7 +459,7 @@ int64_t CVariant::asInteger(int64_t fallback) const
     case VariantTypeDouble:
       return (int64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2int64(*m_data.string, fallback);
+      return str2int64(asString(), fallback);
     case VariantTypeWideString:
       return str2int64(*m_data.wstring, fallback);
     default:
@@ -373,7 +480,7 @@ uint64_t CVariant::asUnsignedInteger(uint64_t fallback) const
     case VariantTypeDouble:
       return (uint64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2uint64(*m_data.string, fallback);
+      return str2uint64(asString(), fallback);
     case VariantTypeWideString:
       return str2uint64(*m_data.wstring, fallback);
     default:
@@ -394,7 +501,7 @@ double CVariant::asDouble(double fallback) const
     case VariantTypeUnsignedInteger:
       return (double)m_data.unsignedinteger;
     case VariantTypeString:
-      return str2double(*m_data.string, fallback);
+      return str2double(asString(), fallback);
     case VariantTypeWideString:
       return str2double(*m_data.wstring, fallback);
     default:
@@ -415,7 +522,7 @@ float CVariant::asFloat(float fallback) const
     case VariantTypeUnsignedInteger:
       return (float)m_data.unsignedinteger;
     case VariantTypeString:
-      return (float)str2double(*m_data.string, fallback);
+      return (float)str2double(asString(), fallback);
     case VariantTypeWideString:
       return (float)str2double(*m_data.wstring, fallback);
     default:
@@ -438,9 +545,13 @@ bool CVariant::asBoolean(bool fallback) const
     case VariantTypeDouble:
       return (m_data.dvalue != 0);
     case VariantTypeString:
-      if (m_data.string->empty() || m_data.string->compare("0") == 0 || m_data.string->compare("false") == 0)
+    {
+      const char *str = stringData();
+      size_t length = stringLength();
+      if (length == 0 || (length == 1 && str[0] == '0') || (length == 5 && memcmp(str, "false", 5) == 0))
         return false;
       return true;
+    }
     case VariantTypeWideString:
       if (m_data.wstring->empty() || m_data.wstring->compare(L"0") == 0 || m_data.wstring->compare(L"false") == 0)
         return false;
@@ -457,7 +568,7 @@ std::string CVariant::asString(const std::string &fallback /* = "" */) const
   switch (m_type)
   {
     case VariantTypeString:
-      return *m_data.string;
+      return string(stringData(), stringLength());
     case VariantTypeBoolean:
       return m_data.boolean ? "true" : "false";
     case VariantTypeInteger:
@@ -517,7 +628,20 @@ CVariant &CVariant::operator[](const std::string &key)
   }
 
   if (m_type == VariantTypeObject)
-    return (*m_data.map)[key];
+  {
+    // members are mostly added in order, check the end first
+    VariantMap &map = *m_data.map;
+    if (map.empty() || map.back().first < key)
+    {
+      map.push_back(make_pair(key, CVariant()));
+      return map.back().second;
+    }
+
+    VariantMap::iterator it = std::lower_bound(map.begin(), map.end(), key, KeyLess());
+    if (it == map.end() || it->first != key)
+      it = map.insert(it, make_pair(key, CVariant()));
+    return it->second;
+  }
   else
     return ConstNullVariant;
 }
@@ -525,7 +649,7 @@ CVariant &CVariant::operator[](const std::string &key)
 const CVariant &CVariant::operator[](const std::string &key) const
 {
   VariantMap::const_iterator it;
-  if (m_type == VariantTypeObject && (it = m_data.map->find(key)) != m_data.map->end())
+  if (m_type == VariantTypeObject && (it = findMember(key)) != m_data.map->end())
     return it->second;
   else
     return ConstNullVariant;
@@ -552,39 +676,26 @@ CVariant &CVariant::operator=(const CVariant &rhs)
   if (m_type == VariantTypeConstNull || this == &rhs)
     return *this;
 
+  // rhs may be part of this value, copy it before letting go of ours
+  CVariant tmp(rhs);
   cleanup();
+  *this = std::move(tmp);
 
-  m_type = rhs.m_type;
+  return *this;
+}
 
-  switch (m_type)
-  {
-  case VariantTypeInteger:
-    m_data.integer = rhs.m_data.integer;
-    break;
-  case VariantTypeUnsignedInteger:
-    m_data.integer = rhs.m_data.unsignedinteger;
-    break;
-  case VariantTypeBoolean:
-    m_data.boolean = rhs.m_data.boolean;
-    break;
-  case VariantTypeDouble:
-    m_data.dvalue = rhs.m_data.dvalue;
-    break;
-  case VariantTypeString:
-    m_data.string = new string(*rhs.m_data.string);
-    break;
-  case VariantTypeWideString:
-    m_data.wstring = new wstring(*rhs.m_data.wstring);
-    break;
-  case VariantTypeArray:
-    m_data.array = new VariantArray(rhs.m_data.array->begin(), rhs.m_data.array->end());
-    break;
-  case VariantTypeObject:
-    m_data.map = new VariantMap(rhs.m_data.map->begin(), rhs.m_data.map->end());
-    break;
-  default:
-    break;
-  }
+CVariant &CVariant::operator=(CVariant &&rhs) throw()
+{
+  if (m_type == VariantTypeConstNull || this == &rhs)
+    return *this;
+
+  // rhs may be part of this value, take it before letting go of ours
+  CVariant tmp(std::move(rhs));
+  cleanup();
+  m_type = tmp.m_type;
+  m_stringLength = tmp.m_stringLength;
+  m_data = tmp.m_data;
+  tmp.m_type = VariantTypeNull;
 
   return *this;
 }
@@ -604,7 +715,7 @@ bool CVariant::operator==(const CVariant &rhs) const
     case VariantTypeDouble:
       return m_data.dvalue == rhs.m_data.dvalue;
     case VariantTypeString:
-      return *m_data.string == *rhs.m_data.string;
+      return stringLength() == rhs.stringLength() && memcmp(stringData(), rhs.stringData(), stringLength()) == 0;
     case VariantTypeWideString:
       return *m_data.wstring == *rhs.m_data.wstring;
     case VariantTypeArray:
@@ -631,28 +742,52 @@ void CVariant::push_back(const CVariant &variant)
     m_data.array->push_back(variant);
 }
 
+void CVariant::push_back(CVariant &&variant)
+{
+  if (m_type == VariantTypeNull)
+  {
+    m_type = VariantTypeArray;
+    m_data.array = new VariantArray;
+  }
+
+  if (m_type == VariantTypeArray)
+    m_data.array->push_back(std::move(variant));
+}
+
 void CVariant::append(const CVariant &variant)
 {
   push_back(variant);
 }
 
+void CVariant::append(CVariant &&variant)
+{
+  push_back(std::move(variant));
+}
+
 const char *CVariant::c_str() const
 {
   if (m_type == VariantTypeString)
-    return m_data.string->c_str();
+    return stringData();
   else
     return NULL;
 }
 
 void CVariant::swap(CVariant &rhs)
 {
+  // like assignments, swaps with the constant null are ignored
+  if (m_type == VariantTypeConstNull || rhs.m_type == VariantTypeConstNull)
+    return;
+
   VariantType  temp_type = m_type;
+  uint8_t      temp_length = m_stringLength;
   VariantUnion temp_data = m_data;
 
   m_type = rhs.m_type;
+  m_stringLength = rhs.m_stringLength;
   m_data = rhs.m_data;
 
   rhs.m_type = temp_type;
+  rhs.m_stringLength = temp_length;
   rhs.m_data = temp_data;
 }
 
@@ -727,7 +862,7 @@ unsigned int CVariant::size() const
   else if (m_type == VariantTypeArray)
     return m_data.array->size();
   else if (m_type == VariantTypeString)
-    return m_data.string->size();
+    return stringLength();
   else if (m_type == VariantTypeWideString)
     return m_data.wstring->size();
   else
@@ -741,7 +876,7 @@ bool CVariant::empty() const
   else if (m_type == VariantTypeArray)
     return m_data.array->empty();
   else if (m_type == VariantTypeString)
-    return m_data.string->empty();
+    return stringLength() == 0;
   else if (m_type == VariantTypeWideString)
     return m_data.wstring->empty();
   else if (m_type == VariantTypeNull)
@@ -757,7 +892,12 @@ void CVariant::clear()
   else if (m_type == VariantTypeArray)
     m_data.array->clear();
   else if (m_type == VariantTypeString)
-    m_data.string->clear();
+  {
+    if (m_stringLength == HEAP_STRING)
+      delete m_data.string;
+    m_stringLength = 0;
+    m_data.smallString[0] = '\0';
+  }
   else if (m_type == VariantTypeWideString)
     m_data.wstring->clear();
 }
@@ -770,7 +910,11 @@ void CVariant::erase(const std::string &key)
     m_data.map = new VariantMap;
   }
   else if (m_type == VariantTypeObject)
-    m_data.map->erase(key);
+  {
+    VariantMap::iterator it = findMember(key);
+    if (it != m_data.map->end())
+      m_data.map->erase(it);
+  }
 }
 
 void CVariant::erase(unsigned int position)
@@ -788,7 +932,7 @@ void CVariant::erase(unsigned int position)
 bool CVariant::isMember(const std::string &key) const
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->find(key) != m_data.map->end();
+    return findMember(key) != m_data.map->end();
 
   return false;
 }
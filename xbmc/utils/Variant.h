@@ -21,6 +21,7 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <utility>
 #include <stdint.h>
 #include <wchar.h>
 
@@ -31,6 +32,15 @@ uint64_t str2uint64(const std::wstring &str, uint64_t fallback = 0);
 double str2double(const std::string &str, double fallback = 0.0);
 double str2double(const std::wstring &str, double fallback = 0.0);
 
+/*!
+ \brief A JSON like value: a number, string, array or object
+
+ Strings of up to 15 characters are stored inline, longer ones on the heap.
+ Objects are kept as a vector of key/value pairs sorted by key, which
+ takes a single allocation instead of one per member. Like with arrays,
+ inserting a member may move the other members of the same object, so
+ references to them must not be held across the insertion.
+ */
 class CVariant
 {
 public:
@@ -59,6 +69,7 @@ public:
   CVariant(const char *str);
   CVariant(const char *str, unsigned int length);
   CVariant(const std::string &str);
+  CVariant(std::string &&str);
   CVariant(const wchar_t *str);
   CVariant(const wchar_t *str, unsigned int length);
   CVariant(const std::wstring &str);
@@ -66,6 +77,7 @@ public:
   CVariant(const std::map<std::string, std::string> &strMap);
   CVariant(const std::map<std::string, CVariant> &variantMap);
   CVariant(const CVariant &variant);
+  CVariant(CVariant &&rhs) throw();
   ~CVariant();
 
   bool isInteger() const;
@@ -94,11 +106,14 @@ public:
   const CVariant &operator[](unsigned int position) const;
 
   CVariant &operator=(const CVariant &rhs);
+  CVariant &operator=(CVariant &&rhs) throw();
   bool operator==(const CVariant &rhs) const;
   bool operator!=(const CVariant &rhs) const { return !(*this == rhs); }
 
   void push_back(const CVariant &variant);
+  void push_back(CVariant &&variant);
   void append(const CVariant &variant);
+  void append(CVariant &&variant);
 
   const char *c_str() const;
 
@@ -106,7 +121,7 @@ public:
 
 private:
   typedef std::vector<CVariant> VariantArray;
-  typedef std::map<std::string, CVariant> VariantMap;
+  typedef std::vector< std::pair<std::string, CVariant> > VariantMap; ///< sorted by key
 
 public:
   typedef VariantArray::iterator        iterator_array;
@@ -136,7 +151,16 @@ public:
   static CVariant ConstNullVariant;
 
 private:
+  enum { SMALL_STRING_SIZE = 15, HEAP_STRING = 0xFF };
+
   void cleanup();
+  void copy(const CVariant &rhs);
+  void initString(const char *str, size_t length);
+  const char *stringData() const;
+  size_t stringLength() const;
+  VariantMap::iterator findMember(const std::string &key);
+  VariantMap::const_iterator findMember(const std::string &key) const;
+
   union VariantUnion
   {
     int64_t integer;
@@ -147,8 +171,10 @@ private:
     std::wstring *wstring;
     VariantArray *array;
     VariantMap *map;
+    char smallString[SMALL_STRING_SIZE + 1];
   };
 
   VariantType m_type;
+  uint8_t m_stringLength; ///< length of an inline string or HEAP_STRING
   VariantUnion m_data;
 };
@@ -0,0 +1,87 @@
+/*
+ *      Copyright (C) 2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/FrameProfiler.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
+
+#include "gtest/gtest.h"
+
+static void AddFrames(FrameStage stage, float ms, unsigned int frames)
+{
+  int64_t ticks = (int64_t)(ms * CurrentHostFrequency() / 1000);
+  for (unsigned int i = 0; i < frames; i++)
+  {
+    CFrameProfiler::Get().AddTime(stage, ticks);
+    CFrameProfiler::Get().EndFrame();
+  }
+}
+
+TEST(TestFrameProfiler, Histogram)
+{
+  CFrameProfiler &profiler = CFrameProfiler::Get();
+  profiler.Reset();
+  profiler.EndFrame(); // the first frame only starts the clock
+
+  std::vector<FrameStageStats> stats;
+  profiler.GetStats(stats);
+  ASSERT_EQ((size_t)FRAME_STAGE_COUNT, stats.size());
+  EXPECT_EQ(0u, stats[FRAME_STAGE_PROCESS].frames);
+  EXPECT_STREQ("process", stats[FRAME_STAGE_PROCESS].name.c_str());
+
+  AddFrames(FRAME_STAGE_PROCESS, 1.5f, 90);
+  AddFrames(FRAME_STAGE_PROCESS, 30.0f, 15);
+  profiler.GetStats(stats);
+  const FrameStageStats &process = stats[FRAME_STAGE_PROCESS];
+  EXPECT_EQ(105u, process.frames);
+  EXPECT_NEAR(1.5f, process.median, 0.01f);
+  EXPECT_NEAR(30.0f, process.p95, 0.01f);
+  EXPECT_NEAR(30.0f, process.maximum, 0.01f);
+  EXPECT_NEAR((135.0f + 450.0f) / 105, process.average, 0.01f);
+  ASSERT_EQ(CFrameProfiler::GetBucketCount(), process.histogram.size());
+  EXPECT_EQ(90u, process.histogram[1]);  // <= 2 ms
+  EXPECT_EQ(15u, process.histogram[8]);   // <= 33.4 ms
+  EXPECT_EQ(105u, stats[FRAME_STAGE_RENDER].histogram[0]);
+
+  // old frames drop out of the ring and the histogram
+  AddFrames(FRAME_STAGE_PROCESS, 300.0f, FRAME_PROFILER_FRAMES);
+  profiler.GetStats(stats);
+  EXPECT_EQ((unsigned int)FRAME_PROFILER_FRAMES, stats[FRAME_STAGE_PROCESS].frames);
+  EXPECT_EQ((unsigned int)FRAME_PROFILER_FRAMES, stats[FRAME_STAGE_PROCESS].histogram.back());
+  EXPECT_EQ(0u, stats[FRAME_STAGE_PROCESS].histogram[1]);
+  EXPECT_NEAR(300.0f, stats[FRAME_STAGE_PROCESS].average, 0.01f);
+}
+
+TEST(TestFrameProfiler, Variant)
+{
+  CFrameProfiler &profiler = CFrameProfiler::Get();
+  profiler.Reset();
+  profiler.EndFrame();
+  AddFrames(FRAME_STAGE_TEXTURE_UPLOAD, 5.0f, 10);
+
+  CVariant stats;
+  profiler.GetStats(stats);
+  EXPECT_EQ(10u, stats["frames"].asUnsignedInteger());
+  EXPECT_EQ(CFrameProfiler::GetBucketCount(), stats["buckets"].size());
+  EXPECT_EQ(0.0f, stats["buckets"][CFrameProfiler::GetBucketCount() - 1].asFloat());
+  EXPECT_NEAR(5.0f, stats["stages"]["textureupload"]["p95"].asFloat(), 0.01f);
+  EXPECT_EQ(10u, stats["stages"]["textureupload"]["histogram"][3].asUnsignedInteger());
+  profiler.Reset();
+}
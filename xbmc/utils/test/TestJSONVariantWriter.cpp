@@ -18,6 +18,7 @@
  *
  */
 
+#include "utils/JSONVariantParser.h"
 #include "utils/JSONVariantWriter.h"
 
 #include "gtest/gtest.h"
@@ -30,3 +31,101 @@ TEST(TestJSONVariantWriter, Write)
   str = CJSONVariantWriter::Write(variant, false);
   EXPECT_STREQ("null\n", str.c_str());
 }
+
+TEST(TestJSONVariantWriter, Compact)
+{
+  CVariant variant(CVariant::VariantTypeObject);
+  variant["int"] = -42;
+  variant["uint"] = (uint64_t)18446744073709551615ULL;
+  variant["double"] = 1.5;
+  variant["round"] = 3.0;
+  variant["bool"] = true;
+  variant["null"] = CVariant();
+  variant["array"].push_back("a");
+  variant["array"].push_back(CVariant(CVariant::VariantTypeObject));
+  variant["array"].push_back(CVariant(CVariant::VariantTypeArray));
+
+  EXPECT_STREQ("{\"array\":[\"a\",{},[]],\"bool\":true,\"double\":1.5,\"int\":-42,"
+               "\"null\":null,\"round\":3.0,\"uint\":18446744073709551615}",
+               CJSONVariantWriter::Write(variant, true).c_str());
+}
+
+TEST(TestJSONVariantWriter, Beautified)
+{
+  CVariant variant(CVariant::VariantTypeObject);
+  variant["list"].push_back(1);
+  variant["list"].push_back(CVariant(CVariant::VariantTypeObject));
+  variant["list"][1]["key"] = "value";
+  variant["empty"] = CVariant(CVariant::VariantTypeArray);
+
+  EXPECT_STREQ("{\n"
+               "\t\"empty\": [\n"
+               "\n"
+               "\t],\n"
+               "\t\"list\": [\n"
+               "\t\t1,\n"
+               "\t\t{\n"
+               "\t\t\t\"key\": \"value\"\n"
+               "\t\t}\n"
+               "\t]\n"
+               "}\n",
+               CJSONVariantWriter::Write(variant, false).c_str());
+}
+
+TEST(TestJSONVariantWriter, Escaping)
+{
+  CVariant variant("quote\" backslash\\ slash/ \b\f\n\r\t \x01\x1f \xc3\xa9");
+  EXPECT_STREQ("\"quote\\\" backslash\\\\ slash/ \\b\\f\\n\\r\\t \\u0001\\u001F \xc3\xa9\"",
+               CJSONVariantWriter::Write(variant, true).c_str());
+}
+
+TEST(TestJSONVariantWriter, Append)
+{
+  std::string output = "{\"result\":";
+  CJSONVariantWriter::Write(CVariant(1), output, true);
+  output += "}";
+  EXPECT_STREQ("{\"result\":1}", output.c_str());
+}
+
+TEST(TestJSONVariantWriter, RoundTrip)
+{
+  // roughly what VideoLibrary.GetMovies returns
+  const unsigned int movies = 50;
+  CVariant result(CVariant::VariantTypeObject);
+  for (unsigned int i = 0; i < movies; i++)
+  {
+    CVariant movie(CVariant::VariantTypeObject);
+    movie["movieid"] = i + 1;
+    movie["label"] = "Some Movie Title";
+    movie["title"] = "Some Movie Title";
+    movie["plot"] = "A \"quoted\" plot\nover two lines";
+    movie["rating"] = 7.5;
+    movie["year"] = 2000 + i % 15;
+    movie["playcount"] = 0;
+    movie["runtime"] = 6300;
+    movie["file"] = "smb://server/share/movies/Some Movie Title (2010)/Some Movie Title (2010).mkv";
+    movie["art"]["poster"] = "image://smb%3a%2f%2fserver%2fshare%2fmovies%2fposter.jpg/";
+    movie["art"]["fanart"] = "image://smb%3a%2f%2fserver%2fshare%2fmovies%2ffanart.jpg/";
+    for (unsigned int g = 0; g < 3; g++)
+      movie["genre"].push_back("Genre");
+    for (unsigned int c = 0; c < 10; c++)
+    {
+      CVariant actor(CVariant::VariantTypeObject);
+      actor["name"] = "Actor Name";
+      actor["role"] = "Role Name";
+      actor["order"] = c;
+      movie["cast"].push_back(actor);
+    }
+    result["movies"].push_back(movie);
+  }
+
+  // parsing the output gives the same document
+  for (int compact = 0; compact < 2; compact++)
+  {
+    std::string output = CJSONVariantWriter::Write(result, compact != 0);
+    CVariant parsed = CJSONVariantParser::Parse((const unsigned char *)output.c_str(), output.size());
+    ASSERT_TRUE(parsed.isObject());
+    ASSERT_EQ(movies, parsed["movies"].size());
+    EXPECT_EQ(output, CJSONVariantWriter::Write(parsed, compact != 0));
+  }
+}
@@ -24,6 +24,8 @@
 
 #include "gtest/gtest.h"
 
+#include <atomic>
+
 /* CSysInfoJob::GetInternetState() will test for network connectivity. */
 class TestJobManager : public testing::Test
 {
@@ -177,3 +179,80 @@ TEST_F(TestJobManager, IsProcessing)
 
   job->FinishAndStopBlocking();
 }
+
+namespace
+{
+class CountingJob : public CJob
+{
+public:
+  CountingJob(std::atomic<int> &destroyed) : m_destroyed(destroyed) {}
+  ~CountingJob() { ++m_destroyed; }
+  bool DoWork() { return true; }
+  const char *GetType() const { return "CountingJob"; }
+private:
+  std::atomic<int> &m_destroyed;
+};
+
+class CountingCallback : public IJobCallback
+{
+public:
+  CountingCallback() : m_completed(0) {}
+  void OnJobComplete(unsigned int jobID, bool success, CJob *job) { ++m_completed; }
+  std::atomic<int> m_completed;
+};
+
+bool WaitForCount(const std::atomic<int> &count, int expected)
+{
+  for (int i = 0; i < 1000 && count < expected; i++)
+    XbmcThreads::ThreadSleep(10);
+  return count == expected;
+}
+}
+
+TEST_F(TestJobManager, ManyJobsComplete)
+{
+  static const int jobs = 2000;
+  std::atomic<int> destroyed(0);
+  CountingCallback callback;
+
+  for (int i = 0; i < jobs; i++)
+    CJobManager::GetInstance().AddJob(new CountingJob(destroyed), &callback,
+                                      CJob::PRIORITY(i % (CJob::PRIORITY_HIGH + 1)));
+
+  EXPECT_TRUE(WaitForCount(callback.m_completed, jobs));
+  EXPECT_TRUE(WaitForCount(destroyed, jobs));
+}
+
+TEST_F(TestJobManager, CancelQueuedJob)
+{
+  std::atomic<int> destroyed(0);
+  CountingCallback callback;
+
+  CJobManager::GetInstance().PauseJobs();
+  unsigned int id = CJobManager::GetInstance().AddJob(new CountingJob(destroyed), &callback,
+                                                      CJob::PRIORITY_LOW_PAUSABLE);
+  EXPECT_NE(0U, id);
+  CJobManager::GetInstance().CancelJob(id);
+  CJobManager::GetInstance().UnPauseJobs();
+
+  // a queued job is deleted straight away and never reports back
+  EXPECT_EQ(1, destroyed);
+  XbmcThreads::ThreadSleep(100);
+  EXPECT_EQ(0, callback.m_completed);
+}
+
+TEST_F(TestJobManager, PausedJobsRunAfterUnPause)
+{
+  std::atomic<int> destroyed(0);
+  CountingCallback callback;
+
+  CJobManager::GetInstance().PauseJobs();
+  for (int i = 0; i < 10; i++)
+    CJobManager::GetInstance().AddJob(new CountingJob(destroyed), &callback,
+                                      CJob::PRIORITY_LOW_PAUSABLE);
+  XbmcThreads::ThreadSleep(100);
+  EXPECT_EQ(0, callback.m_completed);
+
+  CJobManager::GetInstance().UnPauseJobs();
+  EXPECT_TRUE(WaitForCount(callback.m_completed, 10));
+}
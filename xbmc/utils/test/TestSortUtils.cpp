@@ -20,9 +20,32 @@
 
 #include "utils/SortUtils.h"
 #include "utils/Variant.h"
+#include "utils/StringUtils.h"
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
+
+class TestSortUtilsHelper
+{
+public:
+  /* sorts by label like SortUtils::Sort(), but only by precomputed keys */
+  static bool SortByKeys(SortOrder sortOrder, SortAttribute attributes, SortItems &items)
+  {
+    for (SortItems::iterator item = items.begin(); item != items.end(); ++item)
+      (**item)[FieldSort] = CVariant((**item)[FieldLabel].asWideString());
+    return SortUtils::sortByKeys(sortOrder, attributes, items, 0);
+  }
+
+  static SortItems Copy(const SortItems &items)
+  {
+    SortItems copy;
+    for (SortItems::const_iterator item = items.begin(); item != items.end(); ++item)
+      copy.push_back(SortItemPtr(new SortItem(**item)));
+    return copy;
+  }
+};
+
 TEST(TestSortUtils, Sort_SortBy)
 {
   SortItems items;
@@ -131,3 +154,153 @@ TEST(TestSortUtils, GetFieldsForSorting)
   EXPECT_EQ(FieldTrackNumber, *it);
   EXPECT_EQ((unsigned int)4, fields.size());
 }
+
+TEST(TestSortUtils, Sort_Labels)
+{
+  // numbers, case and punctuation have to come out in the order of
+  // StringUtils::AlphaNumericCompare(), equal labels in their original order
+  const char *labels[] = { "Track 10", "track 2", "Track 1", "(Intro)", "Track 02", "a", "A", "", "Track 1b",
+                           "Track 1a", "10 Songs", "9 Songs", "Track 1234567890123456", "Track 1234567890123455" };
+  const size_t count = sizeof(labels) / sizeof(labels[0]);
+  SortOrder orders[] = { SortOrderAscending, SortOrderDescending };
+  for (unsigned int order = 0; order < 2; order++)
+  {
+    SortItems items;
+    for (size_t i = 0; i < count; i++)
+    {
+      SortItemPtr item(new SortItem());
+      (*item)[FieldLabel] = labels[i];
+      (*item)[FieldId] = (int)i;
+      items.push_back(item);
+    }
+
+    SortUtils::Sort(SortByLabel, orders[order], SortAttributeNone, items);
+
+    ASSERT_EQ(count, items.size());
+    for (size_t i = 1; i < count; i++)
+    {
+      std::wstring left = (*items[i - 1])[FieldSort].asWideString();
+      std::wstring right = (*items[i])[FieldSort].asWideString();
+      int64_t result = StringUtils::AlphaNumericCompare(left.c_str(), right.c_str());
+      if (orders[order] == SortOrderDescending)
+        result = -result;
+      EXPECT_LE(result, 0) << (*items[i - 1])[FieldLabel].asString() << " before " << (*items[i])[FieldLabel].asString();
+      if (result == 0)
+      {
+        EXPECT_LT((*items[i - 1])[FieldId].asInteger(), (*items[i])[FieldId].asInteger());
+      }
+    }
+  }
+}
+
+namespace
+{
+struct LabelLess
+{
+  LabelLess(bool descending) : descending(descending) {}
+  bool operator()(const SortItemPtr &left, const SortItemPtr &right) const
+  {
+    std::wstring l = (*left)[FieldSort].asWideString();
+    std::wstring r = (*right)[FieldSort].asWideString();
+    int64_t result = StringUtils::AlphaNumericCompare(l.c_str(), r.c_str());
+    return descending ? result > 0 : result < 0;
+  }
+  bool descending;
+};
+}
+
+TEST(TestSortUtils, Sort_LargeList)
+{
+  // long enough to be sorted on multiple threads, with lots of equal labels
+  const int count = 20000;
+  SortOrder orders[] = { SortOrderAscending, SortOrderDescending };
+  for (unsigned int order = 0; order < 2; order++)
+  {
+    SortItems items;
+    for (int i = 0; i < count; i++)
+    {
+      SortItemPtr item(new SortItem());
+      (*item)[FieldLabel] = StringUtils::Format(i % 2 ? "Track %i" : "track %i", (i * 7919) % 1000);
+      (*item)[FieldId] = i;
+      items.push_back(item);
+    }
+
+    // the serial, stable sort of the same labels
+    SortItems expected = TestSortUtilsHelper::Copy(items);
+    for (SortItems::iterator item = expected.begin(); item != expected.end(); ++item)
+      (**item)[FieldSort] = CVariant((**item)[FieldLabel].asWideString());
+    std::stable_sort(expected.begin(), expected.end(), LabelLess(orders[order] == SortOrderDescending));
+
+    SortUtils::Sort(SortByLabel, orders[order], SortAttributeNone, items);
+
+    ASSERT_EQ(expected.size(), items.size());
+    for (size_t i = 0; i < items.size(); i++)
+      ASSERT_EQ((*expected[i])[FieldId].asInteger(), (*items[i])[FieldId].asInteger()) << "at " << i;
+  }
+}
+
+TEST(TestSortUtils, Sort_SpecialAndFolders)
+{
+  const char *labels[] = { "B", "Parent", "A", "C", "Last", "D" };
+  const bool folders[] = { false, true, true, false, false, true };
+  const int special[] = { SortSpecialNone, SortSpecialOnTop, SortSpecialNone, SortSpecialNone, SortSpecialOnBottom, SortSpecialNone };
+
+  SortItems items;
+  for (size_t i = 0; i < sizeof(labels) / sizeof(labels[0]); i++)
+  {
+    SortItemPtr item(new SortItem());
+    (*item)[FieldLabel] = labels[i];
+    (*item)[FieldFolder] = folders[i];
+    (*item)[FieldSortSpecial] = special[i];
+    items.push_back(item);
+  }
+
+  // special items (like ".." in a listing) mustn't keep the keys from being used
+  SortItems keyed = TestSortUtilsHelper::Copy(items);
+  ASSERT_TRUE(TestSortUtilsHelper::SortByKeys(SortOrderDescending, SortAttributeNone, keyed));
+  SortUtils::Sort(SortByLabel, SortOrderDescending, SortAttributeNone, items);
+
+  const char *expected[] = { "Parent", "D", "A", "C", "B", "Last" };
+  for (size_t i = 0; i < items.size(); i++)
+  {
+    EXPECT_STREQ(expected[i], (*keyed[i])[FieldLabel].asString().c_str());
+    EXPECT_STREQ(expected[i], (*items[i])[FieldLabel].asString().c_str());
+  }
+
+  keyed = TestSortUtilsHelper::Copy(items);
+  ASSERT_TRUE(TestSortUtilsHelper::SortByKeys(SortOrderAscending, SortAttributeIgnoreFolders, keyed));
+  SortUtils::Sort(SortByLabel, SortOrderAscending, SortAttributeIgnoreFolders, items);
+
+  const char *ignoringFolders[] = { "Parent", "A", "B", "C", "D", "Last" };
+  for (size_t i = 0; i < items.size(); i++)
+  {
+    EXPECT_STREQ(ignoringFolders[i], (*keyed[i])[FieldLabel].asString().c_str());
+    EXPECT_STREQ(ignoringFolders[i], (*items[i])[FieldLabel].asString().c_str());
+  }
+
+  // special items without a folder flag don't matter either
+  keyed = TestSortUtilsHelper::Copy(items);
+  (*keyed[0]).erase(FieldFolder);
+  EXPECT_TRUE(TestSortUtilsHelper::SortByKeys(SortOrderAscending, SortAttributeNone, keyed));
+
+  // but regular ones do, those are left to the sorters
+  (*keyed[1]).erase(FieldFolder);
+  EXPECT_FALSE(TestSortUtilsHelper::SortByKeys(SortOrderAscending, SortAttributeNone, keyed));
+}
+
+TEST(TestSortUtils, Sort_Limit)
+{
+  DatabaseResults items;
+  for (unsigned int i = 0; i < 1000; i++)
+  {
+    DatabaseResult item;
+    item[FieldTitle] = StringUtils::Format("Title %u", (i * 7919) % 1000);
+    items.push_back(item);
+  }
+
+  SortUtils::Sort(SortByTitle, SortOrderAscending, SortAttributeNone, items, 15, 5);
+
+  ASSERT_EQ((size_t)10, items.size());
+  for (unsigned int i = 0; i < items.size(); i++)
+    EXPECT_EQ(StringUtils::Format("Title %u", i + 5), items[i][FieldTitle].asString());
+}
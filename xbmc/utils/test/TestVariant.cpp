@@ -22,6 +22,8 @@
 
 #include "gtest/gtest.h"
 
+#include <utility>
+
 TEST(TestVariant, VariantTypeInteger)
 {
   CVariant a((int)0), b((int64_t)1);
@@ -348,3 +350,66 @@ TEST(TestVariant, isMember)
   EXPECT_TRUE(a.isMember("key1"));
   EXPECT_FALSE(a.isMember("key2"));
 }
+
+TEST(TestVariant, move)
+{
+  CVariant a("a string long enough not to be stored inline");
+  CVariant b(std::move(a));
+  EXPECT_TRUE(a.isNull());
+  EXPECT_STREQ("a string long enough not to be stored inline", b.c_str());
+
+  CVariant c;
+  c["key"] = std::move(b);
+  EXPECT_TRUE(b.isNull());
+  EXPECT_STREQ("a string long enough not to be stored inline", c["key"].c_str());
+
+  // the constant null can't be changed through moves or swaps
+  CVariant d(std::move(CVariant::ConstNullVariant));
+  EXPECT_TRUE(CVariant::ConstNullVariant.isNull());
+  c["key"].swap(CVariant::ConstNullVariant);
+  EXPECT_TRUE(CVariant::ConstNullVariant.isNull());
+  EXPECT_TRUE(c["key"].isString());
+}
+
+TEST(TestVariant, smallString)
+{
+  std::string embedded("a\0b", 3);
+  CVariant a(embedded), b("exactly 15 char"), c("exactly 16 chars");
+  EXPECT_EQ(3u, a.size());
+  EXPECT_TRUE(a == CVariant(embedded));
+  EXPECT_EQ(embedded, a.asString());
+  EXPECT_STREQ("exactly 15 char", b.c_str());
+  EXPECT_STREQ("exactly 16 chars", c.c_str());
+  EXPECT_FALSE(b == c);
+
+  b = c;
+  EXPECT_TRUE(b == c);
+  c.clear();
+  EXPECT_TRUE(c.empty());
+  EXPECT_STREQ("", c.c_str());
+
+  // assigning a member of itself
+  CVariant d;
+  d["key"] = "value";
+  d = d["key"];
+  EXPECT_STREQ("value", d.c_str());
+}
+
+TEST(TestVariant, mapOrder)
+{
+  CVariant a;
+  const char *keys[] = { "m", "b", "z", "a", "k", "b" };
+  for (unsigned int i = 0; i < sizeof(keys) / sizeof(keys[0]); i++)
+    a[keys[i]] = i;
+
+  EXPECT_EQ(5u, a.size());
+  EXPECT_EQ(5, a["b"].asInteger());
+  std::string order;
+  for (CVariant::const_iterator_map it = a.begin_map(); it != a.end_map(); ++it)
+    order += it->first;
+  EXPECT_STREQ("abkmz", order.c_str());
+
+  a.erase("k");
+  EXPECT_FALSE(a.isMember("k"));
+  EXPECT_TRUE(a.isMember("m"));
+}
@@ -126,7 +126,7 @@ void CVideoDatabase::CreateTables()
   m_pDS->exec("CREATE TABLE writer_link(actor_id INTEGER, media_id INTEGER, media_type TEXT)");
 
   CLog::Log(LOGINFO, "create path table");
-  m_pDS->exec("CREATE TABLE path ( idPath integer primary key, strPath text, strContent text, strScraper text, strHash text, scanRecursive integer, useFolderNames bool, strSettings text, noUpdate bool, exclude bool, dateAdded text, idParentPath integer)");
+  m_pDS->exec("CREATE TABLE path ( idPath integer primary key, strPath text, strContent text, strScraper text, strHash text, scanRecursive integer, useFolderNames bool, strSettings text, noUpdate bool, exclude bool, dateAdded text, idParentPath integer, strSubDirs text)");
 
   CLog::Log(LOGINFO, "create files table");
   m_pDS->exec("CREATE TABLE files ( idFile integer primary key, idPath integer, strFilename text, playCount integer, lastPlayed text, dateAdded text)");
@@ -941,6 +941,63 @@ bool CVideoDatabase::SetPathHash(const std::string &path, const std::string &has
   return false;
 }
 
+bool CVideoDatabase::SetPathSubDirs(const std::string &path, const std::vector<std::string> &subdirs)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    int idPath = AddPath(path);
+    if (idPath < 0) return false;
+
+    // every folder is terminated, so that the root itself ("") is stored as well
+    std::string dirs;
+    for (std::vector<std::string>::const_iterator it = subdirs.begin(); it != subdirs.end(); ++it)
+      dirs += *it + "\n";
+
+    std::string strSQL=PrepareSQL("update path set strSubDirs='%s' where idPath=%ld", dirs.c_str(), idPath);
+    m_pDS->exec(strSQL.c_str());
+
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, path.c_str());
+  }
+
+  return false;
+}
+
+bool CVideoDatabase::GetPathSubDirs(const std::string &path, std::vector<std::string> &subdirs)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    subdirs.clear();
+    std::string strSQL=PrepareSQL("select strSubDirs from path where strPath='%s'", path.c_str());
+    m_pDS->query(strSQL.c_str());
+    if (m_pDS->num_rows() == 0)
+      return false;
+    std::string dirs = m_pDS->fv("strSubDirs").get_asString();
+    m_pDS->close();
+    if (!dirs.empty())
+    {
+      subdirs = StringUtils::Split(dirs, "\n");
+      subdirs.pop_back();
+    }
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, path.c_str());
+  }
+
+  return false;
+}
+
 bool CVideoDatabase::LinkMovieToTvshow(int idMovie, int idShow, bool bRemove)
 {
    try
@@ -1383,14 +1440,14 @@ int CVideoDatabase::AddToTable(const std::string& table, const std::string& firs
     if (NULL == m_pDB.get()) return -1;
     if (NULL == m_pDS.get()) return -1;
 
-    std::string strSQL = PrepareSQL("select %s from %s where %s like '%s'", firstField.c_str(), table.c_str(), secondField.c_str(), value.c_str());
-    m_pDS->query(strSQL.c_str());
+    std::string strSQL = PrepareSQL("select %s from %s where %s like ?", firstField.c_str(), table.c_str(), secondField.c_str());
+    m_pDS->query(strSQL, { value });
     if (m_pDS->num_rows() == 0)
     {
       m_pDS->close();
       // doesnt exists, add it
-      strSQL = PrepareSQL("insert into %s (%s, %s) values(NULL, '%s')", table.c_str(), firstField.c_str(), secondField.c_str(), value.c_str());      
-      m_pDS->exec(strSQL.c_str());
+      strSQL = PrepareSQL("insert into %s (%s, %s) values(NULL, ?)", table.c_str(), firstField.c_str(), secondField.c_str());
+      m_pDS->exec(strSQL, { value });
       int id = (int)m_pDS->lastinsertid();
       return id;
     }
@@ -1437,14 +1494,12 @@ int CVideoDatabase::AddActor(const std::string& name, const std::string& thumbUR
     std::string trimmedName = name.c_str();
     StringUtils::Trim(trimmedName);
 
-    std::string strSQL=PrepareSQL("select actor_id from actor where name = '%s'", trimmedName.c_str());
-    m_pDS->query(strSQL.c_str());
+    m_pDS->query("select actor_id from actor where name = ?", { trimmedName });
     if (m_pDS->num_rows() == 0)
     {
       m_pDS->close();
       // doesnt exists, add it
-      strSQL=PrepareSQL("insert into actor (actor_id, name, art_urls) values(NULL, '%s', '%s')", trimmedName.c_str(), thumbURLs.c_str());
-      m_pDS->exec(strSQL.c_str());
+      m_pDS->exec("insert into actor (actor_id, name, art_urls) values(NULL, ?, ?)", { trimmedName, thumbURLs });
       idActor = (int)m_pDS->lastinsertid();
     }
     else
@@ -1453,10 +1508,7 @@ int CVideoDatabase::AddActor(const std::string& name, const std::string& thumbUR
       m_pDS->close();
       // update the thumb url's
       if (!thumbURLs.empty())
-      {
-        strSQL=PrepareSQL("update actor set art_urls='%s' where actor_id=%i",thumbURLs.c_str(),idActor);
-        m_pDS->exec(strSQL.c_str());
-      }
+        m_pDS->exec("update actor set art_urls=? where actor_id=?", { thumbURLs, idActor });
     }
     // add artwork
     if (!thumb.empty())
@@ -1474,24 +1526,22 @@ int CVideoDatabase::AddActor(const std::string& name, const std::string& thumbUR
 
 void CVideoDatabase::AddLinkToActor(int mediaId, const char *mediaType, int actorId, const std::string &role, int order)
 {
-  std::string sql=PrepareSQL("SELECT 1 FROM actor_link WHERE actor_id=%i AND media_id=%i AND media_type='%s'", actorId, mediaId, mediaType);
-
-  if (GetSingleValue(sql).empty())
+  if (GetSingleValue("SELECT 1 FROM actor_link WHERE actor_id=? AND media_id=? AND media_type=?", { actorId, mediaId, mediaType }).empty())
   { // doesnt exists, add it
-    sql = PrepareSQL("INSERT INTO actor_link (actor_id, media_id, media_type, role, cast_order) VALUES(%i,%i,'%s','%s',%i)", actorId, mediaId, mediaType, role.c_str(), order);
-    ExecuteQuery(sql);
+    ExecuteQuery("INSERT INTO actor_link (actor_id, media_id, media_type, role, cast_order) VALUES(?,?,?,?,?)",
+                 { actorId, mediaId, mediaType, role, order });
   }
 }
 
 void CVideoDatabase::AddToLinkTable(int mediaId, const std::string& mediaType, const std::string& table, int valueId, const char *foreignKey)
 {
   const char *key = foreignKey ? foreignKey : table.c_str();
-  std::string sql = PrepareSQL("SELECT 1 FROM %s_link WHERE %s_id=%i AND media_id=%i AND media_type='%s'", table.c_str(), key, valueId, mediaId, mediaType.c_str());
+  std::string sql = PrepareSQL("SELECT 1 FROM %s_link WHERE %s_id=? AND media_id=? AND media_type=?", table.c_str(), key);
 
-  if (GetSingleValue(sql).empty())
+  if (GetSingleValue(sql, { valueId, mediaId, mediaType }).empty())
   { // doesnt exists, add it
-    sql = PrepareSQL("INSERT INTO %s_link (%s_id,media_id,media_type) VALUES(%i,%i,'%s')", table.c_str(), key, valueId, mediaId, mediaType.c_str());
-    ExecuteQuery(sql);
+    sql = PrepareSQL("INSERT INTO %s_link (%s_id,media_id,media_type) VALUES(?,?,?)", table.c_str(), key);
+    ExecuteQuery(sql, { valueId, mediaId, mediaType });
   }
 }
 
@@ -4006,6 +4056,33 @@ bool CVideoDatabase::GetArtTypes(const MediaType &mediaType, std::vector<std::st
   return false;
 }
 
+bool CVideoDatabase::GetArtURLs(std::vector<std::string> &urls)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    int numRows = RunQuery("SELECT DISTINCT url FROM art");
+    if (numRows <= 0)
+      return numRows == 0;
+
+    urls.reserve(urls.size() + numRows);
+    while (!m_pDS->eof())
+    {
+      urls.push_back(m_pDS->fv(0).get_asString());
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
 /// \brief GetStackTimes() obtains any saved video times for the stacked file
 /// \retval Returns true if the stack times exist, false otherwise.
 bool CVideoDatabase::GetStackTimes(const std::string &filePath, vector<int> &times)
@@ -4668,11 +4745,13 @@ void CVideoDatabase::UpdateTables(int iVersion)
     m_pDS->exec("DROP TABLE IF EXISTS tag");
     m_pDS->exec("ALTER TABLE tagnew RENAME TO tag");
   }
+  if (iVersion < 92)
+    m_pDS->exec("ALTER TABLE path ADD strSubDirs text");
 }
 
 int CVideoDatabase::GetSchemaVersion() const
 {
-  return 91;
+  return 92;
 }
 
 void CVideoDatabase::CleanupActorLinkTablePre91(const std::string &linkTable, const std::string &linkTableIdActor, const std::string &linkTableIdMedia, int idActor, const std::string &strActor)
@@ -606,6 +606,18 @@ public:
   // scanning hashes and paths scanned
   bool SetPathHash(const std::string &path, const std::string &hash);
   bool GetPathHash(const std::string &path, std::string &hash);
+
+  /*! \brief store the folders below a path that were part of its last recursive hash
+   Lets the scanner check a tree for changes by stat()ing the known folders
+   instead of listing them again.
+   \param path the path the folders belong to
+   \param subdirs the folders relative to path, an empty string for path itself
+   \return true on success, false on failure.
+   \sa GetPathSubDirs
+   */
+  bool SetPathSubDirs(const std::string &path, const std::vector<std::string> &subdirs);
+  bool GetPathSubDirs(const std::string &path, std::vector<std::string> &subdirs);
+
   bool GetPaths(std::set<std::string> &paths);
   bool GetPathsForTvShow(int idShow, std::set<int>& paths);
 
@@ -781,6 +793,7 @@ public:
   bool GetTvShowSeasons(int showId, std::map<int, int> &seasons);
   bool GetTvShowSeasonArt(int mediaId, std::map<int, std::map<std::string, std::string> > &seasonArt);
   bool GetArtTypes(const MediaType &mediaType, std::vector<std::string> &artTypes);
+  bool GetArtURLs(std::vector<std::string> &urls);
 
   int AddTag(const std::string &tag);
   void AddTagToItem(int idItem, int idTag, const std::string &type);
@@ -23,6 +23,7 @@
 #include "VideoInfoScanner.h"
 #include "addons/AddonManager.h"
 #include "filesystem/DirectoryCache.h"
+#include "filesystem/DirectoryChangeJournal.h"
 #include "Util.h"
 #include "NfoFile.h"
 #include "utils/RegExp.h"
@@ -288,10 +289,16 @@ namespace VIDEO
       }
 
       std::string fastHash;
+      bool haveHash = m_database.GetPathHash(strDirectory, dbHash);
       if (g_advancedSettings.m_bVideoLibraryUseFastHash)
-        fastHash = GetFastHash(strDirectory, regexps);
+      {
+        if (g_advancedSettings.m_bVideoScannerUseChangeJournal && CDirectoryChangeJournal::Get().IsUnchanged(strDirectory, dbHash))
+          fastHash = dbHash;
+        else
+          fastHash = GetJournaledFastHash(strDirectory, vector<string>(1, strDirectory), regexps);
+      }
 
-      if (m_database.GetPathHash(strDirectory, dbHash) && !fastHash.empty() && fastHash == dbHash)
+      if (haveHash && !fastHash.empty() && fastHash == dbHash)
       { // fast hashes match - no need to process anything
         hash = fastHash;
       }
@@ -712,10 +719,11 @@ namespace VIDEO
         m_pathsToScan.erase(it);
 
       std::string hash, dbHash;
+      bool haveHash = m_database.GetPathHash(item->GetPath(), dbHash);
       if (g_advancedSettings.m_bVideoLibraryUseFastHash)
-        hash = GetRecursiveFastHash(item->GetPath(), regexps);
+        hash = GetIncrementalFastHash(item->GetPath(), dbHash, regexps);
 
-      if (m_database.GetPathHash(item->GetPath(), dbHash) && !hash.empty() && dbHash == hash)
+      if (haveHash && !hash.empty() && dbHash == hash)
       {
         // fast hashes match - no need to process anything
         bSkip = true;
@@ -1779,45 +1787,19 @@ namespace VIDEO
     return true;
   }
 
-  std::string CVideoInfoScanner::GetFastHash(const std::string &directory, const vector<string> &excludes) const
+  std::string CVideoInfoScanner::GetFastHash(const vector<string> &directories, const vector<string> &excludes) const
   {
     XBMC::XBMC_MD5 md5state;
 
-    if (excludes.size())
-      md5state.append(StringUtils::Join(excludes, "|"));
-
-    struct __stat64 buffer;
-    if (XFILE::CFile::Stat(directory, &buffer) == 0)
-    {
-      int64_t time = buffer.st_mtime;
-      if (!time)
-        time = buffer.st_ctime;
-      if (time)
-      {
-        md5state.append((unsigned char *)&time, sizeof(time));
-        return md5state.getDigest();
-      }
-    }
-    return "";
-  }
-
-  std::string CVideoInfoScanner::GetRecursiveFastHash(const std::string &directory, const vector<string> &excludes) const
-  {
-    CFileItemList items;
-    items.Add(CFileItemPtr(new CFileItem(directory, true)));
-    CUtil::GetRecursiveDirsListing(directory, items, DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_NO_FILE_INFO);
-
-    XBMC::XBMC_MD5 md5state;
-
     if (excludes.size())
       md5state.append(StringUtils::Join(excludes, "|"));
 
     int64_t time = 0;
-    for (int i=0; i < items.Size(); ++i)
+    for (vector<string>::const_iterator i = directories.begin(); i != directories.end(); ++i)
     {
       int64_t stat_time = 0;
       struct __stat64 buffer;
-      if (XFILE::CFile::Stat(items[i]->GetPath(), &buffer) == 0)
+      if (XFILE::CFile::Stat(*i, &buffer) == 0)
       {
         // TODO: some filesystems may return the mtime/ctime inline, in which case this is
         // unnecessarily expensive. Consider supporting Stat() in our directory cache?
@@ -1837,6 +1819,63 @@ namespace VIDEO
     return "";
   }
 
+  std::string CVideoInfoScanner::GetJournaledFastHash(const std::string &directory, const vector<string> &directories, const vector<string> &excludes) const
+  {
+    if (!g_advancedSettings.m_bVideoScannerUseChangeJournal)
+      return GetFastHash(directories, excludes);
+
+    // watch before hashing, so that changes made while we stat() aren't lost
+    CDirectoryChangeJournal &journal = CDirectoryChangeJournal::Get();
+    journal.Watch(directory, directories);
+    std::string hash = GetFastHash(directories, excludes);
+    journal.SetHash(directory, hash);
+    return hash;
+  }
+
+  std::string CVideoInfoScanner::GetIncrementalFastHash(const std::string &directory, const std::string &dbHash, const vector<string> &excludes)
+  {
+    if (g_advancedSettings.m_bVideoScannerUseChangeJournal && CDirectoryChangeJournal::Get().IsUnchanged(directory, dbHash))
+      return dbHash;
+
+    // if we know the folders of the tree from the last scan, stat() them instead of listing
+    // the whole tree. New or removed folders change the mtime of their parent, so the hash
+    // only matches if the folder list is still complete.
+    vector<string> subdirs;
+    if (g_advancedSettings.m_bVideoScannerIncremental && !dbHash.empty() &&
+        m_database.GetPathSubDirs(directory, subdirs) && !subdirs.empty())
+    {
+      vector<string> dirs;
+      for (vector<string>::const_iterator i = subdirs.begin(); i != subdirs.end(); ++i)
+        dirs.push_back(i->empty() ? directory : URIUtils::AddFileToFolder(directory, *i));
+
+      std::string hash = GetJournaledFastHash(directory, dirs, excludes);
+      if (hash == dbHash)
+        return hash;
+    }
+
+    CFileItemList items;
+    items.Add(CFileItemPtr(new CFileItem(directory, true)));
+    CUtil::GetRecursiveDirsListing(directory, items, DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_NO_FILE_INFO);
+
+    vector<string> dirs;
+    for (int i = 0; i < items.Size(); ++i)
+      dirs.push_back(items[i]->GetPath());
+    std::string hash = GetJournaledFastHash(directory, dirs, excludes);
+
+    if (g_advancedSettings.m_bVideoScannerIncremental && !hash.empty())
+    {
+      subdirs.clear();
+      for (vector<string>::const_iterator i = dirs.begin(); i != dirs.end(); ++i)
+      {
+        if (!StringUtils::StartsWith(*i, directory))
+          return hash;
+        subdirs.push_back(i->substr(directory.size()));
+      }
+      m_database.SetPathSubDirs(directory, subdirs);
+    }
+    return hash;
+  }
+
   void CVideoInfoScanner::GetSeasonThumbs(const CVideoInfoTag &show, map<int, map<string, string> > &seasonArt, const vector<string> &artTypes, bool useLocal)
   {
     bool lookForThumb = find(artTypes.begin(), artTypes.end(), "thumb") == artTypes.end();
@@ -182,29 +182,39 @@ namespace VIDEO
 
     static int GetPathHash(const CFileItemList &items, std::string &hash);
 
-    /*! \brief Retrieve a "fast" hash of the given directory (if available)
-     Performs a stat() on the directory, and uses modified time to create a "fast"
-     hash of the folder. If no modified time is available, the create time is used,
+    /*! \brief Retrieve a "fast" hash of the given directories (if available)
+     Performs a stat() on each directory, and uses modified time to create a "fast"
+     hash of the folders. If no modified time is available, the create time is used,
      and if neither are available, an empty hash is returned.
      In case exclude from scan expressions are present, the string array will be appended
      to the md5 hash to ensure we're doing a re-scan whenever the user modifies those.
-     \param directory folder to hash
+     \param directories folders to hash
      \param excludes string array of exclude expressions
-     \return the md5 hash of the folder"
+     \return the md5 hash of the folders
      */
-    std::string GetFastHash(const std::string &directory, const std::vector<std::string> &excludes) const;
+    std::string GetFastHash(const std::vector<std::string> &directories, const std::vector<std::string> &excludes) const;
+
+    /*! \brief As GetFastHash(), but also arms the change journal of the tree if enabled
+     \param directory the root of the tree
+     \param directories all folders of the tree
+     \param excludes string array of exclude expressions
+     \return the md5 hash of the folders
+     \sa XFILE::CDirectoryChangeJournal
+     */
+    std::string GetJournaledFastHash(const std::string &directory, const std::vector<std::string> &directories, const std::vector<std::string> &excludes) const;
 
     /*! \brief Retrieve a "fast" hash of the given directory recursively (if available)
-     Performs a stat() on the directory, and uses modified time to create a "fast"
-     hash of each folder. If no modified time is available, the create time is used,
-     and if neither are available, an empty hash is returned.
-     In case exclude from scan expressions are present, the string array will be appended
-     to the md5 hash to ensure we're doing a re-scan whenever the user modifies those.
+     Performs a stat() on each folder of the tree, and uses modified time to create a "fast"
+     hash, see GetFastHash(). The folders the tree had at the last scan are stat()ed without
+     listing the tree. Only if their hash differs from the one in the database is the tree
+     listed again, and the new folder list stored.
+     With the change journal enabled, unchanged local trees aren't even stat()ed.
      \param directory folder to hash (recursively)
+     \param dbHash the hash stored for the folder in the database
      \param excludes string array of exclude expressions
      \return the md5 hash of the folder
      */
-    std::string GetRecursiveFastHash(const std::string &directory, const std::vector<std::string> &excludes) const;
+    std::string GetIncrementalFastHash(const std::string &directory, const std::string &dbHash, const std::vector<std::string> &excludes);
 
     /*! \brief Decide whether a folder listing could use the "fast" hash
      Fast hashing can be done whenever the folder contains no scannable subfolders, as the
@@ -1552,6 +1552,16 @@ void CGUIWindowVideoBase::PlayItem(int iItem)
   }
 }
 
+void CGUIWindowVideoBase::FrameMove()
+{
+  // load thumbs of the items in view first
+  int item = m_viewControl.GetSelectedItem();
+  if (m_thumbLoader.IsLoading() && item >= 0 && item < m_vecItems->Size())
+    m_thumbLoader.SetFocusItem(m_vecItems->Get(item));
+
+  CGUIMediaWindow::FrameMove();
+}
+
 bool CGUIWindowVideoBase::Update(const std::string &strDirectory, bool updateFilterPath /* = true */)
 {
   if (m_thumbLoader.IsLoading())
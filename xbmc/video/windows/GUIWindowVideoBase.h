@@ -43,6 +43,7 @@ public:
   virtual ~CGUIWindowVideoBase(void);
   virtual bool OnMessage(CGUIMessage& message);
   virtual bool OnAction(const CAction &action);
+  virtual void FrameMove();
 
   void PlayMovie(const CFileItem *item);
   static void GetResumeItemOffset(const CFileItem *item, int& startoffset, int& partNumber);
@@ -23,6 +23,7 @@
 #include "settings/AdvancedSettings.h"
 #include "addons/Skin.h"
 #include "utils/CPUInfo.h"
+#include "utils/FrameProfiler.h"
 #include "utils/log.h"
 #include "CompileInfo.h"
 #include "input/ButtonTranslator.h"
@@ -32,6 +33,8 @@
 #include "guilib/GUIWindowManager.h"
 #include "guilib/GUIControlProfiler.h"
 #include "GUIInfoManager.h"
+#include "GUILargeTextureManager.h"
+#include "filesystem/DllLibCurl.h"
 #include "utils/Variant.h"
 #include "utils/StringUtils.h"
 
@@ -116,6 +119,25 @@ void CGUIWindowDebugInfo::Process(unsigned int currentTime, CDirtyRegionList &di
     info = StringUtils::Format("LOG: %s%s.log\nMEM: %" PRIu64"/%" PRIu64" KB - FPS: %2.1f fps\nCPU: %s (CPU-%s %4.2f%%%s)", g_advancedSettings.m_logFolder.c_str(), lcAppName.c_str(),
                                stat.ullAvailPhys/1024, stat.ullTotalPhys/1024, g_infoManager.GetFPS(), strCores.c_str(), ucAppName.c_str(), dCPU, profiling.c_str());
 #endif
+
+    // per stage frame timings, avg/p95/max in ms over the last frames
+    std::vector<FrameStageStats> stages;
+    CFrameProfiler::Get().GetStats(stages);
+    for (unsigned int i = 0; i < stages.size(); i++)
+    {
+      info += StringUtils::Format("%s%s: %.1f/%.1f/%.1f", i % 4 ? "  " : "\n", stages[i].name.c_str(),
+                                  stages[i].average, stages[i].p95, stages[i].maximum);
+    }
+
+    // background texture loads, and how many of them kept a texture in view waiting
+    CGUILargeTextureManager::Stats textures = g_largeTextureManager.GetStats();
+    info += StringUtils::Format("\nTEX: %u loaded (%u waited for, %u prefetched, %u cancelled), %u queued",
+                                textures.loaded, textures.waited, textures.prefetched, textures.cancelled, textures.queued);
+
+    // connections used by http transfers, how many of them came from a kept-alive session
+    unsigned int created, reused;
+    g_curlInterface.GetConnectionStats(created, reused);
+    info += StringUtils::Format("\nHTTP: %u connections (%u new, %u reused)", created + reused, created, reused);
   }
 
   // render the skin debug info